@@ -0,0 +1,653 @@
+#include "BoundingVolumeTree.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	const std::uint32_t BinCount = 16;
+
+	// Half the surface area; only ever compared.
+	float Area(const BoundingBox& box)
+	{
+		const XMFLOAT3& e = box.Extents;
+		return 4.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+	}
+
+	BoundingBox Merge(const BoundingBox& a, const BoundingBox& b)
+	{
+		BoundingBox merged;
+		BoundingBox::CreateMerged(merged, a, b);
+		return merged;
+	}
+
+	// Build works on min/max corners, which are cheaper to grow than center/extents.
+	struct Bounds3
+	{
+		float Min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+		float Max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+		void Grow(const float min[3], const float max[3])
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				Min[k] = std::min(Min[k], min[k]);
+				Max[k] = std::max(Max[k], max[k]);
+			}
+		}
+
+		float Area()const
+		{
+			float x = Max[0] - Min[0];
+			float y = Max[1] - Min[1];
+			float z = Max[2] - Min[2];
+			return x * y + y * z + z * x;
+		}
+	};
+
+	struct BuildItem
+	{
+		float Min[3];
+		float Max[3];
+		float Centroid[3];
+		std::uint32_t Object;
+	};
+
+	struct BuildTask
+	{
+		std::uint32_t Begin;
+		std::uint32_t End;
+		std::uint32_t Parent;
+		bool Left;
+	};
+
+	// Splits items [begin, end) in two non-empty halves and returns where the second
+	// one starts.
+	std::uint32_t SplitSah(std::vector<BuildItem>& items, std::uint32_t begin, std::uint32_t end)
+	{
+		Bounds3 centroids;
+		for (std::uint32_t i = begin; i < end; ++i)
+			centroids.Grow(items[i].Centroid, items[i].Centroid);
+
+		int axis = 0;
+		for (int k = 1; k < 3; ++k)
+		{
+			if (centroids.Max[k] - centroids.Min[k] > centroids.Max[axis] - centroids.Min[axis])
+				axis = k;
+		}
+
+		const std::uint32_t middle = begin + (end - begin) / 2;
+		const float extent = centroids.Max[axis] - centroids.Min[axis];
+		if (extent <= 0.0f)
+			return middle;
+
+		Bounds3 bins[BinCount];
+		std::uint32_t binCounts[BinCount] = {};
+		const float binScale = BinCount / extent;
+		auto binOf = [&](const BuildItem& item)
+		{
+			std::uint32_t bin = (std::uint32_t)((item.Centroid[axis] - centroids.Min[axis]) * binScale);
+			return std::min(bin, BinCount - 1);
+		};
+
+		for (std::uint32_t i = begin; i < end; ++i)
+		{
+			std::uint32_t bin = binOf(items[i]);
+			bins[bin].Grow(items[i].Min, items[i].Max);
+			++binCounts[bin];
+		}
+
+		// Cost of splitting after bin b is the area times the count of either side.
+		float rightCosts[BinCount] = {};
+		Bounds3 right;
+		std::uint32_t rightCount = 0;
+		for (std::uint32_t b = BinCount - 1; b > 0; --b)
+		{
+			right.Grow(bins[b].Min, bins[b].Max);
+			rightCount += binCounts[b];
+			rightCosts[b - 1] = rightCount > 0 ? right.Area() * rightCount : 0.0f;
+		}
+
+		Bounds3 left;
+		std::uint32_t leftCount = 0;
+		std::uint32_t bestSplit = BinCount;
+		float bestCost = FLT_MAX;
+		for (std::uint32_t b = 0; b + 1 < BinCount; ++b)
+		{
+			left.Grow(bins[b].Min, bins[b].Max);
+			leftCount += binCounts[b];
+			if (leftCount == 0 || leftCount == end - begin)
+				continue;
+
+			float cost = left.Area() * leftCount + rightCosts[b];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = b;
+			}
+		}
+
+		if (bestSplit == BinCount)
+			return middle;
+
+		auto it = std::partition(items.begin() + begin, items.begin() + end,
+			[&](const BuildItem& item) { return binOf(item) <= bestSplit; });
+		return (std::uint32_t)(it - items.begin());
+	}
+}
+
+BoundingVolumeTree::BoundingVolumeTree(float margin) :
+	mMargin(margin)
+{
+}
+
+void BoundingVolumeTree::Clear()
+{
+	mNodes.clear();
+	mRoot = InvalidNode;
+	mFreeList = InvalidNode;
+	mLeafCount = 0;
+}
+
+void BoundingVolumeTree::Build(const BoundingBox* boxes, const std::uint32_t* userData, std::uint32_t count,
+	std::vector<std::uint32_t>* proxies)
+{
+	Clear();
+	if (proxies != nullptr)
+		proxies->assign(count, InvalidNode);
+	if (count == 0)
+		return;
+
+	std::vector<BuildItem> items(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		BoundingBox box = Enlarge(boxes[i]);
+		const float center[3] = { box.Center.x, box.Center.y, box.Center.z };
+		const float extents[3] = { box.Extents.x, box.Extents.y, box.Extents.z };
+		for (int k = 0; k < 3; ++k)
+		{
+			items[i].Min[k] = center[k] - extents[k];
+			items[i].Max[k] = center[k] + extents[k];
+			items[i].Centroid[k] = center[k];
+		}
+		items[i].Object = i;
+	}
+
+	// A tree over n leaves has n - 1 internal nodes.  Nodes are numbered in the order
+	// they are taken off the stack, so every left child directly follows its parent.
+	mNodes.reserve(2 * count - 1);
+	std::vector<BuildTask> tasks;
+	tasks.push_back({ 0, count, InvalidNode, true });
+
+	while (!tasks.empty())
+	{
+		BuildTask task = tasks.back();
+		tasks.pop_back();
+
+		std::uint32_t index = AllocateNode();
+		Node& node = mNodes[index];
+		node.Parent = task.Parent;
+		if (task.Parent == InvalidNode)
+			mRoot = index;
+		else if (task.Left)
+			mNodes[task.Parent].Left = index;
+		else
+			mNodes[task.Parent].Right = index;
+
+		if (task.End - task.Begin == 1)
+		{
+			const BuildItem& item = items[task.Begin];
+			BoundingBox::CreateFromPoints(node.Box, XMVectorSet(item.Min[0], item.Min[1], item.Min[2], 0.0f),
+				XMVectorSet(item.Max[0], item.Max[1], item.Max[2], 0.0f));
+			node.Tight = boxes[item.Object];
+			node.UserData = userData != nullptr ? userData[item.Object] : item.Object;
+			if (proxies != nullptr)
+				(*proxies)[item.Object] = index;
+			++mLeafCount;
+			continue;
+		}
+
+		Bounds3 bounds;
+		for (std::uint32_t i = task.Begin; i < task.End; ++i)
+			bounds.Grow(items[i].Min, items[i].Max);
+		BoundingBox::CreateFromPoints(node.Box, XMVectorSet(bounds.Min[0], bounds.Min[1], bounds.Min[2], 0.0f),
+			XMVectorSet(bounds.Max[0], bounds.Max[1], bounds.Max[2], 0.0f));
+
+		std::uint32_t split = SplitSah(items, task.Begin, task.End);
+		tasks.push_back({ split, task.End, index, false });
+		tasks.push_back({ task.Begin, split, index, true });
+	}
+}
+
+std::uint32_t BoundingVolumeTree::Insert(const BoundingBox& box, std::uint32_t userData)
+{
+	std::uint32_t leaf = AllocateNode();
+	mNodes[leaf].Box = Enlarge(box);
+	mNodes[leaf].Tight = box;
+	mNodes[leaf].UserData = userData;
+	InsertLeaf(leaf);
+	++mLeafCount;
+	return leaf;
+}
+
+void BoundingVolumeTree::Remove(std::uint32_t proxy)
+{
+	assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf());
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	--mLeafCount;
+}
+
+bool BoundingVolumeTree::Move(std::uint32_t proxy, const BoundingBox& box)
+{
+	assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf());
+	mNodes[proxy].Tight = box;
+	if (mNodes[proxy].Box.Contains(box) == CONTAINS)
+		return false;
+
+	RemoveLeaf(proxy);
+	mNodes[proxy].Box = Enlarge(box);
+	InsertLeaf(proxy);
+	return true;
+}
+
+void BoundingVolumeTree::SetBounds(std::uint32_t proxy, const BoundingBox& box)
+{
+	assert(proxy < mNodes.size() && mNodes[proxy].IsLeaf());
+	mNodes[proxy].Box = Enlarge(box);
+	mNodes[proxy].Tight = box;
+}
+
+void BoundingVolumeTree::Refit()
+{
+	if (mRoot == InvalidNode)
+		return;
+
+	// Parents come before their children in preorder, so the reverse has every child
+	// refitted by the time its parent is.
+	std::vector<std::uint32_t> order;
+	order.reserve(mNodes.size());
+	order.push_back(mRoot);
+	for (std::size_t i = 0; i < order.size(); ++i)
+	{
+		const Node& node = mNodes[order[i]];
+		if (!node.IsLeaf())
+		{
+			order.push_back(node.Left);
+			order.push_back(node.Right);
+		}
+	}
+
+	for (auto it = order.rbegin(); it != order.rend(); ++it)
+	{
+		Node& node = mNodes[*it];
+		if (node.IsLeaf())
+			continue;
+		node.Box = Merge(mNodes[node.Left].Box, mNodes[node.Right].Box);
+		Rotate(*it);
+	}
+}
+
+std::uint32_t BoundingVolumeTree::Height()const
+{
+	if (mRoot == InvalidNode)
+		return 0;
+
+	std::uint32_t height = 0;
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> stack(1, std::make_pair(mRoot, 1u));
+	while (!stack.empty())
+	{
+		auto entry = stack.back();
+		stack.pop_back();
+		height = std::max(height, entry.second);
+
+		const Node& node = mNodes[entry.first];
+		if (!node.IsLeaf())
+		{
+			stack.push_back(std::make_pair(node.Left, entry.second + 1));
+			stack.push_back(std::make_pair(node.Right, entry.second + 1));
+		}
+	}
+	return height;
+}
+
+float BoundingVolumeTree::Cost()const
+{
+	if (mRoot == InvalidNode || mNodes[mRoot].IsLeaf())
+		return 0.0f;
+
+	float area = 0.0f;
+	std::vector<std::uint32_t> stack(1, mRoot);
+	while (!stack.empty())
+	{
+		const Node& node = mNodes[stack.back()];
+		stack.pop_back();
+		if (!node.IsLeaf())
+		{
+			area += Area(node.Box);
+			stack.push_back(node.Left);
+			stack.push_back(node.Right);
+		}
+	}
+
+	float rootArea = Area(mNodes[mRoot].Box);
+	return rootArea > 0.0f ? area / rootArea : 0.0f;
+}
+
+void BoundingVolumeTree::QueryFrustum(const float planes[6][4], std::vector<std::uint32_t>& userData)const
+{
+	if (mRoot == InvalidNode)
+		return;
+
+	// Each entry carries the planes its box still straddles; the children of a box
+	// inside a plane are inside it too.
+	const std::uint32_t AllPlanes = (1u << 6) - 1;
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> stack(1, std::make_pair(mRoot, AllPlanes));
+
+	while (!stack.empty())
+	{
+		std::uint32_t index = stack.back().first;
+		std::uint32_t planeMask = stack.back().second;
+		stack.pop_back();
+
+		// Leaves test the object's box; it lies in the enlarged one, so the mask holds.
+		const Node& node = mNodes[index];
+		const BoundingBox& box = node.IsLeaf() ? node.Tight : node.Box;
+		const XMFLOAT3& c = box.Center;
+		const XMFLOAT3& e = box.Extents;
+
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; ++p)
+		{
+			if ((planeMask & (1u << p)) == 0)
+				continue;
+
+			const float* plane = planes[p];
+			float d = plane[0] * c.x + plane[1] * c.y + plane[2] * c.z + plane[3];
+			float r = std::fabs(plane[0]) * e.x + std::fabs(plane[1]) * e.y + std::fabs(plane[2]) * e.z;
+			if (d < -r)
+				outside = true;
+			else if (d >= r)
+				planeMask &= ~(1u << p);
+		}
+		if (outside)
+			continue;
+
+		if (node.IsLeaf())
+			userData.push_back(node.UserData);
+		else
+		{
+			stack.push_back(std::make_pair(node.Right, planeMask));
+			stack.push_back(std::make_pair(node.Left, planeMask));
+		}
+	}
+}
+
+void BoundingVolumeTree::QueryBox(const BoundingBox& box, std::vector<std::uint32_t>& userData)const
+{
+	if (mRoot == InvalidNode)
+		return;
+
+	std::vector<std::uint32_t> stack(1, mRoot);
+	while (!stack.empty())
+	{
+		const Node& node = mNodes[stack.back()];
+		stack.pop_back();
+		if (!(node.IsLeaf() ? node.Tight : node.Box).Intersects(box))
+			continue;
+
+		if (node.IsLeaf())
+			userData.push_back(node.UserData);
+		else
+		{
+			stack.push_back(node.Right);
+			stack.push_back(node.Left);
+		}
+	}
+}
+
+std::uint32_t BoundingVolumeTree::RayCast(FXMVECTOR origin, FXMVECTOR direction, float maxDistance,
+	float* distance)const
+{
+	std::uint32_t closest = InvalidNode;
+	float closestDistance = maxDistance;
+
+	float rootDistance = 0.0f;
+	if (mRoot == InvalidNode || !mNodes[mRoot].Box.Intersects(origin, direction, rootDistance) ||
+		rootDistance > closestDistance)
+		return InvalidNode;
+
+	// Entries carry the distance at which the ray enters their box, so subtrees behind
+	// the closest hit so far are skipped.
+	std::vector<std::pair<std::uint32_t, float>> stack(1, std::make_pair(mRoot, rootDistance));
+	while (!stack.empty())
+	{
+		std::uint32_t index = stack.back().first;
+		float entry = stack.back().second;
+		stack.pop_back();
+		if (entry > closestDistance)
+			continue;
+
+		// The enlarged box only got the ray this far; the hit and its distance come from
+		// the object's box.
+		const Node& node = mNodes[index];
+		if (node.IsLeaf())
+		{
+			float hitDistance = 0.0f;
+			if (node.Tight.Intersects(origin, direction, hitDistance) && hitDistance <= closestDistance)
+			{
+				closest = index;
+				closestDistance = hitDistance;
+			}
+			continue;
+		}
+
+		float leftDistance = 0.0f;
+		float rightDistance = 0.0f;
+		bool hitLeft = mNodes[node.Left].Box.Intersects(origin, direction, leftDistance) && leftDistance <= closestDistance;
+		bool hitRight = mNodes[node.Right].Box.Intersects(origin, direction, rightDistance) && rightDistance <= closestDistance;
+
+		// The nearer child goes on top.
+		if (hitLeft && hitRight && leftDistance > rightDistance)
+		{
+			stack.push_back(std::make_pair(node.Left, leftDistance));
+			stack.push_back(std::make_pair(node.Right, rightDistance));
+		}
+		else
+		{
+			if (hitRight)
+				stack.push_back(std::make_pair(node.Right, rightDistance));
+			if (hitLeft)
+				stack.push_back(std::make_pair(node.Left, leftDistance));
+		}
+	}
+
+	if (closest != InvalidNode && distance != nullptr)
+		*distance = closestDistance;
+	return closest;
+}
+
+std::uint32_t BoundingVolumeTree::AllocateNode()
+{
+	std::uint32_t index = mFreeList;
+	if (index != InvalidNode)
+		mFreeList = mNodes[index].UserData;
+	else
+	{
+		index = (std::uint32_t)mNodes.size();
+		mNodes.emplace_back();
+	}
+
+	mNodes[index] = Node();
+	return index;
+}
+
+void BoundingVolumeTree::FreeNode(std::uint32_t node)
+{
+	mNodes[node].Parent = InvalidNode;
+	mNodes[node].Left = InvalidNode;
+	mNodes[node].Right = InvalidNode;
+	mNodes[node].UserData = mFreeList;
+	mFreeList = node;
+}
+
+void BoundingVolumeTree::InsertLeaf(std::uint32_t leaf)
+{
+	if (mRoot == InvalidNode)
+	{
+		mRoot = leaf;
+		mNodes[leaf].Parent = InvalidNode;
+		return;
+	}
+
+	// Walk down while a child is a cheaper sibling than the current node: the cost of
+	// a sibling is the area of the new parent plus the area every ancestor grows by.
+	const BoundingBox leafBox = mNodes[leaf].Box;
+	std::uint32_t sibling = mRoot;
+	while (!mNodes[sibling].IsLeaf())
+	{
+		const Node& node = mNodes[sibling];
+		float area = Area(node.Box);
+		float combinedArea = Area(Merge(node.Box, leafBox));
+
+		float cost = 2.0f * combinedArea;
+		float inheritance = 2.0f * (combinedArea - area);
+
+		auto childCost = [&](std::uint32_t child)
+		{
+			const Node& c = mNodes[child];
+			float merged = Area(Merge(c.Box, leafBox));
+			return (c.IsLeaf() ? merged : merged - Area(c.Box)) + inheritance;
+		};
+
+		float leftCost = childCost(node.Left);
+		float rightCost = childCost(node.Right);
+		if (cost < leftCost && cost < rightCost)
+			break;
+
+		sibling = leftCost < rightCost ? node.Left : node.Right;
+	}
+
+	// The new parent takes the sibling's place.
+	std::uint32_t oldParent = mNodes[sibling].Parent;
+	std::uint32_t newParent = AllocateNode();
+	mNodes[newParent].Parent = oldParent;
+	mNodes[newParent].Left = sibling;
+	mNodes[newParent].Right = leaf;
+	mNodes[newParent].Box = Merge(leafBox, mNodes[sibling].Box);
+	mNodes[sibling].Parent = newParent;
+	mNodes[leaf].Parent = newParent;
+
+	if (oldParent == InvalidNode)
+		mRoot = newParent;
+	else if (mNodes[oldParent].Left == sibling)
+		mNodes[oldParent].Left = newParent;
+	else
+		mNodes[oldParent].Right = newParent;
+
+	RefitUpwards(oldParent);
+}
+
+void BoundingVolumeTree::RemoveLeaf(std::uint32_t leaf)
+{
+	if (leaf == mRoot)
+	{
+		mRoot = InvalidNode;
+		return;
+	}
+
+	// The sibling takes the parent's place.
+	std::uint32_t parent = mNodes[leaf].Parent;
+	std::uint32_t grandParent = mNodes[parent].Parent;
+	std::uint32_t sibling = mNodes[parent].Left == leaf ? mNodes[parent].Right : mNodes[parent].Left;
+
+	mNodes[sibling].Parent = grandParent;
+	if (grandParent == InvalidNode)
+		mRoot = sibling;
+	else if (mNodes[grandParent].Left == parent)
+		mNodes[grandParent].Left = sibling;
+	else
+		mNodes[grandParent].Right = sibling;
+
+	FreeNode(parent);
+	mNodes[leaf].Parent = InvalidNode;
+
+	RefitUpwards(grandParent);
+}
+
+void BoundingVolumeTree::RefitUpwards(std::uint32_t node)
+{
+	for (std::uint32_t index = node; index != InvalidNode; index = mNodes[index].Parent)
+	{
+		Node& n = mNodes[index];
+		n.Box = Merge(mNodes[n.Left].Box, mNodes[n.Right].Box);
+		Rotate(index);
+	}
+}
+
+void BoundingVolumeTree::Rotate(std::uint32_t node)
+{
+	const std::uint32_t b = mNodes[node].Left;
+	const std::uint32_t c = mNodes[node].Right;
+
+	// Swapping x (a child of node) with y (a child of the other child p) leaves node's
+	// box as it is and changes p's to the merge of x and y's sibling.
+	std::uint32_t bestX = InvalidNode;
+	std::uint32_t bestY = InvalidNode;
+	std::uint32_t bestP = InvalidNode;
+	float bestGain = 0.0f;
+
+	auto consider = [&](std::uint32_t x, std::uint32_t p)
+	{
+		const Node& parent = mNodes[p];
+		if (parent.IsLeaf())
+			return;
+
+		const float area = Area(parent.Box);
+		const std::uint32_t children[2] = { parent.Left, parent.Right };
+		for (int i = 0; i < 2; ++i)
+		{
+			float gain = area - Area(Merge(mNodes[x].Box, mNodes[children[1 - i]].Box));
+			if (gain > bestGain)
+			{
+				bestGain = gain;
+				bestX = x;
+				bestY = children[i];
+				bestP = p;
+			}
+		}
+	};
+
+	consider(b, c);
+	consider(c, b);
+	if (bestX == InvalidNode)
+		return;
+
+	Node& n = mNodes[node];
+	if (n.Left == bestX)
+		n.Left = bestY;
+	else
+		n.Right = bestY;
+
+	Node& p = mNodes[bestP];
+	if (p.Left == bestY)
+		p.Left = bestX;
+	else
+		p.Right = bestX;
+
+	mNodes[bestY].Parent = node;
+	mNodes[bestX].Parent = bestP;
+	p.Box = Merge(mNodes[p.Left].Box, mNodes[p.Right].Box);
+}
+
+BoundingBox BoundingVolumeTree::Enlarge(const BoundingBox& box)const
+{
+	BoundingBox enlarged = box;
+	enlarged.Extents.x += mMargin;
+	enlarged.Extents.y += mMargin;
+	enlarged.Extents.z += mMargin;
+	return enlarged;
+}
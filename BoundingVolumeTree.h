@@ -0,0 +1,120 @@
+//***************************************************************************************
+// BoundingVolumeTree.h
+//
+// A dynamic bounding volume hierarchy over scene objects, for frustum queries, ray
+// picking and box overlap queries that do not visit every object.
+//
+// Every object is a leaf holding one box; internal nodes have exactly two children.
+// Nodes live in one array and refer to each other by index, and leaves are addressed by
+// their node index (a proxy), which stays valid until the object is removed.
+//
+//   - Build makes the whole tree top-down, splitting with the surface area heuristic
+//     over binned centroids, and lays the nodes out depth first.
+//   - Insert walks down to the sibling that adds the least surface area; Insert, Remove
+//     and Move refit the ancestors and rotate nodes on the way up where swapping a child
+//     with a grandchild lowers the area.
+//   - Leaf boxes are enlarged by a margin, so objects that move a little do not have to
+//     be reinserted.  For many moving objects, SetBounds the leaves and Refit once.
+//     Leaves also keep the object's own box, which the queries test last, so the margin
+//     never adds hits or moves the distance RayCast reports.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+
+class BoundingVolumeTree
+{
+public:
+	static const std::uint32_t InvalidNode = 0xffffffff;
+
+	explicit BoundingVolumeTree(float margin = 0.1f);
+
+	void Clear();
+
+	// Replaces the tree.  Object i gets userData[i], or i when userData is null; proxies,
+	// if given, receives the proxy of every object.
+	void Build(const DirectX::BoundingBox* boxes, const std::uint32_t* userData, std::uint32_t count,
+		std::vector<std::uint32_t>* proxies = nullptr);
+
+	std::uint32_t Insert(const DirectX::BoundingBox& box, std::uint32_t userData);
+	void Remove(std::uint32_t proxy);
+
+	// Reinserts the object if box is no longer inside its enlarged box; returns whether
+	// it did.
+	bool Move(std::uint32_t proxy, const DirectX::BoundingBox& box);
+
+	// Replaces the leaf box without touching the tree.  Call Refit before the next query.
+	void SetBounds(std::uint32_t proxy, const DirectX::BoundingBox& box);
+
+	// Recomputes every internal box from its children, rotating where it helps.
+	void Refit();
+
+	std::uint32_t UserData(std::uint32_t proxy)const { return mNodes[proxy].UserData; }
+	// The object's box, and the enlarged one the tree is built from.
+	const DirectX::BoundingBox& Bounds(std::uint32_t proxy)const { return mNodes[proxy].Tight; }
+	const DirectX::BoundingBox& EnlargedBounds(std::uint32_t proxy)const { return mNodes[proxy].Box; }
+
+	std::uint32_t Size()const { return mLeafCount; }
+	std::uint32_t Root()const { return mRoot; }
+
+	// Longest path from the root to a leaf, in nodes.
+	std::uint32_t Height()const;
+
+	// Sum of the surface areas of the internal nodes relative to the root's; what the
+	// heuristic minimizes.
+	float Cost()const;
+
+	// Appends the user data of the leaves that are not entirely outside one of the
+	// planes (ax + by + cz + d >= 0 inside; see Meshlets::ExtractFrustumPlanes).
+	// Subtrees inside every plane are taken without further tests.
+	void QueryFrustum(const float planes[6][4], std::vector<std::uint32_t>& userData)const;
+
+	// Appends the user data of the leaves whose boxes intersect box.
+	void QueryBox(const DirectX::BoundingBox& box, std::vector<std::uint32_t>& userData)const;
+
+	// The proxy of the leaf whose object box the ray enters first within maxDistance,
+	// or InvalidNode.  direction must be normalized.
+	std::uint32_t RayCast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance,
+		float* distance = nullptr)const;
+
+private:
+	struct Node
+	{
+		// Enlarged by the margin for leaves.
+		DirectX::BoundingBox Box;
+		// The object's box, for leaves.
+		DirectX::BoundingBox Tight;
+		std::uint32_t Parent = InvalidNode;
+		// Both InvalidNode for leaves.
+		std::uint32_t Left = InvalidNode;
+		std::uint32_t Right = InvalidNode;
+		// The object's user data for leaves; the next free node for free nodes.
+		std::uint32_t UserData = 0;
+
+		bool IsLeaf()const { return Left == InvalidNode; }
+	};
+
+	std::uint32_t AllocateNode();
+	void FreeNode(std::uint32_t node);
+
+	void InsertLeaf(std::uint32_t leaf);
+	void RemoveLeaf(std::uint32_t leaf);
+
+	// Refits the ancestors of node, starting with node itself.
+	void RefitUpwards(std::uint32_t node);
+
+	// Swaps a child of node with a grandchild under the other child, if that shrinks
+	// the other child.
+	void Rotate(std::uint32_t node);
+
+	DirectX::BoundingBox Enlarge(const DirectX::BoundingBox& box)const;
+
+	float mMargin = 0.0f;
+	std::vector<Node> mNodes;
+	std::uint32_t mRoot = InvalidNode;
+	std::uint32_t mFreeList = InvalidNode;
+	std::uint32_t mLeafCount = 0;
+};
@@ -0,0 +1,140 @@
+#include "BuddyAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+float BuddyAllocator::Stats::Occupancy()const
+{
+	return TotalBytes == 0 ? 0.0f : (float)AllocatedBytes / (float)TotalBytes;
+}
+
+float BuddyAllocator::Stats::InternalFragmentation()const
+{
+	return AllocatedBytes == 0 ? 0.0f : 1.0f - (float)RequestedBytes / (float)AllocatedBytes;
+}
+
+float BuddyAllocator::Stats::ExternalFragmentation()const
+{
+	return FreeBytes == 0 ? 0.0f : 1.0f - (float)LargestFreeBlock / (float)FreeBytes;
+}
+
+std::uint64_t BuddyAllocator::NextPowerOfTwo(std::uint64_t value)
+{
+	std::uint64_t result = 1;
+	while (result < value)
+		result <<= 1;
+	return result;
+}
+
+BuddyAllocator::BuddyAllocator(std::uint64_t capacity, std::uint64_t minBlockSize) :
+	mCapacity(NextPowerOfTwo(capacity)),
+	mMinBlockSize(NextPowerOfTwo(std::max<std::uint64_t>(minBlockSize, 1)))
+{
+	assert(mMinBlockSize <= mCapacity && "The minimum block cannot be larger than the capacity.");
+
+	while (OrderSize(mMaxOrder) < mCapacity)
+		++mMaxOrder;
+
+	mFreeLists.resize(mMaxOrder + 1);
+	mFreeLists[mMaxOrder].insert(0);
+}
+
+std::uint32_t BuddyAllocator::OrderFor(std::uint64_t byteSize)const
+{
+	std::uint32_t order = 0;
+	while (OrderSize(order) < byteSize)
+		++order;
+	return order;
+}
+
+std::uint64_t BuddyAllocator::Allocate(std::uint64_t byteSize, std::uint64_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two.");
+
+	// Blocks are aligned to their size, so asking for a block at least as large as the
+	// alignment is enough.
+	std::uint64_t blockBytes = std::max(byteSize, alignment);
+	if (byteSize == 0 || blockBytes > mCapacity)
+		return InvalidOffset;
+
+	std::uint32_t order = OrderFor(blockBytes);
+
+	// Find the smallest free block that fits.
+	std::uint32_t found = order;
+	while (found <= mMaxOrder && mFreeLists[found].empty())
+		++found;
+	if (found > mMaxOrder)
+		return InvalidOffset;
+
+	std::uint64_t offset = *mFreeLists[found].begin();
+	mFreeLists[found].erase(mFreeLists[found].begin());
+
+	// Split down to the requested order, returning the upper halves to the free lists.
+	while (found > order)
+	{
+		--found;
+		mFreeLists[found].insert(offset + OrderSize(found));
+	}
+
+	AllocationInfo info;
+	info.Order = order;
+	info.RequestedBytes = byteSize;
+	mAllocations[offset] = info;
+
+	mAllocatedBytes += OrderSize(order);
+	mRequestedBytes += byteSize;
+
+	return offset;
+}
+
+void BuddyAllocator::Free(std::uint64_t offset)
+{
+	auto it = mAllocations.find(offset);
+	assert(it != mAllocations.end() && "Freeing an offset that was not allocated.");
+	if (it == mAllocations.end())
+		return;
+
+	std::uint32_t order = it->second.Order;
+	mAllocatedBytes -= OrderSize(order);
+	mRequestedBytes -= it->second.RequestedBytes;
+	mAllocations.erase(it);
+
+	// Merge with the buddy for as long as it is free too.
+	while (order < mMaxOrder)
+	{
+		std::uint64_t buddy = offset ^ OrderSize(order);
+		auto buddyIt = mFreeLists[order].find(buddy);
+		if (buddyIt == mFreeLists[order].end())
+			break;
+
+		mFreeLists[order].erase(buddyIt);
+		offset = std::min(offset, buddy);
+		++order;
+	}
+
+	mFreeLists[order].insert(offset);
+}
+
+std::uint64_t BuddyAllocator::BlockSize(std::uint64_t offset)const
+{
+	auto it = mAllocations.find(offset);
+	return it == mAllocations.end() ? 0 : OrderSize(it->second.Order);
+}
+
+BuddyAllocator::Stats BuddyAllocator::GetStats()const
+{
+	Stats stats;
+	stats.TotalBytes = mCapacity;
+	stats.AllocatedBytes = mAllocatedBytes;
+	stats.RequestedBytes = mRequestedBytes;
+	stats.FreeBytes = mCapacity - mAllocatedBytes;
+	stats.AllocationCount = static_cast<std::uint32_t>(mAllocations.size());
+
+	for (std::uint32_t order = 0; order <= mMaxOrder; ++order)
+	{
+		stats.FreeBlockCount += static_cast<std::uint32_t>(mFreeLists[order].size());
+		if (!mFreeLists[order].empty())
+			stats.LargestFreeBlock = OrderSize(order);
+	}
+
+	return stats;
+}
@@ -0,0 +1,82 @@
+//***************************************************************************************
+// BuddyAllocator.h
+//
+// Binary buddy bookkeeping over a power-of-two range of bytes.  Every block is aligned
+// to its own size, so any alignment up to the block size is honored for free.  Freed
+// blocks merge with their buddy as soon as both halves are free.  The allocator only
+// deals with offsets; GpuHeapAllocator uses it to place resources inside ID3D12Heaps.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class BuddyAllocator
+{
+public:
+	static const std::uint64_t InvalidOffset = ~0ull;
+
+	struct Stats
+	{
+		std::uint64_t TotalBytes = 0;
+		// Bytes covered by allocated blocks (includes the rounding to a power of two).
+		std::uint64_t AllocatedBytes = 0;
+		// Bytes the callers actually asked for.
+		std::uint64_t RequestedBytes = 0;
+		std::uint64_t FreeBytes = 0;
+		std::uint64_t LargestFreeBlock = 0;
+		std::uint32_t AllocationCount = 0;
+		std::uint32_t FreeBlockCount = 0;
+
+		// AllocatedBytes / TotalBytes.
+		float Occupancy()const;
+		// Share of the allocated bytes lost to rounding up.
+		float InternalFragmentation()const;
+		// 1 - LargestFreeBlock / FreeBytes: 0 when all free memory is one block.
+		float ExternalFragmentation()const;
+	};
+
+	// capacity and minBlockSize are rounded up to powers of two.
+	BuddyAllocator(std::uint64_t capacity, std::uint64_t minBlockSize = 256);
+
+	// Returns the offset of a block that holds byteSize bytes at the given alignment (a
+	// power of two), or InvalidOffset if no block is large enough.
+	std::uint64_t Allocate(std::uint64_t byteSize, std::uint64_t alignment = 1);
+
+	// Frees a block returned by Allocate.
+	void Free(std::uint64_t offset);
+
+	// Size of the block backing an allocation (0 if offset is not allocated).
+	std::uint64_t BlockSize(std::uint64_t offset)const;
+
+	std::uint64_t Capacity()const { return mCapacity; }
+	bool IsEmpty()const { return mAllocations.empty(); }
+
+	Stats GetStats()const;
+
+	static std::uint64_t NextPowerOfTwo(std::uint64_t value);
+
+private:
+	struct AllocationInfo
+	{
+		std::uint32_t Order = 0;
+		std::uint64_t RequestedBytes = 0;
+	};
+
+	std::uint64_t OrderSize(std::uint32_t order)const { return mMinBlockSize << order; }
+	std::uint32_t OrderFor(std::uint64_t byteSize)const;
+
+	std::uint64_t mCapacity = 0;
+	std::uint64_t mMinBlockSize = 0;
+	std::uint32_t mMaxOrder = 0;
+
+	// Free block offsets per order; order 0 is mMinBlockSize.
+	std::vector<std::unordered_set<std::uint64_t>> mFreeLists;
+	std::unordered_map<std::uint64_t, AllocationInfo> mAllocations;
+
+	std::uint64_t mAllocatedBytes = 0;
+	std::uint64_t mRequestedBytes = 0;
+};
@@ -0,0 +1,89 @@
+#include "ConstantBufferArena.h"
+
+ConstantBufferArena::ConstantBufferArena(ID3D12Device* device, UINT64 pageByteSize) :
+	mDevice(device),
+	mPageByteSize(d3dUtil::CalcConstantBufferByteSize(static_cast<UINT>(pageByteSize)))
+{
+	AddPage(mPageByteSize);
+}
+
+ConstantBufferArena::~ConstantBufferArena()
+{
+	for (Page& page : mPages)
+	{
+		if (page.Resource != nullptr)
+			page.Resource->Unmap(0, nullptr);
+		page.MappedData = nullptr;
+	}
+}
+
+void ConstantBufferArena::AddPage(UINT64 byteSize)
+{
+	Page page;
+	page.ByteSize = byteSize;
+
+	auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto buffer = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+	ThrowIfFailed(mDevice->CreateCommittedResource(
+		&heapProperties,
+		D3D12_HEAP_FLAG_NONE,
+		&buffer,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(page.Resource.GetAddressOf())));
+
+	// Map once for the lifetime of the page.  We do not intend to read from this
+	// resource on the CPU.
+	CD3DX12_RANGE readRange(0, 0);
+	ThrowIfFailed(page.Resource->Map(0, &readRange, reinterpret_cast<void**>(&page.MappedData)));
+	page.GpuAddress = page.Resource->GetGPUVirtualAddress();
+
+	mPages.push_back(page);
+}
+
+ConstantBufferArena::Slot ConstantBufferArena::Allocate(UINT byteSize)
+{
+	// Constant buffer views must start on a 256 byte boundary and be a multiple of 256
+	// bytes, so every slot is rounded up and pages stay 256 aligned.
+	UINT slotByteSize = d3dUtil::CalcConstantBufferByteSize(byteSize);
+
+	while (mCurrPage < mPages.size() && mPages[mCurrPage].Offset + slotByteSize > mPages[mCurrPage].ByteSize)
+		++mCurrPage;
+
+	if (mCurrPage == mPages.size())
+		AddPage(std::max<UINT64>(mPageByteSize, slotByteSize));
+
+	Page& page = mPages[mCurrPage];
+
+	Slot slot;
+	slot.CpuAddress = page.MappedData + page.Offset;
+	slot.GpuAddress = page.GpuAddress + page.Offset;
+	slot.ByteSize = slotByteSize;
+
+	page.Offset += slotByteSize;
+
+	return slot;
+}
+
+void ConstantBufferArena::Reset()
+{
+	for (Page& page : mPages)
+		page.Offset = 0;
+	mCurrPage = 0;
+}
+
+UINT64 ConstantBufferArena::UsedBytes()const
+{
+	UINT64 used = 0;
+	for (const Page& page : mPages)
+		used += page.Offset;
+	return used;
+}
+
+UINT64 ConstantBufferArena::CapacityBytes()const
+{
+	UINT64 capacity = 0;
+	for (const Page& page : mPages)
+		capacity += page.ByteSize;
+	return capacity;
+}
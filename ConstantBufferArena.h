@@ -0,0 +1,68 @@
+//***************************************************************************************
+// ConstantBufferArena.h
+//
+// Upload-heap memory for constant buffers that is mapped once and stays mapped.  Each
+// Allocate hands out a 256-byte aligned slot addressed by its GPU virtual address, so a
+// slot can be bound directly as a root CBV.  Slots are released all at once by Reset(),
+// which the owner calls when the GPU is done with the previous use of the arena (i.e.
+// one arena per frame resource).
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+
+class ConstantBufferArena
+{
+public:
+	struct Slot
+	{
+		BYTE* CpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+		UINT ByteSize = 0;
+	};
+
+	// pageByteSize is the size of each upload buffer the arena creates; the arena adds
+	// pages when a frame needs more slots than fit in the existing ones.
+	ConstantBufferArena(ID3D12Device* device, UINT64 pageByteSize = 64 * 1024);
+	ConstantBufferArena(const ConstantBufferArena& rhs) = delete;
+	ConstantBufferArena& operator=(const ConstantBufferArena& rhs) = delete;
+	~ConstantBufferArena();
+
+	// Returns a slot of CalcConstantBufferByteSize(byteSize) bytes.
+	Slot Allocate(UINT byteSize);
+
+	// Allocates a slot and copies data into it.
+	template<typename T>
+	Slot Push(const T& data)
+	{
+		Slot slot = Allocate(sizeof(T));
+		memcpy(slot.CpuAddress, &data, sizeof(T));
+		return slot;
+	}
+
+	// Makes every slot available again.  Only call once the GPU is done with them.
+	void Reset();
+
+	UINT64 UsedBytes()const;
+	UINT64 CapacityBytes()const;
+	size_t PageCount()const { return mPages.size(); }
+
+private:
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		BYTE* MappedData = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+		UINT64 ByteSize = 0;
+		UINT64 Offset = 0;
+	};
+
+	void AddPage(UINT64 byteSize);
+
+	ID3D12Device* mDevice = nullptr;
+	UINT64 mPageByteSize = 0;
+
+	std::vector<Page> mPages;
+	size_t mCurrPage = 0;
+};
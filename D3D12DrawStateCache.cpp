@@ -0,0 +1,58 @@
+#include "D3D12DrawStateCache.h"
+
+void D3D12DrawStateCache::Begin(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* initialState)
+{
+	mCmdList = cmdList;
+	mPipelineState = initialState;
+	mRootSignature = nullptr;
+	mHeaps[0] = nullptr;
+	mHeaps[1] = nullptr;
+	mHeapCount = 0;
+}
+
+void D3D12DrawStateCache::SetPipelineState(ID3D12PipelineState* state)
+{
+	if (state == mPipelineState)
+	{
+		++mSkippedCount;
+		return;
+	}
+
+	mCmdList->SetPipelineState(state);
+	mPipelineState = state;
+	++mIssuedCount;
+}
+
+bool D3D12DrawStateCache::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature)
+{
+	if (rootSignature == mRootSignature)
+	{
+		++mSkippedCount;
+		return false;
+	}
+
+	mCmdList->SetGraphicsRootSignature(rootSignature);
+	mRootSignature = rootSignature;
+	++mIssuedCount;
+	return true;
+}
+
+void D3D12DrawStateCache::SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps)
+{
+	assert(count <= _countof(mHeaps));
+
+	bool same = count == mHeapCount;
+	for (UINT i = 0; same && i < count; ++i)
+		same = heaps[i] == mHeaps[i];
+	if (same)
+	{
+		++mSkippedCount;
+		return;
+	}
+
+	mCmdList->SetDescriptorHeaps(count, heaps);
+	for (UINT i = 0; i < count; ++i)
+		mHeaps[i] = heaps[i];
+	mHeapCount = count;
+	++mIssuedCount;
+}
@@ -0,0 +1,43 @@
+//***************************************************************************************
+// D3D12DrawStateCache.h
+//
+// Remembers the pipeline state, root signature and descriptor heaps last set on a
+// command list and drops calls that would set them again.  Draws submitted in sort key
+// order (see DrawPackets.h) mostly repeat the state of the draw before them, so most
+// of these calls go away.
+//
+// Setting a root signature resets the root arguments, so SetGraphicsRootSignature
+// returns whether it was recorded; the caller then binds its root arguments again.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+
+class D3D12DrawStateCache
+{
+public:
+	// Starts recording into cmdList, whose pipeline state is initialState (the one it
+	// was reset with) and whose root signature and heaps are unset.
+	void Begin(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* initialState = nullptr);
+
+	void SetPipelineState(ID3D12PipelineState* state);
+	bool SetGraphicsRootSignature(ID3D12RootSignature* rootSignature);
+	void SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps);
+
+	// Calls recorded and dropped since construction.
+	UINT64 IssuedCount()const { return mIssuedCount; }
+	UINT64 SkippedCount()const { return mSkippedCount; }
+
+private:
+	ID3D12GraphicsCommandList* mCmdList = nullptr;
+
+	ID3D12PipelineState* mPipelineState = nullptr;
+	ID3D12RootSignature* mRootSignature = nullptr;
+	// At most one CBV/SRV/UAV heap and one sampler heap can be bound.
+	ID3D12DescriptorHeap* mHeaps[2] = { nullptr, nullptr };
+	UINT mHeapCount = 0;
+
+	UINT64 mIssuedCount = 0;
+	UINT64 mSkippedCount = 0;
+};
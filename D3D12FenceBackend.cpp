@@ -0,0 +1,62 @@
+#include "D3D12FenceBackend.h"
+
+D3D12FenceBackend::D3D12FenceBackend(ID3D12Device* device, ID3D12CommandQueue* queue, UINT64 initialValue) :
+	mQueue(queue)
+{
+	ThrowIfFailed(device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE,
+		IID_PPV_ARGS(mFence.GetAddressOf())));
+}
+
+std::uint64_t D3D12FenceBackend::GetCompletedValue()const
+{
+	return mFence->GetCompletedValue();
+}
+
+void D3D12FenceBackend::Signal(std::uint64_t value)
+{
+	// Add an instruction to the command queue to set a new fence point.  Because we
+	// are on the GPU timeline, the new fence point won't be set until the GPU finishes
+	// processing all the commands prior to this Signal().
+	ThrowIfFailed(mQueue->Signal(mFence.Get(), value));
+}
+
+void* D3D12FenceBackend::CreateWaiter()
+{
+	// Auto-reset so a pooled event is ready for the next wait without a ResetEvent call.
+	HANDLE eventHandle = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+	if (eventHandle == nullptr)
+		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+	return eventHandle;
+}
+
+void D3D12FenceBackend::DestroyWaiter(void* waiter)
+{
+	CloseHandle(static_cast<HANDLE>(waiter));
+}
+
+bool D3D12FenceBackend::Wait(void* waiter, std::uint64_t value, std::uint32_t timeoutMs)
+{
+	HANDLE eventHandle = static_cast<HANDLE>(waiter);
+	ULONGLONG deadline = GetTickCount64() + timeoutMs;
+
+	// A pooled event may still carry a signal from an earlier wait that timed out, so
+	// always re-check the fence after waking up.
+	while (mFence->GetCompletedValue() < value)
+	{
+		DWORD waitMs = INFINITE;
+		if (timeoutMs != FenceTimeline::InfiniteTimeout)
+		{
+			ULONGLONG now = GetTickCount64();
+			if (now >= deadline)
+				return false;
+			waitMs = static_cast<DWORD>(deadline - now);
+		}
+
+		// Fire event when GPU hits the fence.
+		ThrowIfFailed(mFence->SetEventOnCompletion(value, eventHandle));
+		if (WaitForSingleObject(eventHandle, waitMs) == WAIT_TIMEOUT)
+			return mFence->GetCompletedValue() >= value;
+	}
+
+	return true;
+}
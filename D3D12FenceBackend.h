@@ -0,0 +1,30 @@
+//***************************************************************************************
+// D3D12FenceBackend.h
+//
+// IFenceBackend on top of an ID3D12Fence signaled by one command queue.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FenceTimeline.h"
+
+class D3D12FenceBackend : public IFenceBackend
+{
+public:
+	D3D12FenceBackend(ID3D12Device* device, ID3D12CommandQueue* queue, UINT64 initialValue = 0);
+	D3D12FenceBackend(const D3D12FenceBackend& rhs) = delete;
+	D3D12FenceBackend& operator=(const D3D12FenceBackend& rhs) = delete;
+
+	ID3D12Fence* Fence()const { return mFence.Get(); }
+
+	std::uint64_t GetCompletedValue()const override;
+	void Signal(std::uint64_t value) override;
+	void* CreateWaiter() override;
+	void DestroyWaiter(void* waiter) override;
+	bool Wait(void* waiter, std::uint64_t value, std::uint32_t timeoutMs) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
+	ID3D12CommandQueue* mQueue = nullptr;
+};
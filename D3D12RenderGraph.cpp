@@ -0,0 +1,208 @@
+#include "D3D12RenderGraph.h"
+#include <memory>
+
+D3D12RenderGraph::D3D12RenderGraph(ID3D12Device* device, D3D12StateTracker* stateTracker, FenceTimeline* timeline,
+	D3D12_HEAP_FLAGS transientHeapFlags) :
+	mDevice(device),
+	mStateTracker(stateTracker),
+	mTimeline(timeline),
+	mTransientHeapFlags(transientHeapFlags),
+	mGraph(D3D12StateTracker::ReadOnlyStates, D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+{
+}
+
+D3D12RenderGraph::~D3D12RenderGraph()
+{
+	for (const TransientResource& transient : mCreated)
+	{
+		if (transient.Resource != nullptr)
+			mStateTracker->Unregister(transient.Resource.Get());
+	}
+}
+
+void D3D12RenderGraph::Begin()
+{
+	mGraph.Reset();
+	mExecute.clear();
+	mResources.clear();
+	mDeclared.clear();
+}
+
+D3D12RenderGraph::ResourceHandle D3D12RenderGraph::Import(const std::string& name, ID3D12Resource* resource,
+	D3D12_RESOURCE_STATES finalState)
+{
+	ResourceHandle handle = mGraph.Import(name, mStateTracker->GetState(resource), finalState);
+
+	mResources.push_back(resource);
+	mDeclared.push_back(TransientResource());
+	return handle;
+}
+
+D3D12RenderGraph::ResourceHandle D3D12RenderGraph::CreateTransient(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+	const D3D12_CLEAR_VALUE* optimizedClearValue)
+{
+	D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+
+	RenderGraph::TransientDesc transientDesc;
+	transientDesc.ByteSize = info.SizeInBytes;
+	transientDesc.Alignment = info.Alignment;
+	ResourceHandle handle = mGraph.CreateTransient(name, transientDesc);
+
+	TransientResource transient;
+	transient.Desc = desc;
+	if (optimizedClearValue != nullptr)
+	{
+		transient.HasClearValue = true;
+		transient.ClearValue = *optimizedClearValue;
+	}
+
+	mResources.push_back(nullptr);
+	mDeclared.push_back(transient);
+	return handle;
+}
+
+D3D12RenderGraph::PassHandle D3D12RenderGraph::AddPass(const std::string& name, ExecuteFn execute, bool hasSideEffects)
+{
+	PassHandle handle = mGraph.AddPass(name, hasSideEffects);
+	mExecute.push_back(std::move(execute));
+	return handle;
+}
+
+void D3D12RenderGraph::Read(PassHandle pass, ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+	mGraph.Read(pass, resource, state);
+}
+
+void D3D12RenderGraph::Write(PassHandle pass, ResourceHandle resource, D3D12_RESOURCE_STATES state)
+{
+	mGraph.Write(pass, resource, state);
+}
+
+bool D3D12RenderGraph::TransientsMatch()const
+{
+	if (mDeclared.size() != mCreated.size())
+		return false;
+
+	for (size_t i = 0; i < mDeclared.size(); ++i)
+	{
+		const TransientResource& declared = mDeclared[i];
+		const TransientResource& created = mCreated[i];
+		if (memcmp(&declared.Desc, &created.Desc, sizeof(D3D12_RESOURCE_DESC)) != 0 ||
+			declared.HasClearValue != created.HasClearValue ||
+			(declared.HasClearValue && memcmp(&declared.ClearValue, &created.ClearValue, sizeof(D3D12_CLEAR_VALUE)) != 0))
+			return false;
+	}
+	return true;
+}
+
+void D3D12RenderGraph::CreateTransientResources()
+{
+	mCreated = mDeclared;
+	++mTransientGeneration;
+
+	if (mGraph.TransientByteSize() == 0)
+		return;
+
+	// Heaps come in 64KB or 4MB (MSAA) alignment.
+	UINT64 heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	for (ResourceHandle r = 0; r < mGraph.ResourceCount(); ++r)
+	{
+		if (mGraph.IsTransient(r) && mGraph.GetTransientDesc(r).Alignment > heapAlignment)
+			heapAlignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+	}
+
+	CD3DX12_HEAP_DESC heapDesc(mGraph.TransientByteSize(), D3D12_HEAP_TYPE_DEFAULT, heapAlignment, mTransientHeapFlags);
+	ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(mTransientHeap.GetAddressOf())));
+
+	for (ResourceHandle r = 0; r < mGraph.ResourceCount(); ++r)
+	{
+		const RenderGraph::Placement& placement = mGraph.GetPlacement(r);
+		if (!mGraph.IsTransient(r) || placement.Offset == RenderGraph::InvalidOffset)
+			continue;
+
+		// Created directly in the state of its first use, so the first frame needs no
+		// transition.
+		TransientResource& transient = mCreated[r];
+		D3D12_RESOURCE_STATES initialState = (D3D12_RESOURCE_STATES)placement.FirstState;
+		ThrowIfFailed(mDevice->CreatePlacedResource(
+			mTransientHeap.Get(),
+			placement.Offset,
+			&transient.Desc,
+			initialState,
+			transient.HasClearValue ? &transient.ClearValue : nullptr,
+			IID_PPV_ARGS(transient.Resource.GetAddressOf())));
+
+		mStateTracker->Register(transient.Resource.Get(), initialState);
+	}
+}
+
+void D3D12RenderGraph::ReleaseTransientResources()
+{
+	// Frames in flight may still use the old resources; keep them (and their heap) alive
+	// until everything submitted so far has completed.
+	auto retired = std::make_shared<std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>>>();
+	for (TransientResource& transient : mCreated)
+	{
+		if (transient.Resource == nullptr)
+			continue;
+		mStateTracker->Unregister(transient.Resource.Get());
+		retired->push_back(transient.Resource);
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12Heap> heap = mTransientHeap;
+	mTimeline->OnRetired(mTimeline->LastSignaled(), [retired, heap]() {});
+
+	mCreated.clear();
+	mTransientHeap = nullptr;
+}
+
+void D3D12RenderGraph::Execute(ID3D12GraphicsCommandList* cmdList)
+{
+	bool recompiled = mGraph.Compile();
+	if (recompiled || !TransientsMatch())
+	{
+		ReleaseTransientResources();
+		CreateTransientResources();
+	}
+
+	for (ResourceHandle r = 0; r < mGraph.ResourceCount(); ++r)
+	{
+		if (mGraph.IsTransient(r))
+			mResources[r] = mCreated[r].Resource.Get();
+	}
+
+	// The compiled barriers say which state each pass needs; the tracker knows the state
+	// every resource is really in (transients keep theirs from the previous frame).
+	auto recordBarriers = [this](const std::vector<RenderGraph::Barrier>& barriers)
+	{
+		for (const RenderGraph::Barrier& barrier : barriers)
+		{
+			ID3D12Resource* resource = mResources[barrier.Resource];
+			switch (barrier.Type)
+			{
+			case RenderGraph::BarrierType::Transition:
+				mStateTracker->Transition(resource, (D3D12_RESOURCE_STATES)barrier.After);
+				break;
+			case RenderGraph::BarrierType::Uav:
+				mStateTracker->UavBarrier(resource);
+				break;
+			case RenderGraph::BarrierType::Aliasing:
+				mStateTracker->AliasingBarrier(
+					barrier.AliasBefore == RenderGraph::InvalidHandle ? nullptr : mResources[barrier.AliasBefore], resource);
+				break;
+			}
+		}
+	};
+
+	for (const RenderGraph::ScheduledPass& scheduled : mGraph.Schedule())
+	{
+		recordBarriers(scheduled.Barriers);
+		mStateTracker->FlushBarriers(cmdList);
+
+		if (mExecute[scheduled.Pass])
+			mExecute[scheduled.Pass](cmdList);
+	}
+
+	recordBarriers(mGraph.FinalBarriers());
+	mStateTracker->FlushBarriers(cmdList);
+}
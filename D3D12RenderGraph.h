@@ -0,0 +1,89 @@
+//***************************************************************************************
+// D3D12RenderGraph.h
+//
+// Runs a RenderGraph on a D3D12 command list.  Imported resources take their current
+// state from the D3D12StateTracker; transient resources are placed in one heap at the
+// offsets the compiler picked and are only recreated when the compiled layout or their
+// descriptions change.  Barriers go through the state tracker, one ResourceBarrier call
+// per pass.
+//
+// A transient that shares memory with others starts each frame with undefined contents;
+// its first pass must clear, discard or fully overwrite it.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "D3D12StateTracker.h"
+#include "FenceTimeline.h"
+#include "RenderGraph.h"
+#include <functional>
+
+class D3D12RenderGraph
+{
+public:
+	typedef RenderGraph::ResourceHandle ResourceHandle;
+	typedef RenderGraph::PassHandle PassHandle;
+	typedef std::function<void(ID3D12GraphicsCommandList* cmdList)> ExecuteFn;
+
+	D3D12RenderGraph(ID3D12Device* device, D3D12StateTracker* stateTracker, FenceTimeline* timeline,
+		D3D12_HEAP_FLAGS transientHeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES);
+	~D3D12RenderGraph();
+	D3D12RenderGraph(const D3D12RenderGraph& rhs) = delete;
+	D3D12RenderGraph& operator=(const D3D12RenderGraph& rhs) = delete;
+
+	// Starts declaring this frame's graph.
+	void Begin();
+
+	// resource must be registered with the state tracker.
+	ResourceHandle Import(const std::string& name, ID3D12Resource* resource,
+		D3D12_RESOURCE_STATES finalState = (D3D12_RESOURCE_STATES)RenderGraph::UndefinedState);
+	ResourceHandle CreateTransient(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+		const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr);
+
+	PassHandle AddPass(const std::string& name, ExecuteFn execute, bool hasSideEffects = false);
+	void Read(PassHandle pass, ResourceHandle resource, D3D12_RESOURCE_STATES state);
+	void Write(PassHandle pass, ResourceHandle resource, D3D12_RESOURCE_STATES state);
+
+	// Compiles the graph if needed and records every pass that was not culled.
+	void Execute(ID3D12GraphicsCommandList* cmdList);
+
+	// Imported resources right away; transients once Execute has created them.
+	ID3D12Resource* GetResource(ResourceHandle resource)const { return mResources[resource]; }
+
+	// Changes whenever the transient resources are recreated, so views of them can be
+	// rebuilt.
+	UINT64 TransientGeneration()const { return mTransientGeneration; }
+
+	const RenderGraph& Graph()const { return mGraph; }
+
+private:
+	struct TransientResource
+	{
+		D3D12_RESOURCE_DESC Desc = {};
+		bool HasClearValue = false;
+		D3D12_CLEAR_VALUE ClearValue = {};
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+	};
+
+	bool TransientsMatch()const;
+	void CreateTransientResources();
+	void ReleaseTransientResources();
+
+	ID3D12Device* mDevice = nullptr;
+	D3D12StateTracker* mStateTracker = nullptr;
+	FenceTimeline* mTimeline = nullptr;
+	D3D12_HEAP_FLAGS mTransientHeapFlags;
+
+	RenderGraph mGraph;
+
+	// This frame's declarations, indexed by handle.
+	std::vector<ExecuteFn> mExecute;
+	std::vector<ID3D12Resource*> mResources;
+	std::vector<TransientResource> mDeclared;
+
+	// What the transient heap currently holds, indexed by handle.
+	Microsoft::WRL::ComPtr<ID3D12Heap> mTransientHeap;
+	std::vector<TransientResource> mCreated;
+	UINT64 mTransientGeneration = 0;
+};
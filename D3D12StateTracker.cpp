@@ -0,0 +1,91 @@
+#include "D3D12StateTracker.h"
+
+const D3D12_RESOURCE_STATES D3D12StateTracker::ReadOnlyStates = static_cast<D3D12_RESOURCE_STATES>(
+	D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER |
+	D3D12_RESOURCE_STATE_INDEX_BUFFER |
+	D3D12_RESOURCE_STATE_DEPTH_READ |
+	D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE |
+	D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE |
+	D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT |
+	D3D12_RESOURCE_STATE_COPY_SOURCE |
+	D3D12_RESOURCE_STATE_RESOLVE_SOURCE);
+
+// D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES and the tracker's sentinel are the same value;
+// make sure that stays true since they are passed through unchanged.
+static_assert(D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES == ResourceStateTracker::AllSubresources,
+	"Subresource sentinels must match.");
+
+D3D12StateTracker::D3D12StateTracker() :
+	mTracker(ReadOnlyStates, D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+{
+}
+
+void D3D12StateTracker::Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES initialState, UINT subresourceCount)
+{
+	mTracker.Register(resource, initialState, subresourceCount);
+}
+
+void D3D12StateTracker::Unregister(ID3D12Resource* resource)
+{
+	mTracker.Unregister(resource);
+}
+
+D3D12_RESOURCE_STATES D3D12StateTracker::GetState(ID3D12Resource* resource, UINT subresource)const
+{
+	return static_cast<D3D12_RESOURCE_STATES>(mTracker.GetState(resource, subresource));
+}
+
+void D3D12StateTracker::SetState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+	mTracker.SetState(resource, state);
+}
+
+void D3D12StateTracker::Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after, UINT subresource)
+{
+	mTracker.Transition(resource, after, subresource);
+}
+
+void D3D12StateTracker::UavBarrier(ID3D12Resource* resource)
+{
+	mTracker.UavBarrier(resource);
+}
+
+void D3D12StateTracker::AliasingBarrier(ID3D12Resource* before, ID3D12Resource* after)
+{
+	mTracker.AliasingBarrier(before, after);
+}
+
+void D3D12StateTracker::FlushBarriers(ID3D12GraphicsCommandList* cmdList)
+{
+	mTracker.Flush([this, cmdList](const ResourceStateTracker::Barrier* barriers, size_t count)
+	{
+		mBarriers.clear();
+		for (size_t i = 0; i < count; ++i)
+		{
+			const ResourceStateTracker::Barrier& barrier = barriers[i];
+			ID3D12Resource* resource = static_cast<ID3D12Resource*>(const_cast<void*>(barrier.Resource));
+
+			if (barrier.Type == ResourceStateTracker::BarrierType::Uav)
+			{
+				mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+			}
+			else if (barrier.Type == ResourceStateTracker::BarrierType::Aliasing)
+			{
+				ID3D12Resource* before = static_cast<ID3D12Resource*>(const_cast<void*>(barrier.AliasBefore));
+				mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, resource));
+			}
+			else
+			{
+				mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resource,
+					static_cast<D3D12_RESOURCE_STATES>(barrier.Before),
+					static_cast<D3D12_RESOURCE_STATES>(barrier.After),
+					barrier.Subresource));
+			}
+		}
+
+		cmdList->ResourceBarrier(static_cast<UINT>(mBarriers.size()), mBarriers.data());
+
+		++mFlushCount;
+		mBarrierCount += mBarriers.size();
+	});
+}
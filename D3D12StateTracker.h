@@ -0,0 +1,49 @@
+//***************************************************************************************
+// D3D12StateTracker.h
+//
+// ResourceStateTracker for ID3D12Resources.  Call Transition() whenever a resource is
+// about to be used and FlushBarriers() right before the draw, dispatch, copy or clear
+// that needs it; all pending transitions go out in a single ResourceBarrier call.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "ResourceStateTracker.h"
+
+class D3D12StateTracker
+{
+public:
+	// States in which a resource is only read; they may be combined freely.
+	static const D3D12_RESOURCE_STATES ReadOnlyStates;
+
+	D3D12StateTracker();
+	D3D12StateTracker(const D3D12StateTracker& rhs) = delete;
+	D3D12StateTracker& operator=(const D3D12StateTracker& rhs) = delete;
+
+	void Register(ID3D12Resource* resource, D3D12_RESOURCE_STATES initialState, UINT subresourceCount = 1);
+	void Unregister(ID3D12Resource* resource);
+
+	D3D12_RESOURCE_STATES GetState(ID3D12Resource* resource, UINT subresource = 0)const;
+	// For resources transitioned on another command list; see ResourceStateTracker.
+	void SetState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+
+	void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after,
+		UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES);
+	void UavBarrier(ID3D12Resource* resource);
+	void AliasingBarrier(ID3D12Resource* before, ID3D12Resource* after);
+
+	// Records every pending barrier with one ResourceBarrier call.
+	void FlushBarriers(ID3D12GraphicsCommandList* cmdList);
+
+	// Number of ResourceBarrier calls and barriers issued so far.
+	UINT64 FlushCount()const { return mFlushCount; }
+	UINT64 BarrierCount()const { return mBarrierCount; }
+
+private:
+	ResourceStateTracker mTracker;
+	std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+
+	UINT64 mFlushCount = 0;
+	UINT64 mBarrierCount = 0;
+};
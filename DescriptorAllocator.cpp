@@ -0,0 +1,127 @@
+#include "DescriptorAllocator.h"
+
+StagingDescriptorHeap::StagingDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity) :
+	mAllocator(capacity)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+	heapDesc.NumDescriptors = capacity;
+	heapDesc.Type = type;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	heapDesc.NodeMask = 0;
+	ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(mHeap.GetAddressOf())));
+
+	mCpuStart = mHeap->GetCPUDescriptorHandleForHeapStart();
+	mDescriptorSize = device->GetDescriptorHandleIncrementSize(type);
+}
+
+DescriptorRange StagingDescriptorHeap::Allocate(UINT count)
+{
+	UINT index = mAllocator.Allocate(count);
+	if (index == FreeListAllocator::InvalidOffset)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	DescriptorRange range;
+	range.CpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCpuStart, index, mDescriptorSize);
+	range.Index = index;
+	range.Count = count;
+	range.DescriptorSize = mDescriptorSize;
+	return range;
+}
+
+void StagingDescriptorHeap::Free(DescriptorRange& range)
+{
+	if (!range.IsValid())
+		return;
+
+	mAllocator.Free(range.Index, range.Count);
+	range = DescriptorRange();
+}
+
+GpuDescriptorHeap::GpuDescriptorHeap(ID3D12Device* device, FenceTimeline* timeline, UINT staticCapacity, UINT dynamicCapacity) :
+	mDevice(device),
+	mTimeline(timeline),
+	mStaticCapacity(staticCapacity),
+	mStaticAllocator(staticCapacity, timeline),
+	mDynamicAllocator(dynamicCapacity)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+	heapDesc.NumDescriptors = staticCapacity + dynamicCapacity;
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	heapDesc.NodeMask = 0;
+	ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(mHeap.GetAddressOf())));
+
+	mCpuStart = mHeap->GetCPUDescriptorHandleForHeapStart();
+	mGpuStart = mHeap->GetGPUDescriptorHandleForHeapStart();
+	mDescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+DescriptorRange GpuDescriptorHeap::MakeRange(UINT index, UINT count)const
+{
+	DescriptorRange range;
+	range.CpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(mCpuStart, index, mDescriptorSize);
+	range.GpuStart = CD3DX12_GPU_DESCRIPTOR_HANDLE(mGpuStart, index, mDescriptorSize);
+	range.Index = index;
+	range.Count = count;
+	range.DescriptorSize = mDescriptorSize;
+	return range;
+}
+
+DescriptorRange GpuDescriptorHeap::AllocateStatic(UINT count)
+{
+	UINT index = mStaticAllocator.Allocate(count);
+	if (index == FreeListAllocator::InvalidOffset)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	return MakeRange(index, count);
+}
+
+void GpuDescriptorHeap::FreeStatic(DescriptorRange& range)
+{
+	if (!range.IsValid())
+		return;
+
+	mStaticAllocator.Free(range.Index, range.Count);
+	range = DescriptorRange();
+}
+
+DescriptorRange GpuDescriptorHeap::AllocateDynamic(UINT count)
+{
+	mDynamicAllocator.ReleaseCompleted(mTimeline->CompletedValue());
+
+	UINT64 offset = mDynamicAllocator.Allocate(count);
+	while (offset == RingAllocator::InvalidOffset)
+	{
+		// Only descriptors of already submitted work can come back.
+		UINT64 oldest = mDynamicAllocator.OldestPendingFence();
+		if (oldest == 0)
+			ThrowIfFailed(E_OUTOFMEMORY);
+
+		mTimeline->WaitFor(oldest);
+		mDynamicAllocator.ReleaseCompleted(mTimeline->CompletedValue());
+		offset = mDynamicAllocator.Allocate(count);
+	}
+
+	return MakeRange(mStaticCapacity + static_cast<UINT>(offset), count);
+}
+
+DescriptorRange GpuDescriptorHeap::CopyToDynamic(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, UINT count)
+{
+	DescriptorRange table = AllocateDynamic(count);
+
+	// One destination range of count descriptors, count source ranges of one descriptor.
+	mCopySizes.assign(count, 1);
+	D3D12_CPU_DESCRIPTOR_HANDLE destStart = table.CpuStart;
+	mDevice->CopyDescriptors(1, &destStart, &count,
+		count, srcHandles, mCopySizes.data(),
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	return table;
+}
+
+void GpuDescriptorHeap::Submit(UINT64 fenceValue)
+{
+	mDynamicAllocator.FinishSubmission(fenceValue);
+
+	mStaticAllocator.Submit(fenceValue);
+}
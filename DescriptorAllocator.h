@@ -0,0 +1,111 @@
+//***************************************************************************************
+// DescriptorAllocator.h
+//
+// Descriptor heap management.
+//
+// StagingDescriptorHeap: a CPU-only (non shader-visible) heap where views are created
+//   and kept.  Ranges come from a FreeListAllocator.
+//
+// GpuDescriptorHeap: the one shader-visible CBV/SRV/UAV heap that is bound for the
+//   whole frame.  The front of the heap is a static region for descriptors that live as
+//   long as their resources (deferred free-list); the rest is a dynamic ring where per-draw
+//   tables are assembled with CopyDescriptors and recycled once the frame's fence
+//   value has completed.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FenceTimeline.h"
+#include "FreeListAllocator.h"
+#include "RingAllocator.h"
+
+struct DescriptorRange
+{
+	CD3DX12_CPU_DESCRIPTOR_HANDLE CpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(D3D12_DEFAULT);
+	CD3DX12_GPU_DESCRIPTOR_HANDLE GpuStart = CD3DX12_GPU_DESCRIPTOR_HANDLE(D3D12_DEFAULT);
+	UINT Index = UINT_MAX;
+	UINT Count = 0;
+	UINT DescriptorSize = 0;
+
+	bool IsValid()const { return Index != UINT_MAX; }
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE Cpu(UINT i)const
+	{
+		return CD3DX12_CPU_DESCRIPTOR_HANDLE(CpuStart, i, DescriptorSize);
+	}
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE Gpu(UINT i)const
+	{
+		return CD3DX12_GPU_DESCRIPTOR_HANDLE(GpuStart, i, DescriptorSize);
+	}
+};
+
+class StagingDescriptorHeap
+{
+public:
+	StagingDescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity);
+	StagingDescriptorHeap(const StagingDescriptorHeap& rhs) = delete;
+	StagingDescriptorHeap& operator=(const StagingDescriptorHeap& rhs) = delete;
+
+	// Throws if there are not count contiguous free descriptors.
+	DescriptorRange Allocate(UINT count = 1);
+	void Free(DescriptorRange& range);
+
+	ID3D12DescriptorHeap* Heap()const { return mHeap.Get(); }
+	UINT DescriptorSize()const { return mDescriptorSize; }
+	const FreeListAllocator& Allocator()const { return mAllocator; }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+	D3D12_CPU_DESCRIPTOR_HANDLE mCpuStart = {};
+	UINT mDescriptorSize = 0;
+	FreeListAllocator mAllocator;
+};
+
+class GpuDescriptorHeap
+{
+public:
+	GpuDescriptorHeap(ID3D12Device* device, FenceTimeline* timeline, UINT staticCapacity, UINT dynamicCapacity);
+	GpuDescriptorHeap(const GpuDescriptorHeap& rhs) = delete;
+	GpuDescriptorHeap& operator=(const GpuDescriptorHeap& rhs) = delete;
+
+	// Persistent descriptors.  FreeStatic defers the release until the GPU is done with
+	// the frame passed to the next Submit.
+	DescriptorRange AllocateStatic(UINT count = 1);
+	void FreeStatic(DescriptorRange& range);
+
+	// Transient contiguous table, valid for the command lists of the current submission.
+	// Waits for older submissions if the ring is full.
+	DescriptorRange AllocateDynamic(UINT count);
+
+	// Gathers descriptors from anywhere (usually staging heaps) into one contiguous
+	// dynamic table with a single CopyDescriptors call.
+	DescriptorRange CopyToDynamic(const D3D12_CPU_DESCRIPTOR_HANDLE* srcHandles, UINT count);
+
+	// Tags the dynamic descriptors handed out, and the static ones freed, since the last
+	// call with fenceValue.
+	void Submit(UINT64 fenceValue);
+
+	ID3D12DescriptorHeap* Heap()const { return mHeap.Get(); }
+	UINT DescriptorSize()const { return mDescriptorSize; }
+	const FreeListAllocator& StaticAllocator()const { return mStaticAllocator.Allocator(); }
+	const RingAllocator& DynamicAllocator()const { return mDynamicAllocator; }
+
+private:
+	DescriptorRange MakeRange(UINT index, UINT count)const;
+
+	ID3D12Device* mDevice = nullptr;
+	FenceTimeline* mTimeline = nullptr;
+
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+	D3D12_CPU_DESCRIPTOR_HANDLE mCpuStart = {};
+	D3D12_GPU_DESCRIPTOR_HANDLE mGpuStart = {};
+	UINT mDescriptorSize = 0;
+
+	UINT mStaticCapacity = 0;
+	DeferredFreeListAllocator mStaticAllocator;
+	RingAllocator mDynamicAllocator;
+
+	std::vector<UINT> mCopySizes;
+};
@@ -0,0 +1,187 @@
+#include "DrawPackets.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	const std::uint32_t RadixBits = 8;
+	const std::uint32_t RadixSize = 1 << RadixBits;
+	const std::uint32_t RadixPasses = 64 / RadixBits;
+
+	std::uint64_t Field(std::uint32_t value, std::uint32_t bits, std::uint32_t shift)
+	{
+		return (std::uint64_t)(value & ((1u << bits) - 1)) << shift;
+	}
+
+	std::uint32_t Digit(std::uint64_t key, std::uint32_t pass)
+	{
+		return (std::uint32_t)(key >> (pass * RadixBits)) & (RadixSize - 1);
+	}
+}
+
+std::uint64_t DrawKey::Make(std::uint32_t pass, std::uint32_t rootSignature, std::uint32_t pipeline,
+	std::uint32_t material, float depth)
+{
+	// Non-negative floats order like their bit patterns; the sign bit is dropped with the
+	// low mantissa bits.
+	std::uint32_t depthBits = 0;
+	if (depth > 0.0f)
+	{
+		std::memcpy(&depthBits, &depth, sizeof(depthBits));
+		depthBits >>= 31 - DepthBits;
+	}
+
+	return Field(pass, PassBits, PassShift) |
+		Field(rootSignature, RootSignatureBits, RootSignatureShift) |
+		Field(pipeline, PipelineBits, PipelineShift) |
+		Field(material, MaterialBits, MaterialShift) |
+		Field(depthBits, DepthBits, DepthShift);
+}
+
+std::uint32_t DrawKey::Pass(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> PassShift) & ((1u << PassBits) - 1);
+}
+
+std::uint32_t DrawKey::RootSignature(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> RootSignatureShift) & ((1u << RootSignatureBits) - 1);
+}
+
+std::uint32_t DrawKey::Pipeline(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> PipelineShift) & ((1u << PipelineBits) - 1);
+}
+
+std::uint32_t DrawKey::Material(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> MaterialShift) & ((1u << MaterialBits) - 1);
+}
+
+std::uint32_t DrawKey::Depth(std::uint64_t key)
+{
+	return (std::uint32_t)(key >> DepthShift) & ((1u << DepthBits) - 1);
+}
+
+void DrawPacketList::Reserve(std::size_t count)
+{
+	mPackets.reserve(count);
+	mScratch.reserve(count);
+}
+
+void DrawPacketList::Add(std::uint64_t key, std::uint32_t item)
+{
+	DrawPacket packet;
+	packet.Key = key;
+	packet.Item = item;
+	mPackets.push_back(packet);
+}
+
+void DrawPacketList::Sort(WorkerPool* workers)
+{
+	mSortedPasses = 0;
+	mSkippedPasses = 0;
+	if (mPackets.size() < 2)
+		return;
+
+	std::uint32_t partCount = workers != nullptr ? workers->ThreadCount() : 1;
+	partCount = (std::uint32_t)std::max<std::size_t>(1, std::min<std::size_t>(partCount, mPackets.size() / MinPacketsPerThread));
+
+	mScratch.resize(mPackets.size());
+	if (partCount == 1)
+		SortSerial();
+	else
+		SortParallel(*workers, partCount);
+}
+
+void DrawPacketList::SortSerial()
+{
+	const std::size_t count = mPackets.size();
+
+	// The histograms of every digit in one read of the keys.
+	std::vector<std::uint32_t> histograms(RadixPasses * RadixSize, 0);
+	for (const DrawPacket& packet : mPackets)
+	{
+		for (std::uint32_t pass = 0; pass < RadixPasses; ++pass)
+			++histograms[pass * RadixSize + Digit(packet.Key, pass)];
+	}
+
+	for (std::uint32_t pass = 0; pass < RadixPasses; ++pass)
+	{
+		std::uint32_t* histogram = &histograms[pass * RadixSize];
+
+		// Every key has the same digit: the pass would not move anything.
+		if (histogram[Digit(mPackets[0].Key, pass)] == count)
+		{
+			++mSkippedPasses;
+			continue;
+		}
+
+		std::uint32_t offset = 0;
+		for (std::uint32_t digit = 0; digit < RadixSize; ++digit)
+		{
+			std::uint32_t digitCount = histogram[digit];
+			histogram[digit] = offset;
+			offset += digitCount;
+		}
+
+		for (const DrawPacket& packet : mPackets)
+			mScratch[histogram[Digit(packet.Key, pass)]++] = packet;
+		mPackets.swap(mScratch);
+		++mSortedPasses;
+	}
+}
+
+void DrawPacketList::SortParallel(WorkerPool& workers, std::uint32_t partCount)
+{
+	const std::size_t count = mPackets.size();
+	std::vector<std::uint32_t> histograms(partCount * RadixSize);
+
+	for (std::uint32_t pass = 0; pass < RadixPasses; ++pass)
+	{
+		// Each task counts the digits of its part of the list.
+		std::fill(histograms.begin(), histograms.end(), 0);
+		workers.Run(partCount, [&](std::uint32_t t)
+		{
+			std::uint32_t* histogram = &histograms[t * RadixSize];
+			const std::size_t begin = count * t / partCount;
+			const std::size_t end = count * (t + 1) / partCount;
+			for (std::size_t i = begin; i < end; ++i)
+				++histogram[Digit(mPackets[i].Key, pass)];
+		});
+
+		std::uint32_t firstDigitCount = 0;
+		const std::uint32_t firstDigit = Digit(mPackets[0].Key, pass);
+		for (std::uint32_t t = 0; t < partCount; ++t)
+			firstDigitCount += histograms[t * RadixSize + firstDigit];
+		if (firstDigitCount == count)
+		{
+			++mSkippedPasses;
+			continue;
+		}
+
+		// Digit-major offsets, and part-minor within a digit, keep the sort stable: the
+		// parts are in list order and each task scatters its part in order.
+		std::uint32_t offset = 0;
+		for (std::uint32_t digit = 0; digit < RadixSize; ++digit)
+		{
+			for (std::uint32_t t = 0; t < partCount; ++t)
+			{
+				std::uint32_t digitCount = histograms[t * RadixSize + digit];
+				histograms[t * RadixSize + digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		workers.Run(partCount, [&](std::uint32_t t)
+		{
+			std::uint32_t* offsets = &histograms[t * RadixSize];
+			const std::size_t begin = count * t / partCount;
+			const std::size_t end = count * (t + 1) / partCount;
+			for (std::size_t i = begin; i < end; ++i)
+				mScratch[offsets[Digit(mPackets[i].Key, pass)]++] = mPackets[i];
+		});
+		mPackets.swap(mScratch);
+		++mSortedPasses;
+	}
+}
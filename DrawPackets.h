@@ -0,0 +1,97 @@
+//***************************************************************************************
+// DrawPackets.h
+//
+// Draw order by sort key.  Every visible item becomes a packet whose 64-bit key packs,
+// from the most significant bits down,
+//
+//   Pass           4 bits  - render pass the item is drawn in
+//   RootSignature  4 bits  - root signature index
+//   Pipeline      12 bits  - pipeline state index
+//   Material      20 bits  - material index
+//   Depth         24 bits  - distance to the camera, nearest first
+//
+// so sorting the keys groups the packets by the most expensive state first and draws
+// what is left front to back.  Changing the root signature also drops the root
+// arguments, so it sits above the pipeline state.  Depth is the top 24 bits of the non-negative float's
+// representation, which order the same way the floats do.
+//
+// The packets are sorted with a stable LSD radix sort, eight bits per pass.  Passes in
+// which every key has the same digit are skipped, so keys that only differ in a few
+// fields cost only a few passes.  Large lists are histogrammed and scattered on the
+// threads of a WorkerPool, each over a contiguous part of the list.  Nothing here
+// touches D3D.
+//***************************************************************************************
+
+#pragma once
+
+#include "WorkerPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct DrawPacket
+{
+	std::uint64_t Key = 0;
+	// What to draw; for the renderer, the position in the visible list.
+	std::uint32_t Item = 0;
+};
+
+namespace DrawKey
+{
+	const std::uint32_t PassBits = 4;
+	const std::uint32_t RootSignatureBits = 4;
+	const std::uint32_t PipelineBits = 12;
+	const std::uint32_t MaterialBits = 20;
+	const std::uint32_t DepthBits = 24;
+
+	const std::uint32_t DepthShift = 0;
+	const std::uint32_t MaterialShift = DepthShift + DepthBits;
+	const std::uint32_t PipelineShift = MaterialShift + MaterialBits;
+	const std::uint32_t RootSignatureShift = PipelineShift + PipelineBits;
+	const std::uint32_t PassShift = RootSignatureShift + RootSignatureBits;
+
+	// Fields wider than their bits are truncated; depth below zero counts as zero.
+	std::uint64_t Make(std::uint32_t pass, std::uint32_t rootSignature, std::uint32_t pipeline,
+		std::uint32_t material, float depth);
+
+	std::uint32_t Pass(std::uint64_t key);
+	std::uint32_t RootSignature(std::uint64_t key);
+	std::uint32_t Pipeline(std::uint64_t key);
+	std::uint32_t Material(std::uint64_t key);
+	std::uint32_t Depth(std::uint64_t key);
+}
+
+class DrawPacketList
+{
+public:
+	void Reserve(std::size_t count);
+	void Clear() { mPackets.clear(); }
+
+	void Add(std::uint64_t key, std::uint32_t item);
+
+	// Sorts by key; packets with equal keys keep the order they were added in.  Large
+	// lists are spread over workers when given.
+	void Sort(WorkerPool* workers = nullptr);
+
+	std::size_t Size()const { return mPackets.size(); }
+	const DrawPacket& operator[](std::size_t i)const { return mPackets[i]; }
+	const DrawPacket* Data()const { return mPackets.data(); }
+
+	// Radix passes the last Sort performed and skipped.
+	std::uint32_t SortedPasses()const { return mSortedPasses; }
+	std::uint32_t SkippedPasses()const { return mSkippedPasses; }
+
+	// Lists smaller than this per thread are sorted on fewer threads.
+	static const std::uint32_t MinPacketsPerThread = 64 * 1024;
+
+private:
+	void SortSerial();
+	void SortParallel(WorkerPool& workers, std::uint32_t partCount);
+
+	std::vector<DrawPacket> mPackets;
+	// Where every other radix pass writes to.
+	std::vector<DrawPacket> mScratch;
+
+	std::uint32_t mSortedPasses = 0;
+	std::uint32_t mSkippedPasses = 0;
+};
@@ -0,0 +1,62 @@
+//***************************************************************************************
+// FakeFenceBackend.h
+//
+// CPU-only IFenceBackend.  The "GPU" only moves forward when the owner calls Complete(),
+// which makes the retirement and ordering rules of FenceTimeline deterministic.
+//***************************************************************************************
+
+#pragma once
+
+#include "FenceTimeline.h"
+#include <algorithm>
+
+class FakeFenceBackend : public IFenceBackend
+{
+public:
+	std::uint64_t GetCompletedValue()const override { return mCompleted; }
+
+	void Signal(std::uint64_t value) override
+	{
+		mLastSignaled = std::max(mLastSignaled, value);
+	}
+
+	void* CreateWaiter() override
+	{
+		++mLiveWaiters;
+		return new int(0);
+	}
+
+	void DestroyWaiter(void* waiter) override
+	{
+		--mLiveWaiters;
+		delete static_cast<int*>(waiter);
+	}
+
+	// An infinite wait behaves like a GPU that eventually gets there: the fence jumps to
+	// the requested value (as long as it was signaled).  A finite wait never advances time.
+	bool Wait(void* /*waiter*/, std::uint64_t value, std::uint32_t timeoutMs) override
+	{
+		++mWaitCount;
+		if (mCompleted < value && timeoutMs == FenceTimeline::InfiniteTimeout && value <= mLastSignaled)
+			mCompleted = value;
+		return mCompleted >= value;
+	}
+
+	// Simulates the GPU finishing all work up to value.
+	void Complete(std::uint64_t value)
+	{
+		mCompleted = std::max(mCompleted, std::min(value, mLastSignaled));
+	}
+
+	void CompleteAll() { mCompleted = mLastSignaled; }
+
+	std::uint64_t LastSignaled()const { return mLastSignaled; }
+	int LiveWaiters()const { return mLiveWaiters; }
+	int WaitCount()const { return mWaitCount; }
+
+private:
+	std::uint64_t mCompleted = 0;
+	std::uint64_t mLastSignaled = 0;
+	int mLiveWaiters = 0;
+	int mWaitCount = 0;
+};
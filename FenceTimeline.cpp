@@ -0,0 +1,115 @@
+#include "FenceTimeline.h"
+#include <algorithm>
+
+FenceWaiterPool::~FenceWaiterPool()
+{
+	for (void* waiter : mFree)
+		mBackend->DestroyWaiter(waiter);
+}
+
+void* FenceWaiterPool::Acquire()
+{
+	if (mFree.empty())
+	{
+		++mCreatedCount;
+		return mBackend->CreateWaiter();
+	}
+
+	void* waiter = mFree.back();
+	mFree.pop_back();
+	return waiter;
+}
+
+void FenceWaiterPool::Release(void* waiter)
+{
+	mFree.push_back(waiter);
+}
+
+FenceTimeline::FenceTimeline(IFenceBackend* backend, std::uint64_t initialValue) :
+	mBackend(backend),
+	mWaiters(backend),
+	mLastSignaled(initialValue),
+	mLastCompleted(initialValue)
+{
+}
+
+std::uint64_t FenceTimeline::Signal()
+{
+	++mLastSignaled;
+	mBackend->Signal(mLastSignaled);
+	return mLastSignaled;
+}
+
+std::uint64_t FenceTimeline::CompletedValue()
+{
+	// The fence never goes backwards, so keep the highest value seen.
+	mLastCompleted = std::max(mLastCompleted, mBackend->GetCompletedValue());
+	return mLastCompleted;
+}
+
+bool FenceTimeline::IsComplete(std::uint64_t value)
+{
+	// Fast path: no need to ask the backend for values we already know are done.
+	if (value <= mLastCompleted)
+		return true;
+
+	return value <= CompletedValue();
+}
+
+bool FenceTimeline::WaitFor(std::uint64_t value, std::uint32_t timeoutMs)
+{
+	if (IsComplete(value))
+		return true;
+
+	void* waiter = mWaiters.Acquire();
+	bool reached = mBackend->Wait(waiter, value, timeoutMs);
+	mWaiters.Release(waiter);
+
+	return reached && IsComplete(value);
+}
+
+void FenceTimeline::Flush()
+{
+	WaitFor(Signal());
+}
+
+void FenceTimeline::OnRetired(std::uint64_t value, std::function<void()> callback)
+{
+	PendingCallback pending;
+	pending.Value = value;
+	pending.Callback = std::move(callback);
+
+	// Values are almost always registered in increasing order, so appending is the
+	// common case.  upper_bound keeps callbacks with equal values in registration order.
+	if (mCallbacks.empty() || mCallbacks.back().Value <= value)
+	{
+		mCallbacks.push_back(std::move(pending));
+	}
+	else
+	{
+		auto it = std::upper_bound(mCallbacks.begin(), mCallbacks.end(), value,
+			[](std::uint64_t v, const PendingCallback& c) { return v < c.Value; });
+		mCallbacks.insert(it, std::move(pending));
+	}
+}
+
+std::size_t FenceTimeline::RetireCompleted()
+{
+	if (mCallbacks.empty())
+		return 0;
+
+	std::uint64_t completed = CompletedValue();
+
+	std::size_t count = 0;
+	while (!mCallbacks.empty() && mCallbacks.front().Value <= completed)
+	{
+		// Pop before invoking so a callback may safely register new callbacks.
+		std::function<void()> callback = std::move(mCallbacks.front().Callback);
+		mCallbacks.pop_front();
+		if (callback)
+			callback();
+		++count;
+	}
+
+	return count;
+}
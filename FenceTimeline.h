@@ -0,0 +1,109 @@
+//***************************************************************************************
+// FenceTimeline.h
+//
+// Hands out monotonically increasing fence values for one queue, answers "has the GPU
+// reached this value yet" and runs callbacks once a value retires.  The actual fence
+// lives behind IFenceBackend so the same bookkeeping runs on a D3D12 fence or on the
+// CPU-only FakeFenceBackend.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class IFenceBackend
+{
+public:
+	virtual ~IFenceBackend() = default;
+
+	virtual std::uint64_t GetCompletedValue()const = 0;
+
+	// Asks the queue to set the fence to value once all prior work has finished.
+	virtual void Signal(std::uint64_t value) = 0;
+
+	// Waiters are opaque OS objects (events on Win32) that the timeline pools and reuses.
+	virtual void* CreateWaiter() = 0;
+	virtual void DestroyWaiter(void* waiter) = 0;
+
+	// Blocks on waiter until the fence reaches value or timeoutMs elapses.
+	// Returns true if the value was reached.
+	virtual bool Wait(void* waiter, std::uint64_t value, std::uint32_t timeoutMs) = 0;
+};
+
+// Keeps waiters alive between waits so we do not create and close an OS event every time.
+class FenceWaiterPool
+{
+public:
+	explicit FenceWaiterPool(IFenceBackend* backend) : mBackend(backend) {}
+	FenceWaiterPool(const FenceWaiterPool& rhs) = delete;
+	FenceWaiterPool& operator=(const FenceWaiterPool& rhs) = delete;
+	~FenceWaiterPool();
+
+	void* Acquire();
+	void Release(void* waiter);
+
+	std::size_t CreatedCount()const { return mCreatedCount; }
+	std::size_t FreeCount()const { return mFree.size(); }
+
+private:
+	IFenceBackend* mBackend = nullptr;
+	std::vector<void*> mFree;
+	std::size_t mCreatedCount = 0;
+};
+
+class FenceTimeline
+{
+public:
+	static const std::uint32_t InfiniteTimeout = 0xFFFFFFFF;
+
+	explicit FenceTimeline(IFenceBackend* backend, std::uint64_t initialValue = 0);
+	FenceTimeline(const FenceTimeline& rhs) = delete;
+	FenceTimeline& operator=(const FenceTimeline& rhs) = delete;
+
+	// Returns the next fence value and signals it on the backend.
+	std::uint64_t Signal();
+
+	// Last value handed out by Signal().
+	std::uint64_t LastSignaled()const { return mLastSignaled; }
+
+	// Queries the backend; the result is cached so IsComplete can answer cheaply.
+	std::uint64_t CompletedValue();
+
+	bool IsComplete(std::uint64_t value);
+
+	// Returns true if value was reached before the timeout.
+	bool WaitFor(std::uint64_t value, std::uint32_t timeoutMs = InfiniteTimeout);
+
+	// Signals a new value and waits for it, i.e. waits for all submitted work.
+	void Flush();
+
+	// Runs callback once the GPU reaches value.  Callbacks run from RetireCompleted,
+	// in fence order; callbacks registered with the same value run in registration order.
+	void OnRetired(std::uint64_t value, std::function<void()> callback);
+
+	// Queries the completed value once and runs every callback it has retired.
+	// Returns the number of callbacks that ran.
+	std::size_t RetireCompleted();
+
+	std::size_t PendingCallbackCount()const { return mCallbacks.size(); }
+	const FenceWaiterPool& Waiters()const { return mWaiters; }
+
+private:
+	struct PendingCallback
+	{
+		std::uint64_t Value = 0;
+		std::function<void()> Callback;
+	};
+
+	IFenceBackend* mBackend = nullptr;
+	FenceWaiterPool mWaiters;
+
+	std::uint64_t mLastSignaled = 0;
+	std::uint64_t mLastCompleted = 0;
+
+	// Sorted by Value.
+	std::deque<PendingCallback> mCallbacks;
+};
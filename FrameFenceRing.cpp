@@ -0,0 +1,22 @@
+#include "FrameFenceRing.h"
+#include <cassert>
+
+FrameFenceRing::FrameFenceRing(int frameCount) :
+	mSlotFences(frameCount > 0 ? frameCount : 1, 0)
+{
+}
+
+std::uint64_t FrameFenceRing::Advance()
+{
+	mCurrIndex = (mCurrIndex + 1) % FrameCount();
+	return mSlotFences[mCurrIndex];
+}
+
+void FrameFenceRing::MarkSubmitted(std::uint64_t fenceValue)
+{
+	assert(mCurrIndex >= 0 && "Advance() must be called before MarkSubmitted().");
+	assert(fenceValue > mLastSubmitted && "Fence values must increase monotonically.");
+
+	mSlotFences[mCurrIndex] = fenceValue;
+	mLastSubmitted = fenceValue;
+}
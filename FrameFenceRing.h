@@ -0,0 +1,46 @@
+//***************************************************************************************
+// FrameFenceRing.h
+//
+// Fence bookkeeping for N frames in flight.  This class does not talk to the GPU; it
+// only remembers which fence value each frame slot was submitted with so the caller
+// knows what it has to wait for before reusing that slot's resources.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class FrameFenceRing
+{
+public:
+	explicit FrameFenceRing(int frameCount);
+
+	int FrameCount()const { return static_cast<int>(mSlotFences.size()); }
+	int CurrentIndex()const { return mCurrIndex; }
+
+	// Moves to the next frame slot (the first call selects slot 0).  Returns the fence
+	// value the GPU must have reached before the slot's resources can be reused, or 0
+	// if the slot has never been submitted.
+	std::uint64_t Advance();
+
+	// Fence value the current slot is waiting on (0 if none).
+	std::uint64_t PendingFence()const { return mSlotFences[mCurrIndex]; }
+
+	// True if the CPU must block before recording into the current slot.
+	bool NeedsWait(std::uint64_t completedValue)const
+	{
+		return PendingFence() != 0 && completedValue < PendingFence();
+	}
+
+	// Records the fence value signaled after the current slot's commands were submitted.
+	void MarkSubmitted(std::uint64_t fenceValue);
+
+	// Highest fence value recorded by MarkSubmitted.
+	std::uint64_t LastSubmitted()const { return mLastSubmitted; }
+
+private:
+	std::vector<std::uint64_t> mSlotFences;
+	int mCurrIndex = -1;
+	std::uint64_t mLastSubmitted = 0;
+};
@@ -0,0 +1,17 @@
+#include "FrameResource.h"
+
+FrameResource::FrameResource(ID3D12Device* device, UINT objectCount)
+{
+	ThrowIfFailed(device->CreateCommandAllocator(
+		D3D12_COMMAND_LIST_TYPE_DIRECT,
+		IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+
+	// Size the first page for objectCount instances; the arena grows if a frame needs more.
+	UINT64 passCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
+	UINT64 instanceByteSize = d3dUtil::CalcConstantBufferByteSize((UINT)sizeof(InstanceData) * std::max(objectCount, 1u));
+	ObjectCB = std::make_unique<ConstantBufferArena>(device, passCBByteSize + instanceByteSize);
+}
+
+FrameResource::~FrameResource()
+{
+}
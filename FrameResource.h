@@ -0,0 +1,37 @@
+//***************************************************************************************
+// FrameResource.h
+//
+// Stores the resources the CPU needs to build the command lists for a frame.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "ConstantBufferArena.h"
+#include "InstanceBatcher.h"
+
+// Per-object data is per-instance vertex data (InstanceData), so the only constants
+// left are the pass's.
+struct PassConstants
+{
+	DirectX::XMFLOAT4X4 ViewProj = MathHelper::Identity4x4();
+};
+
+struct FrameResource
+{
+public:
+	FrameResource(ID3D12Device* device, UINT objectCount);
+	FrameResource(const FrameResource& rhs) = delete;
+	FrameResource& operator=(const FrameResource& rhs) = delete;
+	~FrameResource();
+
+	// We cannot reset the allocator until the GPU is done processing the commands.
+	// So each frame needs their own allocator.
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
+
+	// We cannot update a cbuffer until the GPU is done processing the commands
+	// that reference it.  So each frame needs their own cbuffers.  The arena is
+	// reset at the start of the frame and holds the pass constants and the instance
+	// data of the frame.
+	std::unique_ptr<ConstantBufferArena> ObjectCB = nullptr;
+};
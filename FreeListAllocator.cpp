@@ -0,0 +1,107 @@
+#include "FreeListAllocator.h"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(std::uint32_t capacity) :
+	mCapacity(capacity),
+	mFreeCount(capacity)
+{
+	if (capacity > 0)
+		mFreeRanges[0] = capacity;
+}
+
+std::uint32_t FreeListAllocator::Allocate(std::uint32_t count)
+{
+	if (count == 0 || count > mFreeCount)
+		return InvalidOffset;
+
+	for (auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+	{
+		if (it->second < count)
+			continue;
+
+		std::uint32_t offset = it->first;
+		std::uint32_t remaining = it->second - count;
+		mFreeRanges.erase(it);
+		if (remaining > 0)
+			mFreeRanges[offset + count] = remaining;
+
+		mFreeCount -= count;
+		return offset;
+	}
+
+	return InvalidOffset;
+}
+
+void FreeListAllocator::Free(std::uint32_t offset, std::uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	assert(offset + count <= mCapacity && "Freeing a range outside the allocator.");
+
+	mFreeCount += count;
+
+	auto next = mFreeRanges.lower_bound(offset);
+	assert((next == mFreeRanges.end() || offset + count <= next->first) && "Double free or overlapping range.");
+
+	// Merge with the following range.
+	if (next != mFreeRanges.end() && offset + count == next->first)
+	{
+		count += next->second;
+		next = mFreeRanges.erase(next);
+	}
+
+	// Merge with the preceding range.
+	if (next != mFreeRanges.begin())
+	{
+		auto prev = std::prev(next);
+		assert(prev->first + prev->second <= offset && "Double free or overlapping range.");
+		if (prev->first + prev->second == offset)
+		{
+			prev->second += count;
+			return;
+		}
+	}
+
+	mFreeRanges[offset] = count;
+}
+
+std::uint32_t FreeListAllocator::LargestFreeRange()const
+{
+	std::uint32_t largest = 0;
+	for (const auto& range : mFreeRanges)
+		largest = std::max(largest, range.second);
+	return largest;
+}
+
+DeferredFreeListAllocator::DeferredFreeListAllocator(std::uint32_t capacity, FenceTimeline* timeline) :
+	mAllocator(capacity),
+	mTimeline(timeline)
+{
+}
+
+void DeferredFreeListAllocator::Free(std::uint32_t offset, std::uint32_t count)
+{
+	// Command lists already submitted, and the one being recorded, may still reference
+	// the range; the latter completes with the fence Submit is given.
+	if (count > 0)
+		mPendingFrees.emplace_back(offset, count);
+}
+
+void DeferredFreeListAllocator::Submit(std::uint64_t fenceValue)
+{
+	if (mPendingFrees.empty())
+		return;
+
+	// Upload batches and flushes signal too, so a value taken at Free time may belong to
+	// another submission; the frame's own fence does not.
+	FreeListAllocator* allocator = &mAllocator;
+	mTimeline->OnRetired(fenceValue, [allocator, frees = std::move(mPendingFrees)]()
+	{
+		for (const std::pair<std::uint32_t, std::uint32_t>& range : frees)
+			allocator->Free(range.first, range.second);
+	});
+	mPendingFrees.clear();
+}
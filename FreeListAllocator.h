@@ -0,0 +1,73 @@
+//***************************************************************************************
+// FreeListAllocator.h
+//
+// First-fit allocator of contiguous index ranges out of a fixed count (descriptor
+// slots, for instance).  Free ranges are kept sorted by offset and merged with their
+// neighbours when freed, so long-lived allocations do not fragment the range forever.
+//
+// DeferredFreeListAllocator holds frees back until the GPU is done with the submission
+// that may still reference the range (static descriptors, for instance).
+//***************************************************************************************
+
+#pragma once
+
+#include "FenceTimeline.h"
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+class FreeListAllocator
+{
+public:
+	static const std::uint32_t InvalidOffset = ~0u;
+
+	explicit FreeListAllocator(std::uint32_t capacity);
+
+	// Returns the first index of count contiguous free slots, or InvalidOffset.
+	std::uint32_t Allocate(std::uint32_t count);
+
+	// Returns a range obtained from Allocate.
+	void Free(std::uint32_t offset, std::uint32_t count);
+
+	std::uint32_t Capacity()const { return mCapacity; }
+	std::uint32_t FreeCount()const { return mFreeCount; }
+	std::uint32_t UsedCount()const { return mCapacity - mFreeCount; }
+	std::uint32_t FreeRangeCount()const { return static_cast<std::uint32_t>(mFreeRanges.size()); }
+	std::uint32_t LargestFreeRange()const;
+
+private:
+	std::uint32_t mCapacity = 0;
+	std::uint32_t mFreeCount = 0;
+
+	// Offset -> count of every free range.
+	std::map<std::uint32_t, std::uint32_t> mFreeRanges;
+};
+
+class DeferredFreeListAllocator
+{
+public:
+	DeferredFreeListAllocator(std::uint32_t capacity, FenceTimeline* timeline);
+	DeferredFreeListAllocator(const DeferredFreeListAllocator& rhs) = delete;
+	DeferredFreeListAllocator& operator=(const DeferredFreeListAllocator& rhs) = delete;
+
+	std::uint32_t Allocate(std::uint32_t count) { return mAllocator.Allocate(count); }
+
+	// The range is reused once the GPU is done with the submission passed to the next
+	// Submit.
+	void Free(std::uint32_t offset, std::uint32_t count);
+
+	// Tags the frees since the last call with fenceValue.
+	void Submit(std::uint64_t fenceValue);
+
+	const FreeListAllocator& Allocator()const { return mAllocator; }
+	// Frees waiting for the next Submit.
+	std::size_t PendingFreeCount()const { return mPendingFrees.size(); }
+
+private:
+	FreeListAllocator mAllocator;
+	FenceTimeline* mTimeline = nullptr;
+
+	// Ranges (offset, count) freed since the last Submit.
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> mPendingFrees;
+};
@@ -0,0 +1,181 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// Lane i of v set gives bit i.
+	std::uint32_t LaneMask(FXMVECTOR v)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		return (std::uint32_t)_mm_movemask_ps(v);
+#else
+		XMUINT4 lanes;
+		XMStoreUInt4(&lanes, v);
+		return (lanes.x >> 31) | ((lanes.y >> 31) << 1) | ((lanes.z >> 31) << 2) | ((lanes.w >> 31) << 3);
+#endif
+	}
+}
+
+void FrustumCuller::Reserve(std::uint32_t count)
+{
+	std::size_t padded = (count + 3) & ~3u;
+	mCenterX.reserve(padded);
+	mCenterY.reserve(padded);
+	mCenterZ.reserve(padded);
+	mExtentX.reserve(padded);
+	mExtentY.reserve(padded);
+	mExtentZ.reserve(padded);
+}
+
+void FrustumCuller::Clear()
+{
+	mCount = 0;
+	mCenterX.clear();
+	mCenterY.clear();
+	mCenterZ.clear();
+	mExtentX.clear();
+	mExtentY.clear();
+	mExtentZ.clear();
+}
+
+std::uint32_t FrustumCuller::Add(const BoundingBox& bounds)
+{
+	std::uint32_t index = mCount++;
+	if (index == mCenterX.size())
+	{
+		// Grow by a whole vector of four.
+		std::size_t padded = mCenterX.size() + 4;
+		mCenterX.resize(padded, 0.0f);
+		mCenterY.resize(padded, 0.0f);
+		mCenterZ.resize(padded, 0.0f);
+		mExtentX.resize(padded, 0.0f);
+		mExtentY.resize(padded, 0.0f);
+		mExtentZ.resize(padded, 0.0f);
+	}
+	SetBounds(index, bounds);
+	return index;
+}
+
+void FrustumCuller::Remove(std::uint32_t index)
+{
+	std::uint32_t last = --mCount;
+	mCenterX[index] = mCenterX[last];
+	mCenterY[index] = mCenterY[last];
+	mCenterZ[index] = mCenterZ[last];
+	mExtentX[index] = mExtentX[last];
+	mExtentY[index] = mExtentY[last];
+	mExtentZ[index] = mExtentZ[last];
+
+	// Keep the padding empty.
+	SetBounds(last, BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f)));
+	if (mCount % 4 == 0)
+	{
+		mCenterX.resize(mCount);
+		mCenterY.resize(mCount);
+		mCenterZ.resize(mCount);
+		mExtentX.resize(mCount);
+		mExtentY.resize(mCount);
+		mExtentZ.resize(mCount);
+	}
+}
+
+void FrustumCuller::SetBounds(std::uint32_t index, const BoundingBox& bounds)
+{
+	mCenterX[index] = bounds.Center.x;
+	mCenterY[index] = bounds.Center.y;
+	mCenterZ[index] = bounds.Center.z;
+	mExtentX[index] = bounds.Extents.x;
+	mExtentY[index] = bounds.Extents.y;
+	mExtentZ[index] = bounds.Extents.z;
+}
+
+void FrustumCuller::SetBounds(std::uint32_t index, const BoundingBox& bounds, FXMMATRIX world)
+{
+	BoundingBox worldBounds;
+	bounds.Transform(worldBounds, world);
+	SetBounds(index, worldBounds);
+}
+
+void FrustumCuller::Cull(const float planes[6][4], std::vector<std::uint32_t>& visible, WorkerPool* workers)const
+{
+	visible.clear();
+
+	std::uint32_t rangeCount = workers != nullptr ? workers->ThreadCount() : 1;
+	rangeCount = std::max(1u, std::min(rangeCount, mCount / MinObjectsPerThread));
+
+	if (rangeCount == 1)
+	{
+		CullRange(planes, 0, mCount, visible);
+		return;
+	}
+
+	// Contiguous ranges keep the output in index order once the parts are joined.  The
+	// first range goes straight into visible.
+	const std::uint32_t groupCount = (mCount + 3) / 4;
+	if (mParts.size() < rangeCount)
+		mParts.resize(rangeCount);
+	workers->Run(rangeCount, [&](std::uint32_t i)
+	{
+		std::uint32_t begin = groupCount * i / rangeCount * 4;
+		std::uint32_t end = std::min(mCount, groupCount * (i + 1) / rangeCount * 4);
+		std::vector<std::uint32_t>& part = i == 0 ? visible : mParts[i];
+		part.clear();
+		CullRange(planes, begin, end, part);
+	});
+
+	for (std::uint32_t i = 1; i < rangeCount; ++i)
+		visible.insert(visible.end(), mParts[i].begin(), mParts[i].end());
+}
+
+void FrustumCuller::CullRange(const float planes[6][4], std::uint32_t begin, std::uint32_t end,
+	std::vector<std::uint32_t>& visible)const
+{
+	// A box is outside a plane when its center is further behind it than the box
+	// reaches along the normal: n.c + d < -(|n.x| e.x + |n.y| e.y + |n.z| e.z).
+	XMVECTOR normalX[6], normalY[6], normalZ[6], absX[6], absY[6], absZ[6], distance[6];
+	for (int p = 0; p < 6; ++p)
+	{
+		normalX[p] = XMVectorReplicate(planes[p][0]);
+		normalY[p] = XMVectorReplicate(planes[p][1]);
+		normalZ[p] = XMVectorReplicate(planes[p][2]);
+		absX[p] = XMVectorReplicate(std::fabs(planes[p][0]));
+		absY[p] = XMVectorReplicate(std::fabs(planes[p][1]));
+		absZ[p] = XMVectorReplicate(std::fabs(planes[p][2]));
+		distance[p] = XMVectorReplicate(planes[p][3]);
+	}
+
+	for (std::uint32_t i = begin; i < end; i += 4)
+	{
+		XMVECTOR cx = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterX[i]));
+		XMVECTOR cy = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterY[i]));
+		XMVECTOR cz = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mCenterZ[i]));
+		XMVECTOR ex = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentX[i]));
+		XMVECTOR ey = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentY[i]));
+		XMVECTOR ez = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&mExtentZ[i]));
+
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int p = 0; p < 6; ++p)
+		{
+			XMVECTOR d = XMVectorMultiplyAdd(cz, normalZ[p], XMVectorMultiplyAdd(cy, normalY[p],
+				XMVectorMultiplyAdd(cx, normalX[p], distance[p])));
+			XMVECTOR r = XMVectorMultiplyAdd(ez, absZ[p], XMVectorMultiplyAdd(ey, absY[p], XMVectorMultiply(ex, absX[p])));
+			outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(d, r), XMVectorZero()));
+		}
+
+		std::uint32_t mask = ~LaneMask(outside) & 0xf;
+		if (end - i < 4)
+			mask &= (1u << (end - i)) - 1;
+
+		while (mask != 0)
+		{
+			std::uint32_t lane = 0;
+			while ((mask & (1u << lane)) == 0)
+				++lane;
+			visible.push_back(i + lane);
+			mask &= mask - 1;
+		}
+	}
+}
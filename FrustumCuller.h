@@ -0,0 +1,63 @@
+//***************************************************************************************
+// FrustumCuller.h
+//
+// Frustum culling of many objects at once.  World space bounding boxes are stored as
+// separate arrays of center and extent components, so the plane tests run on four boxes
+// per DirectXMath vector with no gathering, and the indices of the boxes that survive
+// are written out as one compacted list.
+//
+// Objects are addressed by the index Add returns.  Remove moves the last object into the
+// freed index, the way RenderItemStore::Destroy does, so the indices can follow a
+// swap-removed array; RenderItemStore keeps one in step with its items.  Large sets are
+// split into contiguous ranges culled on the threads of a WorkerPool.
+//***************************************************************************************
+
+#pragma once
+
+#include "WorkerPool.h"
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <vector>
+
+class FrustumCuller
+{
+public:
+	void Reserve(std::uint32_t count);
+	void Clear();
+
+	std::uint32_t Add(const DirectX::BoundingBox& bounds);
+	void Remove(std::uint32_t index);
+	void SetBounds(std::uint32_t index, const DirectX::BoundingBox& bounds);
+
+	// bounds in its local space, moved to world space with world.
+	void SetBounds(std::uint32_t index, const DirectX::BoundingBox& bounds, DirectX::FXMMATRIX world);
+
+	std::uint32_t Size()const { return mCount; }
+
+	// Replaces visible with the indices, in increasing order, of the boxes that are not
+	// entirely outside one of the planes (ax + by + cz + d >= 0 inside; see
+	// Meshlets::ExtractFrustumPlanes).  Conservative near the frustum's edges and
+	// corners.  Without workers everything is culled on the calling thread.
+	void Cull(const float planes[6][4], std::vector<std::uint32_t>& visible, WorkerPool* workers = nullptr)const;
+
+	// Ranges smaller than this are not worth a task.
+	static const std::uint32_t MinObjectsPerThread = 16 * 1024;
+
+private:
+	// Culls objects [begin, end), begin a multiple of four.
+	void CullRange(const float planes[6][4], std::uint32_t begin, std::uint32_t end,
+		std::vector<std::uint32_t>& visible)const;
+
+	std::uint32_t mCount = 0;
+
+	// Padded to a multiple of four with empty boxes at the origin.
+	std::vector<float> mCenterX;
+	std::vector<float> mCenterY;
+	std::vector<float> mCenterZ;
+	std::vector<float> mExtentX;
+	std::vector<float> mExtentY;
+	std::vector<float> mExtentZ;
+
+	// Survivors of each range after the first, kept to reuse their memory.
+	mutable std::vector<std::vector<std::uint32_t>> mParts;
+};
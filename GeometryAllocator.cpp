@@ -0,0 +1,159 @@
+#include "GeometryAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+GeometryAllocator::GeometryAllocator(std::uint32_t vertexPoolCount, std::uint32_t vertexCapacity,
+	std::uint32_t indexUnitCapacity, FenceTimeline* timeline) :
+	mTimeline(timeline),
+	mVertexCapacity(vertexCapacity),
+	mVertexPools(vertexPoolCount)
+{
+	mIndexPool.Allocator = std::make_unique<FreeListAllocator>(indexUnitCapacity);
+}
+
+std::uint32_t GeometryAllocator::Add(std::uint32_t vertexPool, std::uint32_t vertexCount, std::uint32_t indexCount,
+	bool index32)
+{
+	assert(vertexCount > 0 && indexCount > 0);
+
+	Pool& pool = mVertexPools[vertexPool];
+	if (!pool.Allocator)
+		pool.Allocator = std::make_unique<FreeListAllocator>(mVertexCapacity);
+
+	std::uint32_t vertexOffset = pool.Allocator->Allocate(vertexCount);
+	if (vertexOffset == FreeListAllocator::InvalidOffset)
+		return InvalidHandle;
+
+	std::uint32_t indexUnitCount = index32 ? indexCount : (indexCount + 1) / 2;
+	std::uint32_t indexUnitOffset = mIndexPool.Allocator->Allocate(indexUnitCount);
+	if (indexUnitOffset == FreeListAllocator::InvalidOffset)
+	{
+		pool.Allocator->Free(vertexOffset, vertexCount);
+		return InvalidHandle;
+	}
+
+	Range range;
+	range.VertexPool = vertexPool;
+	range.VertexOffset = vertexOffset;
+	range.VertexCount = vertexCount;
+	range.IndexUnitOffset = indexUnitOffset;
+	range.IndexUnitCount = indexUnitCount;
+	range.IndexCount = indexCount;
+	range.Index32 = index32;
+	range.Live = true;
+
+	std::uint32_t handle;
+	if (!mFreeHandles.empty())
+	{
+		handle = mFreeHandles.back();
+		mFreeHandles.pop_back();
+		mRanges[handle] = range;
+	}
+	else
+	{
+		handle = (std::uint32_t)mRanges.size();
+		mRanges.push_back(range);
+	}
+
+	return handle;
+}
+
+void GeometryAllocator::FreeDeferred(Pool& pool, std::uint32_t offset, std::uint32_t count)
+{
+	// Frames already submitted, and the one being recorded, may still draw from the
+	// range, so it waits for the fence of the frame Submit is given.  If Defragment runs
+	// in the meantime the range is simply not carried over, so the free is dropped.
+	Pool* target = &pool;
+	std::uint32_t generation = pool.Generation;
+	mPendingReleases.push_back([target, generation, offset, count]()
+	{
+		if (target->Generation == generation)
+			target->Allocator->Free(offset, count);
+	});
+}
+
+void GeometryAllocator::Remove(std::uint32_t handle)
+{
+	if (!IsValid(handle))
+		return;
+
+	Range& range = mRanges[handle];
+	FreeDeferred(mVertexPools[range.VertexPool], range.VertexOffset, range.VertexCount);
+	FreeDeferred(mIndexPool, range.IndexUnitOffset, range.IndexUnitCount);
+
+	range.Live = false;
+	mFreeHandles.push_back(handle);
+}
+
+void GeometryAllocator::DeferRelease(std::function<void()> release)
+{
+	mPendingReleases.push_back(std::move(release));
+}
+
+void GeometryAllocator::Submit(std::uint64_t fenceValue)
+{
+	if (mPendingReleases.empty())
+		return;
+
+	// Other signals (upload batches, flushes) may come between the Remove or Defragment
+	// and the frame's submission, so only the frame's own fence is safe to wait for.
+	mTimeline->OnRetired(fenceValue, [releases = std::move(mPendingReleases)]()
+	{
+		for (const std::function<void()>& release : releases)
+			release();
+	});
+	mPendingReleases.clear();
+}
+
+std::uint32_t GeometryAllocator::StartIndexLocation(std::uint32_t handle)const
+{
+	const Range& range = mRanges[handle];
+	return range.Index32 ? range.IndexUnitOffset : range.IndexUnitOffset * 2;
+}
+
+void GeometryAllocator::DefragmentPool(Pool& pool, std::vector<std::pair<std::uint32_t*, std::uint32_t>>& ranges,
+	std::vector<Move>& moves)
+{
+	pool.Allocator = std::make_unique<FreeListAllocator>(pool.Allocator->Capacity());
+	++pool.Generation;
+
+	// Keep the ranges in their current order.
+	std::sort(ranges.begin(), ranges.end(),
+		[](const std::pair<std::uint32_t*, std::uint32_t>& a, const std::pair<std::uint32_t*, std::uint32_t>& b)
+		{ return *a.first < *b.first; });
+
+	moves.clear();
+	for (auto& range : ranges)
+	{
+		Move move;
+		move.From = *range.first;
+		move.To = pool.Allocator->Allocate(range.second);
+		move.Count = range.second;
+		moves.push_back(move);
+		*range.first = move.To;
+	}
+}
+
+void GeometryAllocator::DefragmentVertices(std::uint32_t vertexPool, std::vector<Move>& moves)
+{
+	assert(HasVertexPool(vertexPool) && "No geometry was added to this vertex pool.");
+
+	std::vector<std::pair<std::uint32_t*, std::uint32_t>> ranges;
+	for (Range& range : mRanges)
+	{
+		if (range.Live && range.VertexPool == vertexPool)
+			ranges.emplace_back(&range.VertexOffset, range.VertexCount);
+	}
+	DefragmentPool(mVertexPools[vertexPool], ranges, moves);
+}
+
+void GeometryAllocator::DefragmentIndices(std::vector<Move>& moves)
+{
+	std::vector<std::pair<std::uint32_t*, std::uint32_t>> ranges;
+	for (Range& range : mRanges)
+	{
+		if (range.Live)
+			ranges.emplace_back(&range.IndexUnitOffset, range.IndexUnitCount);
+	}
+	DefragmentPool(mIndexPool, ranges, moves);
+}
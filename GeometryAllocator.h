@@ -0,0 +1,114 @@
+//***************************************************************************************
+// GeometryAllocator.h
+//
+// The range bookkeeping behind GeometryBuffer: which part of which vertex pool and of
+// the shared index pool every mesh owns, when freed space may be reused and where
+// Defragment moves the live ranges.  It only deals with offsets; GeometryBuffer creates
+// the buffers, queues the uploads and records the copies.
+//
+// Vertex pools are counted in vertices, the index pool in 4-byte units so 32-bit ranges
+// stay aligned; a 16-bit range with an odd index count is padded to a whole unit.
+//***************************************************************************************
+
+#pragma once
+
+#include "FenceTimeline.h"
+#include "FreeListAllocator.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class GeometryAllocator
+{
+public:
+	static const std::uint32_t InvalidHandle = 0xffffffff;
+
+	struct Range
+	{
+		std::uint32_t VertexPool = 0;
+		std::uint32_t VertexOffset = 0;
+		std::uint32_t VertexCount = 0;
+		std::uint32_t IndexUnitOffset = 0;
+		std::uint32_t IndexUnitCount = 0;
+		std::uint32_t IndexCount = 0;
+		bool Index32 = false;
+		bool Live = false;
+	};
+
+	// A copy Defragment needs, in elements of the pool.
+	struct Move
+	{
+		std::uint32_t From = 0;
+		std::uint32_t To = 0;
+		std::uint32_t Count = 0;
+	};
+
+	// vertexCapacity is per vertex pool; a pool's allocator is created on first use.
+	GeometryAllocator(std::uint32_t vertexPoolCount, std::uint32_t vertexCapacity, std::uint32_t indexUnitCapacity,
+		FenceTimeline* timeline);
+	GeometryAllocator(const GeometryAllocator& rhs) = delete;
+	GeometryAllocator& operator=(const GeometryAllocator& rhs) = delete;
+
+	// Returns InvalidHandle if either pool has no room left.
+	std::uint32_t Add(std::uint32_t vertexPool, std::uint32_t vertexCount, std::uint32_t indexCount, bool index32);
+
+	// The space is reused once the GPU is done with the frame passed to the next Submit.
+	void Remove(std::uint32_t handle);
+
+	// Runs release once the GPU is done with the frame passed to the next Submit.
+	void DeferRelease(std::function<void()> release);
+
+	// Tags what Remove, DeferRelease and Defragment released since the last call with the
+	// fence of the frame being submitted.
+	void Submit(std::uint64_t fenceValue);
+
+	bool IsValid(std::uint32_t handle)const { return handle < mRanges.size() && mRanges[handle].Live; }
+	const Range& Get(std::uint32_t handle)const { return mRanges[handle]; }
+
+	// In units of the range's index format.
+	std::uint32_t StartIndexLocation(std::uint32_t handle)const;
+
+	std::uint32_t RangeCount()const { return (std::uint32_t)(mRanges.size() - mFreeHandles.size()); }
+	std::uint32_t VertexPoolCount()const { return (std::uint32_t)mVertexPools.size(); }
+	std::uint32_t VertexCapacity()const { return mVertexCapacity; }
+	bool HasVertexPool(std::uint32_t vertexPool)const { return mVertexPools[vertexPool].Allocator != nullptr; }
+	const FreeListAllocator& VertexAllocator(std::uint32_t vertexPool)const { return *mVertexPools[vertexPool].Allocator; }
+	const FreeListAllocator& IndexAllocator()const { return *mIndexPool.Allocator; }
+	// Releases waiting for the next Submit.
+	std::size_t PendingReleaseCount()const { return mPendingReleases.size(); }
+
+	// Packs the live ranges of a pool to its front, in their current order, and returns
+	// the copies that takes.  Frees still waiting for a fence are dropped, since the
+	// ranges they would free are not carried over.
+	void DefragmentVertices(std::uint32_t vertexPool, std::vector<Move>& moves);
+	void DefragmentIndices(std::vector<Move>& moves);
+
+private:
+	struct Pool
+	{
+		std::unique_ptr<FreeListAllocator> Allocator;
+		// Incremented by Defragment so frees deferred past it are dropped.
+		std::uint32_t Generation = 0;
+	};
+
+	void FreeDeferred(Pool& pool, std::uint32_t offset, std::uint32_t count);
+
+	// Moves the ranges (offset, count) to the front of a fresh allocator for pool and
+	// updates the offsets.
+	void DefragmentPool(Pool& pool, std::vector<std::pair<std::uint32_t*, std::uint32_t>>& ranges,
+		std::vector<Move>& moves);
+
+	FenceTimeline* mTimeline = nullptr;
+	std::uint32_t mVertexCapacity = 0;
+
+	std::vector<Pool> mVertexPools;
+	Pool mIndexPool;
+
+	std::vector<Range> mRanges;
+	std::vector<std::uint32_t> mFreeHandles;
+
+	// Releases waiting for the fence of the next Submit.
+	std::vector<std::function<void()>> mPendingReleases;
+};
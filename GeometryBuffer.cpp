@@ -0,0 +1,212 @@
+#include "GeometryBuffer.h"
+#include <algorithm>
+
+namespace
+{
+	const D3D12_RESOURCE_STATES VertexRestingState = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+	const D3D12_RESOURCE_STATES IndexRestingState = D3D12_RESOURCE_STATE_INDEX_BUFFER;
+}
+
+GeometryBuffer::GeometryBuffer(GpuHeapAllocator* bufferHeap, UploadBatch* uploadBatch, FenceTimeline* timeline,
+	D3D12StateTracker* stateTracker, UINT vertexCapacity, UINT indexByteCapacity) :
+	mBufferHeap(bufferHeap),
+	mUploadBatch(uploadBatch),
+	mStateTracker(stateTracker),
+	mAllocator((std::uint32_t)VertexFormat::Count, vertexCapacity, indexByteCapacity / 4, timeline)
+{
+	mIndexBuffer = CreateBuffer((UINT64)mAllocator.IndexAllocator().Capacity() * 4);
+}
+
+GpuHeapAllocator::Allocation GeometryBuffer::CreateBuffer(UINT64 byteSize)
+{
+	GpuHeapAllocator::Allocation buffer = mBufferHeap->CreateBuffer(byteSize);
+	mStateTracker->Register(buffer.Resource.Get(), D3D12_RESOURCE_STATE_COMMON);
+	return buffer;
+}
+
+GeometryHandle GeometryBuffer::Add(VertexFormat format, const void* vertices, UINT vertexCount,
+	const std::uint32_t* indices, UINT indexCount)
+{
+	std::uint32_t maxIndex = 0;
+	for (UINT i = 0; i < indexCount; ++i)
+		maxIndex = std::max(maxIndex, indices[i]);
+
+	const bool narrow = maxIndex <= 0xffff;
+	GeometryHandle handle = AddRange(format, vertices, vertexCount, indexCount, !narrow);
+	if (handle == InvalidHandle)
+		return InvalidHandle;
+
+	if (!narrow)
+	{
+		UploadIndices(handle, indices);
+		return handle;
+	}
+
+	std::vector<std::uint8_t> indexData(indexCount * sizeof(std::uint16_t));
+	std::uint16_t* narrowed = reinterpret_cast<std::uint16_t*>(indexData.data());
+	for (UINT i = 0; i < indexCount; ++i)
+		narrowed[i] = (std::uint16_t)indices[i];
+	UploadIndices(handle, std::move(indexData));
+	return handle;
+}
+
+GeometryHandle GeometryBuffer::Add(VertexFormat format, const void* vertices, UINT vertexCount,
+	const std::uint16_t* indices, UINT indexCount)
+{
+	GeometryHandle handle = AddRange(format, vertices, vertexCount, indexCount, false);
+	if (handle != InvalidHandle)
+		UploadIndices(handle, indices);
+	return handle;
+}
+
+GeometryHandle GeometryBuffer::AddRange(VertexFormat format, const void* vertices, UINT vertexCount, UINT indexCount,
+	bool index32)
+{
+	const UINT stride = GetVertexStride(format);
+	GpuHeapAllocator::Allocation& vertexBuffer = mVertexBuffers[(size_t)format];
+	if (!vertexBuffer.Resource)
+		vertexBuffer = CreateBuffer((UINT64)stride * mAllocator.VertexCapacity());
+
+	GeometryHandle handle = mAllocator.Add((std::uint32_t)format, vertexCount, indexCount, index32);
+	if (handle == InvalidHandle)
+		return InvalidHandle;
+
+	// The upload list records the transitions; the tracker only follows them.
+	ID3D12Resource* resource = vertexBuffer.Resource.Get();
+	mUploadBatch->Enqueue(resource, vertices, (UINT64)vertexCount * stride,
+		(UINT64)mAllocator.Get(handle).VertexOffset * stride, mStateTracker->GetState(resource), VertexRestingState);
+	mStateTracker->SetState(resource, VertexRestingState);
+	return handle;
+}
+
+void GeometryBuffer::UploadIndices(GeometryHandle handle, const void* indices)
+{
+	const GeometryAllocator::Range& range = mAllocator.Get(handle);
+	ID3D12Resource* resource = mIndexBuffer.Resource.Get();
+	mUploadBatch->Enqueue(resource, indices, (UINT64)range.IndexCount * (range.Index32 ? 4 : 2),
+		(UINT64)range.IndexUnitOffset * 4, mStateTracker->GetState(resource), IndexRestingState);
+	mStateTracker->SetState(resource, IndexRestingState);
+}
+
+void GeometryBuffer::UploadIndices(GeometryHandle handle, std::vector<std::uint8_t> indices)
+{
+	const GeometryAllocator::Range& range = mAllocator.Get(handle);
+	ID3D12Resource* resource = mIndexBuffer.Resource.Get();
+	mUploadBatch->EnqueueOwned(resource, std::move(indices), (UINT64)range.IndexUnitOffset * 4,
+		mStateTracker->GetState(resource), IndexRestingState);
+	mStateTracker->SetState(resource, IndexRestingState);
+}
+
+void GeometryBuffer::Remove(GeometryHandle handle)
+{
+	mAllocator.Remove(handle);
+}
+
+void GeometryBuffer::Submit(UINT64 fenceValue)
+{
+	mAllocator.Submit(fenceValue);
+}
+
+D3D12_DRAW_INDEXED_ARGUMENTS GeometryBuffer::DrawArguments(GeometryHandle handle, UINT instanceCount,
+	UINT startInstanceLocation)const
+{
+	D3D12_DRAW_INDEXED_ARGUMENTS arguments;
+	arguments.IndexCountPerInstance = IndexCount(handle);
+	arguments.InstanceCount = instanceCount;
+	arguments.StartIndexLocation = StartIndexLocation(handle);
+	arguments.BaseVertexLocation = BaseVertexLocation(handle);
+	arguments.StartInstanceLocation = startInstanceLocation;
+	return arguments;
+}
+
+D3D12_VERTEX_BUFFER_VIEW GeometryBuffer::VertexBufferView(VertexFormat format)const
+{
+	assert(mAllocator.HasVertexPool((std::uint32_t)format) && "No geometry of this vertex format was added.");
+
+	const UINT stride = GetVertexStride(format);
+	D3D12_VERTEX_BUFFER_VIEW vbv;
+	vbv.BufferLocation = mVertexBuffers[(size_t)format].Resource->GetGPUVirtualAddress();
+	vbv.StrideInBytes = stride;
+	vbv.SizeInBytes = stride * mAllocator.VertexAllocator((std::uint32_t)format).Capacity();
+	return vbv;
+}
+
+D3D12_INDEX_BUFFER_VIEW GeometryBuffer::IndexBufferView(DXGI_FORMAT indexFormat)const
+{
+	assert(indexFormat == DXGI_FORMAT_R16_UINT || indexFormat == DXGI_FORMAT_R32_UINT);
+
+	D3D12_INDEX_BUFFER_VIEW ibv;
+	ibv.BufferLocation = mIndexBuffer.Resource->GetGPUVirtualAddress();
+	ibv.Format = indexFormat;
+	ibv.SizeInBytes = mAllocator.IndexAllocator().Capacity() * 4;
+	return ibv;
+}
+
+void GeometryBuffer::CopyToNewBuffer(ID3D12GraphicsCommandList* cmdList, GpuHeapAllocator::Allocation& buffer,
+	UINT elementSize, UINT capacity, D3D12_RESOURCE_STATES restingState,
+	const std::vector<GeometryAllocator::Move>& moves)
+{
+	GpuHeapAllocator::Allocation old = buffer;
+	buffer = CreateBuffer((UINT64)elementSize * capacity);
+
+	mStateTracker->Transition(old.Resource.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE);
+	mStateTracker->Transition(buffer.Resource.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+	mStateTracker->FlushBarriers(cmdList);
+	// Nothing records another barrier for the old buffer.
+	mStateTracker->Unregister(old.Resource.Get());
+
+	for (const GeometryAllocator::Move& move : moves)
+	{
+		cmdList->CopyBufferRegion(buffer.Resource.Get(), (UINT64)move.To * elementSize,
+			old.Resource.Get(), (UINT64)move.From * elementSize, (UINT64)move.Count * elementSize);
+	}
+
+	mStateTracker->Transition(buffer.Resource.Get(), restingState);
+	mStateTracker->FlushBarriers(cmdList);
+
+	// The old buffer goes once the frame that runs the copies is done.
+	GpuHeapAllocator* bufferHeap = mBufferHeap;
+	mAllocator.DeferRelease([bufferHeap, old]() mutable { bufferHeap->Free(old); });
+}
+
+void GeometryBuffer::Defragment(ID3D12GraphicsCommandList* cmdList)
+{
+	std::vector<GeometryAllocator::Move> moves;
+
+	for (std::uint32_t f = 0; f < (std::uint32_t)VertexFormat::Count; ++f)
+	{
+		if (!mAllocator.HasVertexPool(f))
+			continue;
+
+		mAllocator.DefragmentVertices(f, moves);
+		CopyToNewBuffer(cmdList, mVertexBuffers[f], GetVertexStride((VertexFormat)f),
+			mAllocator.VertexAllocator(f).Capacity(), VertexRestingState, moves);
+	}
+
+	mAllocator.DefragmentIndices(moves);
+	CopyToNewBuffer(cmdList, mIndexBuffer, 4, mAllocator.IndexAllocator().Capacity(), IndexRestingState, moves);
+}
+
+GeometryBuffer::Stats GeometryBuffer::GetStats()const
+{
+	Stats stats;
+	stats.RangeCount = mAllocator.RangeCount();
+
+	for (std::uint32_t f = 0; f < (std::uint32_t)VertexFormat::Count; ++f)
+	{
+		if (!mAllocator.HasVertexPool(f))
+			continue;
+
+		const FreeListAllocator& allocator = mAllocator.VertexAllocator(f);
+		const UINT stride = GetVertexStride((VertexFormat)f);
+		stats.VertexBytes += (UINT64)allocator.Capacity() * stride;
+		stats.VertexBytesUsed += (UINT64)allocator.UsedCount() * stride;
+		stats.FreeRangeCount += allocator.FreeRangeCount();
+	}
+
+	const FreeListAllocator& indexAllocator = mAllocator.IndexAllocator();
+	stats.IndexBytes = (UINT64)indexAllocator.Capacity() * 4;
+	stats.IndexBytesUsed = (UINT64)indexAllocator.UsedCount() * 4;
+	stats.FreeRangeCount += indexAllocator.FreeRangeCount();
+	return stats;
+}
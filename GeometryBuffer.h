@@ -0,0 +1,121 @@
+//***************************************************************************************
+// GeometryBuffer.h
+//
+// Shared vertex and index buffers that many meshes are sub-allocated from, so draws
+// only differ in BaseVertexLocation and StartIndexLocation and can be batched or issued
+// through ExecuteIndirect without rebinding buffers.
+//
+// There is one vertex buffer per VertexFormat, created on first use, and one index
+// buffer for everything.  Each mesh's indices are stored 16-bit when all of them fit,
+// 32-bit otherwise; the index buffer has an R16 and an R32 view over the same memory,
+// and StartIndexLocation is given in units of the range's index format.
+//
+// Which range every mesh owns is tracked by GeometryAllocator, which has no D3D in it.
+// Defragment packs the live ranges to the front of fresh buffers with GPU copies;
+// handles stay valid across it.
+//
+// The buffers are registered with the D3D12StateTracker, which knows their state across
+// uploads and defragmentation and records Defragment's barriers.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "D3D12StateTracker.h"
+#include "FenceTimeline.h"
+#include "GeometryAllocator.h"
+#include "GpuHeapAllocator.h"
+#include "UploadBatch.h"
+#include "VertexFormats.h"
+#include <vector>
+
+typedef std::uint32_t GeometryHandle;
+
+class GeometryBuffer
+{
+public:
+	static const GeometryHandle InvalidHandle = 0xffffffff;
+
+	struct Stats
+	{
+		UINT RangeCount = 0;
+		UINT64 VertexBytes = 0;
+		UINT64 VertexBytesUsed = 0;
+		UINT64 IndexBytes = 0;
+		UINT64 IndexBytesUsed = 0;
+		// Free ranges over all the buffers; Defragment brings it back to one per buffer.
+		UINT FreeRangeCount = 0;
+	};
+
+	// vertexCapacity is per vertex format, indexByteCapacity for the shared index buffer.
+	GeometryBuffer(GpuHeapAllocator* bufferHeap, UploadBatch* uploadBatch, FenceTimeline* timeline,
+		D3D12StateTracker* stateTracker, UINT vertexCapacity, UINT indexByteCapacity);
+	GeometryBuffer(const GeometryBuffer& rhs) = delete;
+	GeometryBuffer& operator=(const GeometryBuffer& rhs) = delete;
+
+	// Sub-allocates a mesh and queues its upload on the UploadBatch.  vertices and indices
+	// must stay valid until the batch is submitted; only 32-bit indices that are narrowed
+	// to 16 bits are copied.  Returns InvalidHandle if either buffer has no room left.
+	GeometryHandle Add(VertexFormat format, const void* vertices, UINT vertexCount,
+		const std::uint32_t* indices, UINT indexCount);
+	GeometryHandle Add(VertexFormat format, const void* vertices, UINT vertexCount,
+		const std::uint16_t* indices, UINT indexCount);
+
+	// The space is reused once the GPU is done with the frame passed to the next Submit.
+	void Remove(GeometryHandle handle);
+
+	bool IsValid(GeometryHandle handle)const { return mAllocator.IsValid(handle); }
+
+	VertexFormat Format(GeometryHandle handle)const { return (VertexFormat)mAllocator.Get(handle).VertexPool; }
+	DXGI_FORMAT IndexFormat(GeometryHandle handle)const
+	{
+		return mAllocator.Get(handle).Index32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+	}
+	UINT IndexCount(GeometryHandle handle)const { return mAllocator.Get(handle).IndexCount; }
+	UINT StartIndexLocation(GeometryHandle handle)const { return mAllocator.StartIndexLocation(handle); }
+	INT BaseVertexLocation(GeometryHandle handle)const { return (INT)mAllocator.Get(handle).VertexOffset; }
+
+	// Arguments for DrawIndexedInstanced or an ExecuteIndirect argument buffer.
+	D3D12_DRAW_INDEXED_ARGUMENTS DrawArguments(GeometryHandle handle, UINT instanceCount = 1,
+		UINT startInstanceLocation = 0)const;
+
+	// Valid until the next Defragment.
+	D3D12_VERTEX_BUFFER_VIEW VertexBufferView(VertexFormat format)const;
+	D3D12_INDEX_BUFFER_VIEW IndexBufferView(DXGI_FORMAT indexFormat)const;
+
+	// Moves every live range to the front of new buffers.  The copies are recorded on
+	// cmdList, which must be executed in the frame passed to the next Submit; submit the
+	// UploadBatch first so no upload targets the old buffers.
+	void Defragment(ID3D12GraphicsCommandList* cmdList);
+
+	// Tags what Remove and Defragment released since the last call with the fence of the
+	// frame being submitted; it is reused once that fence completes.
+	void Submit(UINT64 fenceValue);
+
+	Stats GetStats()const;
+
+private:
+	// Allocates the range, creating the vertex buffer on first use, and queues the
+	// vertex upload.
+	GeometryHandle AddRange(VertexFormat format, const void* vertices, UINT vertexCount, UINT indexCount, bool index32);
+	// Queues the upload of the range's indices, read when the batch is submitted.
+	void UploadIndices(GeometryHandle handle, const void* indices);
+	// Same, for indices built just for the upload.
+	void UploadIndices(GeometryHandle handle, std::vector<std::uint8_t> indices);
+
+	GpuHeapAllocator::Allocation CreateBuffer(UINT64 byteSize);
+
+	// Moves buffer's contents to a new buffer as moves say, in elements of elementSize.
+	void CopyToNewBuffer(ID3D12GraphicsCommandList* cmdList, GpuHeapAllocator::Allocation& buffer, UINT elementSize,
+		UINT capacity, D3D12_RESOURCE_STATES restingState, const std::vector<GeometryAllocator::Move>& moves);
+
+	GpuHeapAllocator* mBufferHeap = nullptr;
+	UploadBatch* mUploadBatch = nullptr;
+	D3D12StateTracker* mStateTracker = nullptr;
+
+	// Which range of which buffer every mesh owns; the buffers below only hold the data.
+	GeometryAllocator mAllocator;
+
+	GpuHeapAllocator::Allocation mVertexBuffers[(size_t)VertexFormat::Count];
+	GpuHeapAllocator::Allocation mIndexBuffer;
+};
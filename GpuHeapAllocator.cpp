@@ -0,0 +1,155 @@
+#include "GpuHeapAllocator.h"
+
+float GpuHeapAllocator::Stats::Occupancy()const
+{
+	return HeapBytes == 0 ? 0.0f : (float)AllocatedBytes / (float)HeapBytes;
+}
+
+GpuHeapAllocator::GpuHeapAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags,
+	UINT64 blockByteSize, UINT64 heapAlignment) :
+	mDevice(device),
+	mHeapType(heapType),
+	mHeapFlags(heapFlags),
+	mBlockByteSize(BuddyAllocator::NextPowerOfTwo(blockByteSize)),
+	mHeapAlignment(heapAlignment)
+{
+}
+
+UINT GpuHeapAllocator::CreateHeapBlock(UINT64 byteSize, bool dedicated)
+{
+	HeapBlock block;
+	block.Dedicated = dedicated;
+	if (dedicated)
+	{
+		block.ByteSize = (byteSize + mHeapAlignment - 1) & ~(mHeapAlignment - 1);
+		block.RequestedBytes = byteSize;
+	}
+	else
+	{
+		block.Allocator = std::make_unique<BuddyAllocator>(byteSize, mHeapAlignment);
+		block.ByteSize = block.Allocator->Capacity();
+	}
+
+	CD3DX12_HEAP_DESC heapDesc(block.ByteSize, mHeapType, mHeapAlignment, mHeapFlags);
+	ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(block.Heap.GetAddressOf())));
+
+	// Reuse the slot of a released dedicated heap if there is one.
+	for (UINT i = 0; i < (UINT)mBlocks.size(); ++i)
+	{
+		if (mBlocks[i].Heap == nullptr)
+		{
+			mBlocks[i] = std::move(block);
+			return i;
+		}
+	}
+
+	mBlocks.push_back(std::move(block));
+	return (UINT)mBlocks.size() - 1;
+}
+
+GpuHeapAllocator::Allocation GpuHeapAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc,
+	D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* optimizedClearValue)
+{
+	D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+	UINT64 alignment = std::max<UINT64>(info.Alignment, mHeapAlignment);
+
+	Allocation allocation;
+	for (UINT i = 0; i < (UINT)mBlocks.size() && !allocation.IsValid(); ++i)
+	{
+		HeapBlock& block = mBlocks[i];
+		if (block.Heap == nullptr || block.Dedicated)
+			continue;
+
+		UINT64 offset = block.Allocator->Allocate(info.SizeInBytes, alignment);
+		if (offset != BuddyAllocator::InvalidOffset)
+		{
+			allocation.HeapIndex = i;
+			allocation.Offset = offset;
+		}
+	}
+
+	if (!allocation.IsValid())
+	{
+		// Anything that does not fit in a regular block gets a heap of its own, sized to
+		// the resource.  The heap itself is aligned to alignment, so offset 0 is too.
+		bool dedicated = std::max(info.SizeInBytes, alignment) > mBlockByteSize;
+		if (dedicated)
+		{
+			allocation.HeapIndex = CreateHeapBlock(info.SizeInBytes, true);
+			allocation.Offset = 0;
+		}
+		else
+		{
+			allocation.HeapIndex = CreateHeapBlock(mBlockByteSize, false);
+			allocation.Offset = mBlocks[allocation.HeapIndex].Allocator->Allocate(info.SizeInBytes, alignment);
+			if (allocation.Offset == BuddyAllocator::InvalidOffset)
+				ThrowIfFailed(E_OUTOFMEMORY);
+		}
+	}
+
+	HRESULT hr = mDevice->CreatePlacedResource(
+		mBlocks[allocation.HeapIndex].Heap.Get(),
+		allocation.Offset,
+		&desc,
+		initialState,
+		optimizedClearValue,
+		IID_PPV_ARGS(allocation.Resource.GetAddressOf()));
+	if (FAILED(hr))
+	{
+		Free(allocation);
+		ThrowIfFailed(hr);
+	}
+
+	return allocation;
+}
+
+GpuHeapAllocator::Allocation GpuHeapAllocator::CreateBuffer(UINT64 byteSize, D3D12_RESOURCE_STATES initialState)
+{
+	auto buffer = CD3DX12_RESOURCE_DESC::Buffer(byteSize);
+	return CreateResource(buffer, initialState);
+}
+
+void GpuHeapAllocator::Free(Allocation& allocation)
+{
+	if (!allocation.IsValid())
+		return;
+
+	allocation.Resource = nullptr;
+
+	// Dedicated heaps only ever hold one resource.
+	HeapBlock& block = mBlocks[allocation.HeapIndex];
+	if (block.Dedicated)
+		block = HeapBlock();
+	else
+		block.Allocator->Free(allocation.Offset);
+
+	allocation.HeapIndex = UINT_MAX;
+	allocation.Offset = 0;
+}
+
+GpuHeapAllocator::Stats GpuHeapAllocator::GetStats()const
+{
+	Stats stats;
+	for (const HeapBlock& block : mBlocks)
+	{
+		if (block.Heap == nullptr)
+			continue;
+
+		stats.HeapCount++;
+		stats.HeapBytes += block.ByteSize;
+		if (block.Dedicated)
+		{
+			stats.AllocatedBytes += block.ByteSize;
+			stats.RequestedBytes += block.RequestedBytes;
+			stats.AllocationCount++;
+			continue;
+		}
+
+		BuddyAllocator::Stats blockStats = block.Allocator->GetStats();
+		stats.AllocatedBytes += blockStats.AllocatedBytes;
+		stats.RequestedBytes += blockStats.RequestedBytes;
+		stats.AllocationCount += blockStats.AllocationCount;
+		stats.MaxExternalFragmentation = std::max(stats.MaxExternalFragmentation, blockStats.ExternalFragmentation());
+	}
+	return stats;
+}
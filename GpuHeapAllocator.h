@@ -0,0 +1,84 @@
+//***************************************************************************************
+// GpuHeapAllocator.h
+//
+// Places resources inside large ID3D12Heap blocks instead of giving each one its own
+// committed resource (and implicit heap).  Each block is managed by a BuddyAllocator.
+// Resources larger than a block get a dedicated heap of exactly their own size, with no
+// buddy rounding.
+//
+// One allocator serves one heap type/flag combination; on resource heap tier 1
+// hardware buffers, RT/DS textures and other textures must live in separate heaps, so
+// create one allocator per category.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "BuddyAllocator.h"
+
+class GpuHeapAllocator
+{
+public:
+	struct Allocation
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		UINT HeapIndex = UINT_MAX;
+		UINT64 Offset = 0;
+
+		bool IsValid()const { return HeapIndex != UINT_MAX; }
+	};
+
+	struct Stats
+	{
+		UINT HeapCount = 0;
+		UINT64 HeapBytes = 0;
+		UINT64 AllocatedBytes = 0;
+		UINT64 RequestedBytes = 0;
+		UINT AllocationCount = 0;
+		// Worst external fragmentation over all the heaps.
+		float MaxExternalFragmentation = 0.0f;
+
+		// AllocatedBytes / HeapBytes.
+		float Occupancy()const;
+	};
+
+	GpuHeapAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags,
+		UINT64 blockByteSize = 64 * 1024 * 1024,
+		UINT64 heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	GpuHeapAllocator(const GpuHeapAllocator& rhs) = delete;
+	GpuHeapAllocator& operator=(const GpuHeapAllocator& rhs) = delete;
+
+	// Creates a placed resource.  Size and alignment come from GetResourceAllocationInfo.
+	Allocation CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr);
+
+	Allocation CreateBuffer(UINT64 byteSize, D3D12_RESOURCE_STATES initialState = D3D12_RESOURCE_STATE_COMMON);
+
+	// Releases the resource and returns its memory.  The GPU must be done with it.
+	void Free(Allocation& allocation);
+
+	Stats GetStats()const;
+
+private:
+	struct HeapBlock
+	{
+		Microsoft::WRL::ComPtr<ID3D12Heap> Heap;
+		// Null for dedicated heaps, which hold one resource at offset 0.
+		std::unique_ptr<BuddyAllocator> Allocator;
+		bool Dedicated = false;
+		UINT64 ByteSize = 0;
+		// Size the resource of a dedicated heap asked for.
+		UINT64 RequestedBytes = 0;
+	};
+
+	UINT CreateHeapBlock(UINT64 byteSize, bool dedicated);
+
+	ID3D12Device* mDevice = nullptr;
+	D3D12_HEAP_TYPE mHeapType = D3D12_HEAP_TYPE_DEFAULT;
+	D3D12_HEAP_FLAGS mHeapFlags = D3D12_HEAP_FLAG_NONE;
+	UINT64 mBlockByteSize = 0;
+	UINT64 mHeapAlignment = 0;
+
+	// Freed dedicated blocks leave a null Heap behind so indices stay stable.
+	std::vector<HeapBlock> mBlocks;
+};
@@ -0,0 +1,72 @@
+#include "InstanceBatcher.h"
+
+using namespace DirectX;
+
+std::size_t InstanceBatcher::KeyHash::operator()(const Key& key)const
+{
+	std::uint64_t h = key.Pipeline;
+	h = h * 0x9e3779b97f4a7c15ull + key.Geometry;
+	h = h * 0x9e3779b97f4a7c15ull + key.Submesh;
+	return (std::size_t)(h ^ (h >> 32));
+}
+
+void InstanceBatcher::Build(const std::uint32_t* visible, const std::uint32_t* submeshes, std::uint32_t count,
+	const std::uint32_t* pipelines, const std::uint32_t* geometries)
+{
+	// The map keeps its buckets from frame to frame.
+	mBatchOfKey.clear();
+	mBatches.clear();
+	mBatchOfItem.resize(count);
+
+	// Batch ids in order of first appearance, counting the instances of each.
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		const std::uint32_t index = visible[i];
+		Key key = { pipelines[index], geometries[index], submeshes[i] };
+
+		auto inserted = mBatchOfKey.emplace(key, (std::uint32_t)mBatches.size());
+		if (inserted.second)
+		{
+			InstanceBatch batch;
+			batch.Pipeline = key.Pipeline;
+			batch.Geometry = key.Geometry;
+			batch.Submesh = key.Submesh;
+			mBatches.push_back(batch);
+		}
+
+		const std::uint32_t batch = inserted.first->second;
+		mBatchOfItem[i] = batch;
+		++mBatches[batch].InstanceCount;
+	}
+
+	// Ranges from the counts, then scatter the items into them.
+	mCursors.resize(mBatches.size());
+	std::uint32_t first = 0;
+	for (std::size_t b = 0; b < mBatches.size(); ++b)
+	{
+		mBatches[b].FirstInstance = first;
+		mCursors[b] = first;
+		first += mBatches[b].InstanceCount;
+	}
+
+	mOrder.resize(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+		mOrder[mCursors[mBatchOfItem[i]]++] = visible[i];
+
+	mStats.Items = count;
+	mStats.Draws = (std::uint32_t)mBatches.size();
+}
+
+void InstanceBatcher::WriteInstances(InstanceData* dst, const XMFLOAT4X4* worlds, const std::uint32_t* materials)const
+{
+	// dst is usually write-combined upload memory, so every field is written once, in
+	// order, and never read back.
+	for (std::size_t i = 0; i < mOrder.size(); ++i)
+	{
+		const std::uint32_t index = mOrder[i];
+		InstanceData instance;
+		instance.World = worlds[index];
+		instance.Material = materials[index];
+		dst[i] = instance;
+	}
+}
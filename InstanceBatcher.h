@@ -0,0 +1,98 @@
+//***************************************************************************************
+// InstanceBatcher.h
+//
+// Automatic instancing.  Visible items that draw the same submesh of the same geometry
+// with the same pipeline state are merged into one batch, and their per-instance data
+// is packed so that each batch is a contiguous run of InstanceData.  A batch is then a
+// single DrawIndexedInstanced whose StartInstanceLocation is the batch's first
+// instance; the shaders read InstanceData as a per-instance vertex stream.
+//
+// Grouping is a counting sort: every item gets the id of its batch from a hash map,
+// batches get their ranges from the counts, and the items are scattered into them.
+// Batches come out in the order their first item was visible, and items keep their
+// visible order inside a batch.  Nothing here touches D3D, so the batches and the
+// packed data can be checked on the CPU.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// One instance in the per-instance vertex stream (see GetInstanceInputLayout).
+struct InstanceData
+{
+	DirectX::XMFLOAT4X4 World;
+	std::uint32_t Material = 0;
+	std::uint32_t Pad[3] = { 0, 0, 0 };
+};
+
+struct InstanceBatch
+{
+	std::uint32_t Pipeline = 0;
+	std::uint32_t Geometry = 0;
+	std::uint32_t Submesh = 0;
+	std::uint32_t FirstInstance = 0;
+	std::uint32_t InstanceCount = 0;
+};
+
+struct InstancingStats
+{
+	std::uint32_t Items = 0;
+	std::uint32_t Draws = 0;
+
+	// Draw calls instancing saved this frame.
+	std::uint32_t SavedDraws()const { return Items - Draws; }
+};
+
+class InstanceBatcher
+{
+public:
+	// Groups the items at positions visible[0..count).  submeshes[i] is the submesh that
+	// visible[i] draws this frame (its LOD); pipelines and geometries are indexed by item
+	// position.
+	void Build(const std::uint32_t* visible, const std::uint32_t* submeshes, std::uint32_t count,
+		const std::uint32_t* pipelines, const std::uint32_t* geometries);
+
+	// Writes the InstanceData of every batched item to dst, batch after batch.  dst must
+	// hold InstanceCount() entries; worlds and materials are indexed by item position.
+	void WriteInstances(InstanceData* dst, const DirectX::XMFLOAT4X4* worlds, const std::uint32_t* materials)const;
+
+	const std::vector<InstanceBatch>& Batches()const { return mBatches; }
+	std::uint32_t InstanceCount()const { return (std::uint32_t)mOrder.size(); }
+
+	// The item position of instance i.
+	std::uint32_t ItemOf(std::uint32_t instance)const { return mOrder[instance]; }
+
+	const InstancingStats& Stats()const { return mStats; }
+
+private:
+	struct Key
+	{
+		std::uint32_t Pipeline;
+		std::uint32_t Geometry;
+		std::uint32_t Submesh;
+
+		bool operator==(const Key& rhs)const
+		{
+			return Pipeline == rhs.Pipeline && Geometry == rhs.Geometry && Submesh == rhs.Submesh;
+		}
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key)const;
+	};
+
+	std::unordered_map<Key, std::uint32_t, KeyHash> mBatchOfKey;
+	// Batch of each visible entry, then the next free instance of each batch.
+	std::vector<std::uint32_t> mBatchOfItem;
+	std::vector<std::uint32_t> mCursors;
+
+	std::vector<InstanceBatch> mBatches;
+	std::vector<std::uint32_t> mOrder;
+	InstancingStats mStats;
+};
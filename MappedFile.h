@@ -0,0 +1,39 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// Read-only memory mapping of a whole file.  The contents stay mapped (and the pointers
+// into them valid) for the lifetime of the object.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+
+	// Maps path; returns false (and stays closed) if the file cannot be opened or mapped.
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen()const { return mData != nullptr; }
+	const unsigned char* Data()const { return mData; }
+	std::size_t Size()const { return mSize; }
+
+private:
+	const unsigned char* mData = nullptr;
+	std::size_t mSize = 0;
+
+#ifdef _WIN32
+	void* mFile = nullptr;
+	void* mMapping = nullptr;
+#else
+	int mFile = -1;
+#endif
+};
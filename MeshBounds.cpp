@@ -0,0 +1,267 @@
+#include "MeshBounds.h"
+#include "SubmeshTable.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Fewer indices than this in all are not worth waking the workers for.
+	const std::size_t MinParallelIndexCount = 64 * 1024;
+
+	// Eigenvectors of the symmetric matrix a, by cyclic Jacobi rotations, as the rows of
+	// axes.  a is destroyed.
+	void SymmetricEigenvectors(float a[3][3], float axes[3][3])
+	{
+		float v[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		const int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+
+		for (int sweep = 0; sweep < 16; ++sweep)
+		{
+			float diagonal = std::fabs(a[0][0]) + std::fabs(a[1][1]) + std::fabs(a[2][2]);
+			float offDiagonal = std::fabs(a[0][1]) + std::fabs(a[0][2]) + std::fabs(a[1][2]);
+			if (offDiagonal <= 1e-6f * diagonal)
+				break;
+
+			for (const int* pair : pairs)
+			{
+				const int p = pair[0];
+				const int q = pair[1];
+				if (a[p][q] == 0.0f)
+					continue;
+
+				// The rotation in the (p, q) plane that zeroes a[p][q].
+				float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+				float t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0f));
+				float c = 1.0f / std::sqrt(t * t + 1.0f);
+				float s = t * c;
+
+				for (int k = 0; k < 3; ++k)
+				{
+					float kp = a[k][p];
+					float kq = a[k][q];
+					a[k][p] = c * kp - s * kq;
+					a[k][q] = s * kp + c * kq;
+				}
+				for (int k = 0; k < 3; ++k)
+				{
+					float pk = a[p][k];
+					float qk = a[q][k];
+					a[p][k] = c * pk - s * qk;
+					a[q][k] = s * pk + c * qk;
+				}
+				for (int k = 0; k < 3; ++k)
+				{
+					float kp = v[k][p];
+					float kq = v[k][q];
+					v[k][p] = c * kp - s * kq;
+					v[k][q] = s * kp + c * kq;
+				}
+			}
+		}
+
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int k = 0; k < 3; ++k)
+				axes[i][k] = v[k][i];
+		}
+	}
+
+	// load(i) returns point i with w = 0.
+	template<typename LoadPoint>
+	MeshBounds Compute(LoadPoint load, std::size_t count)
+	{
+		MeshBounds bounds;
+		if (count == 0)
+			return bounds;
+
+		// The moments are taken relative to the first point, which keeps the float sums
+		// small for meshes far from the origin.
+		const XMVECTOR origin = load(0);
+
+		XMVECTOR vMin = origin;
+		XMVECTOR vMax = origin;
+		XMVECTOR minPoints[3] = { origin, origin, origin };
+		XMVECTOR maxPoints[3] = { origin, origin, origin };
+		XMVECTOR sum = XMVectorZero();
+		XMVECTOR sumSquares = XMVectorZero();	// xx, yy, zz
+		XMVECTOR sumProducts = XMVectorZero();	// xy, yz, zx
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			XMVECTOR p = load(i);
+
+			XMVECTOR less = XMVectorLess(p, vMin);
+			XMVECTOR greater = XMVectorGreater(p, vMax);
+			minPoints[0] = XMVectorSelect(minPoints[0], p, XMVectorSplatX(less));
+			minPoints[1] = XMVectorSelect(minPoints[1], p, XMVectorSplatY(less));
+			minPoints[2] = XMVectorSelect(minPoints[2], p, XMVectorSplatZ(less));
+			maxPoints[0] = XMVectorSelect(maxPoints[0], p, XMVectorSplatX(greater));
+			maxPoints[1] = XMVectorSelect(maxPoints[1], p, XMVectorSplatY(greater));
+			maxPoints[2] = XMVectorSelect(maxPoints[2], p, XMVectorSplatZ(greater));
+			vMin = XMVectorMin(vMin, p);
+			vMax = XMVectorMax(vMax, p);
+
+			XMVECTOR d = XMVectorSubtract(p, origin);
+			sum = XMVectorAdd(sum, d);
+			sumSquares = XMVectorMultiplyAdd(d, d, sumSquares);
+			sumProducts = XMVectorMultiplyAdd(d, XMVectorSwizzle<1, 2, 0, 3>(d), sumProducts);
+		}
+
+		BoundingBox::CreateFromPoints(bounds.Box, vMin, vMax);
+
+		// Ritter's initial sphere spans the pair of extremes that are farthest apart.
+		int widest = 0;
+		float widestSq = -1.0f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float distanceSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(maxPoints[axis], minPoints[axis])));
+			if (distanceSq > widestSq)
+			{
+				widestSq = distanceSq;
+				widest = axis;
+			}
+		}
+		XMVECTOR center = XMVectorScale(XMVectorAdd(minPoints[widest], maxPoints[widest]), 0.5f);
+		float radius = std::sqrt(widestSq) * 0.5f;
+		float radiusSq = radius * radius;
+
+		// Covariance from the moments, then its eigenvectors as the box axes.
+		const float invCount = 1.0f / (float)count;
+		XMFLOAT3 mean, squares, products;
+		XMStoreFloat3(&mean, XMVectorScale(sum, invCount));
+		XMStoreFloat3(&squares, XMVectorScale(sumSquares, invCount));
+		XMStoreFloat3(&products, XMVectorScale(sumProducts, invCount));
+
+		float covariance[3][3];
+		covariance[0][0] = squares.x - mean.x * mean.x;
+		covariance[1][1] = squares.y - mean.y * mean.y;
+		covariance[2][2] = squares.z - mean.z * mean.z;
+		covariance[0][1] = covariance[1][0] = products.x - mean.x * mean.y;
+		covariance[1][2] = covariance[2][1] = products.y - mean.y * mean.z;
+		covariance[0][2] = covariance[2][0] = products.z - mean.z * mean.x;
+
+		float axes[3][3];
+		SymmetricEigenvectors(covariance, axes);
+
+		XMMATRIX toWorld(
+			XMVectorSet(axes[0][0], axes[0][1], axes[0][2], 0.0f),
+			XMVectorSet(axes[1][0], axes[1][1], axes[1][2], 0.0f),
+			XMVectorSet(axes[2][0], axes[2][1], axes[2][2], 0.0f),
+			g_XMIdentityR3);
+		// The quaternion needs a rotation, not a reflection.
+		if (XMVectorGetX(XMVector3Dot(XMVector3Cross(toWorld.r[0], toWorld.r[1]), toWorld.r[2])) < 0.0f)
+			toWorld.r[2] = XMVectorNegate(toWorld.r[2]);
+		const XMMATRIX toLocal = XMMatrixTranspose(toWorld);
+
+		XMVECTOR localMin = XMVector3TransformNormal(origin, toLocal);
+		XMVECTOR localMax = localMin;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			XMVECTOR p = load(i);
+
+			XMVECTOR local = XMVector3TransformNormal(p, toLocal);
+			localMin = XMVectorMin(localMin, local);
+			localMax = XMVectorMax(localMax, local);
+
+			XMVECTOR d = XMVectorSubtract(p, center);
+			float distanceSq = XMVectorGetX(XMVector3LengthSq(d));
+			if (distanceSq > radiusSq)
+			{
+				// Move the center towards p just enough to cover it and the old sphere.
+				float distance = std::sqrt(distanceSq);
+				float newRadius = (radius + distance) * 0.5f;
+				center = XMVectorMultiplyAdd(d, XMVectorReplicate((newRadius - radius) / distance), center);
+				radius = newRadius;
+				radiusSq = radius * radius;
+			}
+		}
+
+		XMFLOAT3 boxExtents = bounds.Box.Extents;
+		float boxRadius = std::sqrt(boxExtents.x * boxExtents.x + boxExtents.y * boxExtents.y + boxExtents.z * boxExtents.z);
+		if (boxRadius < radius)
+			BoundingSphere::CreateFromBoundingBox(bounds.Sphere, bounds.Box);
+		else
+		{
+			XMStoreFloat3(&bounds.Sphere.Center, center);
+			bounds.Sphere.Radius = radius;
+		}
+
+		XMFLOAT3 extents;
+		XMStoreFloat3(&extents, XMVectorScale(XMVectorSubtract(localMax, localMin), 0.5f));
+		if (extents.x * extents.y * extents.z < boxExtents.x * boxExtents.y * boxExtents.z)
+		{
+			XMVECTOR localCenter = XMVectorScale(XMVectorAdd(localMin, localMax), 0.5f);
+			XMStoreFloat3(&bounds.OrientedBox.Center, XMVector3TransformNormal(localCenter, toWorld));
+			bounds.OrientedBox.Extents = extents;
+			XMStoreFloat4(&bounds.OrientedBox.Orientation, XMQuaternionRotationMatrix(toWorld));
+		}
+		else
+			BoundingOrientedBox::CreateFromBoundingBox(bounds.OrientedBox, bounds.Box);
+
+		return bounds;
+	}
+}
+
+MeshBounds MeshBounds::FromBox(const BoundingBox& box)
+{
+	MeshBounds bounds;
+	bounds.Box = box;
+	BoundingSphere::CreateFromBoundingBox(bounds.Sphere, box);
+	BoundingOrientedBox::CreateFromBoundingBox(bounds.OrientedBox, box);
+	return bounds;
+}
+
+MeshBounds ComputeMeshBounds(const float* positions, std::size_t positionStride, std::size_t count)
+{
+	const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(positions);
+	return Compute([=](std::size_t i)
+	{
+		return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(base + positionStride * i));
+	}, count);
+}
+
+MeshBounds ComputeMeshBounds(const float* positions, std::size_t positionStride,
+	const std::uint32_t* indices, std::size_t indexCount, std::int32_t baseVertex)
+{
+	const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(positions);
+	return Compute([=](std::size_t i)
+	{
+		std::size_t vertex = (std::size_t)((std::int64_t)indices[i] + baseVertex);
+		return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(base + positionStride * vertex));
+	}, indexCount);
+}
+
+void ComputeSubmeshBounds(SubmeshTable& table, const float* positions, std::size_t positionStride,
+	const std::uint32_t* indices, WorkerPool* workers)
+{
+	const std::uint32_t submeshCount = table.Size();
+	if (submeshCount == 0)
+		return;
+
+	std::size_t indexCount = 0;
+	for (SubmeshHandle h = 0; h < submeshCount; ++h)
+		indexCount += table.IndexCount(h);
+
+	// Every submesh is a task of its own, written by exactly one thread.
+	std::vector<MeshBounds> results(submeshCount);
+	auto compute = [&](std::uint32_t h)
+	{
+		results[h] = ComputeMeshBounds(positions, positionStride, indices + table.StartIndexLocation(h),
+			table.IndexCount(h), table.BaseVertexLocation(h));
+	};
+
+	if (workers != nullptr && submeshCount > 1 && indexCount >= MinParallelIndexCount)
+		workers->Run(submeshCount, compute);
+	else
+	{
+		for (SubmeshHandle h = 0; h < submeshCount; ++h)
+			compute(h);
+	}
+
+	for (SubmeshHandle h = 0; h < submeshCount; ++h)
+		table.SetBounds(h, results[h]);
+}
@@ -0,0 +1,49 @@
+//***************************************************************************************
+// MeshBounds.h
+//
+// Bounding volumes of a point set: an axis-aligned box, a sphere and an oriented box,
+// computed together with DirectXMath vector code.
+//
+// The first pass gathers the box, the extreme point on each axis and the covariance of
+// the points; the second grows Ritter's sphere from the two most separated extremes and
+// measures the points along the principal axes of the covariance for the oriented box.
+// When the sphere around the box or the box itself is tighter, it is used instead.
+//
+// Indexed variants read the vertices a submesh's indices reference, so submeshes that
+// share a vertex buffer get their own bounds.
+//***************************************************************************************
+
+#pragma once
+
+#include "WorkerPool.h"
+#include <DirectXCollision.h>
+#include <cstddef>
+#include <cstdint>
+
+class SubmeshTable;
+
+struct MeshBounds
+{
+	DirectX::BoundingBox Box = DirectX::BoundingBox(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+	DirectX::BoundingSphere Sphere = DirectX::BoundingSphere(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f);
+	DirectX::BoundingOrientedBox OrientedBox = DirectX::BoundingOrientedBox(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f),
+		DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+
+	// Box, sphere around it and the box as an oriented box, for when only a box is known.
+	static MeshBounds FromBox(const DirectX::BoundingBox& box);
+};
+
+// positions points at float3 values, positionStride bytes apart.  Empty input gives
+// zero-sized volumes at the origin.
+MeshBounds ComputeMeshBounds(const float* positions, std::size_t positionStride, std::size_t count);
+
+// The vertices indices[i] + baseVertex.  Vertices referenced several times weigh more
+// in the choice of the oriented box axes.
+MeshBounds ComputeMeshBounds(const float* positions, std::size_t positionStride,
+	const std::uint32_t* indices, std::size_t indexCount, std::int32_t baseVertex = 0);
+
+// Fills in the bounds of every submesh of table, LODs included, from the 32-bit index
+// list the submeshes point into.  Submeshes are spread over the threads of workers;
+// without workers, or with few indices in all, they are done on the calling thread.
+void ComputeSubmeshBounds(SubmeshTable& table, const float* positions, std::size_t positionStride,
+	const std::uint32_t* indices, WorkerPool* workers = nullptr);
@@ -0,0 +1,160 @@
+#include "MeshFile.h"
+#include <cstring>
+#include <fstream>
+
+static_assert(sizeof(MeshFileHeader) % MeshFile::SectionAlignment == 0, "Header must keep the sections aligned.");
+static_assert(sizeof(MeshFileSubmesh) == 44, "MeshFileSubmesh layout changed; bump MeshFile::Version.");
+
+namespace
+{
+	std::uint64_t AlignSection(std::uint64_t offset)
+	{
+		return (offset + MeshFile::SectionAlignment - 1) & ~(std::uint64_t)(MeshFile::SectionAlignment - 1);
+	}
+
+	// True if [offset, offset + byteSize) lies inside size bytes, without overflowing.
+	bool InRange(std::uint64_t offset, std::uint64_t byteSize, std::uint64_t size)
+	{
+		return offset <= size && byteSize <= size - offset;
+	}
+}
+
+const char* MeshFile::StatusString(Status status)
+{
+	switch (status)
+	{
+	case Status::Ok:					return "ok";
+	case Status::TooSmall:				return "file is smaller than its header";
+	case Status::BadMagic:				return "not a mesh file";
+	case Status::UnsupportedVersion:	return "unsupported mesh file version";
+	case Status::BadIndexSize:			return "index size must be 2 or 4";
+	case Status::SectionOutOfRange:		return "section lies outside the file";
+	case Status::MisalignedSection:		return "section is not aligned";
+	case Status::SubmeshOutOfRange:		return "submesh indices lie outside the index stream";
+	case Status::BaseVertexOutOfRange:	return "submesh base vertex lies outside the vertex stream";
+	case Status::NameOutOfRange:		return "submesh name lies outside the name section";
+	}
+	return "unknown";
+}
+
+MeshFile::Status MeshFileView::Parse(const void* data, std::size_t size)
+{
+	using MeshFile::Status;
+
+	mBase = nullptr;
+	mHeader = nullptr;
+	mSubmeshes = nullptr;
+
+	const unsigned char* base = static_cast<const unsigned char*>(data);
+	if (base == nullptr || size < sizeof(MeshFileHeader))
+		return Status::TooSmall;
+
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(base);
+	if (header->Magic != MeshFile::Magic)
+		return Status::BadMagic;
+	if (header->Version != MeshFile::Version)
+		return Status::UnsupportedVersion;
+	if (header->IndexSize != 2 && header->IndexSize != 4)
+		return Status::BadIndexSize;
+
+	const std::uint64_t vertexBytes = (std::uint64_t)header->VertexCount * header->VertexStride;
+	const std::uint64_t indexBytes = (std::uint64_t)header->IndexCount * header->IndexSize;
+	const std::uint64_t submeshBytes = (std::uint64_t)header->SubmeshCount * sizeof(MeshFileSubmesh);
+
+	if (!InRange(header->SubmeshOffset, submeshBytes, size) ||
+		!InRange(header->VertexOffset, vertexBytes, size) ||
+		!InRange(header->IndexOffset, indexBytes, size) ||
+		!InRange(header->NameOffset, header->NameBytes, size))
+		return Status::SectionOutOfRange;
+
+	if (header->SubmeshOffset % MeshFile::SectionAlignment != 0 ||
+		header->VertexOffset % MeshFile::SectionAlignment != 0 ||
+		header->IndexOffset % MeshFile::SectionAlignment != 0)
+		return Status::MisalignedSection;
+
+	const MeshFileSubmesh* submeshes = reinterpret_cast<const MeshFileSubmesh*>(base + header->SubmeshOffset);
+	for (std::uint32_t i = 0; i < header->SubmeshCount; ++i)
+	{
+		const MeshFileSubmesh& submesh = submeshes[i];
+		if (!InRange(submesh.StartIndexLocation, submesh.IndexCount, header->IndexCount))
+			return Status::SubmeshOutOfRange;
+		if (submesh.BaseVertexLocation < 0 || (std::uint32_t)submesh.BaseVertexLocation >= header->VertexCount)
+			return Status::BaseVertexOutOfRange;
+		if (!InRange(submesh.NameOffset, submesh.NameLength, header->NameBytes))
+			return Status::NameOutOfRange;
+	}
+
+	mBase = base;
+	mHeader = header;
+	mSubmeshes = submeshes;
+	return Status::Ok;
+}
+
+std::string MeshFileView::SubmeshName(std::uint32_t i)const
+{
+	const MeshFileSubmesh& submesh = mSubmeshes[i];
+	const char* names = reinterpret_cast<const char*>(mBase + mHeader->NameOffset);
+	return std::string(names + submesh.NameOffset, submesh.NameLength);
+}
+
+void BuildMeshFile(const MeshFileSource& source, std::vector<unsigned char>& file)
+{
+	MeshFileHeader header = {};
+	header.Magic = MeshFile::Magic;
+	header.Version = MeshFile::Version;
+	header.VertexFormat = source.VertexFormat;
+	header.VertexStride = source.VertexStride;
+	header.VertexCount = source.VertexCount;
+	header.IndexSize = source.IndexSize;
+	header.IndexCount = source.IndexCount;
+	header.SubmeshCount = (std::uint32_t)source.Submeshes.size();
+	header.Bounds = source.Bounds;
+
+	std::vector<MeshFileSubmesh> submeshes(source.Submeshes.size());
+	std::string names;
+	for (size_t i = 0; i < source.Submeshes.size(); ++i)
+	{
+		const MeshFileSource::Submesh& src = source.Submeshes[i];
+		MeshFileSubmesh& dst = submeshes[i];
+		dst.IndexCount = src.IndexCount;
+		dst.StartIndexLocation = src.StartIndexLocation;
+		dst.BaseVertexLocation = src.BaseVertexLocation;
+		dst.NameOffset = (std::uint32_t)names.size();
+		dst.NameLength = (std::uint32_t)src.Name.size();
+		dst.Bounds = src.Bounds;
+		names += src.Name;
+	}
+
+	const std::uint64_t vertexBytes = (std::uint64_t)source.VertexCount * source.VertexStride;
+	const std::uint64_t indexBytes = (std::uint64_t)source.IndexCount * source.IndexSize;
+
+	header.SubmeshOffset = AlignSection(sizeof(MeshFileHeader));
+	header.VertexOffset = AlignSection(header.SubmeshOffset + submeshes.size() * sizeof(MeshFileSubmesh));
+	header.IndexOffset = AlignSection(header.VertexOffset + vertexBytes);
+	header.NameOffset = AlignSection(header.IndexOffset + indexBytes);
+	header.NameBytes = names.size();
+
+	file.assign((size_t)(header.NameOffset + header.NameBytes), 0);
+	std::memcpy(file.data(), &header, sizeof(header));
+	if (!submeshes.empty())
+		std::memcpy(file.data() + header.SubmeshOffset, submeshes.data(), submeshes.size() * sizeof(MeshFileSubmesh));
+	if (vertexBytes > 0)
+		std::memcpy(file.data() + header.VertexOffset, source.Vertices, (size_t)vertexBytes);
+	if (indexBytes > 0)
+		std::memcpy(file.data() + header.IndexOffset, source.Indices, (size_t)indexBytes);
+	if (!names.empty())
+		std::memcpy(file.data() + header.NameOffset, names.data(), names.size());
+}
+
+bool WriteMeshFile(const std::string& path, const MeshFileSource& source)
+{
+	std::vector<unsigned char> file;
+	BuildMeshFile(source, file);
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+
+	out.write(reinterpret_cast<const char*>(file.data()), (std::streamsize)file.size());
+	return (bool)out;
+}
@@ -0,0 +1,144 @@
+//***************************************************************************************
+// MeshFile.h
+//
+// Binary mesh container, laid out so it can be used in place once mapped:
+//
+//   MeshFileHeader
+//   MeshFileSubmesh[SubmeshCount]
+//   vertex stream   (VertexCount * VertexStride bytes)
+//   index stream    (IndexCount * IndexSize bytes)
+//   submesh names   (not null terminated; referenced by offset and length)
+//
+// Every section starts on a SectionAlignment boundary and all values are little endian.
+// MeshFileView checks a block of memory against the format and hands out pointers into
+// it; WriteMeshFile produces the files.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct MeshFileBounds
+{
+	float Center[3];
+	float Extents[3];
+};
+
+struct MeshFileHeader
+{
+	std::uint32_t Magic;
+	std::uint32_t Version;
+
+	// Application-defined id of the vertex layout; the sample stores a VertexFormat.
+	std::uint32_t VertexFormat;
+	std::uint32_t VertexStride;
+	std::uint32_t VertexCount;
+	// 2 or 4 bytes.
+	std::uint32_t IndexSize;
+	std::uint32_t IndexCount;
+	std::uint32_t SubmeshCount;
+
+	// Byte offsets from the start of the file.
+	std::uint64_t SubmeshOffset;
+	std::uint64_t VertexOffset;
+	std::uint64_t IndexOffset;
+	std::uint64_t NameOffset;
+	std::uint64_t NameBytes;
+
+	// Bounds of the whole mesh.
+	MeshFileBounds Bounds;
+};
+
+struct MeshFileSubmesh
+{
+	std::uint32_t IndexCount;
+	std::uint32_t StartIndexLocation;
+	std::int32_t BaseVertexLocation;
+	// Into the name section.
+	std::uint32_t NameOffset;
+	std::uint32_t NameLength;
+	MeshFileBounds Bounds;
+};
+
+namespace MeshFile
+{
+	const std::uint32_t Magic = 0x4853454d; // "MESH"
+	const std::uint32_t Version = 1;
+	const std::uint32_t SectionAlignment = 16;
+
+	enum class Status
+	{
+		Ok,
+		TooSmall,
+		BadMagic,
+		UnsupportedVersion,
+		BadIndexSize,
+		SectionOutOfRange,
+		MisalignedSection,
+		SubmeshOutOfRange,
+		BaseVertexOutOfRange,
+		NameOutOfRange
+	};
+
+	const char* StatusString(Status status);
+}
+
+// Read-only view of a mesh file in memory.  Nothing is copied; the pointers stay valid as
+// long as the memory does.
+class MeshFileView
+{
+public:
+	// Validates data before anything is exposed: on success every section, submesh index
+	// range, base vertex and name lies inside the size bytes.  The index values themselves
+	// are not read, so an index can still point past the vertex stream.
+	MeshFile::Status Parse(const void* data, std::size_t size);
+
+	const MeshFileHeader& Header()const { return *mHeader; }
+
+	const void* VertexData()const { return mBase + mHeader->VertexOffset; }
+	std::uint64_t VertexByteSize()const { return (std::uint64_t)mHeader->VertexCount * mHeader->VertexStride; }
+
+	const void* IndexData()const { return mBase + mHeader->IndexOffset; }
+	std::uint64_t IndexByteSize()const { return (std::uint64_t)mHeader->IndexCount * mHeader->IndexSize; }
+
+	std::uint32_t SubmeshCount()const { return mHeader->SubmeshCount; }
+	const MeshFileSubmesh& Submesh(std::uint32_t i)const { return mSubmeshes[i]; }
+	std::string SubmeshName(std::uint32_t i)const;
+
+private:
+	const unsigned char* mBase = nullptr;
+	const MeshFileHeader* mHeader = nullptr;
+	const MeshFileSubmesh* mSubmeshes = nullptr;
+};
+
+// Everything needed to write a mesh file; the pointers are only read during the call.
+struct MeshFileSource
+{
+	std::uint32_t VertexFormat = 0;
+	std::uint32_t VertexStride = 0;
+	std::uint32_t VertexCount = 0;
+	const void* Vertices = nullptr;
+
+	std::uint32_t IndexSize = 2;
+	std::uint32_t IndexCount = 0;
+	const void* Indices = nullptr;
+
+	struct Submesh
+	{
+		std::string Name;
+		std::uint32_t IndexCount = 0;
+		std::uint32_t StartIndexLocation = 0;
+		std::int32_t BaseVertexLocation = 0;
+		MeshFileBounds Bounds = {};
+	};
+	std::vector<Submesh> Submeshes;
+
+	MeshFileBounds Bounds = {};
+};
+
+// Lays the file out in memory (sections aligned, padding zeroed).
+void BuildMeshFile(const MeshFileSource& source, std::vector<unsigned char>& file);
+bool WriteMeshFile(const std::string& path, const MeshFileSource& source);
@@ -0,0 +1,203 @@
+#include "MeshLoader.h"
+#include "MappedFile.h"
+#include "MeshBounds.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+namespace
+{
+	// Cache and overdraw order per submesh, then one fetch-order pass over the whole mesh.
+	void OptimizeMesh(ObjMesh& mesh)
+	{
+		const std::uint32_t vertexCount = (std::uint32_t)mesh.Vertices.size();
+		for (const ObjSubmesh& submesh : mesh.Submeshes)
+		{
+			std::uint32_t* indices = mesh.Indices.data() + submesh.StartIndexLocation;
+			MeshOptimizer::OptimizeVertexCache(indices, submesh.IndexCount, vertexCount);
+			MeshOptimizer::OptimizeOverdraw(indices, submesh.IndexCount, mesh.Vertices[0].Position,
+				sizeof(ObjVertex), vertexCount);
+		}
+
+		std::uint32_t usedCount = MeshOptimizer::OptimizeVertexFetch(mesh.Vertices.data(), sizeof(ObjVertex), vertexCount,
+			mesh.Indices.data(), mesh.Indices.size());
+		mesh.Vertices.resize(usedCount);
+	}
+
+	// Each LOD aims at half the triangles of the one before, within an error of
+	// LodMaxError of the mesh extent.  The chain ends when a level saves too little.
+	const std::uint32_t MaxLodCount = 4;
+	const float LodTriangleRatio = 0.5f;
+	const float LodMaxError = 0.02f;
+	const float LodMinReduction = 0.85f;
+	const std::size_t LodMinTriangles = 64;
+	// Normal and texture coordinate differences, next to the relative position error.
+	const float LodAttributeWeights[5] = { 0.05f, 0.05f, 0.05f, 0.02f, 0.02f };
+
+	struct ObjLod
+	{
+		std::uint32_t Submesh;
+		std::uint32_t IndexCount;
+		std::uint32_t StartIndexLocation;
+		// In the mesh's units.
+		float Error;
+	};
+
+	// Appends the LOD chain of every submesh to mesh.Indices, sharing the vertices.
+	std::vector<ObjLod> BuildLods(ObjMesh& mesh)
+	{
+		std::vector<ObjLod> lods;
+		const std::uint32_t vertexCount = (std::uint32_t)mesh.Vertices.size();
+		const float scale = MeshSimplifier::GetScale(mesh.Vertices[0].Position, sizeof(ObjVertex), vertexCount);
+
+		std::vector<std::uint32_t> source;
+		std::vector<std::uint32_t> simplified;
+		for (std::uint32_t s = 0; s < (std::uint32_t)mesh.Submeshes.size(); ++s)
+		{
+			const ObjSubmesh& submesh = mesh.Submeshes[s];
+			source.assign(mesh.Indices.begin() + submesh.StartIndexLocation,
+				mesh.Indices.begin() + submesh.StartIndexLocation + submesh.IndexCount);
+
+			// Every level starts from the previous one, so the errors add up.
+			float error = 0.0f;
+			for (std::uint32_t level = 0; level < MaxLodCount && source.size() / 3 > LodMinTriangles; ++level)
+			{
+				std::size_t target = (std::size_t)(source.size() / 3 * LodTriangleRatio) * 3;
+				float levelError = 0.0f;
+				simplified.resize(source.size());
+				simplified.resize(MeshSimplifier::Simplify(simplified.data(), source.data(), source.size(),
+					mesh.Vertices[0].Position, sizeof(ObjVertex), vertexCount, target, LodMaxError, &levelError,
+					mesh.Vertices[0].Normal, sizeof(ObjVertex), LodAttributeWeights, _countof(LodAttributeWeights)));
+
+				if (simplified.empty() || simplified.size() > source.size() * LodMinReduction)
+					break;
+
+				MeshOptimizer::OptimizeVertexCache(simplified.data(), simplified.size(), vertexCount);
+				error += levelError;
+
+				ObjLod lod = { s, (std::uint32_t)simplified.size(), (std::uint32_t)mesh.Indices.size(), error * scale };
+				lods.push_back(lod);
+				mesh.Indices.insert(mesh.Indices.end(), simplified.begin(), simplified.end());
+				source.swap(simplified);
+			}
+		}
+
+		return lods;
+	}
+
+	// Reports why path could not be loaded to the debugger and throws.
+	void FailLoad(const std::string& path, const std::string& reason)
+	{
+		std::string message = path + ": " + reason + "\n";
+		OutputDebugStringA(message.c_str());
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_INVALID_DATA));
+	}
+
+	DirectX::BoundingBox ToBoundingBox(const MeshFileBounds& bounds)
+	{
+		return DirectX::BoundingBox(
+			DirectX::XMFLOAT3(bounds.Center[0], bounds.Center[1], bounds.Center[2]),
+			DirectX::XMFLOAT3(bounds.Extents[0], bounds.Extents[1], bounds.Extents[2]));
+	}
+}
+
+LoadedMesh LoadMeshGeometry(const std::string& path, GeometryBuffer& geometryBuffer)
+{
+	auto file = std::make_shared<MappedFile>();
+	if (!file->Open(path))
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+
+	MeshFileView view;
+	MeshFile::Status status = view.Parse(file->Data(), file->Size());
+	if (status != MeshFile::Status::Ok)
+		FailLoad(path, MeshFile::StatusString(status));
+
+	const MeshFileHeader& header = view.Header();
+	if (header.VertexFormat >= (std::uint32_t)VertexFormat::Count ||
+		header.VertexStride != GetVertexStride((VertexFormat)header.VertexFormat))
+		FailLoad(path, "unknown vertex format");
+	if (header.VertexCount == 0 || header.IndexCount == 0)
+		FailLoad(path, "the file has no geometry");
+
+	LoadedMesh mesh;
+	mesh.Format = (VertexFormat)header.VertexFormat;
+	// The upload reads the vertices and indices from the mapping when the batch is submitted.
+	mesh.UploadSource = file;
+	if (header.IndexSize == 4)
+	{
+		mesh.Geometry = geometryBuffer.Add(mesh.Format, view.VertexData(), header.VertexCount,
+			static_cast<const std::uint32_t*>(view.IndexData()), header.IndexCount);
+	}
+	else
+	{
+		mesh.Geometry = geometryBuffer.Add(mesh.Format, view.VertexData(), header.VertexCount,
+			static_cast<const std::uint16_t*>(view.IndexData()), header.IndexCount);
+	}
+	if (mesh.Geometry == GeometryBuffer::InvalidHandle)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	mesh.Submeshes.Reserve(view.SubmeshCount());
+	for (std::uint32_t i = 0; i < view.SubmeshCount(); ++i)
+	{
+		const MeshFileSubmesh& submesh = view.Submesh(i);
+		mesh.Submeshes.Add(view.SubmeshName(i), submesh.IndexCount, submesh.StartIndexLocation,
+			submesh.BaseVertexLocation, ToBoundingBox(submesh.Bounds));
+	}
+
+	return mesh;
+}
+
+LoadedMesh ImportObjGeometry(const std::string& path, GeometryBuffer& geometryBuffer, WorkerPool* workers,
+	ObjImportStats* stats)
+{
+	ObjImporter importer;
+	auto imported = std::make_shared<ObjMesh>();
+	ObjMesh& objMesh = *imported;
+	if (!importer.ImportFile(path, objMesh, workers))
+		FailLoad(path, importer.Error());
+	if (stats != nullptr)
+		*stats = importer.Stats();
+
+	// The optimizer and the simplifier need at least one triangle.
+	if (objMesh.Indices.empty() || objMesh.Vertices.empty())
+		FailLoad(path, "the file has no faces");
+
+	OptimizeMesh(objMesh);
+	std::vector<ObjLod> lods = BuildLods(objMesh);
+
+	// Add narrows the indices to 16 bits when they fit.  The imported arrays are what the
+	// upload reads from.
+	LoadedMesh mesh;
+	mesh.Format = VertexFormat::PositionNormalTexC;
+	mesh.UploadSource = imported;
+	mesh.Geometry = geometryBuffer.Add(mesh.Format, objMesh.Vertices.data(), (UINT)objMesh.Vertices.size(),
+		objMesh.Indices.data(), (UINT)objMesh.Indices.size());
+	if (mesh.Geometry == GeometryBuffer::InvalidHandle)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	mesh.Submeshes.Reserve((std::uint32_t)(objMesh.Submeshes.size() + lods.size()));
+	for (const ObjSubmesh& submesh : objMesh.Submeshes)
+	{
+		DirectX::BoundingBox bounds;
+		DirectX::BoundingBox::CreateFromPoints(bounds,
+			DirectX::XMVectorSet(submesh.BoundsMin[0], submesh.BoundsMin[1], submesh.BoundsMin[2], 1.0f),
+			DirectX::XMVectorSet(submesh.BoundsMax[0], submesh.BoundsMax[1], submesh.BoundsMax[2], 1.0f));
+		mesh.Submeshes.Add(submesh.Name, submesh.IndexCount, submesh.StartIndexLocation, 0, bounds);
+	}
+
+	// Submesh handles are the submesh indices, and the LODs follow in chain order.
+	for (const ObjLod& lod : lods)
+		mesh.Submeshes.AddLod(lod.Submesh, lod.IndexCount, lod.StartIndexLocation, lod.Error);
+
+	const float* positions = objMesh.Vertices[0].Position;
+	ComputeSubmeshBounds(mesh.Submeshes, positions, sizeof(ObjVertex), objMesh.Indices.data(), workers);
+
+	for (SubmeshHandle h = 0; h < mesh.Submeshes.Size(); ++h)
+	{
+		mesh.Meshlets.Submeshes.push_back(Meshlets::Build(mesh.Meshlets,
+			objMesh.Indices.data() + mesh.Submeshes.StartIndexLocation(h), mesh.Submeshes.IndexCount(h),
+			positions, sizeof(ObjVertex), (std::uint32_t)objMesh.Vertices.size()));
+	}
+
+	return mesh;
+}
@@ -0,0 +1,54 @@
+//***************************************************************************************
+// MeshLoader.h
+//
+// Loads meshes into a GeometryBuffer, so every loaded mesh shares its vertex and index
+// buffers and is drawn through BaseVertexLocation and StartIndexLocation alone.
+//
+// Mesh files (see MeshFile.h) are loaded without a parse step: the file is mapped and
+// the upload copies the vertices and indices straight from the mapping into the upload
+// ring.  OBJ files go through ObjImporter instead and are uploaded from the imported
+// arrays.
+//
+// GeometryBuffer::Add reads the vertices and indices when the UploadBatch is submitted,
+// so LoadedMesh::UploadSource keeps them alive until then.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryBuffer.h"
+#include "ObjImporter.h"
+#include <memory>
+
+// A mesh sub-allocated from a GeometryBuffer.  Its submesh locations are relative to the
+// range: add the buffer's StartIndexLocation and BaseVertexLocation of Geometry.  Remove
+// Geometry from the buffer to free it.
+struct LoadedMesh
+{
+	GeometryHandle Geometry = GeometryBuffer::InvalidHandle;
+	VertexFormat Format = VertexFormat::PositionColor;
+
+	SubmeshTable Submeshes;
+	// Clusters for CPU culling, indexed by submesh handle; empty unless the loader built
+	// them.  Their vertex indices are relative to the submesh's base vertex.
+	MeshletSet Meshlets;
+
+	// The vertex and index data the queued upload reads from.  Release it once the UploadBatch has
+	// been submitted.
+	std::shared_ptr<const void> UploadSource;
+};
+
+// The file's VertexFormat is a VertexFormat value and its stride must match.  Throws if
+// the file cannot be mapped, is not a valid mesh file, has no geometry or does not fit
+// in geometryBuffer.  The uploads are queued on the buffer's UploadBatch; submit it
+// before drawing.
+LoadedMesh LoadMeshGeometry(const std::string& path, GeometryBuffer& geometryBuffer);
+
+// Imports an OBJ file.  Vertices are PositionNormalTexC (ObjVertex).  Triangles and
+// vertices are reordered with MeshOptimizer before upload.  Every submesh gets an LOD
+// chain (see SubmeshTable::AddLod) in the same range, every range gets bounds fitted to
+// its vertices, and every range is split into meshlets.  Throws if the file cannot be
+// read or parsed, has no faces or does not fit in geometryBuffer.  The text is parsed
+// and the bounds computed on workers if given.  stats, if given, receives the importer's timings.
+LoadedMesh ImportObjGeometry(const std::string& path, GeometryBuffer& geometryBuffer,
+	WorkerPool* workers = nullptr, ObjImportStats* stats = nullptr);
@@ -0,0 +1,373 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// Forsyth, "Linear-Speed Vertex Cache Optimisation" (2006).
+	const int ForsythCacheSize = 32;
+	const float CacheDecayPower = 1.5f;
+	const float LastTriangleScore = 0.75f;
+	const float ValenceBoostScale = 2.0f;
+	const float ValenceBoostPower = 0.5f;
+
+	float ForsythScore(int cachePosition, std::uint32_t remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+			return -1.0f;
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				// The triangle just drawn; its vertices are deliberately scored lower so the
+				// next triangle does not simply continue a strip.
+				score = LastTriangleScore;
+			}
+			else
+			{
+				const float scaler = 1.0f / (ForsythCacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+			}
+		}
+
+		// Vertices with few triangles left get a boost so they are finished off.
+		score += ValenceBoostScale * std::pow((float)remainingTriangles, -ValenceBoostPower);
+		return score;
+	}
+
+	struct Vec3
+	{
+		float X, Y, Z;
+	};
+
+	Vec3 LoadPosition(const float* positions, std::size_t stride, std::uint32_t index)
+	{
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + stride * index);
+		Vec3 v = { p[0], p[1], p[2] };
+		return v;
+	}
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const std::uint32_t* indices, std::size_t indexCount,
+	std::uint32_t vertexCount, std::uint32_t cacheSize)
+{
+	VertexCacheStats stats;
+	if (indexCount < 3)
+		return stats;
+
+	// FIFO cache: a vertex is in the cache if it was inserted less than cacheSize misses ago.
+	std::vector<std::uint32_t> insertedAt(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	std::uint32_t misses = 0;
+	std::uint32_t uniqueVertices = 0;
+
+	for (std::size_t i = 0; i < indexCount; ++i)
+	{
+		std::uint32_t v = indices[i];
+		assert(v < vertexCount);
+
+		if (!referenced[v])
+		{
+			referenced[v] = true;
+			++uniqueVertices;
+		}
+
+		if (insertedAt[v] == 0 || misses - insertedAt[v] + 1 > cacheSize)
+		{
+			++misses;
+			insertedAt[v] = misses;
+		}
+	}
+
+	stats.TransformedVertices = misses;
+	stats.Acmr = (float)misses / (float)(indexCount / 3);
+	stats.Atvr = uniqueVertices > 0 ? (float)misses / (float)uniqueVertices : 0.0f;
+	return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount)
+{
+	assert(indexCount % 3 == 0);
+	const std::size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+		return;
+
+	// Triangles of every vertex, as one array with per-vertex offsets.
+	std::vector<std::uint32_t> remaining(vertexCount, 0);
+	for (std::size_t i = 0; i < triangleCount * 3; ++i)
+		++remaining[indices[i]];
+
+	std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (std::uint32_t v = 0; v < vertexCount; ++v)
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+
+	std::vector<std::uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (std::size_t t = 0; t < triangleCount; ++t)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				std::uint32_t v = indices[t * 3 + k];
+				adjacency[fill[v]++] = (std::uint32_t)t;
+			}
+		}
+	}
+
+	std::vector<float> vertexScore(vertexCount);
+	for (std::uint32_t v = 0; v < vertexCount; ++v)
+		vertexScore[v] = ForsythScore(-1, remaining[v]);
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<float> triangleScore(triangleCount);
+	for (std::size_t t = 0; t < triangleCount; ++t)
+	{
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+			vertexScore[indices[t * 3 + 2]];
+	}
+
+	std::vector<std::uint32_t> output;
+	output.reserve(indexCount);
+
+	// LRU cache, most recent first.  It briefly holds up to three extra vertices after a
+	// triangle is pushed; those are rescored as having left the cache.
+	std::vector<std::uint32_t> cache, newCache;
+	cache.reserve(ForsythCacheSize + 3);
+	newCache.reserve(ForsythCacheSize + 3);
+
+	std::size_t nextCandidate = 0;
+	std::size_t best = 0;
+	float bestScore = triangleScore[0];
+	for (std::size_t t = 1; t < triangleCount; ++t)
+	{
+		if (triangleScore[t] > bestScore)
+		{
+			bestScore = triangleScore[t];
+			best = t;
+		}
+	}
+
+	for (std::size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		if (bestScore < 0.0f)
+		{
+			// Nothing in the cache connects to a remaining triangle; take the next one in
+			// the original order.
+			while (emitted[nextCandidate])
+				++nextCandidate;
+			best = nextCandidate;
+		}
+
+		emitted[best] = true;
+		const std::uint32_t* tri = indices + best * 3;
+		output.insert(output.end(), tri, tri + 3);
+
+		// Drop the triangle from its vertices' lists.
+		for (int k = 0; k < 3; ++k)
+		{
+			std::uint32_t v = tri[k];
+			std::uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+			std::uint32_t* end = begin + remaining[v];
+			std::uint32_t* it = std::find(begin, end, (std::uint32_t)best);
+			*it = end[-1];
+			--remaining[v];
+		}
+
+		// Move the triangle's vertices to the front of the LRU cache.
+		newCache.assign(tri, tri + 3);
+		for (std::uint32_t v : cache)
+		{
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache.push_back(v);
+		}
+		cache.swap(newCache);
+
+		// Rescore every vertex in (or just pushed out of) the cache and the triangles that
+		// use them; pick the best of those triangles as the next one.
+		bestScore = -1.0f;
+		for (std::size_t i = 0; i < cache.size(); ++i)
+		{
+			std::uint32_t v = cache[i];
+			int position = i < (std::size_t)ForsythCacheSize ? (int)i : -1;
+
+			float newScore = ForsythScore(position, remaining[v]);
+			float delta = newScore - vertexScore[v];
+			vertexScore[v] = newScore;
+
+			const std::uint32_t* triangles = adjacency.data() + adjacencyOffsets[v];
+			for (std::uint32_t j = 0; j < remaining[v]; ++j)
+			{
+				std::uint32_t t = triangles[j];
+				triangleScore[t] += delta;
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		if (cache.size() > (std::size_t)ForsythCacheSize)
+			cache.resize(ForsythCacheSize);
+	}
+
+	std::memcpy(indices, output.data(), output.size() * sizeof(std::uint32_t));
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::uint32_t* indices, std::size_t indexCount, const float* positions,
+	std::size_t positionStride, std::uint32_t vertexCount, float threshold)
+{
+	const std::size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2)
+		return;
+
+	VertexCacheStats before = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+	// Clusters start wherever the cache-optimized order restarts, i.e. at triangles whose
+	// three vertices all miss the cache.  Reordering whole clusters keeps most of the
+	// cache locality.
+	std::vector<std::size_t> clusterStarts;
+	{
+		std::vector<std::uint32_t> insertedAt(vertexCount, 0);
+		std::uint32_t misses = 0;
+		for (std::size_t t = 0; t < triangleCount; ++t)
+		{
+			int triangleMisses = 0;
+			for (int k = 0; k < 3; ++k)
+			{
+				std::uint32_t v = indices[t * 3 + k];
+				if (insertedAt[v] == 0 || misses - insertedAt[v] + 1 > DefaultCacheSize)
+				{
+					++misses;
+					insertedAt[v] = misses;
+					++triangleMisses;
+				}
+			}
+			if (t == 0 || triangleMisses == 3)
+				clusterStarts.push_back(t);
+		}
+	}
+
+	if (clusterStarts.size() < 2)
+		return;
+
+	// Mesh centroid (area weighted) and, per cluster, its centroid and average normal.
+	struct Cluster
+	{
+		std::size_t Start;
+		std::size_t End;
+		float SortKey;
+	};
+	std::vector<Cluster> clusters(clusterStarts.size());
+
+	Vec3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	std::vector<Vec3> clusterCentroids(clusters.size());
+	std::vector<Vec3> clusterNormals(clusters.size());
+
+	for (std::size_t c = 0; c < clusters.size(); ++c)
+	{
+		Cluster& cluster = clusters[c];
+		cluster.Start = clusterStarts[c];
+		cluster.End = c + 1 < clusters.size() ? clusterStarts[c + 1] : triangleCount;
+
+		Vec3 centroid = { 0.0f, 0.0f, 0.0f };
+		Vec3 normal = { 0.0f, 0.0f, 0.0f };
+		float area = 0.0f;
+
+		for (std::size_t t = cluster.Start; t < cluster.End; ++t)
+		{
+			Vec3 a = LoadPosition(positions, positionStride, indices[t * 3]);
+			Vec3 b = LoadPosition(positions, positionStride, indices[t * 3 + 1]);
+			Vec3 c2 = LoadPosition(positions, positionStride, indices[t * 3 + 2]);
+
+			Vec3 e1 = { b.X - a.X, b.Y - a.Y, b.Z - a.Z };
+			Vec3 e2 = { c2.X - a.X, c2.Y - a.Y, c2.Z - a.Z };
+			Vec3 n = { e1.Y * e2.Z - e1.Z * e2.Y, e1.Z * e2.X - e1.X * e2.Z, e1.X * e2.Y - e1.Y * e2.X };
+			float w = std::sqrt(n.X * n.X + n.Y * n.Y + n.Z * n.Z);
+
+			centroid.X += (a.X + b.X + c2.X) / 3.0f * w;
+			centroid.Y += (a.Y + b.Y + c2.Y) / 3.0f * w;
+			centroid.Z += (a.Z + b.Z + c2.Z) / 3.0f * w;
+			normal.X += n.X;
+			normal.Y += n.Y;
+			normal.Z += n.Z;
+			area += w;
+		}
+
+		meshCentroid.X += centroid.X;
+		meshCentroid.Y += centroid.Y;
+		meshCentroid.Z += centroid.Z;
+		meshArea += area;
+
+		float inverseArea = area > 0.0f ? 1.0f / area : 0.0f;
+		clusterCentroids[c] = { centroid.X * inverseArea, centroid.Y * inverseArea, centroid.Z * inverseArea };
+
+		float length = std::sqrt(normal.X * normal.X + normal.Y * normal.Y + normal.Z * normal.Z);
+		float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+		clusterNormals[c] = { normal.X * inverseLength, normal.Y * inverseLength, normal.Z * inverseLength };
+	}
+
+	if (meshArea > 0.0f)
+	{
+		meshCentroid.X /= meshArea;
+		meshCentroid.Y /= meshArea;
+		meshCentroid.Z /= meshArea;
+	}
+
+	// Clusters that face away from the center are likely to occlude the rest from most
+	// directions, so they go first.
+	for (std::size_t c = 0; c < clusters.size(); ++c)
+	{
+		const Vec3& centroid = clusterCentroids[c];
+		const Vec3& normal = clusterNormals[c];
+		clusters[c].SortKey = (centroid.X - meshCentroid.X) * normal.X +
+			(centroid.Y - meshCentroid.Y) * normal.Y +
+			(centroid.Z - meshCentroid.Z) * normal.Z;
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b)
+	{
+		return a.SortKey > b.SortKey;
+	});
+
+	std::vector<std::uint32_t> reordered;
+	reordered.reserve(triangleCount * 3);
+	for (const Cluster& cluster : clusters)
+		reordered.insert(reordered.end(), indices + cluster.Start * 3, indices + cluster.End * 3);
+
+	VertexCacheStats after = AnalyzeVertexCache(reordered.data(), reordered.size(), vertexCount);
+	if (after.Acmr <= before.Acmr * threshold)
+		std::memcpy(indices, reordered.data(), reordered.size() * sizeof(std::uint32_t));
+}
+
+std::uint32_t MeshOptimizer::OptimizeVertexFetch(void* vertices, std::size_t vertexStride, std::uint32_t vertexCount,
+	std::uint32_t* indices, std::size_t indexCount)
+{
+	const std::uint32_t Unused = 0xffffffff;
+
+	std::vector<std::uint32_t> remap(vertexCount, Unused);
+	std::uint32_t nextVertex = 0;
+	for (std::size_t i = 0; i < indexCount; ++i)
+	{
+		std::uint32_t& target = remap[indices[i]];
+		if (target == Unused)
+			target = nextVertex++;
+		indices[i] = target;
+	}
+
+	unsigned char* data = static_cast<unsigned char*>(vertices);
+	std::vector<unsigned char> copy(data, data + vertexStride * vertexCount);
+	for (std::uint32_t v = 0; v < vertexCount; ++v)
+	{
+		if (remap[v] != Unused)
+			std::memcpy(data + vertexStride * remap[v], copy.data() + vertexStride * v, vertexStride);
+	}
+
+	return nextVertex;
+}
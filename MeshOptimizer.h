@@ -0,0 +1,53 @@
+//***************************************************************************************
+// MeshOptimizer.h
+//
+// Index and vertex reordering for triangle lists, in the order it should be applied:
+//
+//   OptimizeVertexCache - reorders triangles so vertices are reused while they are still
+//                         in the post-transform cache (Forsyth's linear-speed algorithm).
+//   OptimizeOverdraw    - splits that order into clusters and sorts the clusters so
+//                         outward-facing ones draw first (view independent), keeping the
+//                         cache efficiency within a threshold.
+//   OptimizeVertexFetch - renumbers vertices in first-use order so the vertex fetches
+//                         walk memory sequentially, dropping unused vertices.
+//
+// AnalyzeVertexCache simulates a FIFO post-transform cache and reports ACMR (transformed
+// vertices per triangle) and ATVR (transformed vertices per vertex; 1.0 is optimal).
+// Lists of fewer than three indices have no triangles and report zeroed stats.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+struct VertexCacheStats
+{
+	std::uint32_t TransformedVertices = 0;
+	// Average cache miss ratio: transformed vertices per triangle (0.5 - 3.0).
+	float Acmr = 0.0f;
+	// Average transformed vertex ratio: transformed vertices per referenced vertex.
+	float Atvr = 0.0f;
+};
+
+namespace MeshOptimizer
+{
+	const std::uint32_t DefaultCacheSize = 16;
+
+	VertexCacheStats AnalyzeVertexCache(const std::uint32_t* indices, std::size_t indexCount,
+		std::uint32_t vertexCount, std::uint32_t cacheSize = DefaultCacheSize);
+
+	// Reorders the triangles of indices in place.  indexCount must be a multiple of 3.
+	void OptimizeVertexCache(std::uint32_t* indices, std::size_t indexCount, std::uint32_t vertexCount);
+
+	// Reorders the triangles of an index buffer that went through OptimizeVertexCache.
+	// positions points at the first vertex's float3 position, positionStride bytes apart.
+	// The new order is only kept if its ACMR stays within threshold times the old one.
+	void OptimizeOverdraw(std::uint32_t* indices, std::size_t indexCount, const float* positions,
+		std::size_t positionStride, std::uint32_t vertexCount, float threshold = 1.05f);
+
+	// Renumbers the vertices in order of first use and moves their data accordingly.
+	// Returns the number of vertices still referenced; they are packed at the front.
+	std::uint32_t OptimizeVertexFetch(void* vertices, std::size_t vertexStride, std::uint32_t vertexCount,
+		std::uint32_t* indices, std::size_t indexCount);
+}
@@ -0,0 +1,480 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+	// Border edges weigh this much more than the faces around them.
+	const float BorderWeight = 10.0f;
+
+	// Collapses may turn a triangle's normal by at most acos of this.
+	const float MaxFlipCosine = 0.25f;
+
+	struct Vec3
+	{
+		float X, Y, Z;
+
+		const float* Bits()const { return &X; }
+	};
+
+	Vec3 LoadPosition(const float* positions, std::size_t stride, std::uint32_t index)
+	{
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + stride * index);
+		Vec3 v = { p[0], p[1], p[2] };
+		return v;
+	}
+
+	Vec3 Sub(const Vec3& a, const Vec3& b)
+	{
+		Vec3 v = { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+		return v;
+	}
+
+	float Dot(const Vec3& a, const Vec3& b)
+	{
+		return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+	}
+
+	Vec3 Cross(const Vec3& a, const Vec3& b)
+	{
+		Vec3 v = { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+		return v;
+	}
+
+	// Sum of weighted squared distances to a set of planes, as a symmetric 4x4 matrix.
+	struct Quadric
+	{
+		double A2 = 0, B2 = 0, C2 = 0, D2 = 0;
+		double AB = 0, AC = 0, AD = 0, BC = 0, BD = 0, CD = 0;
+		double Weight = 0;
+
+		void AddPlane(double a, double b, double c, double d, double weight)
+		{
+			A2 += a * a * weight;  B2 += b * b * weight;  C2 += c * c * weight;  D2 += d * d * weight;
+			AB += a * b * weight;  AC += a * c * weight;  AD += a * d * weight;
+			BC += b * c * weight;  BD += b * d * weight;  CD += c * d * weight;
+			Weight += weight;
+		}
+
+		void Add(const Quadric& q)
+		{
+			A2 += q.A2;  B2 += q.B2;  C2 += q.C2;  D2 += q.D2;
+			AB += q.AB;  AC += q.AC;  AD += q.AD;
+			BC += q.BC;  BD += q.BD;  CD += q.CD;
+			Weight += q.Weight;
+		}
+
+		// Weighted mean squared distance of p to the planes.
+		double Evaluate(const Vec3& p)const
+		{
+			double x = p.X, y = p.Y, z = p.Z;
+			double sum =
+				A2 * x * x + B2 * y * y + C2 * z * z + D2 +
+				2.0 * (AB * x * y + AC * x * z + BC * y * z) +
+				2.0 * (AD * x + BD * y + CD * z);
+			return Weight > 0.0 ? std::fabs(sum) / Weight : 0.0;
+		}
+	};
+
+	enum class VertexKind : std::uint8_t
+	{
+		Manifold,
+		// On an open border with one edge in and one out; slides along the border.
+		Border,
+		// Attribute seams and non-manifold vertices.
+		Locked
+	};
+
+	struct Collapse
+	{
+		std::uint32_t From;
+		std::uint32_t To;
+		double Error;
+	};
+
+	// Maps every vertex to the first vertex with the same position and marks the
+	// vertices that share their position with another one.
+	void WeldPositions(const float* positions, std::size_t positionStride, std::uint32_t vertexCount,
+		std::vector<std::uint32_t>& welded, std::vector<bool>& onSeam)
+	{
+		welded.resize(vertexCount);
+		onSeam.assign(vertexCount, false);
+
+		// Open addressing on the position bits.
+		const std::uint32_t Empty = 0xffffffff;
+		std::size_t capacity = 16;
+		while (capacity < (std::size_t)vertexCount * 2)
+			capacity *= 2;
+		std::vector<std::uint32_t> firstByPosition(capacity, Empty);
+
+		for (std::uint32_t v = 0; v < vertexCount; ++v)
+		{
+			// Adding zero turns -0 into +0, so both hash and compare alike.
+			Vec3 p = LoadPosition(positions, positionStride, v);
+			p = { p.X + 0.0f, p.Y + 0.0f, p.Z + 0.0f };
+			std::uint32_t bits[3];
+			std::memcpy(bits, p.Bits(), sizeof(bits));
+			std::size_t slot = ((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) & (capacity - 1);
+
+			for (;; slot = (slot + 1) & (capacity - 1))
+			{
+				std::uint32_t first = firstByPosition[slot];
+				if (first == Empty)
+				{
+					firstByPosition[slot] = v;
+					welded[v] = v;
+					break;
+				}
+
+				Vec3 q = LoadPosition(positions, positionStride, first);
+				if (q.X == p.X && q.Y == p.Y && q.Z == p.Z)
+				{
+					welded[v] = first;
+					onSeam[v] = true;
+					onSeam[first] = true;
+					break;
+				}
+			}
+		}
+	}
+}
+
+float MeshSimplifier::GetScale(const float* positions, std::size_t positionStride, std::uint32_t vertexCount)
+{
+	if (vertexCount == 0)
+		return 0.0f;
+
+	Vec3 lo = LoadPosition(positions, positionStride, 0);
+	Vec3 hi = lo;
+	for (std::uint32_t v = 1; v < vertexCount; ++v)
+	{
+		Vec3 p = LoadPosition(positions, positionStride, v);
+		lo.X = std::min(lo.X, p.X);  hi.X = std::max(hi.X, p.X);
+		lo.Y = std::min(lo.Y, p.Y);  hi.Y = std::max(hi.Y, p.Y);
+		lo.Z = std::min(lo.Z, p.Z);  hi.Z = std::max(hi.Z, p.Z);
+	}
+
+	return std::max(hi.X - lo.X, std::max(hi.Y - lo.Y, hi.Z - lo.Z));
+}
+
+std::size_t MeshSimplifier::Simplify(std::uint32_t* destination, const std::uint32_t* indices, std::size_t indexCount,
+	const float* positions, std::size_t positionStride, std::uint32_t vertexCount,
+	std::size_t targetIndexCount, float targetError, float* resultError,
+	const float* attributes, std::size_t attributeStride, const float* attributeWeights, std::size_t attributeCount)
+{
+	assert(indexCount % 3 == 0);
+
+	// Work in a unit box so errors are relative to the mesh size.
+	float scale = GetScale(positions, positionStride, vertexCount);
+	float inverseScale = scale > 0.0f ? 1.0f / scale : 1.0f;
+
+	std::vector<Vec3> points(vertexCount);
+	for (std::uint32_t v = 0; v < vertexCount; ++v)
+	{
+		Vec3 p = LoadPosition(positions, positionStride, v);
+		points[v] = { p.X * inverseScale, p.Y * inverseScale, p.Z * inverseScale };
+	}
+
+	std::vector<std::uint32_t> welded;
+	std::vector<bool> onSeam;
+	WeldPositions(positions, positionStride, vertexCount, welded, onSeam);
+
+	// Triangles that reuse an index are dropped right away.
+	std::vector<std::uint32_t> current;
+	current.reserve(indexCount);
+	for (std::size_t i = 0; i < indexCount; i += 3)
+	{
+		std::uint32_t a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+		assert(a < vertexCount && b < vertexCount && c < vertexCount);
+		if (welded[a] != welded[b] && welded[b] != welded[c] && welded[a] != welded[c])
+			current.insert(current.end(), { a, b, c });
+	}
+
+	// Triangles around every welded vertex, and a bit per triangle edge that has no twin
+	// running the other way, i.e. lies on an open border.
+	std::vector<std::uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<std::uint32_t> adjacency;
+	std::vector<std::uint8_t> borderEdges;
+
+	auto buildTopology = [&]()
+	{
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (std::uint32_t v : current)
+			++adjacencyOffsets[welded[v] + 1];
+		std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+
+		adjacency.resize(current.size());
+		std::vector<std::uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (std::size_t i = 0; i < current.size(); ++i)
+			adjacency[fill[welded[current[i]]]++] = (std::uint32_t)(i / 3);
+
+		borderEdges.assign(current.size() / 3, 0);
+		for (std::size_t t = 0; t < current.size() / 3; ++t)
+		{
+			for (int e = 0; e < 3; ++e)
+			{
+				std::uint32_t a = welded[current[t * 3 + e]], b = welded[current[t * 3 + (e + 1) % 3]];
+
+				bool twin = false;
+				for (std::uint32_t k = adjacencyOffsets[b]; k < adjacencyOffsets[b + 1] && !twin; ++k)
+				{
+					const std::uint32_t* other = &current[adjacency[k] * 3];
+					for (int j = 0; j < 3; ++j)
+						twin |= welded[other[j]] == b && welded[other[(j + 1) % 3]] == a;
+				}
+
+				if (!twin)
+					borderEdges[t] |= 1 << e;
+			}
+		}
+	};
+
+	// Plane quadrics per welded vertex, plus a perpendicular plane along every border
+	// edge so borders resist moving inwards.
+	std::vector<Quadric> quadrics(vertexCount);
+	{
+		buildTopology();
+		for (std::size_t i = 0; i < current.size(); i += 3)
+		{
+			const std::uint32_t* t = &current[i];
+			Vec3 p0 = points[t[0]], p1 = points[t[1]], p2 = points[t[2]];
+			Vec3 n = Cross(Sub(p1, p0), Sub(p2, p0));
+			float length = std::sqrt(Dot(n, n));
+			if (length == 0.0f)
+				continue;
+
+			n = { n.X / length, n.Y / length, n.Z / length };
+			float area = length * 0.5f;
+			float d = -Dot(n, p0);
+			for (int k = 0; k < 3; ++k)
+				quadrics[welded[t[k]]].AddPlane(n.X, n.Y, n.Z, d, area);
+
+			for (int e = 0; e < 3; ++e)
+			{
+				if (!(borderEdges[i / 3] & (1 << e)))
+					continue;
+
+				std::uint32_t a = t[e], b = t[(e + 1) % 3];
+
+				Vec3 edge = Sub(points[b], points[a]);
+				Vec3 en = Cross(edge, n);
+				float enLength = std::sqrt(Dot(en, en));
+				if (enLength == 0.0f)
+					continue;
+
+				en = { en.X / enLength, en.Y / enLength, en.Z / enLength };
+				float ed = -Dot(en, points[a]);
+				float weight = Dot(edge, edge) * BorderWeight;
+				quadrics[welded[a]].AddPlane(en.X, en.Y, en.Z, ed, weight);
+				quadrics[welded[b]].AddPlane(en.X, en.Y, en.Z, ed, weight);
+			}
+		}
+	}
+
+	auto attributeError = [&](std::uint32_t u, std::uint32_t v)
+	{
+		if (attributes == nullptr)
+			return 0.0;
+
+		const float* au = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(attributes) + attributeStride * u);
+		const float* av = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(attributes) + attributeStride * v);
+		double error = 0.0;
+		for (std::size_t k = 0; k < attributeCount; ++k)
+		{
+			double d = (au[k] - av[k]) * (attributeWeights != nullptr ? attributeWeights[k] : 1.0f);
+			error += d * d;
+		}
+		return error;
+	};
+
+	const double targetErrorSq = (double)targetError * targetError;
+	double maxError = 0.0;
+	std::size_t triangleCount = current.size() / 3;
+	const std::size_t targetTriangleCount = targetIndexCount / 3;
+
+	std::vector<VertexKind> kinds(vertexCount);
+	std::vector<std::uint32_t> borderEdgeCounts(vertexCount);
+	std::vector<Collapse> collapses;
+	std::vector<std::uint32_t> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+
+	while (triangleCount > targetTriangleCount)
+	{
+		buildTopology();
+
+		std::fill(borderEdgeCounts.begin(), borderEdgeCounts.end(), 0);
+		for (std::size_t i = 0; i < current.size(); i += 3)
+		{
+			for (int e = 0; e < 3; ++e)
+			{
+				std::uint32_t a = current[i + e], b = current[i + (e + 1) % 3];
+				if (borderEdges[i / 3] & (1 << e))
+				{
+					++borderEdgeCounts[a];
+					++borderEdgeCounts[b];
+				}
+			}
+		}
+
+		for (std::uint32_t v = 0; v < vertexCount; ++v)
+		{
+			if (onSeam[v])
+				kinds[v] = VertexKind::Locked;
+			else if (borderEdgeCounts[v] == 0)
+				kinds[v] = VertexKind::Manifold;
+			else
+				kinds[v] = borderEdgeCounts[v] == 2 ? VertexKind::Border : VertexKind::Locked;
+		}
+
+		// Cheapest allowed direction of every edge.
+		auto canCollapse = [&](std::uint32_t u, std::uint32_t v, bool borderEdge)
+		{
+			switch (kinds[u])
+			{
+			case VertexKind::Manifold:
+				return true;
+			case VertexKind::Border:
+				return borderEdge && kinds[v] != VertexKind::Manifold;
+			default:
+				return false;
+			}
+		};
+
+		auto collapseError = [&](std::uint32_t u, std::uint32_t v)
+		{
+			Quadric q = quadrics[welded[u]];
+			q.Add(quadrics[welded[v]]);
+			return q.Evaluate(points[v]) + attributeError(u, v);
+		};
+
+		collapses.clear();
+		for (std::size_t i = 0; i < current.size(); i += 3)
+		{
+			for (int e = 0; e < 3; ++e)
+			{
+				std::uint32_t a = current[i + e], b = current[i + (e + 1) % 3];
+				bool borderEdge = (borderEdges[i / 3] & (1 << e)) != 0;
+
+				// Interior edges show up once from each side; take them from one.
+				if (!borderEdge && a > b)
+					continue;
+
+				Collapse best = { 0, 0, -1.0 };
+				if (canCollapse(a, b, borderEdge))
+					best = { a, b, collapseError(a, b) };
+				if (canCollapse(b, a, borderEdge))
+				{
+					double error = collapseError(b, a);
+					if (best.Error < 0.0 || error < best.Error)
+						best = { b, a, error };
+				}
+
+				if (best.Error >= 0.0 && best.Error <= targetErrorSq)
+					collapses.push_back(best);
+			}
+		}
+
+		if (collapses.empty())
+			break;
+
+		// Only take the cheapest collapses this pass; each removes about two triangles.
+		// When the cheapest ones are all rejected, the pass goes on to the dearer ones
+		// rather than stalling above the target.
+		std::size_t goal = std::max<std::size_t>(1, (triangleCount - targetTriangleCount) / 2);
+		std::size_t sorted = std::min(collapses.size(), goal + goal / 2);
+		auto byError = [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; };
+		std::nth_element(collapses.begin(), collapses.begin() + (sorted - 1), collapses.end(), byError);
+		std::sort(collapses.begin(), collapses.begin() + sorted, byError);
+
+		std::iota(remap.begin(), remap.end(), 0);
+		std::fill(touched.begin(), touched.end(), false);
+
+		std::size_t applied = 0;
+		for (std::size_t c = 0; c < collapses.size() && applied < goal && triangleCount > targetTriangleCount; ++c)
+		{
+			if (c == sorted)
+			{
+				std::sort(collapses.begin() + sorted, collapses.end(), byError);
+				sorted = collapses.size();
+			}
+
+			const Collapse& collapse = collapses[c];
+			std::uint32_t u = collapse.From, v = collapse.To;
+
+			// A vertex moves at most once per pass, so remap never has to be chased.  u is
+			// not on a seam, so its welded vertex is itself.
+			if (touched[u] || touched[v])
+				continue;
+
+			std::size_t removed = 0;
+			bool flips = false;
+			for (std::uint32_t k = adjacencyOffsets[u]; k < adjacencyOffsets[u + 1] && !flips; ++k)
+			{
+				const std::uint32_t* t = &current[adjacency[k] * 3];
+				std::uint32_t r[3] = { remap[t[0]], remap[t[1]], remap[t[2]] };
+				std::uint32_t w[3] = { welded[r[0]], welded[r[1]], welded[r[2]] };
+				if (w[0] == w[1] || w[1] == w[2] || w[0] == w[2])
+					continue;
+
+				if (w[0] == welded[v] || w[1] == welded[v] || w[2] == welded[v])
+				{
+					++removed;
+					continue;
+				}
+
+				// The triangle must keep facing about the same way with u moved onto v.
+				// Limiting the turn of each collapse keeps folds from building up over
+				// several of them.
+				Vec3 before[3] = { points[r[0]], points[r[1]], points[r[2]] };
+				Vec3 after[3] = { before[0], before[1], before[2] };
+				for (int j = 0; j < 3; ++j)
+				{
+					if (r[j] == u)
+						after[j] = points[v];
+				}
+
+				Vec3 n0 = Cross(Sub(before[1], before[0]), Sub(before[2], before[0]));
+				Vec3 n1 = Cross(Sub(after[1], after[0]), Sub(after[2], after[0]));
+				flips = Dot(n0, n1) <= MaxFlipCosine * std::sqrt(Dot(n0, n0) * Dot(n1, n1));
+			}
+
+			if (flips)
+				continue;
+
+			remap[u] = v;
+			touched[u] = touched[v] = true;
+			quadrics[welded[v]].Add(quadrics[welded[u]]);
+
+			triangleCount -= removed;
+			maxError = std::max(maxError, collapse.Error);
+			++applied;
+		}
+
+		if (applied == 0)
+			break;
+
+		std::size_t write = 0;
+		for (std::size_t i = 0; i < current.size(); i += 3)
+		{
+			std::uint32_t a = remap[current[i + 0]], b = remap[current[i + 1]], c = remap[current[i + 2]];
+			if (welded[a] != welded[b] && welded[b] != welded[c] && welded[a] != welded[c])
+			{
+				current[write++] = a;
+				current[write++] = b;
+				current[write++] = c;
+			}
+		}
+		current.resize(write);
+		triangleCount = write / 3;
+	}
+
+	std::copy(current.begin(), current.end(), destination);
+	if (resultError != nullptr)
+		*resultError = (float)std::sqrt(maxError);
+
+	return current.size();
+}
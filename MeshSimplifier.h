@@ -0,0 +1,45 @@
+//***************************************************************************************
+// MeshSimplifier.h
+//
+// Triangle list simplification by edge collapse with quadric error metrics (Garland and
+// Heckbert), for building LOD chains.
+//
+// Collapses move one vertex onto a neighbour instead of placing a new one, so the result
+// is a new index list into the original vertex buffer and every LOD can share it.
+// Vertices are welded by position to find the mesh topology:
+//
+//   - vertices on an attribute seam (several vertices at one position) are never moved,
+//     so UV and normal seams do not tear;
+//   - vertices on an open border only slide along the border, and border edges add
+//     extra planes to their quadrics so the outline is kept;
+//   - collapses that would flip a triangle are rejected.
+//
+// Attributes (normals, texture coordinates) add a weighted squared difference to the
+// cost of a collapse, which keeps detail where shading changes quickly.
+//
+// Errors are distances relative to the mesh extent (see GetScale), so the same target
+// works for meshes of any size.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MeshSimplifier
+{
+	// Writes at most indexCount indices to destination and returns how many were written.
+	// Stops at targetIndexCount, or earlier when the next collapse would exceed
+	// targetError.  resultError, if given, receives the largest error introduced.
+	// attributes points at attributeCount floats per vertex, attributeStride bytes apart,
+	// each scaled by the matching attributeWeights entry; it may be null.
+	std::size_t Simplify(std::uint32_t* destination, const std::uint32_t* indices, std::size_t indexCount,
+		const float* positions, std::size_t positionStride, std::uint32_t vertexCount,
+		std::size_t targetIndexCount, float targetError, float* resultError = nullptr,
+		const float* attributes = nullptr, std::size_t attributeStride = 0,
+		const float* attributeWeights = nullptr, std::size_t attributeCount = 0);
+
+	// The largest side of the bounding box of the vertices; multiply a relative error by
+	// it to get a distance in the mesh's units.
+	float GetScale(const float* positions, std::size_t positionStride, std::uint32_t vertexCount);
+}
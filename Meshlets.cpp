@@ -0,0 +1,322 @@
+#include "Meshlets.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	struct Vec3
+	{
+		float X, Y, Z;
+	};
+
+	Vec3 LoadPosition(const float* positions, std::size_t stride, std::uint32_t index)
+	{
+		const float* p = reinterpret_cast<const float*>(reinterpret_cast<const unsigned char*>(positions) + stride * index);
+		Vec3 v = { p[0], p[1], p[2] };
+		return v;
+	}
+
+	Vec3 Sub(const Vec3& a, const Vec3& b)
+	{
+		Vec3 v = { a.X - b.X, a.Y - b.Y, a.Z - b.Z };
+		return v;
+	}
+
+	float Dot(const Vec3& a, const Vec3& b)
+	{
+		return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+	}
+
+	Vec3 Cross(const Vec3& a, const Vec3& b)
+	{
+		Vec3 v = { a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X };
+		return v;
+	}
+
+	const std::uint8_t NotInMeshlet = 0xff;
+
+	// Ritter's bounding sphere: a sphere over two far apart points, grown to take in
+	// the rest.  Within a few percent of the minimal sphere for typical clusters.
+	void ComputeSphere(const MeshletSet& set, const Meshlet& meshlet, const float* positions,
+		std::size_t positionStride, MeshletBounds& bounds)
+	{
+		const std::uint32_t* vertices = set.Vertices.data() + meshlet.VertexOffset;
+
+		auto farthestFrom = [&](const Vec3& from)
+		{
+			Vec3 farthest = from;
+			float maxDistanceSq = -1.0f;
+			for (std::uint32_t i = 0; i < meshlet.VertexCount; ++i)
+			{
+				Vec3 p = LoadPosition(positions, positionStride, vertices[i]);
+				Vec3 d = Sub(p, from);
+				float distanceSq = Dot(d, d);
+				if (distanceSq > maxDistanceSq)
+				{
+					maxDistanceSq = distanceSq;
+					farthest = p;
+				}
+			}
+			return farthest;
+		};
+
+		Vec3 a = farthestFrom(LoadPosition(positions, positionStride, vertices[0]));
+		Vec3 b = farthestFrom(a);
+
+		Vec3 center = { (a.X + b.X) * 0.5f, (a.Y + b.Y) * 0.5f, (a.Z + b.Z) * 0.5f };
+		Vec3 ab = Sub(b, a);
+		float radius = std::sqrt(Dot(ab, ab)) * 0.5f;
+
+		for (std::uint32_t i = 0; i < meshlet.VertexCount; ++i)
+		{
+			Vec3 p = LoadPosition(positions, positionStride, vertices[i]);
+			Vec3 d = Sub(p, center);
+			float distance = std::sqrt(Dot(d, d));
+			if (distance > radius)
+			{
+				// Move the center towards p just enough to cover it and the old sphere.
+				float newRadius = (radius + distance) * 0.5f;
+				float t = (newRadius - radius) / distance;
+				center.X += d.X * t;
+				center.Y += d.Y * t;
+				center.Z += d.Z * t;
+				radius = newRadius;
+			}
+		}
+
+		bounds.Center[0] = center.X;
+		bounds.Center[1] = center.Y;
+		bounds.Center[2] = center.Z;
+		bounds.Radius = radius;
+	}
+
+	// Cone around the average triangle normal.  Normals are cross(b - a, c - a), which
+	// faces out of clockwise triangles, D3D's default front face.
+	void ComputeCone(const MeshletSet& set, const Meshlet& meshlet, const float* positions,
+		std::size_t positionStride, MeshletBounds& bounds)
+	{
+		const std::uint32_t* vertices = set.Vertices.data() + meshlet.VertexOffset;
+		const std::uint8_t* triangles = set.Triangles.data() + meshlet.TriangleOffset * 3;
+
+		auto triangleNormal = [&](std::uint32_t t, Vec3& normal)
+		{
+			Vec3 a = LoadPosition(positions, positionStride, vertices[triangles[t * 3 + 0]]);
+			Vec3 b = LoadPosition(positions, positionStride, vertices[triangles[t * 3 + 1]]);
+			Vec3 c = LoadPosition(positions, positionStride, vertices[triangles[t * 3 + 2]]);
+			normal = Cross(Sub(b, a), Sub(c, a));
+
+			float length = std::sqrt(Dot(normal, normal));
+			if (length == 0.0f)
+				return false;
+
+			normal.X /= length;
+			normal.Y /= length;
+			normal.Z /= length;
+			return true;
+		};
+
+		Vec3 sum = { 0.0f, 0.0f, 0.0f };
+		for (std::uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+		{
+			Vec3 normal;
+			if (triangleNormal(t, normal))
+			{
+				sum.X += normal.X;
+				sum.Y += normal.Y;
+				sum.Z += normal.Z;
+			}
+		}
+
+		float length = std::sqrt(Dot(sum, sum));
+		if (length < 1e-6f)
+			return;
+
+		Vec3 axis = { sum.X / length, sum.Y / length, sum.Z / length };
+		float cutoff = 1.0f;
+		for (std::uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+		{
+			Vec3 normal;
+			if (triangleNormal(t, normal))
+				cutoff = std::min(cutoff, Dot(axis, normal));
+		}
+
+		bounds.ConeAxis[0] = axis.X;
+		bounds.ConeAxis[1] = axis.Y;
+		bounds.ConeAxis[2] = axis.Z;
+		bounds.ConeCutoff = cutoff;
+	}
+}
+
+void MeshletSet::Clear()
+{
+	Meshlets.clear();
+	Bounds.clear();
+	Vertices.clear();
+	Triangles.clear();
+	Submeshes.clear();
+}
+
+MeshletRange Meshlets::Build(MeshletSet& set, const std::uint32_t* indices, std::size_t indexCount,
+	const float* positions, std::size_t positionStride, std::uint32_t vertexCount,
+	std::uint32_t maxVertices, std::uint32_t maxTriangles)
+{
+	assert(maxVertices >= 3 && maxVertices < NotInMeshlet);
+	assert(maxTriangles >= 1);
+	assert(indexCount % 3 == 0);
+
+	MeshletRange range;
+	range.FirstMeshlet = (std::uint32_t)set.Meshlets.size();
+
+	// Position of each vertex within the meshlet being filled.
+	std::vector<std::uint8_t> localIndex(vertexCount, NotInMeshlet);
+
+	Meshlet current;
+	current.VertexOffset = (std::uint32_t)set.Vertices.size();
+	current.TriangleOffset = (std::uint32_t)(set.Triangles.size() / 3);
+
+	auto finish = [&]()
+	{
+		if (current.TriangleCount == 0)
+			return;
+
+		for (std::uint32_t i = 0; i < current.VertexCount; ++i)
+			localIndex[set.Vertices[current.VertexOffset + i]] = NotInMeshlet;
+
+		MeshletBounds bounds;
+		ComputeSphere(set, current, positions, positionStride, bounds);
+		ComputeCone(set, current, positions, positionStride, bounds);
+
+		set.Meshlets.push_back(current);
+		set.Bounds.push_back(bounds);
+		++range.MeshletCount;
+
+		current = Meshlet();
+		current.VertexOffset = (std::uint32_t)set.Vertices.size();
+		current.TriangleOffset = (std::uint32_t)(set.Triangles.size() / 3);
+	};
+
+	for (std::size_t i = 0; i < indexCount; i += 3)
+	{
+		const std::uint32_t triangle[3] = { indices[i + 0], indices[i + 1], indices[i + 2] };
+		assert(triangle[0] < vertexCount && triangle[1] < vertexCount && triangle[2] < vertexCount);
+
+		// Index-degenerate triangles never produce pixels.
+		if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+			continue;
+
+		std::uint32_t newVertices = 0;
+		for (std::uint32_t v : triangle)
+			newVertices += localIndex[v] == NotInMeshlet ? 1 : 0;
+
+		if (current.VertexCount + newVertices > maxVertices || current.TriangleCount == maxTriangles)
+			finish();
+
+		for (std::uint32_t v : triangle)
+		{
+			if (localIndex[v] == NotInMeshlet)
+			{
+				localIndex[v] = (std::uint8_t)current.VertexCount++;
+				set.Vertices.push_back(v);
+			}
+			set.Triangles.push_back(localIndex[v]);
+		}
+		++current.TriangleCount;
+	}
+
+	finish();
+	return range;
+}
+
+void Meshlets::ExtractFrustumPlanes(const float viewProj[16], float planes[6][4])
+{
+	// With row vectors, clip coordinate j is the dot product with column j.
+	auto column = [&](int j, int r) { return viewProj[r * 4 + j]; };
+
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+	const int axis[6] = { 0, 0, 1, 1, 2, 2 };
+	const float sign[6] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+
+	for (int p = 0; p < 6; ++p)
+	{
+		for (int r = 0; r < 4; ++r)
+		{
+			float w = column(3, r);
+			float a = column(axis[p], r);
+			// The near plane is z >= 0 by itself.
+			planes[p][r] = p == 4 ? a : w + sign[p] * a;
+		}
+
+		float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+		if (length > 0.0f)
+		{
+			for (int r = 0; r < 4; ++r)
+				planes[p][r] /= length;
+		}
+	}
+}
+
+MeshletCullStats Meshlets::Cull(const MeshletSet& set, MeshletRange range, const MeshletCullParams& params,
+	std::vector<std::uint32_t>& indices)
+{
+	MeshletCullStats stats;
+	const Vec3 camera = { params.CameraPosition[0], params.CameraPosition[1], params.CameraPosition[2] };
+
+	for (std::uint32_t m = range.FirstMeshlet; m < range.FirstMeshlet + range.MeshletCount; ++m)
+	{
+		const MeshletBounds& bounds = set.Bounds[m];
+		const Vec3 center = { bounds.Center[0], bounds.Center[1], bounds.Center[2] };
+
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; ++p)
+		{
+			const float* plane = params.FrustumPlanes[p];
+			outside = plane[0] * center.X + plane[1] * center.Y + plane[2] * center.Z + plane[3] < -bounds.Radius;
+		}
+		if (outside)
+		{
+			++stats.FrustumCulled;
+			continue;
+		}
+
+		Vec3 toCenter = Sub(center, camera);
+		float distance = std::sqrt(Dot(toCenter, toCenter));
+
+		// Backfacing if every normal in the cone points away from every point of the
+		// sphere: |d| cos(phi + theta) > r, with phi the angle between the axis and d.
+		if (params.BackfaceCulling && bounds.ConeCutoff > 0.0f && distance > bounds.Radius)
+		{
+			const Vec3 axis = { bounds.ConeAxis[0], bounds.ConeAxis[1], bounds.ConeAxis[2] };
+			float cosPhi = Dot(toCenter, axis) / distance;
+			float sinPhi = std::sqrt(std::max(0.0f, 1.0f - cosPhi * cosPhi));
+			float sinTheta = std::sqrt(std::max(0.0f, 1.0f - bounds.ConeCutoff * bounds.ConeCutoff));
+
+			if (distance * (cosPhi * bounds.ConeCutoff - sinPhi * sinTheta) > bounds.Radius)
+			{
+				++stats.BackfaceCulled;
+				continue;
+			}
+		}
+
+		if (params.ProjectionScale > 0.0f && distance > bounds.Radius &&
+			bounds.Radius * params.ProjectionScale < params.MinPixelRadius * distance)
+		{
+			++stats.SmallCulled;
+			continue;
+		}
+
+		const Meshlet& meshlet = set.Meshlets[m];
+		const std::uint32_t* vertices = set.Vertices.data() + meshlet.VertexOffset;
+		const std::uint8_t* triangles = set.Triangles.data() + meshlet.TriangleOffset * 3;
+
+		std::size_t first = indices.size();
+		indices.resize(first + meshlet.TriangleCount * 3);
+		for (std::uint32_t i = 0; i < meshlet.TriangleCount * 3; ++i)
+			indices[first + i] = vertices[triangles[i]];
+
+		++stats.Visible;
+		stats.IndexCount += meshlet.TriangleCount * 3;
+	}
+
+	return stats;
+}
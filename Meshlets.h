@@ -0,0 +1,113 @@
+//***************************************************************************************
+// Meshlets.h
+//
+// Splits triangle lists into small clusters (meshlets) with bounded vertex and triangle
+// counts, and culls them on the CPU.
+//
+// A meshlet stores its unique vertices as indices into the mesh's vertex buffer and its
+// triangles as byte triplets into that list.  Each meshlet has a bounding sphere and a
+// normal cone, so whole clusters can be rejected when they are outside the frustum,
+// facing away from the camera or smaller than a pixel.  Cull writes the triangles of the
+// surviving meshlets back out as one compacted index list, which can be drawn with an
+// ordinary DrawIndexedInstanced; no mesh shaders are needed.
+//
+// Build works through the triangles in index order, so run MeshOptimizer's
+// OptimizeVertexCache first; it keeps neighbouring triangles together.
+//
+// The sample's own draw path does not call Cull: its items are drawn in instanced
+// batches, while Cull works in one instance's local space and produces one index list
+// per instance.  Tests/MeshletsTests.cpp covers it and Tests/BenchMeshlets.cpp times it.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Meshlet
+{
+	// Into MeshletSet::Vertices.
+	std::uint32_t VertexOffset = 0;
+	std::uint32_t VertexCount = 0;
+	// Into MeshletSet::Triangles, in triangles (three bytes each).
+	std::uint32_t TriangleOffset = 0;
+	std::uint32_t TriangleCount = 0;
+};
+
+struct MeshletBounds
+{
+	float Center[3] = { 0.0f, 0.0f, 0.0f };
+	float Radius = 0.0f;
+
+	// Every triangle normal is within acos(ConeCutoff) of ConeAxis.  Clusters whose
+	// normals spread over a hemisphere or more have ConeCutoff <= 0 and are never
+	// backface culled.
+	float ConeAxis[3] = { 0.0f, 0.0f, 1.0f };
+	float ConeCutoff = -1.0f;
+};
+
+struct MeshletRange
+{
+	std::uint32_t FirstMeshlet = 0;
+	std::uint32_t MeshletCount = 0;
+};
+
+// The meshlets of a whole mesh; Submeshes[h] holds the meshlets of submesh h.
+struct MeshletSet
+{
+	std::vector<Meshlet> Meshlets;
+	std::vector<MeshletBounds> Bounds;
+	// Vertex buffer indices, relative to the submesh's base vertex.
+	std::vector<std::uint32_t> Vertices;
+	std::vector<std::uint8_t> Triangles;
+	std::vector<MeshletRange> Submeshes;
+
+	void Clear();
+	bool Empty()const { return Meshlets.empty(); }
+};
+
+// Everything in the mesh's local space.
+struct MeshletCullParams
+{
+	// ax + by + cz + d >= 0 inside, in the order left, right, bottom, top, near, far.
+	float FrustumPlanes[6][4] = {};
+	float CameraPosition[3] = { 0.0f, 0.0f, 0.0f };
+	bool BackfaceCulling = true;
+
+	// Pixels covered by one unit at distance one (viewport height * 0.5 * proj._22).
+	// Meshlets with a projected radius under MinPixelRadius are dropped; 0 turns this off.
+	float ProjectionScale = 0.0f;
+	float MinPixelRadius = 0.5f;
+};
+
+struct MeshletCullStats
+{
+	std::uint32_t Visible = 0;
+	std::uint32_t FrustumCulled = 0;
+	std::uint32_t BackfaceCulled = 0;
+	std::uint32_t SmallCulled = 0;
+	std::uint32_t IndexCount = 0;
+};
+
+namespace Meshlets
+{
+	// 124 triangles rather than 128 leaves room for per-primitive data in a 128-entry
+	// mesh shader output; the vertex limit must stay below 256.
+	const std::uint32_t DefaultMaxVertices = 64;
+	const std::uint32_t DefaultMaxTriangles = 124;
+
+	// Appends the meshlets of one triangle list to set and returns their range.
+	// positions points at the first vertex's float3 position, positionStride bytes apart.
+	MeshletRange Build(MeshletSet& set, const std::uint32_t* indices, std::size_t indexCount,
+		const float* positions, std::size_t positionStride, std::uint32_t vertexCount,
+		std::uint32_t maxVertices = DefaultMaxVertices, std::uint32_t maxTriangles = DefaultMaxTriangles);
+
+	// Frustum planes of a row-major view-projection matrix (row vectors, D3D clip space);
+	// with a world-view-projection matrix they come out in local space.
+	void ExtractFrustumPlanes(const float viewProj[16], float planes[6][4]);
+
+	// Appends the indices of the meshlets in range that pass the tests to indices.
+	MeshletCullStats Cull(const MeshletSet& set, MeshletRange range, const MeshletCullParams& params,
+		std::vector<std::uint32_t>& indices);
+}
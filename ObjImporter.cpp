@@ -0,0 +1,670 @@
+#include "ObjImporter.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+	const std::int32_t MissingIndex = std::numeric_limits<std::int32_t>::min();
+	const std::uint32_t MissingGlobal = 0xffffffff;
+
+	const std::uint8_t RelativePosition = 1;
+	const std::uint8_t RelativeTexCoord = 2;
+	const std::uint8_t RelativeNormal = 4;
+
+	bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	const char* SkipSpace(const char* p, const char* end)
+	{
+		while (p < end && IsSpace(*p))
+			++p;
+		return p;
+	}
+
+	// Locale-independent and much cheaper than strtof; exact for the short decimals
+	// exporters write.
+	const char* ParseFloat(const char* p, const char* end, float& value)
+	{
+		static const double PowersOf10[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negative = *p == '-';
+			++p;
+		}
+
+		std::uint64_t mantissa = 0;
+		int significantDigits = 0;
+		int exponent = 0;
+		bool anyDigits = false;
+
+		for (; p < end && *p >= '0' && *p <= '9'; ++p)
+		{
+			anyDigits = true;
+			if (significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0)
+					++significantDigits;
+			}
+			else
+			{
+				++exponent;
+			}
+		}
+
+		if (p < end && *p == '.')
+		{
+			for (++p; p < end && *p >= '0' && *p <= '9'; ++p)
+			{
+				anyDigits = true;
+				if (significantDigits < 19)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					if (mantissa != 0)
+						++significantDigits;
+					--exponent;
+				}
+			}
+		}
+
+		if (!anyDigits)
+			return nullptr;
+
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			bool negativeExponent = false;
+			if (p < end && (*p == '-' || *p == '+'))
+			{
+				negativeExponent = *p == '-';
+				++p;
+			}
+			if (p >= end || *p < '0' || *p > '9')
+				return nullptr;
+
+			int e = 0;
+			for (; p < end && *p >= '0' && *p <= '9'; ++p)
+				e = std::min(e * 10 + (*p - '0'), 10000);
+			exponent += negativeExponent ? -e : e;
+		}
+
+		double result = (double)mantissa;
+		if (exponent > 0)
+			result *= exponent <= 22 ? PowersOf10[exponent] : std::pow(10.0, exponent);
+		else if (exponent < 0)
+			result /= exponent >= -22 ? PowersOf10[-exponent] : std::pow(10.0, -exponent);
+
+		value = (float)(negative ? -result : result);
+		return p;
+	}
+
+	const char* ParseInt(const char* p, const char* end, std::int64_t& value)
+	{
+		bool negative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negative = *p == '-';
+			++p;
+		}
+
+		if (p >= end || *p < '0' || *p > '9')
+			return nullptr;
+
+		std::int64_t result = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; ++p)
+			result = std::min<std::int64_t>(result * 10 + (*p - '0'), std::numeric_limits<std::int32_t>::max());
+
+		value = negative ? -result : result;
+		return p;
+	}
+
+	bool StartsWithWord(const char* p, const char* end, const char* word)
+	{
+		std::size_t length = std::strlen(word);
+		return (std::size_t)(end - p) >= length && std::memcmp(p, word, length) == 0 &&
+			((std::size_t)(end - p) == length || IsSpace(p[length]));
+	}
+
+	std::string RestOfLine(const char* p, const char* end)
+	{
+		p = SkipSpace(p, end);
+		while (end > p && IsSpace(end[-1]))
+			--end;
+		return std::string(p, end);
+	}
+
+	// Open addressing map from (position, texcoord, normal) to output vertex.
+	class CornerMap
+	{
+	public:
+		explicit CornerMap(std::size_t expectedCount)
+		{
+			std::size_t capacity = 16;
+			while (capacity < expectedCount * 2)
+				capacity *= 2;
+			mSlots.assign(capacity, Slot());
+		}
+
+		// Returns the vertex of the corner, or inserts newValue and returns it.
+		std::uint32_t FindOrInsert(std::uint32_t p, std::uint32_t t, std::uint32_t n, std::uint32_t newValue)
+		{
+			if ((mCount + 1) * 10 > mSlots.size() * 7)
+				Grow();
+
+			std::size_t mask = mSlots.size() - 1;
+			for (std::size_t i = Hash(p, t, n) & mask;; i = (i + 1) & mask)
+			{
+				Slot& slot = mSlots[i];
+				if (slot.Value == MissingGlobal)
+				{
+					slot.P = p;
+					slot.T = t;
+					slot.N = n;
+					slot.Value = newValue;
+					++mCount;
+					return newValue;
+				}
+				if (slot.P == p && slot.T == t && slot.N == n)
+					return slot.Value;
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			std::uint32_t P = 0;
+			std::uint32_t T = 0;
+			std::uint32_t N = 0;
+			std::uint32_t Value = MissingGlobal;
+		};
+
+		static std::size_t Hash(std::uint32_t p, std::uint32_t t, std::uint32_t n)
+		{
+			std::uint64_t h = p * 0x9E3779B97F4A7C15ull;
+			h ^= (t + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+			h ^= (n + 0x165667B19E3779F9ull) * 0x85EBCA77C2B2AE63ull;
+			h ^= h >> 29;
+			return (std::size_t)h;
+		}
+
+		void Grow()
+		{
+			std::vector<Slot> old;
+			old.swap(mSlots);
+			mSlots.assign(old.size() * 2, Slot());
+			mCount = 0;
+
+			std::size_t mask = mSlots.size() - 1;
+			for (const Slot& slot : old)
+			{
+				if (slot.Value == MissingGlobal)
+					continue;
+				std::size_t i = Hash(slot.P, slot.T, slot.N) & mask;
+				while (mSlots[i].Value != MissingGlobal)
+					i = (i + 1) & mask;
+				mSlots[i] = slot;
+				++mCount;
+			}
+		}
+
+		std::vector<Slot> mSlots;
+		std::size_t mCount = 0;
+	};
+}
+
+struct ObjImporter::Chunk
+{
+	const char* Begin = nullptr;
+	const char* End = nullptr;
+
+	std::vector<float> Positions;
+	std::vector<float> TexCoords;
+	std::vector<float> Normals;
+
+	// One per triangle corner, 0-based.  A Relative* bit means the index came from a
+	// negative OBJ index and counts from the chunk's first element (it may point into an
+	// earlier chunk, i.e. be negative).
+	struct Corner
+	{
+		std::int32_t P = MissingIndex;
+		std::int32_t T = MissingIndex;
+		std::int32_t N = MissingIndex;
+		std::uint8_t Relative = 0;
+	};
+	std::vector<Corner> Corners;
+
+	// Group started at Corners[FirstCorner].
+	struct Group
+	{
+		std::size_t FirstCorner = 0;
+		std::string Name;
+	};
+	std::vector<Group> Groups;
+
+	const char* ErrorAt = nullptr;
+	const char* Error = nullptr;
+};
+
+double ObjImportStats::MegabytesPerSecond()const
+{
+	return TotalSeconds() > 0.0 ? (double)ByteSize / (1024.0 * 1024.0) / TotalSeconds() : 0.0;
+}
+
+double ObjImportStats::TrianglesPerSecond()const
+{
+	return TotalSeconds() > 0.0 ? (double)TriangleCount / TotalSeconds() : 0.0;
+}
+
+void ObjMesh::Get16BitIndices(std::vector<std::uint16_t>& indices)const
+{
+	indices.resize(Indices.size());
+	for (std::size_t i = 0; i < Indices.size(); ++i)
+		indices[i] = (std::uint16_t)Indices[i];
+}
+
+bool ObjImporter::ImportFile(const std::string& path, ObjMesh& mesh, WorkerPool* workers)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		mError = "cannot open " + path;
+		return false;
+	}
+	return Import(reinterpret_cast<const char*>(file.Data()), file.Size(), mesh, workers);
+}
+
+bool ObjImporter::Import(const char* text, std::size_t byteSize, ObjMesh& mesh, WorkerPool* workers)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	mError.clear();
+	mStats = ObjImportStats();
+	mStats.ByteSize = byteSize;
+	mesh = ObjMesh();
+
+	// Split at line boundaries.
+	const std::size_t threadCount = workers != nullptr ? workers->ThreadCount() : 1;
+	std::size_t chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(threadCount, byteSize / MinChunkSize));
+	std::vector<Chunk> chunks(chunkCount);
+
+	const char* end = text + byteSize;
+	const char* begin = text;
+	for (std::size_t i = 0; i < chunkCount; ++i)
+	{
+		const char* split = end;
+		if (i + 1 < chunkCount)
+		{
+			split = std::max(begin, text + byteSize * (i + 1) / chunkCount);
+			const char* newline = split < end ? static_cast<const char*>(std::memchr(split, '\n', end - split)) : nullptr;
+			split = newline != nullptr ? newline + 1 : end;
+		}
+		chunks[i].Begin = begin;
+		chunks[i].End = split;
+		begin = split;
+	}
+	mStats.ChunkCount = (std::uint32_t)chunkCount;
+
+	if (chunkCount == 1)
+		ParseChunk(chunks[0]);
+	else
+		workers->Run((std::uint32_t)chunkCount, [this, &chunks](std::uint32_t i) { ParseChunk(chunks[i]); });
+
+	for (const Chunk& chunk : chunks)
+	{
+		if (chunk.Error != nullptr)
+		{
+			std::size_t line = 1 + std::count(text, chunk.ErrorAt, '\n');
+			mError = "line " + std::to_string(line) + ": " + chunk.Error;
+			return false;
+		}
+	}
+
+	auto parsed = std::chrono::steady_clock::now();
+	mStats.ParseSeconds = std::chrono::duration<double>(parsed - start).count();
+
+	bool resolved = Resolve(chunks, mesh);
+
+	mStats.ResolveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - parsed).count();
+	mStats.TriangleCount = mesh.Indices.size() / 3;
+	mStats.VertexCount = mesh.Vertices.size();
+	return resolved;
+}
+
+void ObjImporter::ParseChunk(Chunk& chunk)const
+{
+	// Rough guess (a face line is ~30 bytes) to avoid most reallocations.
+	chunk.Corners.reserve((chunk.End - chunk.Begin) / 32);
+
+	std::vector<Chunk::Corner> face;
+
+	const char* line = chunk.Begin;
+	while (line < chunk.End)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', chunk.End - line));
+		if (lineEnd == nullptr)
+			lineEnd = chunk.End;
+
+		const char* p = SkipSpace(line, lineEnd);
+		const char* next = lineEnd + 1;
+
+		auto fail = [&](const char* error)
+		{
+			chunk.ErrorAt = line;
+			chunk.Error = error;
+		};
+
+		if (p + 1 < lineEnd && p[0] == 'v' && IsSpace(p[1]))
+		{
+			float xyz[3];
+			p += 2;
+			for (int i = 0; i < 3 && p != nullptr; ++i)
+				p = ParseFloat(SkipSpace(p, lineEnd), lineEnd, xyz[i]);
+			if (p == nullptr)
+			{
+				fail("bad vertex position");
+				return;
+			}
+			chunk.Positions.insert(chunk.Positions.end(), xyz, xyz + 3);
+		}
+		else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 't' && IsSpace(p[2]))
+		{
+			float uv[2] = { 0.0f, 0.0f };
+			p = ParseFloat(SkipSpace(p + 3, lineEnd), lineEnd, uv[0]);
+			if (p == nullptr)
+			{
+				fail("bad texture coordinate");
+				return;
+			}
+			// v is optional.
+			const char* q = SkipSpace(p, lineEnd);
+			if (q < lineEnd)
+				ParseFloat(q, lineEnd, uv[1]);
+			chunk.TexCoords.insert(chunk.TexCoords.end(), uv, uv + 2);
+		}
+		else if (p + 2 < lineEnd && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2]))
+		{
+			float xyz[3];
+			p += 3;
+			for (int i = 0; i < 3 && p != nullptr; ++i)
+				p = ParseFloat(SkipSpace(p, lineEnd), lineEnd, xyz[i]);
+			if (p == nullptr)
+			{
+				fail("bad vertex normal");
+				return;
+			}
+			chunk.Normals.insert(chunk.Normals.end(), xyz, xyz + 3);
+		}
+		else if (p + 1 < lineEnd && p[0] == 'f' && IsSpace(p[1]))
+		{
+			const std::int64_t positionCount = chunk.Positions.size() / 3;
+			const std::int64_t texCoordCount = chunk.TexCoords.size() / 2;
+			const std::int64_t normalCount = chunk.Normals.size() / 3;
+
+			// OBJ indices are 1-based; negative ones count back from the last element.
+			auto toIndex = [](std::int64_t raw, std::int64_t localCount, std::uint8_t relativeBit,
+				std::int32_t& index, std::uint8_t& relative)
+			{
+				if (raw > 0)
+				{
+					index = (std::int32_t)(raw - 1);
+				}
+				else
+				{
+					index = (std::int32_t)(localCount + raw);
+					relative |= relativeBit;
+				}
+			};
+
+			face.clear();
+			p = SkipSpace(p + 2, lineEnd);
+			while (p < lineEnd)
+			{
+				Chunk::Corner corner;
+				std::int64_t raw = 0;
+
+				p = ParseInt(p, lineEnd, raw);
+				if (p == nullptr || raw == 0)
+				{
+					fail("bad face index");
+					return;
+				}
+				toIndex(raw, positionCount, RelativePosition, corner.P, corner.Relative);
+
+				if (p < lineEnd && *p == '/')
+				{
+					++p;
+					if (p < lineEnd && *p != '/')
+					{
+						p = ParseInt(p, lineEnd, raw);
+						if (p == nullptr || raw == 0)
+						{
+							fail("bad face texture coordinate index");
+							return;
+						}
+						toIndex(raw, texCoordCount, RelativeTexCoord, corner.T, corner.Relative);
+					}
+					if (p < lineEnd && *p == '/')
+					{
+						p = ParseInt(p + 1, lineEnd, raw);
+						if (p == nullptr || raw == 0)
+						{
+							fail("bad face normal index");
+							return;
+						}
+						toIndex(raw, normalCount, RelativeNormal, corner.N, corner.Relative);
+					}
+				}
+
+				if (p < lineEnd && !IsSpace(*p))
+				{
+					fail("bad face");
+					return;
+				}
+
+				face.push_back(corner);
+				p = SkipSpace(p, lineEnd);
+			}
+
+			if (face.size() < 3)
+			{
+				fail("face with fewer than three corners");
+				return;
+			}
+
+			// Fan triangulation.
+			for (std::size_t i = 2; i < face.size(); ++i)
+			{
+				chunk.Corners.push_back(face[0]);
+				chunk.Corners.push_back(face[i - 1]);
+				chunk.Corners.push_back(face[i]);
+			}
+		}
+		else if (p + 1 < lineEnd && (p[0] == 'o' || p[0] == 'g') && IsSpace(p[1]))
+		{
+			Chunk::Group group;
+			group.FirstCorner = chunk.Corners.size();
+			group.Name = RestOfLine(p + 2, lineEnd);
+			chunk.Groups.push_back(group);
+		}
+		else if (StartsWithWord(p, lineEnd, "usemtl"))
+		{
+			Chunk::Group group;
+			group.FirstCorner = chunk.Corners.size();
+			group.Name = RestOfLine(p + 6, lineEnd);
+			chunk.Groups.push_back(group);
+		}
+
+		line = next;
+	}
+}
+
+bool ObjImporter::Resolve(std::vector<Chunk>& chunks, ObjMesh& mesh)
+{
+	// Where each chunk's elements start in the whole file.
+	std::vector<std::int64_t> positionBase(chunks.size()), texCoordBase(chunks.size()), normalBase(chunks.size());
+	std::int64_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+	std::size_t cornerCount = 0;
+	for (std::size_t c = 0; c < chunks.size(); ++c)
+	{
+		positionBase[c] = positionCount;
+		texCoordBase[c] = texCoordCount;
+		normalBase[c] = normalCount;
+		positionCount += chunks[c].Positions.size() / 3;
+		texCoordCount += chunks[c].TexCoords.size() / 2;
+		normalCount += chunks[c].Normals.size() / 3;
+		cornerCount += chunks[c].Corners.size();
+	}
+
+	if (cornerCount / 3 > 0xffffffffull || positionCount >= (std::int64_t)MissingGlobal)
+	{
+		mError = "mesh is too large";
+		return false;
+	}
+
+	// Gather the face ranges of each group name, in order of first appearance.
+	struct FaceRange
+	{
+		std::size_t Chunk;
+		std::size_t Begin;
+		std::size_t End;
+	};
+	struct GroupFaces
+	{
+		std::string Name;
+		std::vector<FaceRange> Ranges;
+	};
+	std::vector<GroupFaces> groups;
+	std::unordered_map<std::string, std::size_t> groupIndices;
+
+	std::size_t currentGroup = 0;
+	auto selectGroup = [&](const std::string& name)
+	{
+		std::string key = name.empty() ? "default" : name;
+		auto it = groupIndices.find(key);
+		if (it == groupIndices.end())
+		{
+			it = groupIndices.emplace(key, groups.size()).first;
+			groups.push_back(GroupFaces());
+			groups.back().Name = key;
+		}
+		currentGroup = it->second;
+	};
+	auto addRange = [&](std::size_t c, std::size_t begin, std::size_t end)
+	{
+		if (begin < end)
+			groups[currentGroup].Ranges.push_back(FaceRange{ c, begin, end });
+	};
+
+	selectGroup("default");
+	for (std::size_t c = 0; c < chunks.size(); ++c)
+	{
+		std::size_t begin = 0;
+		for (const Chunk::Group& group : chunks[c].Groups)
+		{
+			addRange(c, begin, group.FirstCorner);
+			selectGroup(group.Name);
+			begin = group.FirstCorner;
+		}
+		addRange(c, begin, chunks[c].Corners.size());
+	}
+
+	mesh.HasTexCoords = texCoordCount > 0;
+	mesh.HasNormals = normalCount > 0;
+	mesh.Indices.reserve(cornerCount);
+	mesh.Vertices.reserve((std::size_t)positionCount);
+
+	// Elements are looked up in the chunk that holds them.
+	auto locate = [](const std::vector<std::int64_t>& bases, std::int64_t index) -> std::size_t
+	{
+		return std::upper_bound(bases.begin(), bases.end(), index) - bases.begin() - 1;
+	};
+
+	CornerMap corners((std::size_t)positionCount);
+
+	for (const GroupFaces& group : groups)
+	{
+		if (group.Ranges.empty())
+			continue;
+
+		ObjSubmesh submesh;
+		submesh.Name = group.Name;
+		submesh.StartIndexLocation = (std::uint32_t)mesh.Indices.size();
+		for (int i = 0; i < 3; ++i)
+		{
+			submesh.BoundsMin[i] = std::numeric_limits<float>::max();
+			submesh.BoundsMax[i] = -std::numeric_limits<float>::max();
+		}
+
+		for (const FaceRange& range : group.Ranges)
+		{
+			const Chunk& chunk = chunks[range.Chunk];
+			for (std::size_t i = range.Begin; i < range.End; ++i)
+			{
+				const Chunk::Corner& corner = chunk.Corners[i];
+
+				std::int64_t p = corner.P + ((corner.Relative & RelativePosition) ? positionBase[range.Chunk] : 0);
+				std::int64_t t = corner.T == MissingIndex ? -1 :
+					corner.T + ((corner.Relative & RelativeTexCoord) ? texCoordBase[range.Chunk] : 0);
+				std::int64_t n = corner.N == MissingIndex ? -1 :
+					corner.N + ((corner.Relative & RelativeNormal) ? normalBase[range.Chunk] : 0);
+
+				if (p < 0 || p >= positionCount || (corner.T != MissingIndex && (t < 0 || t >= texCoordCount)) ||
+					(corner.N != MissingIndex && (n < 0 || n >= normalCount)))
+				{
+					mError = "face index out of range in group " + group.Name;
+					return false;
+				}
+
+				std::uint32_t newIndex = (std::uint32_t)mesh.Vertices.size();
+				std::uint32_t index = corners.FindOrInsert((std::uint32_t)p,
+					t < 0 ? MissingGlobal : (std::uint32_t)t, n < 0 ? MissingGlobal : (std::uint32_t)n, newIndex);
+
+				if (index == newIndex)
+				{
+					ObjVertex vertex = {};
+
+					std::size_t c = locate(positionBase, p);
+					std::memcpy(vertex.Position, &chunks[c].Positions[(std::size_t)(p - positionBase[c]) * 3], sizeof(vertex.Position));
+					if (t >= 0)
+					{
+						c = locate(texCoordBase, t);
+						std::memcpy(vertex.TexC, &chunks[c].TexCoords[(std::size_t)(t - texCoordBase[c]) * 2], sizeof(vertex.TexC));
+					}
+					if (n >= 0)
+					{
+						c = locate(normalBase, n);
+						std::memcpy(vertex.Normal, &chunks[c].Normals[(std::size_t)(n - normalBase[c]) * 3], sizeof(vertex.Normal));
+					}
+					mesh.Vertices.push_back(vertex);
+				}
+
+				const float* position = mesh.Vertices[index].Position;
+				for (int k = 0; k < 3; ++k)
+				{
+					submesh.BoundsMin[k] = std::min(submesh.BoundsMin[k], position[k]);
+					submesh.BoundsMax[k] = std::max(submesh.BoundsMax[k], position[k]);
+				}
+
+				mesh.Indices.push_back(index);
+			}
+		}
+
+		submesh.IndexCount = (std::uint32_t)mesh.Indices.size() - submesh.StartIndexLocation;
+		mesh.Submeshes.push_back(submesh);
+	}
+
+	return true;
+}
@@ -0,0 +1,89 @@
+//***************************************************************************************
+// ObjImporter.h
+//
+// Wavefront OBJ importer for large files.  The text is split into chunks at line
+// boundaries and the chunks are parsed on the threads of a WorkerPool; the results are
+// then stitched together in file order, faces are triangulated as fans and identical
+// position/texcoord/normal corners are merged through a hash table.
+//
+// Every "o", "g" or "usemtl" statement starts a group; faces of groups with the same name
+// are merged into one submesh.  Only geometry is read (v, vt, vn, f); materials, smoothing
+// groups, lines and points are ignored.
+//***************************************************************************************
+
+#pragma once
+
+#include "WorkerPool.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ObjVertex
+{
+	float Position[3];
+	float Normal[3];
+	float TexC[2];
+};
+
+struct ObjSubmesh
+{
+	std::string Name;
+	std::uint32_t IndexCount = 0;
+	std::uint32_t StartIndexLocation = 0;
+	float BoundsMin[3] = { 0.0f, 0.0f, 0.0f };
+	float BoundsMax[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+struct ObjMesh
+{
+	std::vector<ObjVertex> Vertices;
+	// Triangle list into Vertices.
+	std::vector<std::uint32_t> Indices;
+	std::vector<ObjSubmesh> Submeshes;
+
+	bool HasNormals = false;
+	bool HasTexCoords = false;
+
+	// True if every index fits in 16 bits.
+	bool Fits16BitIndices()const { return Vertices.size() <= 0x10000; }
+	void Get16BitIndices(std::vector<std::uint16_t>& indices)const;
+};
+
+struct ObjImportStats
+{
+	std::uint64_t ByteSize = 0;
+	std::uint64_t TriangleCount = 0;
+	std::uint64_t VertexCount = 0;
+	std::uint32_t ChunkCount = 0;
+	double ParseSeconds = 0.0;
+	double ResolveSeconds = 0.0;
+
+	double TotalSeconds()const { return ParseSeconds + ResolveSeconds; }
+	double MegabytesPerSecond()const;
+	double TrianglesPerSecond()const;
+};
+
+class ObjImporter
+{
+public:
+	// Returns false and sets Error() if the text is malformed.  Without workers the text
+	// is parsed as a single chunk on the calling thread.
+	bool Import(const char* text, std::size_t byteSize, ObjMesh& mesh, WorkerPool* workers = nullptr);
+	bool ImportFile(const std::string& path, ObjMesh& mesh, WorkerPool* workers = nullptr);
+
+	const std::string& Error()const { return mError; }
+	const ObjImportStats& Stats()const { return mStats; }
+
+	// Chunks smaller than this are not worth a thread.
+	static const std::size_t MinChunkSize = 1 << 20;
+
+private:
+	struct Chunk;
+
+	void ParseChunk(Chunk& chunk)const;
+	bool Resolve(std::vector<Chunk>& chunks, ObjMesh& mesh);
+
+	std::string mError;
+	ObjImportStats mStats;
+};
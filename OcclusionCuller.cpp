@@ -0,0 +1,316 @@
+#include "OcclusionCuller.h"
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// Triangle batches smaller than this are not worth a task of their own.
+	const std::uint32_t MinTrianglesPerThread = 4 * 1024;
+
+	// Clip space w below this counts as behind the eye.
+	const float MinW = 1e-5f;
+
+	struct ScreenVertex
+	{
+		float X, Y, Z;
+	};
+
+	// Clip space to pixels; y grows downwards.  False if the point is not in front of
+	// the near plane.
+	bool ToScreen(FXMVECTOR clip, float width, float height, ScreenVertex& v)
+	{
+		XMFLOAT4 c;
+		XMStoreFloat4(&c, clip);
+		if (c.w < MinW || c.z < 0.0f)
+			return false;
+
+		float invW = 1.0f / c.w;
+		v.X = (c.x * invW * 0.5f + 0.5f) * width;
+		v.Y = (0.5f - c.y * invW * 0.5f) * height;
+		v.Z = c.z * invW;
+		return true;
+	}
+}
+
+OcclusionCuller::OcclusionCuller(std::uint32_t width, std::uint32_t height) :
+	mWidth(width),
+	mHeight(height),
+	mTilesX(width / TileWidth),
+	mTilesY(height / TileHeight)
+{
+	assert(width % TileWidth == 0 && height % TileHeight == 0);
+
+	for (std::uint32_t level = 0; level == 0 || LevelWidth(level - 1) > 1 || LevelHeight(level - 1) > 1; ++level)
+		mLevels.emplace_back(LevelWidth(level) * LevelHeight(level), 1.0f);
+}
+
+void OcclusionCuller::Clear()
+{
+	mTriangles.clear();
+	mStats = OcclusionStats();
+	std::fill(mLevels[0].begin(), mLevels[0].end(), 1.0f);
+}
+
+void OcclusionCuller::AddOccluder(const float* positions, std::size_t positionStride, const std::uint32_t* indices,
+	std::size_t indexCount, FXMMATRIX worldViewProj)
+{
+	const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(positions);
+	const float width = (float)mWidth;
+	const float height = (float)mHeight;
+
+	for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		++mStats.OccluderTriangles;
+
+		ScreenVertex v[3];
+		bool inFront = true;
+		for (int k = 0; k < 3 && inFront; ++k)
+		{
+			XMVECTOR p = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(base + positionStride * indices[i + k]));
+			inFront = ToScreen(XMVector3Transform(p, worldViewProj), width, height, v[k]);
+		}
+		// Dropping an occluder can only let more through.
+		if (!inFront)
+			continue;
+
+		float area = (v[1].X - v[0].X) * (v[2].Y - v[0].Y) - (v[1].Y - v[0].Y) * (v[2].X - v[0].X);
+		if (std::fabs(area) < 1e-8f)
+			continue;
+		if (area < 0.0f)
+		{
+			std::swap(v[1], v[2]);
+			area = -area;
+		}
+
+		// Pixels whose centers fall in the triangle's bounding rectangle.
+		float minX = std::min(v[0].X, std::min(v[1].X, v[2].X));
+		float maxX = std::max(v[0].X, std::max(v[1].X, v[2].X));
+		float minY = std::min(v[0].Y, std::min(v[1].Y, v[2].Y));
+		float maxY = std::max(v[0].Y, std::max(v[1].Y, v[2].Y));
+
+		Triangle t;
+		t.MinX = std::max(0, (std::int32_t)std::ceil(minX - 0.5f));
+		t.MinY = std::max(0, (std::int32_t)std::ceil(minY - 0.5f));
+		t.MaxX = std::min((std::int32_t)mWidth - 1, (std::int32_t)std::floor(maxX - 0.5f));
+		t.MaxY = std::min((std::int32_t)mHeight - 1, (std::int32_t)std::floor(maxY - 0.5f));
+		if (t.MinX > t.MaxX || t.MinY > t.MaxY)
+			continue;
+
+		// Edge k runs from v[k] to v[k + 1] and is positive on the triangle's side.
+		for (int k = 0; k < 3; ++k)
+		{
+			const ScreenVertex& a = v[k];
+			const ScreenVertex& b = v[(k + 1) % 3];
+			t.A[k] = a.Y - b.Y;
+			t.B[k] = b.X - a.X;
+			t.C[k] = -(t.A[k] * a.X + t.B[k] * a.Y);
+		}
+
+		// Barycentrics are the opposite edge functions over the area.
+		const float invArea = 1.0f / area;
+		t.ZA = (v[0].Z * t.A[1] + v[1].Z * t.A[2] + v[2].Z * t.A[0]) * invArea;
+		t.ZB = (v[0].Z * t.B[1] + v[1].Z * t.B[2] + v[2].Z * t.B[0]) * invArea;
+		t.ZC = (v[0].Z * t.C[1] + v[1].Z * t.C[2] + v[2].Z * t.C[0]) * invArea;
+
+		mTriangles.push_back(t);
+	}
+}
+
+void OcclusionCuller::Render(WorkerPool* workers)
+{
+	mStats.RasterizedTriangles = (std::uint32_t)mTriangles.size();
+
+	const std::uint32_t threadCount = workers != nullptr ? workers->ThreadCount() : 1;
+	const std::uint32_t triangleCount = (std::uint32_t)mTriangles.size();
+	const std::uint32_t tileCount = mTilesX * mTilesY;
+	const std::uint32_t binTasks = std::min(threadCount, 1 + triangleCount / MinTrianglesPerThread);
+
+	mBins.resize(binTasks);
+	for (auto& bins : mBins)
+	{
+		bins.resize(tileCount);
+		for (auto& bin : bins)
+			bin.clear();
+	}
+
+	if (binTasks == 1)
+	{
+		BinTriangles(0, triangleCount, mBins[0]);
+		for (std::uint32_t tile = 0; tile < tileCount; ++tile)
+			RasterizeTile(tile);
+		BuildPyramid();
+		return;
+	}
+
+	// Contiguous batches keep each tile's triangles in submission order.
+	workers->Run(binTasks, [&](std::uint32_t i)
+	{
+		std::uint32_t first = (std::uint32_t)((std::uint64_t)triangleCount * i / binTasks);
+		std::uint32_t end = (std::uint32_t)((std::uint64_t)triangleCount * (i + 1) / binTasks);
+		BinTriangles(first, end, mBins[i]);
+	});
+
+	// Every tile is one task, so it is written by exactly one thread.
+	workers->Run(tileCount, [this](std::uint32_t tile) { RasterizeTile(tile); });
+
+	BuildPyramid();
+}
+
+void OcclusionCuller::BinTriangles(std::uint32_t first, std::uint32_t end,
+	std::vector<std::vector<std::uint32_t>>& bins)const
+{
+	for (std::uint32_t i = first; i < end; ++i)
+	{
+		const Triangle& t = mTriangles[i];
+		for (std::uint32_t ty = t.MinY / TileHeight; ty <= (std::uint32_t)t.MaxY / TileHeight; ++ty)
+		{
+			for (std::uint32_t tx = t.MinX / TileWidth; tx <= (std::uint32_t)t.MaxX / TileWidth; ++tx)
+				bins[ty * mTilesX + tx].push_back(i);
+		}
+	}
+}
+
+void OcclusionCuller::RasterizeTile(std::uint32_t tile)
+{
+	const std::int32_t tileX = (std::int32_t)((tile % mTilesX) * TileWidth);
+	const std::int32_t tileY = (std::int32_t)((tile / mTilesX) * TileHeight);
+	float* depth = mLevels[0].data();
+
+	const XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (const auto& bins : mBins)
+	{
+		for (std::uint32_t index : bins[tile])
+		{
+			const Triangle& t = mTriangles[index];
+
+			// Rows are walked in groups of four pixels from a multiple of four, which
+			// never leaves the tile.
+			const std::int32_t x0 = std::max(t.MinX, tileX) & ~3;
+			const std::int32_t x1 = std::min(t.MaxX, tileX + (std::int32_t)TileWidth - 1);
+			const std::int32_t y0 = std::max(t.MinY, tileY);
+			const std::int32_t y1 = std::min(t.MaxY, tileY + (std::int32_t)TileHeight - 1);
+
+			const XMVECTOR a0 = XMVectorReplicate(t.A[0]);
+			const XMVECTOR a1 = XMVectorReplicate(t.A[1]);
+			const XMVECTOR a2 = XMVectorReplicate(t.A[2]);
+			const XMVECTOR za = XMVectorReplicate(t.ZA);
+
+			for (std::int32_t y = y0; y <= y1; ++y)
+			{
+				const float py = (float)y + 0.5f;
+				const XMVECTOR row0 = XMVectorReplicate(t.B[0] * py + t.C[0]);
+				const XMVECTOR row1 = XMVectorReplicate(t.B[1] * py + t.C[1]);
+				const XMVECTOR row2 = XMVectorReplicate(t.B[2] * py + t.C[2]);
+				const XMVECTOR rowZ = XMVectorReplicate(t.ZB * py + t.ZC);
+				float* depthRow = depth + (std::size_t)y * mWidth;
+
+				for (std::int32_t x = x0; x <= x1; x += 4)
+				{
+					XMVECTOR px = XMVectorAdd(XMVectorReplicate((float)x), laneOffsets);
+
+					XMVECTOR inside = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a0, px, row0), XMVectorZero());
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a1, px, row1), XMVectorZero()));
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a2, px, row2), XMVectorZero()));
+
+					XMVECTOR z = XMVectorMax(XMVectorMultiplyAdd(za, px, rowZ), XMVectorZero());
+					XMVECTOR old = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(depthRow + x));
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(depthRow + x), XMVectorSelect(old, XMVectorMin(old, z), inside));
+				}
+			}
+		}
+	}
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+	for (std::uint32_t level = 1; level < LevelCount(); ++level)
+	{
+		const std::vector<float>& source = mLevels[level - 1];
+		std::vector<float>& target = mLevels[level];
+		const std::uint32_t sourceWidth = LevelWidth(level - 1);
+		const std::uint32_t sourceHeight = LevelHeight(level - 1);
+		const std::uint32_t width = LevelWidth(level);
+		const std::uint32_t height = LevelHeight(level);
+
+		// Odd rows and columns fold into the last texel so nothing is left out.
+		std::fill(target.begin(), target.end(), 0.0f);
+		for (std::uint32_t y = 0; y < sourceHeight; ++y)
+		{
+			float* targetRow = target.data() + std::min(y >> 1, height - 1) * width;
+			const float* sourceRow = source.data() + y * sourceWidth;
+			for (std::uint32_t x = 0; x < sourceWidth; ++x)
+			{
+				float& texel = targetRow[std::min(x >> 1, width - 1)];
+				texel = std::max(texel, sourceRow[x]);
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::IsOccluded(const BoundingBox& bounds, FXMMATRIX viewProj)const
+{
+	XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+	bounds.GetCorners(corners);
+
+	float minX = FLT_MAX, maxX = -FLT_MAX;
+	float minY = FLT_MAX, maxY = -FLT_MAX;
+	float minZ = 1.0f;
+	for (const XMFLOAT3& corner : corners)
+	{
+		ScreenVertex v;
+		if (!ToScreen(XMVector3Transform(XMLoadFloat3(&corner), viewProj), (float)mWidth, (float)mHeight, v))
+			return false;
+
+		minX = std::min(minX, v.X);
+		maxX = std::max(maxX, v.X);
+		minY = std::min(minY, v.Y);
+		maxY = std::max(maxY, v.Y);
+		minZ = std::min(minZ, v.Z);
+	}
+
+	// Off screen is for the frustum test to decide.
+	if (maxX < 0.0f || maxY < 0.0f || minX >= (float)mWidth || minY >= (float)mHeight)
+		return false;
+
+	// Every pixel the rectangle touches.
+	const std::uint32_t x0 = (std::uint32_t)std::max(0.0f, std::floor(minX));
+	const std::uint32_t y0 = (std::uint32_t)std::max(0.0f, std::floor(minY));
+	const std::uint32_t x1 = (std::uint32_t)std::min((float)mWidth - 1.0f, std::floor(maxX));
+	const std::uint32_t y1 = (std::uint32_t)std::min((float)mHeight - 1.0f, std::floor(maxY));
+
+	// The finest level where the rectangle touches at most 2 x 2 texels.
+	std::uint32_t level = 0;
+	while (level + 1 < LevelCount() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+		++level;
+
+	const std::uint32_t width = LevelWidth(level);
+	const std::uint32_t height = LevelHeight(level);
+	const float* depth = Level(level);
+
+	float maxDepth = 0.0f;
+	for (std::uint32_t y = std::min(y0 >> level, height - 1); y <= std::min(y1 >> level, height - 1); ++y)
+	{
+		for (std::uint32_t x = std::min(x0 >> level, width - 1); x <= std::min(x1 >> level, width - 1); ++x)
+			maxDepth = std::max(maxDepth, depth[y * width + x]);
+	}
+
+	return minZ > maxDepth;
+}
+
+void OcclusionCuller::Cull(const BoundingBox* bounds, std::vector<std::uint32_t>& indices, FXMMATRIX viewProj)
+{
+	std::size_t kept = 0;
+	for (std::uint32_t index : indices)
+	{
+		++mStats.Tested;
+		if (IsOccluded(bounds[index], viewProj))
+			++mStats.Occluded;
+		else
+			indices[kept++] = index;
+	}
+	indices.resize(kept);
+}
@@ -0,0 +1,101 @@
+//***************************************************************************************
+// OcclusionCuller.h
+//
+// Occlusion culling on the CPU.  A few large occluders (typically coarse LODs) are
+// rasterized into a small depth buffer, and the screen rectangles of other objects'
+// bounds are tested against a max-depth pyramid built from it.
+//
+// Rasterization works on fixed size tiles.  Render first bins the occluder triangles
+// into tiles, then rasterizes whole tiles, both spread over the threads of a WorkerPool,
+// so no two threads ever write the same pixels.  Within a tile, rows are filled four pixels
+// at a time with DirectXMath vectors: the edge functions and depth of four pixel centers
+// are evaluated at once and the depth is written through the coverage mask.
+//
+// Depth is D3D's post-projection z, 0 near and 1 far, cleared to 1.  Occluder triangles
+// that reach behind the near plane are dropped, and an object is only reported occluded
+// when its nearest point is behind the farthest depth under its rectangle, so the
+// results are conservative.  Everything is plain memory, so the depth buffer can be
+// compared against reference images.
+//***************************************************************************************
+
+#pragma once
+
+#include "WorkerPool.h"
+#include <DirectXCollision.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct OcclusionStats
+{
+	std::uint32_t OccluderTriangles = 0;
+	std::uint32_t RasterizedTriangles = 0;
+	std::uint32_t Tested = 0;
+	std::uint32_t Occluded = 0;
+};
+
+class OcclusionCuller
+{
+public:
+	static const std::uint32_t TileWidth = 32;
+	static const std::uint32_t TileHeight = 16;
+
+	// width must be a multiple of TileWidth, height of TileHeight.
+	OcclusionCuller(std::uint32_t width, std::uint32_t height);
+
+	// Starts a new frame: drops the occluders and clears the depth buffer.
+	void Clear();
+
+	// Queues the triangles of an occluder.  positions points at float3 values,
+	// positionStride bytes apart; worldViewProj takes them to clip space.
+	void AddOccluder(const float* positions, std::size_t positionStride, const std::uint32_t* indices,
+		std::size_t indexCount, DirectX::FXMMATRIX worldViewProj);
+
+	// Rasterizes the queued occluders and builds the depth pyramid, on the calling thread
+	// alone when workers is null.
+	void Render(WorkerPool* workers = nullptr);
+
+	// Whether the world space box is certainly hidden behind the occluders.
+	bool IsOccluded(const DirectX::BoundingBox& bounds, DirectX::FXMMATRIX viewProj)const;
+
+	// Removes the entries of indices whose bounds[index] are occluded, keeping the order.
+	void Cull(const DirectX::BoundingBox* bounds, std::vector<std::uint32_t>& indices, DirectX::FXMMATRIX viewProj);
+
+	std::uint32_t Width()const { return mWidth; }
+	std::uint32_t Height()const { return mHeight; }
+
+	// Level 0 is the depth buffer; level n holds the largest depth of 2^n x 2^n pixels.
+	std::uint32_t LevelCount()const { return (std::uint32_t)mLevels.size(); }
+	std::uint32_t LevelWidth(std::uint32_t level)const { return std::max(1u, mWidth >> level); }
+	std::uint32_t LevelHeight(std::uint32_t level)const { return std::max(1u, mHeight >> level); }
+	const float* Level(std::uint32_t level)const { return mLevels[level].data(); }
+
+	const OcclusionStats& Stats()const { return mStats; }
+
+private:
+	// A screen space triangle: E(x, y) = A x + B y + C is >= 0 inside for every edge,
+	// and depth is ZA x + ZB y + ZC.
+	struct Triangle
+	{
+		float A[3], B[3], C[3];
+		float ZA, ZB, ZC;
+		std::int32_t MinX, MinY, MaxX, MaxY;
+	};
+
+	void BinTriangles(std::uint32_t first, std::uint32_t end, std::vector<std::vector<std::uint32_t>>& bins)const;
+	void RasterizeTile(std::uint32_t tile);
+	void BuildPyramid();
+
+	std::uint32_t mWidth = 0;
+	std::uint32_t mHeight = 0;
+	std::uint32_t mTilesX = 0;
+	std::uint32_t mTilesY = 0;
+
+	std::vector<Triangle> mTriangles;
+	// Triangle indices per tile, one set of bins per binning task.
+	std::vector<std::vector<std::vector<std::uint32_t>>> mBins;
+
+	std::vector<std::vector<float>> mLevels;
+	OcclusionStats mStats;
+};
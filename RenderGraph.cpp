@@ -0,0 +1,476 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <sstream>
+
+RenderGraph::RenderGraph(State readOnlyStates, State uavState) :
+	mReadOnlyStates(readOnlyStates),
+	mUavState(uavState)
+{
+}
+
+void RenderGraph::Reset()
+{
+	mResources.clear();
+	mPasses.clear();
+}
+
+RenderGraph::ResourceHandle RenderGraph::Import(const std::string& name, State initialState, State finalState)
+{
+	ResourceNode node;
+	node.Name = name;
+	node.InitialState = initialState;
+	node.FinalState = finalState;
+	mResources.push_back(node);
+	return (ResourceHandle)mResources.size() - 1;
+}
+
+RenderGraph::ResourceHandle RenderGraph::CreateTransient(const std::string& name, const TransientDesc& desc)
+{
+	assert(desc.Alignment != 0 && (desc.Alignment & (desc.Alignment - 1)) == 0 && "Alignment must be a power of two.");
+
+	ResourceNode node;
+	node.Name = name;
+	node.Transient = true;
+	node.Desc = desc;
+	mResources.push_back(node);
+	return (ResourceHandle)mResources.size() - 1;
+}
+
+RenderGraph::PassHandle RenderGraph::AddPass(const std::string& name, bool hasSideEffects)
+{
+	PassNode node;
+	node.Name = name;
+	node.HasSideEffects = hasSideEffects;
+	mPasses.push_back(node);
+	return (PassHandle)mPasses.size() - 1;
+}
+
+void RenderGraph::Read(PassHandle pass, ResourceHandle resource, State state)
+{
+	AddUsage(pass, resource, state, false);
+}
+
+void RenderGraph::Write(PassHandle pass, ResourceHandle resource, State state)
+{
+	AddUsage(pass, resource, state, true);
+}
+
+void RenderGraph::AddUsage(PassHandle pass, ResourceHandle resource, State state, bool write)
+{
+	assert(pass < mPasses.size() && resource < mResources.size());
+
+	// A pass uses each resource in one (possibly combined) state.
+	for (Usage& usage : mPasses[pass].Usages)
+	{
+		if (usage.Resource == resource)
+		{
+			usage.Requested |= state;
+			usage.Write = usage.Write || write;
+			return;
+		}
+	}
+
+	Usage usage;
+	usage.Resource = resource;
+	usage.Requested = state;
+	usage.Write = write;
+	mPasses[pass].Usages.push_back(usage);
+}
+
+void RenderGraph::BuildTopologyKey(std::vector<std::uint64_t>& key)const
+{
+	key.clear();
+
+	key.push_back(mResources.size());
+	for (const ResourceNode& resource : mResources)
+	{
+		key.push_back(resource.Transient ? 1 : 0);
+		key.push_back(((std::uint64_t)resource.InitialState << 32) | resource.FinalState);
+		key.push_back(resource.Desc.ByteSize);
+		key.push_back(resource.Desc.Alignment);
+	}
+
+	key.push_back(mPasses.size());
+	for (const PassNode& pass : mPasses)
+	{
+		key.push_back(((std::uint64_t)pass.Usages.size() << 1) | (pass.HasSideEffects ? 1 : 0));
+		for (const Usage& usage : pass.Usages)
+		{
+			key.push_back(((std::uint64_t)usage.Resource << 32) | usage.Requested);
+			key.push_back(usage.Write ? 1 : 0);
+		}
+	}
+}
+
+bool RenderGraph::Compile()
+{
+	// Comparing the whole key rather than a hash of it rules out false cache hits.
+	std::vector<std::uint64_t> key;
+	BuildTopologyKey(key);
+	if (mHasCompiled && key == mCompiledKey)
+		return false;
+
+	CullPasses();
+	PlaceTransients();
+	ScheduleBarriers();
+
+	mCompiledKey.swap(key);
+	mHasCompiled = true;
+	++mCompileCount;
+	return true;
+}
+
+void RenderGraph::CullPasses()
+{
+	const std::size_t passCount = mPasses.size();
+	const std::size_t resourceCount = mResources.size();
+
+	// A pass is needed as long as one of the resources it writes is; a transient is
+	// needed as long as a pass that is still alive reads it.  Imported resources are
+	// visible outside the graph, so they are always needed.
+	std::vector<std::uint32_t> passRefs(passCount, 0);
+	std::vector<std::uint32_t> resourceRefs(resourceCount, 0);
+	std::vector<std::vector<PassHandle>> writers(resourceCount);
+
+	for (PassHandle p = 0; p < (PassHandle)passCount; ++p)
+	{
+		for (const Usage& usage : mPasses[p].Usages)
+		{
+			if (usage.Write)
+			{
+				++passRefs[p];
+				writers[usage.Resource].push_back(p);
+			}
+			else
+			{
+				++resourceRefs[usage.Resource];
+			}
+		}
+	}
+
+	// Every resource goes on the worklist once, when its last reader goes: those nothing
+	// reads now, and the rest from cullPass.
+	mCulled.assign(passCount, false);
+	std::vector<ResourceHandle> unused;
+	for (ResourceHandle r = 0; r < (ResourceHandle)resourceCount; ++r)
+	{
+		if (resourceRefs[r] == 0)
+			unused.push_back(r);
+	}
+
+	auto cullPass = [&](PassHandle p)
+	{
+		mCulled[p] = true;
+		for (const Usage& usage : mPasses[p].Usages)
+		{
+			if (!usage.Write && --resourceRefs[usage.Resource] == 0)
+				unused.push_back(usage.Resource);
+		}
+	};
+
+	for (PassHandle p = 0; p < (PassHandle)passCount; ++p)
+	{
+		if (passRefs[p] == 0 && !mPasses[p].HasSideEffects)
+			cullPass(p);
+	}
+
+	while (!unused.empty())
+	{
+		ResourceHandle r = unused.back();
+		unused.pop_back();
+
+		if (!mResources[r].Transient)
+			continue;
+
+		for (PassHandle p : writers[r])
+		{
+			if (!mCulled[p] && --passRefs[p] == 0 && !mPasses[p].HasSideEffects)
+				cullPass(p);
+		}
+	}
+
+	// The surviving passes run in declaration order.
+	mSchedule.clear();
+	for (PassHandle p = 0; p < (PassHandle)passCount; ++p)
+	{
+		if (!mCulled[p])
+		{
+			ScheduledPass scheduled;
+			scheduled.Pass = p;
+			mSchedule.push_back(scheduled);
+		}
+	}
+}
+
+void RenderGraph::PlaceTransients()
+{
+	mPlacements.assign(mResources.size(), Placement());
+	mTransientByteSize = 0;
+
+	for (std::uint32_t i = 0; i < (std::uint32_t)mSchedule.size(); ++i)
+	{
+		for (const Usage& usage : mPasses[mSchedule[i].Pass].Usages)
+		{
+			Placement& placement = mPlacements[usage.Resource];
+			if (placement.FirstPass == InvalidHandle)
+			{
+				placement.FirstPass = i;
+				placement.FirstState = usage.Requested;
+			}
+			placement.LastPass = i;
+		}
+	}
+
+	// Biggest first: large resources claim the bottom of the heap and the small ones fill
+	// the gaps between them.
+	std::vector<ResourceHandle> order;
+	for (ResourceHandle r = 0; r < (ResourceHandle)mResources.size(); ++r)
+	{
+		if (mResources[r].Transient && mPlacements[r].FirstPass != InvalidHandle)
+			order.push_back(r);
+	}
+
+	std::stable_sort(order.begin(), order.end(), [this](ResourceHandle a, ResourceHandle b)
+	{
+		return mResources[a].Desc.ByteSize > mResources[b].Desc.ByteSize;
+	});
+
+	auto lifetimesOverlap = [](const Placement& a, const Placement& b)
+	{
+		return a.FirstPass <= b.LastPass && b.FirstPass <= a.LastPass;
+	};
+
+	auto memoryOverlaps = [](const Placement& a, const Placement& b)
+	{
+		return a.Offset < b.Offset + b.ByteSize && b.Offset < a.Offset + a.ByteSize;
+	};
+
+	std::vector<ResourceHandle> placed;
+	std::vector<std::pair<std::uint64_t, std::uint64_t>> busy;
+	for (ResourceHandle r : order)
+	{
+		Placement& placement = mPlacements[r];
+		const TransientDesc& desc = mResources[r].Desc;
+
+		// Memory ranges taken by resources alive at the same time as this one.
+		busy.clear();
+		for (ResourceHandle other : placed)
+		{
+			const Placement& otherPlacement = mPlacements[other];
+			if (lifetimesOverlap(placement, otherPlacement))
+				busy.push_back(std::make_pair(otherPlacement.Offset, otherPlacement.Offset + otherPlacement.ByteSize));
+		}
+		std::sort(busy.begin(), busy.end());
+
+		// Lowest aligned offset that fits between the busy ranges.
+		std::uint64_t offset = 0;
+		for (const auto& range : busy)
+		{
+			std::uint64_t candidate = (offset + desc.Alignment - 1) & ~(desc.Alignment - 1);
+			if (candidate + desc.ByteSize <= range.first)
+				break;
+			offset = std::max(offset, range.second);
+		}
+		offset = (offset + desc.Alignment - 1) & ~(desc.Alignment - 1);
+
+		placement.Offset = offset;
+		placement.ByteSize = desc.ByteSize;
+		mTransientByteSize = std::max(mTransientByteSize, offset + desc.ByteSize);
+		placed.push_back(r);
+	}
+
+	// The aliasing barrier of a resource names the one that used its memory last.
+	for (ResourceHandle r : placed)
+	{
+		Placement& placement = mPlacements[r];
+		for (ResourceHandle other : placed)
+		{
+			const Placement& otherPlacement = mPlacements[other];
+			if (other == r || !memoryOverlaps(placement, otherPlacement))
+				continue;
+
+			placement.Aliased = true;
+			if (otherPlacement.LastPass < placement.FirstPass &&
+				(placement.AliasBefore == InvalidHandle || otherPlacement.LastPass > mPlacements[placement.AliasBefore].LastPass))
+				placement.AliasBefore = other;
+		}
+	}
+}
+
+void RenderGraph::ScheduleBarriers()
+{
+	std::vector<State> current(mResources.size());
+	for (ResourceHandle r = 0; r < (ResourceHandle)mResources.size(); ++r)
+		current[r] = mResources[r].Transient ? UndefinedState : mResources[r].InitialState;
+
+	// Schedule indices of the passes using each resource, in order, so widening a read
+	// only visits the resource's own later uses.  next[r] is the use after the current one.
+	std::vector<std::vector<std::uint32_t>> uses(mResources.size());
+	for (std::uint32_t i = 0; i < (std::uint32_t)mSchedule.size(); ++i)
+	{
+		for (const Usage& usage : mPasses[mSchedule[i].Pass].Usages)
+			uses[usage.Resource].push_back(i);
+	}
+	std::vector<std::uint32_t> next(mResources.size(), 0);
+
+	for (std::uint32_t i = 0; i < (std::uint32_t)mSchedule.size(); ++i)
+	{
+		ScheduledPass& scheduled = mSchedule[i];
+		scheduled.Barriers.clear();
+
+		for (const Usage& usage : mPasses[scheduled.Pass].Usages)
+		{
+			ResourceHandle r = usage.Resource;
+			State requested = usage.Requested;
+			++next[r];
+
+			if (current[r] == UndefinedState && mPlacements[r].Aliased)
+			{
+				Barrier barrier;
+				barrier.Type = BarrierType::Aliasing;
+				barrier.Resource = r;
+				barrier.AliasBefore = mPlacements[r].AliasBefore;
+				scheduled.Barriers.push_back(barrier);
+			}
+
+			if (IsSatisfied(current[r], requested))
+			{
+				if (requested == mUavState)
+				{
+					Barrier barrier;
+					barrier.Type = BarrierType::Uav;
+					barrier.Resource = r;
+					scheduled.Barriers.push_back(barrier);
+				}
+				continue;
+			}
+
+			// Going into a read state: take in the states of every following pass that
+			// also only reads the resource, so the whole run needs one transition.
+			if (!usage.Write && IsReadOnly(requested))
+			{
+				for (std::size_t u = next[r]; u < uses[r].size(); ++u)
+				{
+					const Usage* later = FindUsage(mSchedule[uses[r][u]].Pass, r);
+					if (later->Write || !IsReadOnly(later->Requested))
+						break;
+					requested |= later->Requested;
+				}
+			}
+
+			Barrier barrier;
+			barrier.Resource = r;
+			barrier.Before = current[r];
+			barrier.After = requested;
+			scheduled.Barriers.push_back(barrier);
+
+			current[r] = requested;
+		}
+	}
+
+	mFinalBarriers.clear();
+	for (ResourceHandle r = 0; r < (ResourceHandle)mResources.size(); ++r)
+	{
+		const ResourceNode& resource = mResources[r];
+		if (resource.Transient || resource.FinalState == UndefinedState || current[r] == resource.FinalState)
+			continue;
+
+		Barrier barrier;
+		barrier.Resource = r;
+		barrier.Before = current[r];
+		barrier.After = resource.FinalState;
+		mFinalBarriers.push_back(barrier);
+	}
+}
+
+const RenderGraph::Usage* RenderGraph::FindUsage(PassHandle pass, ResourceHandle resource)const
+{
+	for (const Usage& usage : mPasses[pass].Usages)
+	{
+		if (usage.Resource == resource)
+			return &usage;
+	}
+	return nullptr;
+}
+
+bool RenderGraph::IsReadOnly(State state)const
+{
+	return state != 0 && (state & ~mReadOnlyStates) == 0;
+}
+
+bool RenderGraph::IsSatisfied(State current, State requested)const
+{
+	if (current == UndefinedState)
+		return false;
+	if (current == requested)
+		return true;
+
+	// A combined read state already covers each of the read states it contains.
+	return IsReadOnly(current) && requested != 0 && (current & requested) == requested;
+}
+
+std::string RenderGraph::Describe()const
+{
+	std::ostringstream out;
+
+	auto describeState = [&out](State state)
+	{
+		if (state == UndefinedState)
+			out << "undefined";
+		else
+			out << "0x" << std::hex << state << std::dec;
+	};
+
+	auto describeBarrier = [&](const Barrier& barrier)
+	{
+		out << "  ";
+		switch (barrier.Type)
+		{
+		case BarrierType::Transition:
+			out << "transition " << mResources[barrier.Resource].Name << " ";
+			describeState(barrier.Before);
+			out << " -> ";
+			describeState(barrier.After);
+			break;
+		case BarrierType::Uav:
+			out << "uav " << mResources[barrier.Resource].Name;
+			break;
+		case BarrierType::Aliasing:
+			out << "aliasing " << (barrier.AliasBefore == InvalidHandle ? "*" : mResources[barrier.AliasBefore].Name.c_str())
+				<< " -> " << mResources[barrier.Resource].Name;
+			break;
+		}
+		out << "\n";
+	};
+
+	for (PassHandle p = 0; p < (PassHandle)mCulled.size(); ++p)
+	{
+		if (mCulled[p])
+			out << "culled " << mPasses[p].Name << "\n";
+	}
+
+	for (const ScheduledPass& scheduled : mSchedule)
+	{
+		out << "pass " << mPasses[scheduled.Pass].Name << "\n";
+		for (const Barrier& barrier : scheduled.Barriers)
+			describeBarrier(barrier);
+	}
+
+	out << "final\n";
+	for (const Barrier& barrier : mFinalBarriers)
+		describeBarrier(barrier);
+
+	for (ResourceHandle r = 0; r < (ResourceHandle)mPlacements.size(); ++r)
+	{
+		const Placement& placement = mPlacements[r];
+		if (placement.Offset == InvalidOffset)
+			continue;
+		out << "transient " << mResources[r].Name << " offset " << placement.Offset << " size " << placement.ByteSize
+			<< " passes " << placement.FirstPass << "-" << placement.LastPass << "\n";
+	}
+	out << "transient bytes " << mTransientByteSize << "\n";
+
+	return out.str();
+}
@@ -0,0 +1,181 @@
+//***************************************************************************************
+// RenderGraph.h
+//
+// Declarative description of a frame.  Passes declare which resources they read and
+// write (and in which state); Compile() then
+//   - culls passes whose results are never used (a pass is kept if it has side effects,
+//     writes an imported resource, or writes a transient that a kept pass reads),
+//   - computes the barriers to record before each pass, widening a read transition to
+//     cover every following pass that only reads the resource,
+//   - places the transient resources in one block of memory, letting resources whose
+//     lifetimes do not overlap share the same bytes.
+//
+// The graph is declared again every frame but only recompiled when its topology (passes,
+// resources, usages, sizes) differs from the last compiled one.
+//
+// Resources, states and sizes are plain numbers so the compiler has no D3D dependency;
+// D3D12RenderGraph creates the transient resources and records the passes.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RenderGraph
+{
+public:
+	typedef std::uint32_t State;
+	typedef std::uint32_t ResourceHandle;
+	typedef std::uint32_t PassHandle;
+
+	static const std::uint32_t InvalidHandle = 0xffffffff;
+	static const std::uint64_t InvalidOffset = ~0ull;
+
+	// Before-state of a transient's first use (its contents are undefined), and the final
+	// state of an import that may be left in whatever state its last use needed.
+	static const State UndefinedState = 0xffffffff;
+
+	enum class BarrierType
+	{
+		Transition,
+		// Between two passes that both access the resource as a UAV.
+		Uav,
+		// Resource starts using memory it shares with other transients.
+		Aliasing
+	};
+
+	struct Barrier
+	{
+		BarrierType Type = BarrierType::Transition;
+		ResourceHandle Resource = InvalidHandle;
+		State Before = 0;
+		State After = 0;
+		// Aliasing only: transient that last used the memory in this graph, if any.
+		ResourceHandle AliasBefore = InvalidHandle;
+	};
+
+	struct TransientDesc
+	{
+		std::uint64_t ByteSize = 0;
+		// Power of two.
+		std::uint64_t Alignment = 1;
+	};
+
+	struct Placement
+	{
+		std::uint64_t Offset = InvalidOffset;
+		std::uint64_t ByteSize = 0;
+		// Indices into Schedule() of the first and last pass using the resource.
+		std::uint32_t FirstPass = InvalidHandle;
+		std::uint32_t LastPass = InvalidHandle;
+		// Shares at least part of its memory with another transient.
+		bool Aliased = false;
+		ResourceHandle AliasBefore = InvalidHandle;
+		// State the resource is first used in.
+		State FirstState = 0;
+	};
+
+	struct ScheduledPass
+	{
+		PassHandle Pass = InvalidHandle;
+		// Recorded right before the pass.
+		std::vector<Barrier> Barriers;
+	};
+
+	// readOnlyStates is the mask of states that only read (they combine); uavState is the
+	// state that needs a UAV barrier between consecutive uses.
+	RenderGraph(State readOnlyStates, State uavState);
+
+	// Forgets the declarations so the graph can be declared again.  The compiled result
+	// is kept until the next Compile().
+	void Reset();
+
+	// External resource in initialState; left in finalState once the graph has run.
+	ResourceHandle Import(const std::string& name, State initialState, State finalState = UndefinedState);
+	// Resource that only lives inside the graph.
+	ResourceHandle CreateTransient(const std::string& name, const TransientDesc& desc);
+
+	PassHandle AddPass(const std::string& name, bool hasSideEffects = false);
+	void Read(PassHandle pass, ResourceHandle resource, State state);
+	void Write(PassHandle pass, ResourceHandle resource, State state);
+
+	// Compiles the graph declared since Reset().  Returns false when the topology matches
+	// the last compiled graph and the previous result was kept.
+	bool Compile();
+
+	const std::vector<ScheduledPass>& Schedule()const { return mSchedule; }
+	// Transitions of imported resources to their final state, after the last pass.
+	const std::vector<Barrier>& FinalBarriers()const { return mFinalBarriers; }
+
+	bool IsCulled(PassHandle pass)const { return mCulled[pass]; }
+	bool IsTransient(ResourceHandle resource)const { return mResources[resource].Transient; }
+	const Placement& GetPlacement(ResourceHandle resource)const { return mPlacements[resource]; }
+	const TransientDesc& GetTransientDesc(ResourceHandle resource)const { return mResources[resource].Desc; }
+
+	// Bytes needed to hold every transient resource.
+	std::uint64_t TransientByteSize()const { return mTransientByteSize; }
+	std::uint64_t CompileCount()const { return mCompileCount; }
+
+	std::uint32_t PassCount()const { return (std::uint32_t)mPasses.size(); }
+	std::uint32_t ResourceCount()const { return (std::uint32_t)mResources.size(); }
+	const std::string& PassName(PassHandle pass)const { return mPasses[pass].Name; }
+	const std::string& ResourceName(ResourceHandle resource)const { return mResources[resource].Name; }
+
+	// Text listing of the compiled graph (culled passes, barriers, placements); the same
+	// graph always produces the same text.
+	std::string Describe()const;
+
+private:
+	struct ResourceNode
+	{
+		std::string Name;
+		bool Transient = false;
+		State InitialState = 0;
+		State FinalState = UndefinedState;
+		TransientDesc Desc;
+	};
+
+	struct Usage
+	{
+		ResourceHandle Resource = InvalidHandle;
+		State Requested = 0;
+		bool Write = false;
+	};
+
+	struct PassNode
+	{
+		std::string Name;
+		bool HasSideEffects = false;
+		std::vector<Usage> Usages;
+	};
+
+	void AddUsage(PassHandle pass, ResourceHandle resource, State state, bool write);
+	void BuildTopologyKey(std::vector<std::uint64_t>& key)const;
+
+	void CullPasses();
+	void PlaceTransients();
+	void ScheduleBarriers();
+
+	const Usage* FindUsage(PassHandle pass, ResourceHandle resource)const;
+	bool IsReadOnly(State state)const;
+	bool IsSatisfied(State current, State requested)const;
+
+	State mReadOnlyStates = 0;
+	State mUavState = 0;
+
+	std::vector<ResourceNode> mResources;
+	std::vector<PassNode> mPasses;
+
+	// Compiled result.
+	std::vector<std::uint64_t> mCompiledKey;
+	bool mHasCompiled = false;
+	std::uint64_t mCompileCount = 0;
+
+	std::vector<bool> mCulled;
+	std::vector<ScheduledPass> mSchedule;
+	std::vector<Barrier> mFinalBarriers;
+	std::vector<Placement> mPlacements;
+	std::uint64_t mTransientByteSize = 0;
+};
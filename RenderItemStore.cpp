@@ -0,0 +1,123 @@
+#include "RenderItemStore.h"
+#include <cassert>
+
+using namespace DirectX;
+
+void RenderItemStore::Reserve(std::uint32_t count)
+{
+	mSlots.reserve(count);
+	mGeometries.reserve(count);
+	mSubmeshes.reserve(count);
+	mPipelines.reserve(count);
+	mMaterials.reserve(count);
+	mWorlds.reserve(count);
+	mBounds.reserve(count);
+	mCuller.Reserve(count);
+	mOwners.reserve(count);
+}
+
+void RenderItemStore::Clear()
+{
+	// Outstanding handles must stay invalid, so the slots are freed rather than dropped.
+	for (std::uint32_t i = 0; i < Size(); ++i)
+	{
+		Slot& slot = mSlots[mOwners[i]];
+		++slot.Generation;
+		slot.Index = mFreeSlots;
+		mFreeSlots = mOwners[i];
+	}
+
+	mGeometries.clear();
+	mSubmeshes.clear();
+	mPipelines.clear();
+	mMaterials.clear();
+	mWorlds.clear();
+	mBounds.clear();
+	mCuller.Clear();
+	mOwners.clear();
+}
+
+RenderItemHandle RenderItemStore::Create(GeometryHandle geometry, SubmeshHandle submesh, std::uint32_t pipeline,
+	std::uint32_t material, const XMFLOAT4X4& world, const BoundingBox& bounds)
+{
+	std::uint32_t slotIndex = mFreeSlots;
+	if (slotIndex != NoSlot)
+		mFreeSlots = mSlots[slotIndex].Index;
+	else
+	{
+		slotIndex = (std::uint32_t)mSlots.size();
+		mSlots.emplace_back();
+	}
+
+	Slot& slot = mSlots[slotIndex];
+	slot.Index = Size();
+
+	mGeometries.push_back(geometry);
+	mSubmeshes.push_back(submesh);
+	mPipelines.push_back(pipeline);
+	mMaterials.push_back(material);
+	mWorlds.push_back(world);
+	mBounds.push_back(bounds);
+	mCuller.Add(bounds);
+	mOwners.push_back(slotIndex);
+
+	RenderItemHandle handle;
+	handle.Slot = slotIndex;
+	handle.Generation = slot.Generation;
+	return handle;
+}
+
+void RenderItemStore::Destroy(RenderItemHandle handle)
+{
+	assert(IsValid(handle));
+	Slot& slot = mSlots[handle.Slot];
+	const std::uint32_t index = slot.Index;
+	const std::uint32_t last = Size() - 1;
+
+	if (index != last)
+	{
+		mGeometries[index] = mGeometries[last];
+		mSubmeshes[index] = mSubmeshes[last];
+		mPipelines[index] = mPipelines[last];
+		mMaterials[index] = mMaterials[last];
+		mWorlds[index] = mWorlds[last];
+		mBounds[index] = mBounds[last];
+		mOwners[index] = mOwners[last];
+		mSlots[mOwners[index]].Index = index;
+	}
+
+	mGeometries.pop_back();
+	mSubmeshes.pop_back();
+	mPipelines.pop_back();
+	mMaterials.pop_back();
+	mWorlds.pop_back();
+	mBounds.pop_back();
+	mCuller.Remove(index);
+	mOwners.pop_back();
+
+	++slot.Generation;
+	slot.Index = mFreeSlots;
+	mFreeSlots = handle.Slot;
+}
+
+bool RenderItemStore::IsValid(RenderItemHandle handle)const
+{
+	// Freeing a slot bumps its generation, so only the live item's handle matches.
+	return handle.Slot < mSlots.size() && mSlots[handle.Slot].Generation == handle.Generation;
+}
+
+RenderItemHandle RenderItemStore::HandleAt(std::uint32_t index)const
+{
+	RenderItemHandle handle;
+	handle.Slot = mOwners[index];
+	handle.Generation = mSlots[handle.Slot].Generation;
+	return handle;
+}
+
+void RenderItemStore::SetWorld(RenderItemHandle handle, const XMFLOAT4X4& world, const BoundingBox& bounds)
+{
+	std::uint32_t index = IndexOf(handle);
+	mWorlds[index] = world;
+	mBounds[index] = bounds;
+	mCuller.SetBounds(index, bounds);
+}
@@ -0,0 +1,97 @@
+//***************************************************************************************
+// RenderItemStore.h
+//
+// Render items stored as dense component arrays: geometry, submesh, pipeline state,
+// material, world matrix and world bounds each live in their own array, indexed by the
+// item's position.
+//
+// Destroying an item moves the last item into its place, so the arrays stay packed and
+// per-frame loops stream through them.  Items are referred to from outside with
+// handles that carry a generation, so a handle to a destroyed item is detected instead
+// of silently reaching whichever item took its slot.  Positions (dense indices) change
+// on Destroy and are only meant for the loops of one frame.
+//
+// The world bounds are also kept in a FrustumCuller, indexed by position like the other
+// components, so culling needs no copy of them kept in step by hand.
+//***************************************************************************************
+
+#pragma once
+
+#include "FrustumCuller.h"
+#include "SubmeshTable.h"
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+// As in GeometryBuffer.h, which is not included so the store builds without D3D.
+typedef std::uint32_t GeometryHandle;
+
+struct RenderItemHandle
+{
+	std::uint32_t Slot = 0xffffffff;
+	std::uint32_t Generation = 0;
+
+	bool operator==(const RenderItemHandle& rhs)const { return Slot == rhs.Slot && Generation == rhs.Generation; }
+	bool operator!=(const RenderItemHandle& rhs)const { return !(*this == rhs); }
+};
+
+class RenderItemStore
+{
+public:
+	void Reserve(std::uint32_t count);
+	void Clear();
+
+	// pipeline indexes the renderer's pipeline states.  world is the full object to world
+	// transform the shaders use; bounds are in world space.
+	RenderItemHandle Create(GeometryHandle geometry, SubmeshHandle submesh, std::uint32_t pipeline,
+		std::uint32_t material, const DirectX::XMFLOAT4X4& world, const DirectX::BoundingBox& bounds);
+
+	// The last item moves into the freed position.
+	void Destroy(RenderItemHandle handle);
+
+	bool IsValid(RenderItemHandle handle)const;
+
+	// The current position of a valid item.
+	std::uint32_t IndexOf(RenderItemHandle handle)const { return mSlots[handle.Slot].Index; }
+	RenderItemHandle HandleAt(std::uint32_t index)const;
+
+	std::uint32_t Size()const { return (std::uint32_t)mGeometries.size(); }
+
+	void SetWorld(RenderItemHandle handle, const DirectX::XMFLOAT4X4& world, const DirectX::BoundingBox& bounds);
+	void SetMaterial(RenderItemHandle handle, std::uint32_t material) { mMaterials[IndexOf(handle)] = material; }
+
+	// Components, by position.
+	const GeometryHandle* Geometries()const { return mGeometries.data(); }
+	const SubmeshHandle* Submeshes()const { return mSubmeshes.data(); }
+	const std::uint32_t* Pipelines()const { return mPipelines.data(); }
+	const std::uint32_t* Materials()const { return mMaterials.data(); }
+	const DirectX::XMFLOAT4X4* Worlds()const { return mWorlds.data(); }
+	const DirectX::BoundingBox* Bounds()const { return mBounds.data(); }
+
+	// The world bounds again, for culling; its indices are item positions.
+	const FrustumCuller& Culler()const { return mCuller; }
+
+private:
+	struct Slot
+	{
+		// Position of the item; the next free slot while the slot is unused.
+		std::uint32_t Index = 0;
+		std::uint32_t Generation = 0;
+	};
+
+	static const std::uint32_t NoSlot = 0xffffffff;
+
+	std::vector<Slot> mSlots;
+	std::uint32_t mFreeSlots = NoSlot;
+
+	// Components, all Size() long.
+	std::vector<GeometryHandle> mGeometries;
+	std::vector<SubmeshHandle> mSubmeshes;
+	std::vector<std::uint32_t> mPipelines;
+	std::vector<std::uint32_t> mMaterials;
+	std::vector<DirectX::XMFLOAT4X4> mWorlds;
+	std::vector<DirectX::BoundingBox> mBounds;
+	FrustumCuller mCuller;
+	// The slot of each item, to patch it when the item moves.
+	std::vector<std::uint32_t> mOwners;
+};
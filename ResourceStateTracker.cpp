@@ -0,0 +1,193 @@
+#include "ResourceStateTracker.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+ResourceStateTracker::ResourceStateTracker(State readOnlyStates, State uavState) :
+	mReadOnlyStates(readOnlyStates),
+	mUavState(uavState)
+{
+}
+
+void ResourceStateTracker::Register(const void* resource, State initialState, std::uint32_t subresourceCount)
+{
+	TrackedResource tracked;
+	tracked.Whole = initialState;
+	tracked.Uniform = true;
+	tracked.Subresources.assign(subresourceCount > 0 ? subresourceCount : 1, initialState);
+	mResources[resource] = tracked;
+}
+
+void ResourceStateTracker::Unregister(const void* resource)
+{
+	mResources.erase(resource);
+
+	// Drop anything still pending for it; the resource is going away.
+	for (std::size_t i = 0; i < mPending.size();)
+	{
+		if (mPending[i].Resource == resource)
+			mPending.erase(mPending.begin() + i);
+		else
+			++i;
+	}
+}
+
+bool ResourceStateTracker::IsRegistered(const void* resource)const
+{
+	return mResources.find(resource) != mResources.end();
+}
+
+ResourceStateTracker::State ResourceStateTracker::GetState(const void* resource, std::uint32_t subresource)const
+{
+	auto it = mResources.find(resource);
+	assert(it != mResources.end() && "Resource is not registered.");
+	if (it == mResources.end())
+		return 0;
+
+	const TrackedResource& tracked = it->second;
+	return tracked.Uniform ? tracked.Whole : tracked.Subresources[subresource];
+}
+
+void ResourceStateTracker::SetState(const void* resource, State state)
+{
+	auto it = mResources.find(resource);
+	assert(it != mResources.end() && "Resource is not registered.");
+	if (it == mResources.end())
+		return;
+
+	assert(std::none_of(mPending.begin(), mPending.end(),
+		[resource](const Barrier& pending) { return pending.Resource == resource; }) &&
+		"A barrier is still pending for the resource.");
+
+	TrackedResource& tracked = it->second;
+	tracked.Whole = state;
+	tracked.Uniform = true;
+	for (State& subresourceState : tracked.Subresources)
+		subresourceState = state;
+}
+
+bool ResourceStateTracker::IsSatisfied(State current, State requested)const
+{
+	if (current == requested)
+		return true;
+
+	// A resource in a combined read state (e.g. GENERIC_READ) can already be used for any
+	// of the read states it contains.
+	bool currentIsRead = current != 0 && (current & ~mReadOnlyStates) == 0;
+	return currentIsRead && requested != 0 && (current & requested) == requested;
+}
+
+void ResourceStateTracker::AddTransition(const void* resource, std::uint32_t subresource, State before, State after)
+{
+	// Fold into the latest pending barrier of this resource if it is a transition of the
+	// same subresource: A->B followed by B->C becomes A->C, and A->B followed by B->A
+	// cancels out.  Anything older must stay in order and is left alone.
+	for (std::size_t i = mPending.size(); i-- > 0;)
+	{
+		Barrier& pending = mPending[i];
+		if (pending.Resource != resource)
+			continue;
+
+		if (pending.Type == BarrierType::Transition && pending.Subresource == subresource)
+		{
+			if (pending.Before == after)
+				mPending.erase(mPending.begin() + i);
+			else
+				pending.After = after;
+			return;
+		}
+		break;
+	}
+
+	Barrier barrier;
+	barrier.Type = BarrierType::Transition;
+	barrier.Resource = resource;
+	barrier.Subresource = subresource;
+	barrier.Before = before;
+	barrier.After = after;
+	mPending.push_back(barrier);
+}
+
+void ResourceStateTracker::Transition(const void* resource, State after, std::uint32_t subresource)
+{
+	auto it = mResources.find(resource);
+	assert(it != mResources.end() && "Resource is not registered.");
+	if (it == mResources.end())
+		return;
+
+	TrackedResource& tracked = it->second;
+
+	if (subresource == AllSubresources)
+	{
+		if (tracked.Uniform)
+		{
+			if (!IsSatisfied(tracked.Whole, after))
+				AddTransition(resource, AllSubresources, tracked.Whole, after);
+			else
+				after = tracked.Whole;
+		}
+		else
+		{
+			// Subresources diverged: bring each one over individually.
+			for (std::uint32_t i = 0; i < (std::uint32_t)tracked.Subresources.size(); ++i)
+			{
+				if (tracked.Subresources[i] != after)
+					AddTransition(resource, i, tracked.Subresources[i], after);
+			}
+		}
+
+		tracked.Whole = after;
+		tracked.Uniform = true;
+		for (State& state : tracked.Subresources)
+			state = after;
+		return;
+	}
+
+	assert(subresource < tracked.Subresources.size() && "Subresource index out of range.");
+
+	State current = tracked.Uniform ? tracked.Whole : tracked.Subresources[subresource];
+	if (IsSatisfied(current, after))
+		return;
+
+	// Any pending whole-resource transition stays ahead of this one in the list, so
+	// the order in which they are flushed is still correct.
+	AddTransition(resource, subresource, current, after);
+
+	tracked.Uniform = false;
+	tracked.Subresources[subresource] = after;
+
+	// Collapse back to a uniform state if all subresources agree again.
+	bool uniform = true;
+	for (State state : tracked.Subresources)
+		uniform = uniform && state == after;
+	if (uniform)
+	{
+		tracked.Uniform = true;
+		tracked.Whole = after;
+	}
+}
+
+void ResourceStateTracker::UavBarrier(const void* resource)
+{
+	for (const Barrier& pending : mPending)
+	{
+		// A transition into or out of the UAV state already orders the accesses.
+		if (pending.Resource == resource && (pending.Type == BarrierType::Uav ||
+			pending.Before == mUavState || pending.After == mUavState))
+			return;
+	}
+
+	Barrier barrier;
+	barrier.Type = BarrierType::Uav;
+	barrier.Resource = resource;
+	mPending.push_back(barrier);
+}
+
+void ResourceStateTracker::AliasingBarrier(const void* before, const void* after)
+{
+	Barrier barrier;
+	barrier.Type = BarrierType::Aliasing;
+	barrier.Resource = after;
+	barrier.AliasBefore = before;
+	mPending.push_back(barrier);
+}
@@ -0,0 +1,103 @@
+//***************************************************************************************
+// ResourceStateTracker.h
+//
+// Remembers the current state of every registered resource (per subresource when they
+// diverge) and turns "I am about to use this resource as X" requests into the minimal
+// list of transitions.  Redundant requests are dropped, a transition that is undone
+// before it is flushed disappears, and consecutive transitions of the same subresource
+// collapse into one.  Pending barriers are handed to a sink in one batch by Flush(),
+// which the caller does right before the next draw, dispatch or copy.
+//
+// Resources are opaque keys and states are plain bit masks (the D3D12_RESOURCE_STATES
+// values), so the tracker does not depend on D3D; D3D12StateTracker adapts it.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class ResourceStateTracker
+{
+public:
+	typedef std::uint32_t State;
+
+	static const std::uint32_t AllSubresources = 0xffffffff;
+
+	enum class BarrierType
+	{
+		Transition,
+		// Orders UAV accesses of the same resource; Subresource/Before/After are unused.
+		Uav,
+		// Resource starts using memory that AliasBefore (may be null) used so far.
+		Aliasing
+	};
+
+	struct Barrier
+	{
+		BarrierType Type = BarrierType::Transition;
+		const void* Resource = nullptr;
+		std::uint32_t Subresource = AllSubresources;
+		State Before = 0;
+		State After = 0;
+		const void* AliasBefore = nullptr;
+	};
+
+	// readOnlyStates is the mask of states that only read; requesting a read state that
+	// the resource is already in (as part of a combined read state) is not a transition.
+	// uavState is the state that needs a UAV barrier between consecutive uses.
+	ResourceStateTracker(State readOnlyStates, State uavState);
+
+	void Register(const void* resource, State initialState, std::uint32_t subresourceCount = 1);
+	void Unregister(const void* resource);
+	bool IsRegistered(const void* resource)const;
+
+	State GetState(const void* resource, std::uint32_t subresource = 0)const;
+
+	// Records that barriers recorded elsewhere (e.g. on an upload command list) left the
+	// whole resource in state; nothing is queued.  No barrier may be pending for it.
+	void SetState(const void* resource, State state);
+
+	// Requests resource (or one of its subresources) to be in state after.
+	void Transition(const void* resource, State after, std::uint32_t subresource = AllSubresources);
+
+	// Requests a UAV barrier on resource (if no transition is pending for it already).
+	void UavBarrier(const void* resource);
+
+	// Requests an aliasing barrier: after takes over memory shared with before (null if
+	// any other resource placed there may have used it).
+	void AliasingBarrier(const void* before, const void* after);
+
+	bool HasPendingBarriers()const { return !mPending.empty(); }
+	const std::vector<Barrier>& PendingBarriers()const { return mPending; }
+
+	// Hands every pending barrier to sink(const Barrier* barriers, size_t count) in one
+	// call and clears the list.
+	template<typename Sink>
+	void Flush(Sink&& sink)
+	{
+		if (mPending.empty())
+			return;
+		sink(mPending.data(), mPending.size());
+		mPending.clear();
+	}
+
+private:
+	struct TrackedResource
+	{
+		// Valid while every subresource is in the same state.
+		State Whole = 0;
+		bool Uniform = true;
+		std::vector<State> Subresources;
+	};
+
+	void AddTransition(const void* resource, std::uint32_t subresource, State before, State after);
+	bool IsSatisfied(State current, State requested)const;
+
+	State mReadOnlyStates = 0;
+	State mUavState = 0;
+
+	std::unordered_map<const void*, TrackedResource> mResources;
+	std::vector<Barrier> mPending;
+};
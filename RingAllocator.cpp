@@ -0,0 +1,94 @@
+#include "RingAllocator.h"
+#include <cassert>
+
+RingAllocator::RingAllocator(std::uint64_t capacity) :
+	mCapacity(capacity)
+{
+}
+
+std::uint64_t RingAllocator::Allocate(std::uint64_t byteSize, std::uint64_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two.");
+
+	if (byteSize == 0 || byteSize > mCapacity || IsFull())
+		return InvalidOffset;
+
+	// Nothing is in flight, so start over at the beginning for the largest possible block.
+	if (IsEmpty())
+		mHead = mTail = 0;
+
+	std::uint64_t offset = InvalidOffset;
+	std::uint64_t consumed = 0;
+
+	if (mHead >= mTail)
+	{
+		// Free space is [head, capacity) followed by [0, tail).
+		std::uint64_t aligned = AlignUp(mHead, alignment);
+		if (aligned + byteSize <= mCapacity)
+		{
+			offset = aligned;
+			consumed = (aligned - mHead) + byteSize;
+		}
+		else if (byteSize <= mTail)
+		{
+			// Skip the end of the ring and wrap around; offset 0 satisfies any alignment.
+			offset = 0;
+			consumed = (mCapacity - mHead) + byteSize;
+		}
+	}
+	else
+	{
+		// Free space is [head, tail).
+		std::uint64_t aligned = AlignUp(mHead, alignment);
+		if (aligned + byteSize <= mTail)
+		{
+			offset = aligned;
+			consumed = (aligned - mHead) + byteSize;
+		}
+	}
+
+	if (offset == InvalidOffset)
+		return InvalidOffset;
+
+	mHead = offset + byteSize;
+	if (mHead == mCapacity)
+		mHead = 0;
+
+	mUsedSize += consumed;
+	mOpenSize += consumed;
+
+	return offset;
+}
+
+void RingAllocator::FinishSubmission(std::uint64_t fenceValue)
+{
+	if (mOpenSize == 0)
+		return;
+
+	assert((mSubmissions.empty() || mSubmissions.back().FenceValue <= fenceValue) &&
+		"Submissions must be finished in fence order.");
+
+	Submission submission;
+	submission.FenceValue = fenceValue;
+	submission.End = mHead;
+	submission.Size = mOpenSize;
+	mSubmissions.push_back(submission);
+
+	mOpenSize = 0;
+}
+
+void RingAllocator::ReleaseCompleted(std::uint64_t completedFenceValue)
+{
+	while (!mSubmissions.empty() && mSubmissions.front().FenceValue <= completedFenceValue)
+	{
+		const Submission& oldest = mSubmissions.front();
+		mTail = oldest.End;
+		mUsedSize -= oldest.Size;
+		mSubmissions.pop_front();
+	}
+}
+
+std::uint64_t RingAllocator::OldestPendingFence()const
+{
+	return mSubmissions.empty() ? 0 : mSubmissions.front().FenceValue;
+}
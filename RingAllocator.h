@@ -0,0 +1,70 @@
+//***************************************************************************************
+// RingAllocator.h
+//
+// Linear sub-allocator over a fixed-size circular range of bytes.  Allocations are
+// handed out at the head; when a batch of work is submitted, everything allocated since
+// the previous submission is tagged with that submission's fence value and becomes
+// reclaimable once the fence completes.  It only deals with offsets, so the same code
+// backs GPU upload buffers and can be exercised entirely on the CPU.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+class RingAllocator
+{
+public:
+	static const std::uint64_t InvalidOffset = ~0ull;
+
+	explicit RingAllocator(std::uint64_t capacity);
+
+	// Returns the offset of a block of byteSize bytes aligned to alignment (a power of
+	// two), or InvalidOffset if the ring does not have enough contiguous free space.
+	// A block never straddles the end of the ring; the skipped tail is counted as used
+	// until it is reclaimed.
+	std::uint64_t Allocate(std::uint64_t byteSize, std::uint64_t alignment = 1);
+
+	// Tags everything allocated since the last call with fenceValue.
+	void FinishSubmission(std::uint64_t fenceValue);
+
+	// Frees every submission whose fence value is <= completedFenceValue.
+	void ReleaseCompleted(std::uint64_t completedFenceValue);
+
+	// Fence value of the oldest submission still holding memory (0 if none).
+	std::uint64_t OldestPendingFence()const;
+
+	std::uint64_t Capacity()const { return mCapacity; }
+	std::uint64_t UsedSize()const { return mUsedSize; }
+	std::uint64_t FreeSize()const { return mCapacity - mUsedSize; }
+	std::uint64_t Head()const { return mHead; }
+	std::uint64_t Tail()const { return mTail; }
+	bool IsEmpty()const { return mUsedSize == 0; }
+	bool IsFull()const { return mUsedSize == mCapacity; }
+
+	static std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+private:
+	struct Submission
+	{
+		std::uint64_t FenceValue = 0;
+		// Head position when the submission was closed; the tail moves here once it retires.
+		std::uint64_t End = 0;
+		// Bytes (including padding) the submission occupies.
+		std::uint64_t Size = 0;
+	};
+
+	std::uint64_t mCapacity = 0;
+	std::uint64_t mHead = 0;
+	std::uint64_t mTail = 0;
+	std::uint64_t mUsedSize = 0;
+
+	// Bytes allocated since the last FinishSubmission.
+	std::uint64_t mOpenSize = 0;
+
+	std::deque<Submission> mSubmissions;
+};
@@ -4,15 +4,20 @@
 // Transforms and colors geometry.
 //***************************************************************************************
 
-cbuffer cbPerObject : register(b0)
+cbuffer cbPass : register(b0)
 {
-	float4x4 gWorldViewProj; 
+	float4x4 gViewProj;
 };
 
 struct VertexIn
 {
 	float3 PosL  : POSITION;
     float4 Color : COLOR;
+
+	// Per-instance data (InstanceData), stepped once per instance.  WORLD0-3 are the
+	// rows of the world matrix as DirectXMath stores them.
+	row_major float4x4 World : WORLD;
+	uint Material  : MATERIAL;
 };
 
 struct VertexOut
@@ -26,7 +31,8 @@ VertexOut VS(VertexIn vin)
 	VertexOut vout;
 	
 	// Transform to homogeneous clip space.
-	vout.PosH = mul(float4(vin.PosL, 1.0f), gWorldViewProj);
+	float4 posW = mul(float4(vin.PosL, 1.0f), vin.World);
+	vout.PosH = mul(posW, gViewProj);
 	
 	// Just pass vertex color into the pixel shader.
     vout.Color = vin.Color;
@@ -0,0 +1,104 @@
+#include "SubmeshTable.h"
+#include <cassert>
+
+const SubmeshHandle SubmeshTable::InvalidHandle;
+
+void SubmeshTable::Reserve(std::uint32_t count)
+{
+	mIndexCounts.reserve(count);
+	mStartIndexLocations.reserve(count);
+	mBaseVertexLocations.reserve(count);
+	mBounds.reserve(count);
+	mSpheres.reserve(count);
+	mOrientedBoxes.reserve(count);
+	mFirstLods.reserve(count);
+	mLodCounts.reserve(count);
+	mLodErrors.reserve(count);
+	mNames.reserve(count);
+	mHandlesByName.reserve(count);
+}
+
+void SubmeshTable::Clear()
+{
+	mIndexCounts.clear();
+	mStartIndexLocations.clear();
+	mBaseVertexLocations.clear();
+	mBounds.clear();
+	mSpheres.clear();
+	mOrientedBoxes.clear();
+	mFirstLods.clear();
+	mLodCounts.clear();
+	mLodErrors.clear();
+	mNames.clear();
+	mHandlesByName.clear();
+}
+
+SubmeshHandle SubmeshTable::Add(const std::string& name, std::uint32_t indexCount, std::uint32_t startIndexLocation,
+	std::int32_t baseVertexLocation, const DirectX::BoundingBox& bounds)
+{
+	SubmeshHandle handle = Size();
+
+	bool inserted = mHandlesByName.emplace(name, handle).second;
+	assert(inserted && "Submesh names must be unique.");
+	if (!inserted)
+		return InvalidHandle;
+
+	mIndexCounts.push_back(indexCount);
+	mStartIndexLocations.push_back(startIndexLocation);
+	mBaseVertexLocations.push_back(baseVertexLocation);
+	MeshBounds volumes = MeshBounds::FromBox(bounds);
+	mBounds.push_back(volumes.Box);
+	mSpheres.push_back(volumes.Sphere);
+	mOrientedBoxes.push_back(volumes.OrientedBox);
+	mFirstLods.push_back(InvalidHandle);
+	mLodCounts.push_back(0);
+	mLodErrors.push_back(0.0f);
+	mNames.push_back(name);
+	return handle;
+}
+
+SubmeshHandle SubmeshTable::AddLod(SubmeshHandle base, std::uint32_t indexCount, std::uint32_t startIndexLocation,
+	float error)
+{
+	assert(IsValid(base));
+	SubmeshHandle handle = Size();
+	assert((mLodCounts[base] == 0 || mFirstLods[base] + mLodCounts[base] == handle) &&
+		"The LODs of a submesh must be added consecutively.");
+
+	std::string name = mNames[base] + "#lod" + std::to_string(mLodCounts[base] + 1);
+	if (Add(name, indexCount, startIndexLocation, mBaseVertexLocations[base], mBounds[base]) == InvalidHandle)
+		return InvalidHandle;
+	mSpheres[handle] = mSpheres[base];
+	mOrientedBoxes[handle] = mOrientedBoxes[base];
+
+	if (mLodCounts[base] == 0)
+		mFirstLods[base] = handle;
+	++mLodCounts[base];
+	mLodErrors[handle] = error;
+	return handle;
+}
+
+void SubmeshTable::SetBounds(SubmeshHandle handle, const MeshBounds& bounds)
+{
+	mBounds[handle] = bounds.Box;
+	mSpheres[handle] = bounds.Sphere;
+	mOrientedBoxes[handle] = bounds.OrientedBox;
+}
+
+SubmeshHandle SubmeshTable::SelectLod(SubmeshHandle handle, float maxError)const
+{
+	// Errors grow along the chain, so the first one from the coarse end that fits wins.
+	for (std::uint32_t level = mLodCounts[handle]; level > 0; --level)
+	{
+		SubmeshHandle lod = mFirstLods[handle] + level - 1;
+		if (mLodErrors[lod] <= maxError)
+			return lod;
+	}
+	return handle;
+}
+
+SubmeshHandle SubmeshTable::Find(const std::string& name)const
+{
+	auto it = mHandlesByName.find(name);
+	return it != mHandlesByName.end() ? it->second : InvalidHandle;
+}
@@ -0,0 +1,90 @@
+//***************************************************************************************
+// SubmeshTable.h
+//
+// The submeshes of a MeshGeometry, stored as parallel arrays and addressed by integer
+// handles.  Draw loops read the fields they need straight from the arrays; the name to
+// handle map is only meant for resolving names when content is loaded.
+//
+// A submesh can have a chain of simplified versions (LODs) that draw from the same
+// vertex buffer.  They are submeshes of their own, added with AddLod right after each
+// other, and SelectLod picks one from the error the caller can tolerate.
+//
+// Every submesh has a box, a sphere and an oriented box (see MeshBounds.h).  Add only
+// takes a box and derives the others from it; ComputeSubmeshBounds replaces all three
+// with volumes fitted to the vertices.
+//***************************************************************************************
+
+#pragma once
+
+#include "MeshBounds.h"
+#include <DirectXCollision.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef std::uint32_t SubmeshHandle;
+
+class SubmeshTable
+{
+public:
+	static const SubmeshHandle InvalidHandle = 0xffffffff;
+
+	void Reserve(std::uint32_t count);
+	void Clear();
+
+	// Names must be unique within the table.
+	SubmeshHandle Add(const std::string& name, std::uint32_t indexCount, std::uint32_t startIndexLocation,
+		std::int32_t baseVertexLocation, const DirectX::BoundingBox& bounds = DirectX::BoundingBox());
+
+	// Adds a coarser version of base, named "<base>#lod<n>", that is at most error away
+	// from it in the mesh's units.  The LODs of one submesh must be added consecutively,
+	// from finest to coarsest.
+	SubmeshHandle AddLod(SubmeshHandle base, std::uint32_t indexCount, std::uint32_t startIndexLocation, float error);
+
+	// Load-time lookup; InvalidHandle if there is no submesh with that name.
+	SubmeshHandle Find(const std::string& name)const;
+
+	std::uint32_t Size()const { return (std::uint32_t)mIndexCounts.size(); }
+	bool IsValid(SubmeshHandle handle)const { return handle < Size(); }
+
+	std::uint32_t IndexCount(SubmeshHandle handle)const { return mIndexCounts[handle]; }
+	std::uint32_t StartIndexLocation(SubmeshHandle handle)const { return mStartIndexLocations[handle]; }
+	std::int32_t BaseVertexLocation(SubmeshHandle handle)const { return mBaseVertexLocations[handle]; }
+	const DirectX::BoundingBox& Bounds(SubmeshHandle handle)const { return mBounds[handle]; }
+	const DirectX::BoundingSphere& Sphere(SubmeshHandle handle)const { return mSpheres[handle]; }
+	const DirectX::BoundingOrientedBox& OrientedBox(SubmeshHandle handle)const { return mOrientedBoxes[handle]; }
+	const std::string& Name(SubmeshHandle handle)const { return mNames[handle]; }
+
+	std::uint32_t LodCount(SubmeshHandle handle)const { return mLodCounts[handle]; }
+	float LodError(SubmeshHandle handle)const { return mLodErrors[handle]; }
+
+	// The coarsest LOD of handle whose error is at most maxError, or handle itself.  For
+	// an error of p pixels at distance d, maxError = p * d / (0.5 * viewport height * proj._22).
+	SubmeshHandle SelectLod(SubmeshHandle handle, float maxError)const;
+
+	void SetBounds(SubmeshHandle handle, const DirectX::BoundingBox& bounds) { SetBounds(handle, MeshBounds::FromBox(bounds)); }
+	void SetBounds(SubmeshHandle handle, const MeshBounds& bounds);
+
+	// Whole columns, for loops over many submeshes.
+	const std::uint32_t* IndexCounts()const { return mIndexCounts.data(); }
+	const std::uint32_t* StartIndexLocations()const { return mStartIndexLocations.data(); }
+	const std::int32_t* BaseVertexLocations()const { return mBaseVertexLocations.data(); }
+	const DirectX::BoundingBox* AllBounds()const { return mBounds.data(); }
+	const DirectX::BoundingSphere* AllSpheres()const { return mSpheres.data(); }
+
+private:
+	std::vector<std::uint32_t> mIndexCounts;
+	std::vector<std::uint32_t> mStartIndexLocations;
+	std::vector<std::int32_t> mBaseVertexLocations;
+	std::vector<DirectX::BoundingBox> mBounds;
+	std::vector<DirectX::BoundingSphere> mSpheres;
+	std::vector<DirectX::BoundingOrientedBox> mOrientedBoxes;
+	std::vector<SubmeshHandle> mFirstLods;
+	std::vector<std::uint32_t> mLodCounts;
+	std::vector<float> mLodErrors;
+
+	// Cold data, not touched while drawing.
+	std::vector<std::string> mNames;
+	std::unordered_map<std::string, SubmeshHandle> mHandlesByName;
+};
@@ -0,0 +1,127 @@
+#include "BoundingVolumeTree.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	double Milliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	// The axis-aligned box |x|, |y|, |z| <= halfSize as six planes.
+	void BoxPlanes(float halfSize, float planes[6][4])
+	{
+		const float box[6][4] =
+		{
+			{ 1, 0, 0, halfSize }, { -1, 0, 0, halfSize }, { 0, 1, 0, halfSize },
+			{ 0, -1, 0, halfSize }, { 0, 0, 1, halfSize }, { 0, 0, -1, halfSize }
+		};
+		std::copy(&box[0][0], &box[0][0] + 24, &planes[0][0]);
+	}
+}
+
+// Builds trees of 10k to 1M random boxes at the same density, then moves every box a
+// little with SetBounds and refits, queries a frustum holding about a thousand of them and
+// casts a thousand random rays.  Best of a few runs of each.
+int main()
+{
+	const int runCount = 3;
+
+	for (std::uint32_t count : { 10000u, 100000u, 1000000u })
+	{
+		// About one box per 1000 cubic units.
+		const float halfSize = 5.0f * std::cbrt((float)count);
+		std::mt19937 random(count);
+		std::uniform_real_distribution<float> position(-halfSize, halfSize);
+		std::uniform_real_distribution<float> extent(0.2f, 2.0f);
+		std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+
+		std::vector<BoundingBox> boxes(count);
+		for (BoundingBox& box : boxes)
+		{
+			box = BoundingBox(XMFLOAT3(position(random), position(random), position(random)),
+				XMFLOAT3(extent(random), extent(random), extent(random)));
+		}
+
+		BoundingVolumeTree tree;
+		std::vector<std::uint32_t> proxies;
+		double build = 1e30;
+		for (int run = 0; run < runCount; ++run)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			tree.Build(boxes.data(), nullptr, count, &proxies);
+			auto end = std::chrono::steady_clock::now();
+			build = std::min(build, Milliseconds(begin, end));
+		}
+
+		double refit = 1e30;
+		for (int run = 0; run < runCount; ++run)
+		{
+			for (BoundingBox& box : boxes)
+			{
+				box.Center.x += jitter(random);
+				box.Center.y += jitter(random);
+				box.Center.z += jitter(random);
+			}
+
+			auto begin = std::chrono::steady_clock::now();
+			for (std::uint32_t i = 0; i < count; ++i)
+				tree.SetBounds(proxies[i], boxes[i]);
+			tree.Refit();
+			auto end = std::chrono::steady_clock::now();
+			refit = std::min(refit, Milliseconds(begin, end));
+		}
+
+		float planes[6][4];
+		BoxPlanes(50.0f, planes);
+		std::vector<std::uint32_t> visible;
+		double query = 1e30;
+		for (int run = 0; run < runCount; ++run)
+		{
+			visible.clear();
+			auto begin = std::chrono::steady_clock::now();
+			tree.QueryFrustum(planes, visible);
+			auto end = std::chrono::steady_clock::now();
+			query = std::min(query, Milliseconds(begin, end));
+		}
+
+		const std::uint32_t rayCount = 1000;
+		std::vector<XMFLOAT3> origins(rayCount);
+		std::vector<XMFLOAT3> directions(rayCount);
+		std::normal_distribution<float> normal;
+		for (std::uint32_t i = 0; i < rayCount; ++i)
+		{
+			origins[i] = XMFLOAT3(position(random), position(random), position(random));
+			XMStoreFloat3(&directions[i], XMVector3Normalize(XMVectorSet(normal(random), normal(random), normal(random), 0.0f)));
+		}
+
+		std::uint32_t hits = 0;
+		double rayCast = 1e30;
+		for (int run = 0; run < runCount; ++run)
+		{
+			hits = 0;
+			auto begin = std::chrono::steady_clock::now();
+			for (std::uint32_t i = 0; i < rayCount; ++i)
+			{
+				if (tree.RayCast(XMLoadFloat3(&origins[i]), XMLoadFloat3(&directions[i]), 2.0f * halfSize) !=
+					BoundingVolumeTree::InvalidNode)
+					++hits;
+			}
+			auto end = std::chrono::steady_clock::now();
+			rayCast = std::min(rayCast, Milliseconds(begin, end));
+		}
+
+		std::printf("BoundingVolumeTree: %u boxes, height %u, cost %.1f\n", count, tree.Height(), tree.Cost());
+		std::printf("  build %.2f ms, SetBounds + Refit %.2f ms (%.1f ns/box)\n", build, refit, refit * 1e6 / count);
+		std::printf("  QueryFrustum %.3f ms, %zu visible; RayCast %.2f us/ray, %u of %u hit\n", query, visible.size(),
+			rayCast * 1e3 / rayCount, hits, rayCount);
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include "BuddyAllocator.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Allocates and frees blocks of random size in a 1 GB range, the way GpuHeapAllocator
+// places buffers and textures in its heaps, and reports the time per operation and the
+// fragmentation left behind.
+int main()
+{
+	const std::uint64_t capacity = 1ull << 30;
+	const int operations = 2000000;
+
+	BuddyAllocator allocator(capacity, 64 * 1024);
+	std::mt19937 random(1);
+	std::vector<std::uint64_t> live;
+	live.reserve(1024);
+
+	int failed = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < operations; ++i)
+	{
+		if (live.size() < 256 || (live.size() < 1024 && random() % 2 == 0))
+		{
+			std::uint64_t size = 1 + random() % (512u * 1024);
+			std::uint64_t offset = allocator.Allocate(size, 64 * 1024);
+			if (offset == BuddyAllocator::InvalidOffset)
+				++failed;
+			else
+				live.push_back(offset);
+		}
+		else
+		{
+			std::size_t index = random() % live.size();
+			allocator.Free(live[index]);
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	BuddyAllocator::Stats stats = allocator.GetStats();
+	std::printf("BuddyAllocator: %d operations, %.1f ns each, %d failed\n", operations, ns / operations, failed);
+	std::printf("  occupancy %.3f, internal fragmentation %.3f, external fragmentation %.3f\n",
+		stats.Occupancy(), stats.InternalFragmentation(), stats.ExternalFragmentation());
+	return 0;
+}
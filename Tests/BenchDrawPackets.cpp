@@ -0,0 +1,52 @@
+#include "DrawPackets.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Sorts a million draw keys on the calling thread and on a WorkerPool, once with keys
+// like the sample's (few passes, pipelines and root signatures, many materials) and
+// once with every bit random.
+int main()
+{
+	const std::uint32_t count = 1000 * 1000;
+	std::mt19937_64 random(1);
+	std::uniform_real_distribution<float> depth(0.0f, 1000.0f);
+
+	std::vector<std::uint64_t> sceneKeys(count), randomKeys(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		sceneKeys[i] = DrawKey::Make((std::uint32_t)(random() % 2), (std::uint32_t)(random() % 2),
+			(std::uint32_t)(random() % 16), (std::uint32_t)(random() % 4096), depth(random));
+		randomKeys[i] = random();
+	}
+
+	WorkerPool workers;
+	DrawPacketList packets;
+	packets.Reserve(count);
+
+	std::printf("DrawPacketList: %u keys\n", count);
+	for (const std::vector<std::uint64_t>* keys : { &sceneKeys, &randomKeys })
+	{
+		for (WorkerPool* pool : { (WorkerPool*)nullptr, &workers })
+		{
+			const int runs = 20;
+			double ms = 0.0;
+			for (int run = 0; run < runs; ++run)
+			{
+				packets.Clear();
+				for (std::uint32_t i = 0; i < count; ++i)
+					packets.Add((*keys)[i], i);
+
+				auto start = std::chrono::steady_clock::now();
+				packets.Sort(pool);
+				auto end = std::chrono::steady_clock::now();
+				ms += std::chrono::duration<double, std::milli>(end - start).count();
+			}
+			ms /= runs;
+			std::printf("  %s keys, %u thread(s): %.3f ms, %.1f Mkeys/s, %u passes (%u skipped)\n",
+				keys == &sceneKeys ? "scene" : "random", pool != nullptr ? pool->ThreadCount() : 1, ms,
+				count / ms / 1000.0, packets.SortedPasses(), packets.SkippedPasses());
+		}
+	}
+	return 0;
+}
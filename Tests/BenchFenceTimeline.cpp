@@ -0,0 +1,55 @@
+#include "FenceTimeline.h"
+#include "FakeFenceBackend.h"
+#include <chrono>
+#include <cstdio>
+
+// Runs FenceTimeline on FakeFenceBackend the way a frame uses it: signal, register a
+// few retirement callbacks, retire what the fake GPU finished.  Then times flushes and
+// reports how many waiters the pool had to create for them (one, if they are reused).
+int main()
+{
+	const int frames = 1000000;
+	const int callbacksPerFrame = 4;
+	const int framesInFlight = 3;
+
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		std::uint64_t ran = 0;
+		std::size_t retired = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; ++i)
+		{
+			std::uint64_t value = timeline.Signal();
+			for (int c = 0; c < callbacksPerFrame; ++c)
+				timeline.OnRetired(value, [&ran]() { ++ran; });
+			if (value > (std::uint64_t)framesInFlight)
+				backend.Complete(value - framesInFlight);
+			retired += timeline.RetireCompleted();
+		}
+		backend.CompleteAll();
+		retired += timeline.RetireCompleted();
+		auto end = std::chrono::steady_clock::now();
+
+		double ns = std::chrono::duration<double, std::nano>(end - start).count();
+		std::printf("Signal + %d OnRetired + RetireCompleted: %d frames, %.1f ns per frame, %.1f ns per callback\n",
+			callbacksPerFrame, frames, ns / frames, ns / (double)retired);
+		std::printf("  %llu callbacks ran\n", (unsigned long long)ran);
+	}
+
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < frames; ++i)
+			timeline.Flush();
+		auto end = std::chrono::steady_clock::now();
+
+		double ns = std::chrono::duration<double, std::nano>(end - start).count();
+		std::printf("Flush: %d waits, %.1f ns each, %zu waiter(s) created, %d backend waits\n",
+			frames, ns / frames, timeline.Waiters().CreatedCount(), backend.WaitCount());
+	}
+	return 0;
+}
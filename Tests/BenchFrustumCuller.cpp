@@ -0,0 +1,99 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	// The planes of an unrotated frustum, in the form Cull takes.
+	void FrustumPlanes(const BoundingFrustum& frustum, float planes[6][4])
+	{
+		const float o[3] = { frustum.Origin.x, frustum.Origin.y, frustum.Origin.z };
+		// Right, left, top, bottom: x <= RightSlope * z and so on, z measured from the origin.
+		const float sides[4][3] =
+		{
+			{ -1.0f, 0.0f, frustum.RightSlope }, { 1.0f, 0.0f, -frustum.LeftSlope },
+			{ 0.0f, -1.0f, frustum.TopSlope }, { 0.0f, 1.0f, -frustum.BottomSlope }
+		};
+		for (int p = 0; p < 4; ++p)
+		{
+			float length = std::sqrt(sides[p][0] * sides[p][0] + sides[p][1] * sides[p][1] + sides[p][2] * sides[p][2]);
+			for (int i = 0; i < 3; ++i)
+				planes[p][i] = sides[p][i] / length;
+			planes[p][3] = -(planes[p][0] * o[0] + planes[p][1] * o[1] + planes[p][2] * o[2]);
+		}
+		const float nearFar[2][4] = { { 0.0f, 0.0f, 1.0f, -(o[2] + frustum.Near) }, { 0.0f, 0.0f, -1.0f, o[2] + frustum.Far } };
+		std::copy(&nearFar[0][0], &nearFar[0][0] + 8, &planes[4][0]);
+	}
+}
+
+// Culls a million random boxes against a camera frustum, on the calling thread and on a
+// WorkerPool the way Update does every frame, next to BoundingFrustum::Intersects called
+// on every box.
+int main()
+{
+	const std::uint32_t count = 1000 * 1000;
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+	FrustumCuller culler;
+	culler.Reserve(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+		culler.Add(BoundingBox(XMFLOAT3(position(random), position(random), position(random)), XMFLOAT3(0.5f, 0.5f, 0.5f)));
+
+	// A 90 degree camera behind the boxes looking down +z: about two thirds of them.
+	BoundingFrustum frustum;
+	frustum.Origin = XMFLOAT3(0.0f, 0.0f, -100.0f);
+	frustum.RightSlope = frustum.TopSlope = 1.0f;
+	frustum.LeftSlope = frustum.BottomSlope = -1.0f;
+	frustum.Near = 1.0f;
+	frustum.Far = 200.0f;
+	float planes[6][4];
+	FrustumPlanes(frustum, planes);
+
+	WorkerPool workers;
+	std::vector<std::uint32_t> visible;
+	visible.reserve(count);
+
+	std::printf("FrustumCuller: %u boxes\n", count);
+	for (WorkerPool* pool : { (WorkerPool*)nullptr, &workers })
+	{
+		const int runs = 50;
+		auto start = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; ++run)
+			culler.Cull(planes, visible, pool);
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+		std::printf("  %u thread(s): %.3f ms, %.1f Mboxes/s, %zu visible\n", pool != nullptr ? pool->ThreadCount() : 1,
+			ms, count / ms / 1000.0, visible.size());
+	}
+
+	// The per-object test the culler replaces.  It is exact, so it keeps no more boxes
+	// than the plane tests.
+	std::vector<BoundingBox> boxes;
+	boxes.reserve(count);
+	random.seed(1);
+	for (std::uint32_t i = 0; i < count; ++i)
+		boxes.push_back(BoundingBox(XMFLOAT3(position(random), position(random), position(random)), XMFLOAT3(0.5f, 0.5f, 0.5f)));
+
+	const int runs = 5;
+	auto start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; ++run)
+	{
+		visible.clear();
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			if (frustum.Intersects(boxes[i]))
+				visible.push_back(i);
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+	std::printf("  BoundingFrustum::Intersects per box: %.3f ms, %.1f Mboxes/s, %zu visible\n", ms, count / ms / 1000.0,
+		visible.size());
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include "MeshBounds.h"
+#include "SubmeshTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	double Seconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double>(end - start).count();
+	}
+
+	// Points in a rotated 20 x 2 x 1 slab, with a normal and texture coordinate after each
+	// position as in a vertex buffer.
+	struct Vertex
+	{
+		XMFLOAT3 Position;
+		XMFLOAT3 Normal;
+		XMFLOAT2 TexC;
+	};
+
+	std::vector<Vertex> MakeSlab(std::uint32_t count)
+	{
+		std::mt19937 random(count);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		XMMATRIX rotation = XMMatrixRotationRollPitchYaw(0.3f, 0.7f, -0.4f);
+
+		std::vector<Vertex> vertices(count);
+		for (Vertex& v : vertices)
+		{
+			XMVECTOR local = XMVectorSet(10.0f * unit(random), unit(random), 0.5f * unit(random), 1.0f);
+			XMStoreFloat3(&v.Position, XMVector3TransformCoord(local, rotation));
+			v.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+			v.TexC = XMFLOAT2(0.0f, 0.0f);
+		}
+		return vertices;
+	}
+
+	float Volume(const XMFLOAT3& extents)
+	{
+		return 8.0f * extents.x * extents.y * extents.z;
+	}
+}
+
+// Computes the three volumes of 10k to 1M points with ComputeMeshBounds next to the box
+// alone from BoundingBox::CreateFromPoints, then the bounds of 256 submeshes over the 1M
+// points serially and on a WorkerPool with every hardware thread.  Best of a few runs.
+int main()
+{
+	const int runCount = 5;
+
+	for (std::uint32_t pointCount : { 10000u, 100000u, 1000000u })
+	{
+		std::vector<Vertex> vertices = MakeSlab(pointCount);
+
+		double createFromPoints = 1e30;
+		BoundingBox box;
+		for (int run = 0; run < runCount; ++run)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			BoundingBox::CreateFromPoints(box, pointCount, &vertices[0].Position, sizeof(Vertex));
+			auto end = std::chrono::steady_clock::now();
+			createFromPoints = std::min(createFromPoints, Seconds(begin, end));
+		}
+
+		double compute = 1e30;
+		MeshBounds bounds;
+		for (int run = 0; run < runCount; ++run)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			bounds = ComputeMeshBounds(&vertices[0].Position.x, sizeof(Vertex), pointCount);
+			auto end = std::chrono::steady_clock::now();
+			compute = std::min(compute, Seconds(begin, end));
+		}
+
+		std::printf("MeshBounds: %u points\n", pointCount);
+		std::printf("  BoundingBox::CreateFromPoints %.2f ms (%.1f M points/s), box volume %.1f\n",
+			createFromPoints * 1e3, pointCount / createFromPoints / 1e6, Volume(box.Extents));
+		std::printf("  ComputeMeshBounds %.2f ms (%.1f M points/s, %.1fx the box alone), box %.1f, oriented box %.1f, sphere radius %.2f%s\n",
+			compute * 1e3, pointCount / compute / 1e6, compute / createFromPoints, Volume(bounds.Box.Extents),
+			Volume(bounds.OrientedBox.Extents), bounds.Sphere.Radius,
+			bounds.Box.Extents.x == box.Extents.x ? "" : " (boxes differ!)");
+	}
+
+	const std::uint32_t pointCount = 1000000;
+	const std::uint32_t submeshCount = 256;
+	const std::uint32_t pointsPerSubmesh = pointCount / submeshCount;
+	std::vector<Vertex> vertices = MakeSlab(pointCount);
+	std::vector<std::uint32_t> indices(pointCount);
+	SubmeshTable table;
+	table.Reserve(submeshCount);
+	for (std::uint32_t s = 0; s < submeshCount; ++s)
+	{
+		for (std::uint32_t i = 0; i < pointsPerSubmesh; ++i)
+			indices[s * pointsPerSubmesh + i] = i;
+		table.Add("submesh" + std::to_string(s), pointsPerSubmesh, s * pointsPerSubmesh, s * pointsPerSubmesh);
+	}
+
+	WorkerPool workers(std::max(1u, std::thread::hardware_concurrency()));
+	std::printf("ComputeSubmeshBounds: %u submeshes, %u indices\n", submeshCount, submeshCount * pointsPerSubmesh);
+	for (WorkerPool* pool : { (WorkerPool*)nullptr, &workers })
+	{
+		double best = 1e30;
+		for (int run = 0; run < runCount; ++run)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			ComputeSubmeshBounds(table, &vertices[0].Position.x, sizeof(Vertex), indices.data(), pool);
+			auto end = std::chrono::steady_clock::now();
+			best = std::min(best, Seconds(begin, end));
+		}
+		std::printf("  %u threads: %.2f ms (%.1f M indices/s)\n", pool != nullptr ? pool->ThreadCount() : 1,
+			best * 1e3, submeshCount * pointsPerSubmesh / best / 1e6);
+	}
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include "MeshFile.h"
+#include "MappedFile.h"
+#include "ObjImporter.h"
+#include "TestMeshes.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+	double Seconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double>(end - start).count();
+	}
+
+	// Best of a few runs, so both files are read from the page cache.
+	template <typename Load>
+	double BestSeconds(Load load)
+	{
+		double best = 1e30;
+		for (int run = 0; run < 5; ++run)
+		{
+			auto start = std::chrono::steady_clock::now();
+			load();
+			auto end = std::chrono::steady_clock::now();
+			best = std::min(best, Seconds(start, end));
+		}
+		return best;
+	}
+}
+
+// Writes the same sphere as a mesh file and as OBJ text and times getting from the file to
+// vertex and index arrays that can be uploaded: mapping and validating the mesh file (the
+// arrays are used in place), the same plus copying them out, and importing the OBJ file
+// serially and on a WorkerPool.
+int main()
+{
+	const char* meshPath = "BenchMeshFile.mesh";
+	const char* objPath = "BenchMeshFile.obj";
+	WorkerPool workers(std::max(1u, std::thread::hardware_concurrency()));
+
+	for (std::uint32_t rings : { 128u, 512u, 1024u })
+	{
+		std::vector<TestMeshes::Vertex> vertices;
+		std::vector<std::uint32_t> indices;
+		TestMeshes::MakeSphere(rings, rings, vertices, indices);
+
+		MeshFileSource source;
+		source.VertexStride = sizeof(TestMeshes::Vertex);
+		source.VertexCount = (std::uint32_t)vertices.size();
+		source.Vertices = vertices.data();
+		source.IndexSize = 4;
+		source.IndexCount = (std::uint32_t)indices.size();
+		source.Indices = indices.data();
+		MeshFileSource::Submesh submesh;
+		submesh.Name = "sphere";
+		submesh.IndexCount = source.IndexCount;
+		source.Submeshes.push_back(submesh);
+		if (!WriteMeshFile(meshPath, source))
+		{
+			std::printf("cannot write %s\n", meshPath);
+			return 1;
+		}
+
+		std::string text = TestMeshes::MakeObjText(vertices, indices, "sphere");
+		{
+			std::ofstream out(objPath, std::ios::binary | std::ios::trunc);
+			out.write(text.data(), (std::streamsize)text.size());
+		}
+
+		bool failed = false;
+		std::uint64_t meshBytes = 0;
+		double mapped = BestSeconds([&]()
+		{
+			MappedFile file;
+			MeshFileView view;
+			failed |= !file.Open(meshPath) || view.Parse(file.Data(), file.Size()) != MeshFile::Status::Ok;
+			meshBytes = file.Size();
+		});
+
+		std::vector<unsigned char> vertexCopy, indexCopy;
+		double copied = BestSeconds([&]()
+		{
+			MappedFile file;
+			MeshFileView view;
+			failed |= !file.Open(meshPath) || view.Parse(file.Data(), file.Size()) != MeshFile::Status::Ok;
+			if (file.IsOpen())
+			{
+				const unsigned char* v = static_cast<const unsigned char*>(view.VertexData());
+				const unsigned char* i = static_cast<const unsigned char*>(view.IndexData());
+				vertexCopy.assign(v, v + view.VertexByteSize());
+				indexCopy.assign(i, i + view.IndexByteSize());
+			}
+		});
+
+		ObjImporter importer;
+		ObjMesh mesh;
+		double serial = BestSeconds([&]() { failed |= !importer.ImportFile(objPath, mesh); });
+		double pooled = BestSeconds([&]() { failed |= !importer.ImportFile(objPath, mesh, &workers); });
+		failed |= mesh.Indices.size() != indices.size();
+
+		std::printf("%u vertices, %zu triangles: mesh file %.1f MB, OBJ %.1f MB%s\n",
+			source.VertexCount, indices.size() / 3, meshBytes / 1e6, text.size() / 1e6, failed ? " (load failed!)" : "");
+		std::printf("  mesh file: map + parse %.3f ms, + copy out %.3f ms\n", mapped * 1e3, copied * 1e3);
+		std::printf("  OBJ: serial %.1f ms, %u threads %.1f ms (%.0fx the copied mesh file)\n",
+			serial * 1e3, workers.ThreadCount(), pooled * 1e3, pooled / copied);
+	}
+
+	std::remove(meshPath);
+	std::remove(objPath);
+	return 0;
+}
@@ -0,0 +1,28 @@
+#include "MeshSimplifier.h"
+#include "TestMeshes.h"
+#include <chrono>
+#include <cstdio>
+
+// Simplifies a sphere of about a million triangles to a half, a quarter and a tenth of
+// its triangles, like one LOD chain of ImportObjGeometry.
+int main()
+{
+	std::vector<TestMeshes::Vertex> vertices;
+	std::vector<std::uint32_t> indices;
+	TestMeshes::MakeSphere(512, 1024, vertices, indices);
+	std::vector<std::uint32_t> result(indices.size());
+
+	std::printf("MeshSimplifier: %zu triangles\n", indices.size() / 3);
+	for (std::size_t divisor : { 2, 4, 10 })
+	{
+		float error = 0.0f;
+		auto start = std::chrono::steady_clock::now();
+		std::size_t count = MeshSimplifier::Simplify(result.data(), indices.data(), indices.size(),
+			vertices[0].Position, sizeof(TestMeshes::Vertex), (std::uint32_t)vertices.size(),
+			indices.size() / divisor / 3 * 3, 1.0f, &error);
+		auto end = std::chrono::steady_clock::now();
+		std::printf("  1/%zu: %zu triangles, error %.2e, %.0f ms\n", divisor, count / 3, error,
+			std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return 0;
+}
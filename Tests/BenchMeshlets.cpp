@@ -0,0 +1,48 @@
+#include "Meshlets.h"
+#include "TestMeshes.h"
+#include <chrono>
+#include <cstdio>
+
+// Builds the meshlets of a sphere of about a million triangles and culls them from a
+// camera that sees part of it, reporting the time of each and the cull throughput.
+int main()
+{
+	std::vector<TestMeshes::Vertex> vertices;
+	std::vector<std::uint32_t> indices;
+	TestMeshes::MakeSphere(512, 1024, vertices, indices);
+	const std::size_t triangleCount = indices.size() / 3;
+
+	MeshletSet set;
+	auto start = std::chrono::steady_clock::now();
+	MeshletRange range = Meshlets::Build(set, indices.data(), indices.size(), vertices[0].Position,
+		sizeof(TestMeshes::Vertex), (std::uint32_t)vertices.size());
+	auto end = std::chrono::steady_clock::now();
+	double buildMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// Close enough that part of the sphere is off screen and every meshlet covers pixels.
+	MeshletCullParams params;
+	float viewProj[16];
+	TestMeshes::MakeViewProj(1.6f, 0.25f * 3.14159265f, 16.0f / 9.0f, 0.1f, 100.0f, viewProj);
+	Meshlets::ExtractFrustumPlanes(viewProj, params.FrustumPlanes);
+	params.CameraPosition[2] = -1.6f;
+	params.ProjectionScale = 0.5f * 1080.0f * viewProj[5];
+
+	const int runs = 20;
+	std::vector<std::uint32_t> visible;
+	visible.reserve(indices.size());
+	MeshletCullStats stats;
+	start = std::chrono::steady_clock::now();
+	for (int run = 0; run < runs; ++run)
+	{
+		visible.clear();
+		stats = Meshlets::Cull(set, range, params, visible);
+	}
+	end = std::chrono::steady_clock::now();
+	double cullMs = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+
+	std::printf("Meshlets: %zu triangles in %u meshlets, build %.1f ms\n", triangleCount, range.MeshletCount, buildMs);
+	std::printf("  cull %.3f ms (%.0f meshlets/ms): %u visible, %u frustum, %u backface, %u small, %u indices\n",
+		cullMs, range.MeshletCount / cullMs, stats.Visible, stats.FrustumCulled, stats.BackfaceCulled, stats.SmallCulled,
+		stats.IndexCount);
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include "ObjImporter.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// A size x size grid of quads in the layout exporters write: positions, texture
+	// coordinates and one shared normal, then "f v/vt/vn" quads, one group per row band.
+	std::string MakeGrid(std::uint32_t size)
+	{
+		std::string text;
+		text.reserve((std::size_t)(size + 1) * (size + 1) * 48 + (std::size_t)size * size * 48);
+		char line[128];
+		for (std::uint32_t z = 0; z <= size; ++z)
+		{
+			for (std::uint32_t x = 0; x <= size; ++x)
+			{
+				std::snprintf(line, sizeof(line), "v %.4f 0.0000 %.4f\nvt %.5f %.5f\n",
+					x * 0.1f, z * 0.1f, (float)x / size, (float)z / size);
+				text += line;
+			}
+		}
+		text += "vn 0 1 0\n";
+
+		for (std::uint32_t z = 0; z < size; ++z)
+		{
+			if (z % 64 == 0)
+			{
+				std::snprintf(line, sizeof(line), "g band%u\n", z / 64);
+				text += line;
+			}
+			for (std::uint32_t x = 0; x < size; ++x)
+			{
+				std::uint32_t a = z * (size + 1) + x + 1;
+				std::uint32_t b = a + size + 1;
+				std::snprintf(line, sizeof(line), "f %u/%u/1 %u/%u/1 %u/%u/1 %u/%u/1\n",
+					a, a, b, b, b + 1, b + 1, a + 1, a + 1);
+				text += line;
+			}
+		}
+		return text;
+	}
+}
+
+// Imports generated grids of 64k to 4M quads from memory, serially and on a WorkerPool
+// with every hardware thread, and reports the best of a few runs of each.
+int main()
+{
+	WorkerPool workers(std::max(1u, std::thread::hardware_concurrency()));
+
+	for (std::uint32_t size : { 256u, 1024u, 2048u })
+	{
+		std::string text = MakeGrid(size);
+		ObjImporter importer;
+		ObjMesh mesh;
+
+		std::printf("OBJ grid: %u quads, %.1f MB\n", size * size, text.size() / (1024.0 * 1024.0));
+		for (WorkerPool* pool : { (WorkerPool*)nullptr, &workers })
+		{
+			ObjImportStats best;
+			bool imported = true;
+			for (int run = 0; run < 3; ++run)
+			{
+				imported &= importer.Import(text.data(), text.size(), mesh, pool);
+				if (run == 0 || importer.Stats().TotalSeconds() < best.TotalSeconds())
+					best = importer.Stats();
+			}
+
+			std::printf("  %u threads, %u chunks, parse %.1f ms + resolve %.1f ms: %.0f MB/s, %.1f M triangles/s%s\n",
+				pool != nullptr ? pool->ThreadCount() : 1, best.ChunkCount, best.ParseSeconds * 1e3,
+				best.ResolveSeconds * 1e3, best.MegabytesPerSecond(), best.TrianglesPerSecond() / 1e6,
+				imported && best.TriangleCount == 2ull * size * size ? "" : " (import failed!)");
+		}
+	}
+	return 0;
+}
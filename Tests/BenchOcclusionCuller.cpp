@@ -0,0 +1,49 @@
+#include "OcclusionCuller.h"
+#include "TestMeshes.h"
+#include <chrono>
+#include <cstdio>
+
+using namespace DirectX;
+
+// Rasterizes a grid of sphere occluders into the sample's 256 x 128 depth buffer, on the
+// calling thread and on a WorkerPool, the way Update does every frame.
+int main()
+{
+	std::vector<TestMeshes::Vertex> vertices;
+	std::vector<std::uint32_t> indices;
+	TestMeshes::MakeSphere(32, 64, vertices, indices);
+
+	const XMMATRIX viewProj = XMMatrixMultiply(
+		XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -30.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)),
+		XMMatrixPerspectiveFovLH(0.25f * 3.14159265f, 2.0f, 1.0f, 1000.0f));
+	const int grid = 8;
+
+	OcclusionCuller culler(256, 128);
+	WorkerPool workers;
+
+	std::printf("OcclusionCuller: %d occluders of %zu triangles\n", grid * grid, indices.size() / 3);
+	for (WorkerPool* pool : { (WorkerPool*)nullptr, &workers })
+	{
+		const int runs = 50;
+		auto start = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; ++run)
+		{
+			culler.Clear();
+			for (int y = 0; y < grid; ++y)
+			{
+				for (int x = 0; x < grid; ++x)
+				{
+					XMMATRIX world = XMMatrixTranslation(3.0f * (x - grid / 2), 3.0f * (y - grid / 2), 0.0f);
+					culler.AddOccluder(vertices[0].Position, sizeof(TestMeshes::Vertex), indices.data(), indices.size(),
+						XMMatrixMultiply(world, viewProj));
+				}
+			}
+			culler.Render(pool);
+		}
+		auto end = std::chrono::steady_clock::now();
+		double ms = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+		std::printf("  %u thread(s): %.3f ms, %u triangles rasterized\n", pool != nullptr ? pool->ThreadCount() : 1,
+			ms, culler.Stats().RasterizedTriangles);
+	}
+	return 0;
+}
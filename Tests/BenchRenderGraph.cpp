@@ -0,0 +1,89 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const RenderGraph::State RenderTarget = 0x4;
+	const RenderGraph::State UnorderedAccess = 0x8;
+	const RenderGraph::State PixelShaderResource = 0x80;
+	const RenderGraph::State GenericRead = 0xac3;
+
+	// A chain of passes where each one writes a new transient (render target or UAV)
+	// and reads two of the last few; every eighth pass writes an import, and every
+	// sixteenth transient is never read so its pass is culled.
+	void Declare(RenderGraph& graph, std::uint32_t passCount)
+	{
+		std::mt19937 random(passCount);
+		std::vector<RenderGraph::ResourceHandle> transients;
+		transients.reserve(passCount);
+
+		auto backBuffer = graph.Import("BackBuffer", 0, 0);
+		for (std::uint32_t i = 0; i < passCount; ++i)
+		{
+			RenderGraph::TransientDesc desc;
+			desc.ByteSize = (1 + random() % 16) << 20;
+			desc.Alignment = 64 * 1024;
+
+			auto pass = graph.AddPass("Pass" + std::to_string(i));
+			for (int r = 0; r < 2 && !transients.empty(); ++r)
+			{
+				std::size_t back = 1 + random() % std::min<std::size_t>(transients.size(), 8);
+				graph.Read(pass, transients[transients.size() - back], PixelShaderResource);
+			}
+
+			auto output = graph.CreateTransient("Target" + std::to_string(i), desc);
+			graph.Write(pass, output, i % 3 == 0 ? UnorderedAccess : RenderTarget);
+			if (i % 16 != 15)
+				transients.push_back(output);
+			if (i % 8 == 7)
+				graph.Write(pass, backBuffer, RenderTarget);
+		}
+	}
+}
+
+// Declares and compiles synthetic graphs of 1k to 10k passes, once with a topology the
+// graph has not seen (full compile) and then again with the same one (cache hit, which
+// is what happens every frame the frame graph does not change).
+int main()
+{
+	for (std::uint32_t passCount : { 1000u, 3000u, 10000u })
+	{
+		RenderGraph graph(GenericRead | PixelShaderResource, UnorderedAccess);
+
+		auto start = std::chrono::steady_clock::now();
+		Declare(graph, passCount);
+		bool compiled = graph.Compile();
+		auto end = std::chrono::steady_clock::now();
+		double missMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+		std::uint32_t culled = 0;
+		std::size_t barriers = 0;
+		for (std::uint32_t p = 0; p < graph.PassCount(); ++p)
+			culled += graph.IsCulled(p) ? 1 : 0;
+		for (const RenderGraph::ScheduledPass& pass : graph.Schedule())
+			barriers += pass.Barriers.size();
+
+		const int runs = 20;
+		bool recompiled = false;
+		start = std::chrono::steady_clock::now();
+		for (int run = 0; run < runs; ++run)
+		{
+			graph.Reset();
+			Declare(graph, passCount);
+			recompiled |= graph.Compile();
+		}
+		end = std::chrono::steady_clock::now();
+		double hitMs = std::chrono::duration<double, std::milli>(end - start).count() / runs;
+
+		std::printf("RenderGraph: %u passes, %u culled, %zu barriers, %.1f MB of transients\n",
+			passCount, culled, barriers, graph.TransientByteSize() / (1024.0 * 1024.0));
+		std::printf("  declare + compile %.3f ms%s, declare + cache hit %.3f ms%s\n",
+			missMs, compiled ? "" : " (not compiled!)", hitMs, recompiled ? " (recompiled!)" : "");
+	}
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include "RenderItemStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	double Milliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	// One item with every component together, the layout the store replaced.
+	struct RenderItem
+	{
+		GeometryHandle Geometry = 0;
+		SubmeshHandle Submesh = 0;
+		std::uint32_t Pipeline = 0;
+		std::uint32_t Material = 0;
+		XMFLOAT4X4 World;
+		BoundingBox Bounds;
+	};
+
+	// Keeps x >= 0: about half of the items.
+	void PositiveX(float planes[6][4])
+	{
+		const float halfSpace[6][4] =
+		{
+			{ 1, 0, 0, 0 }, { -1, 0, 0, 1e6f }, { 0, 1, 0, 1e6f },
+			{ 0, -1, 0, 1e6f }, { 0, 0, 1, 1e6f }, { 0, 0, -1, 1e6f }
+		};
+		std::copy(&halfSpace[0][0], &halfSpace[0][0] + 24, &planes[0][0]);
+	}
+}
+
+// Fills a store with a million items, then destroys and recreates a tenth of them at random
+// a few times, and gathers the world matrices and bounds of the items a frustum keeps
+// into packed arrays, the way Update fills the per-object constants, next to the same
+// gather from an array of whole items.  Best of a few runs.
+int main()
+{
+	const std::uint32_t count = 1000 * 1000;
+	const std::uint32_t churnCount = count / 10;
+	const int runCount = 5;
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::vector<XMFLOAT4X4> worlds(count);
+	std::vector<BoundingBox> bounds(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		float x = position(random), y = position(random), z = position(random);
+		XMStoreFloat4x4(&worlds[i], XMMatrixTranslation(x, y, z));
+		bounds[i] = BoundingBox(XMFLOAT3(x, y, z), XMFLOAT3(0.5f, 0.5f, 0.5f));
+	}
+
+	RenderItemStore store;
+	store.Reserve(count);
+	std::vector<RenderItemHandle> handles(count);
+	auto begin = std::chrono::steady_clock::now();
+	for (std::uint32_t i = 0; i < count; ++i)
+		handles[i] = store.Create(i % 16, i % 256, i % 4, i % 64, worlds[i], bounds[i]);
+	auto end = std::chrono::steady_clock::now();
+	const double create = Milliseconds(begin, end);
+
+	std::printf("RenderItemStore: %u items\n", count);
+	std::printf("  Create %.1f ns/item\n", create * 1e6 / count);
+
+	double churn = 1e30;
+	std::vector<std::uint32_t> picked(churnCount);
+	for (int run = 0; run < runCount; ++run)
+	{
+		for (std::uint32_t& i : picked)
+			i = random() % count;
+		std::sort(picked.begin(), picked.end());
+		picked.erase(std::unique(picked.begin(), picked.end()), picked.end());
+
+		begin = std::chrono::steady_clock::now();
+		for (std::uint32_t i : picked)
+			store.Destroy(handles[i]);
+		for (std::uint32_t i : picked)
+			handles[i] = store.Create(i % 16, i % 256, i % 4, i % 64, worlds[i], bounds[i]);
+		end = std::chrono::steady_clock::now();
+		churn = std::min(churn, Milliseconds(begin, end) / picked.size());
+		picked.resize(churnCount);
+	}
+	std::printf("  Destroy + Create of a random tenth: %.1f ns/item%s\n", churn * 1e6,
+		store.Size() == count ? "" : " (size changed!)");
+
+	float planes[6][4];
+	PositiveX(planes);
+	std::vector<std::uint32_t> visible;
+	store.Culler().Cull(planes, visible);
+
+	std::vector<RenderItem> items(count);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		items[i].Geometry = store.Geometries()[i];
+		items[i].Submesh = store.Submeshes()[i];
+		items[i].Pipeline = store.Pipelines()[i];
+		items[i].Material = store.Materials()[i];
+		items[i].World = store.Worlds()[i];
+		items[i].Bounds = store.Bounds()[i];
+	}
+
+	std::vector<XMFLOAT4X4> gatheredWorlds(visible.size());
+	std::vector<BoundingBox> gatheredBounds(visible.size());
+	double components = 1e30;
+	double wholeItems = 1e30;
+	for (int run = 0; run < runCount; ++run)
+	{
+		const XMFLOAT4X4* storeWorlds = store.Worlds();
+		const BoundingBox* storeBounds = store.Bounds();
+		begin = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < visible.size(); ++i)
+		{
+			gatheredWorlds[i] = storeWorlds[visible[i]];
+			gatheredBounds[i] = storeBounds[visible[i]];
+		}
+		end = std::chrono::steady_clock::now();
+		components = std::min(components, Milliseconds(begin, end));
+
+		begin = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < visible.size(); ++i)
+		{
+			gatheredWorlds[i] = items[visible[i]].World;
+			gatheredBounds[i] = items[visible[i]].Bounds;
+		}
+		end = std::chrono::steady_clock::now();
+		wholeItems = std::min(wholeItems, Milliseconds(begin, end));
+	}
+
+	std::printf("  gather Worlds() and Bounds() of %zu visible: %.2f ms (%.1f ns/item)\n", visible.size(), components,
+		components * 1e6 / visible.size());
+	std::printf("  same from an array of %zu-byte items: %.2f ms (%.1f ns/item)\n", sizeof(RenderItem), wholeItems,
+		wholeItems * 1e6 / visible.size());
+	return 0;
+}
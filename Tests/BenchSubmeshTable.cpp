@@ -0,0 +1,65 @@
+#include "SubmeshTable.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	double Seconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+	{
+		return std::chrono::duration<double>(end - start).count();
+	}
+}
+
+// Issues the same random draw list by name (a hash lookup per draw, as the old DrawArgs
+// map did) and by handle (three array reads), for tables of 10k to 100k submeshes.
+int main()
+{
+	for (std::uint32_t submeshCount : { 10000u, 30000u, 100000u })
+	{
+		SubmeshTable table;
+		table.Reserve(submeshCount);
+		std::vector<std::string> names(submeshCount);
+		std::uint32_t start = 0;
+		for (std::uint32_t i = 0; i < submeshCount; ++i)
+		{
+			names[i] = "submesh" + std::to_string(i);
+			table.Add(names[i], 36 + i % 64 * 3, start, i * 24);
+			start += 36 + i % 64 * 3;
+		}
+
+		const std::uint32_t drawCount = 1000000;
+		std::mt19937 random(submeshCount);
+		std::vector<SubmeshHandle> draws(drawCount);
+		for (SubmeshHandle& handle : draws)
+			handle = random() % submeshCount;
+
+		std::uint64_t byNameSum = 0;
+		auto begin = std::chrono::steady_clock::now();
+		for (SubmeshHandle handle : draws)
+		{
+			SubmeshHandle found = table.Find(names[handle]);
+			byNameSum += table.IndexCount(found) + table.StartIndexLocation(found) + table.BaseVertexLocation(found);
+		}
+		auto end = std::chrono::steady_clock::now();
+		double byName = Seconds(begin, end);
+
+		const std::uint32_t* indexCounts = table.IndexCounts();
+		const std::uint32_t* startIndices = table.StartIndexLocations();
+		const std::int32_t* baseVertices = table.BaseVertexLocations();
+		std::uint64_t byHandleSum = 0;
+		begin = std::chrono::steady_clock::now();
+		for (SubmeshHandle handle : draws)
+			byHandleSum += indexCounts[handle] + startIndices[handle] + baseVertices[handle];
+		end = std::chrono::steady_clock::now();
+		double byHandle = Seconds(begin, end);
+
+		std::printf("SubmeshTable: %u submeshes, %u draws\n", submeshCount, drawCount);
+		std::printf("  by name %.1f ns/draw, by handle %.1f ns/draw (%.0fx)%s\n",
+			byName * 1e9 / drawCount, byHandle * 1e9 / drawCount, byName / byHandle,
+			byNameSum == byHandleSum ? "" : " (mismatch!)");
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include "TransformHierarchy.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace DirectX;
+
+// A scene of 100k nodes in shallow trees.  Times the full recompute against the
+// incremental Update with 1% and 10% of the nodes edited each frame.
+int main()
+{
+	const std::uint32_t count = 100 * 1000;
+	std::mt19937 random(1);
+
+	TransformHierarchy hierarchy;
+	hierarchy.Reserve(count);
+	for (std::uint32_t node = 0; node < count; ++node)
+	{
+		// Every node hangs off one of the few before it, so subtrees stay small.
+		std::uint32_t parent = node % 100 == 0 ? TransformHierarchy::InvalidNode : node - 1 - random() % std::min(node % 100, 8u);
+		hierarchy.Add(parent);
+		hierarchy.SetTranslation(node, XMFLOAT3((float)(node % 7), (float)(node % 11), (float)(node % 13)));
+	}
+	hierarchy.Update();
+
+	const int frames = 50;
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frames; ++frame)
+		hierarchy.UpdateAll();
+	auto end = std::chrono::steady_clock::now();
+	std::printf("TransformHierarchy: %u nodes\n", count);
+	std::printf("  UpdateAll: %.3f ms\n", std::chrono::duration<double, std::milli>(end - start).count() / frames);
+
+	for (std::uint32_t percent : { 1u, 10u })
+	{
+		std::uint64_t updated = 0;
+		start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			for (std::uint32_t edit = 0; edit < count * percent / 100; ++edit)
+				hierarchy.SetRotation(random() % count, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+			updated += hierarchy.Update();
+		}
+		end = std::chrono::steady_clock::now();
+		std::printf("  Update, %u%% edited: %.3f ms, %llu nodes recomputed per frame\n", percent,
+			std::chrono::duration<double, std::milli>(end - start).count() / frames, (unsigned long long)(updated / frames));
+	}
+	return 0;
+}
@@ -0,0 +1,246 @@
+#include "BoundingVolumeTree.h"
+#include "Check.h"
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Scene
+	{
+		std::vector<BoundingBox> Boxes;
+		// Objects still in the tree.
+		std::vector<bool> Live;
+
+		explicit Scene(std::uint32_t count, std::uint32_t seed = 3)
+		{
+			std::mt19937 random(seed);
+			std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+			std::uniform_real_distribution<float> extent(0.2f, 2.0f);
+			for (std::uint32_t i = 0; i < count; ++i)
+			{
+				Boxes.push_back(BoundingBox(XMFLOAT3(position(random), position(random), position(random)),
+					XMFLOAT3(extent(random), extent(random), extent(random))));
+				Live.push_back(true);
+			}
+		}
+
+		std::vector<std::uint32_t> QueryBox(const BoundingBox& box)const
+		{
+			std::vector<std::uint32_t> hits;
+			for (std::uint32_t i = 0; i < Boxes.size(); ++i)
+			{
+				if (Live[i] && Boxes[i].Intersects(box))
+					hits.push_back(i);
+			}
+			return hits;
+		}
+
+		std::vector<std::uint32_t> QueryFrustum(const float planes[6][4])const
+		{
+			std::vector<std::uint32_t> hits;
+			for (std::uint32_t i = 0; i < Boxes.size(); ++i)
+			{
+				const XMFLOAT3& c = Boxes[i].Center;
+				const XMFLOAT3& e = Boxes[i].Extents;
+				bool outside = false;
+				for (int p = 0; p < 6; ++p)
+				{
+					float d = planes[p][0] * c.x + planes[p][1] * c.y + planes[p][2] * c.z + planes[p][3];
+					float r = std::fabs(planes[p][0]) * e.x + std::fabs(planes[p][1]) * e.y + std::fabs(planes[p][2]) * e.z;
+					outside = outside || d < -r;
+				}
+				if (Live[i] && !outside)
+					hits.push_back(i);
+			}
+			return hits;
+		}
+
+		// The nearest box in front of the origin, by brute force.
+		std::uint32_t RayCast(FXMVECTOR origin, FXMVECTOR direction, float* distance)const
+		{
+			std::uint32_t closest = BoundingVolumeTree::InvalidNode;
+			*distance = FLT_MAX;
+			for (std::uint32_t i = 0; i < Boxes.size(); ++i)
+			{
+				float hit = 0.0f;
+				if (Live[i] && Boxes[i].Intersects(origin, direction, hit) && hit < *distance)
+				{
+					closest = i;
+					*distance = hit;
+				}
+			}
+			return closest;
+		}
+	};
+
+	std::vector<std::uint32_t> Sorted(std::vector<std::uint32_t> values)
+	{
+		std::sort(values.begin(), values.end());
+		return values;
+	}
+
+	// Queries the tree and the brute force reference alike and compares them.
+	void CheckQueries(const BoundingVolumeTree& tree, const Scene& scene, std::uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> extent(1.0f, 15.0f);
+
+		bool boxesMatch = true;
+		bool frustaMatch = true;
+		bool raysMatch = true;
+		for (int query = 0; query < 50; ++query)
+		{
+			BoundingBox box(XMFLOAT3(position(random), position(random), position(random)),
+				XMFLOAT3(extent(random), extent(random), extent(random)));
+			std::vector<std::uint32_t> hits;
+			tree.QueryBox(box, hits);
+			boxesMatch = boxesMatch && Sorted(hits) == scene.QueryBox(box);
+
+			// A slab along a random axis, tilted, and an open box on the other axes.
+			float a = position(random) / 60.0f;
+			float b = std::sqrt(1.0f - a * a);
+			const float planes[6][4] =
+			{
+				{ a, b, 0, 20 }, { -a, -b, 0, 20 }, { 0, 0, 1, 40 },
+				{ 0, 0, -1, 40 }, { 1, 0, 0, 1000 }, { -1, 0, 0, 1000 }
+			};
+			hits.clear();
+			tree.QueryFrustum(planes, hits);
+			frustaMatch = frustaMatch && Sorted(hits) == scene.QueryFrustum(planes);
+
+			// From outside the scene towards a random point in it.
+			XMVECTOR origin = XMVectorSet(position(random), position(random), -100.0f, 1.0f);
+			XMVECTOR target = XMVectorSet(position(random) * 0.5f, position(random) * 0.5f, 0.0f, 1.0f);
+			XMVECTOR direction = XMVector3Normalize(XMVectorSubtract(target, origin));
+			float treeDistance = 0.0f;
+			float sceneDistance = 0.0f;
+			std::uint32_t proxy = tree.RayCast(origin, direction, FLT_MAX, &treeDistance);
+			std::uint32_t expected = scene.RayCast(origin, direction, &sceneDistance);
+			if (expected == BoundingVolumeTree::InvalidNode)
+				raysMatch = raysMatch && proxy == BoundingVolumeTree::InvalidNode;
+			else
+				raysMatch = raysMatch && proxy != BoundingVolumeTree::InvalidNode &&
+					tree.UserData(proxy) == expected && treeDistance == sceneDistance;
+		}
+		CHECK(boxesMatch);
+		CHECK(frustaMatch);
+		CHECK(raysMatch);
+	}
+
+	void TestBuild()
+	{
+		Scene scene(2000);
+		BoundingVolumeTree tree;
+		std::vector<std::uint32_t> proxies;
+		tree.Build(scene.Boxes.data(), nullptr, (std::uint32_t)scene.Boxes.size(), &proxies);
+
+		CHECK(tree.Size() == 2000);
+		// Binned SAH over uniform boxes stays close to balanced: log2(2000) is 11.
+		CHECK(tree.Height() <= 22);
+
+		bool userData = true;
+		for (std::uint32_t i = 0; i < proxies.size(); ++i)
+			userData = userData && tree.UserData(proxies[i]) == i;
+		CHECK(userData);
+
+		CheckQueries(tree, scene, 10);
+	}
+
+	void TestInsertRemoveMove()
+	{
+		Scene scene(1000);
+		BoundingVolumeTree tree;
+		std::vector<std::uint32_t> proxies;
+		for (std::uint32_t i = 0; i < scene.Boxes.size(); ++i)
+			proxies.push_back(tree.Insert(scene.Boxes[i], i));
+		CHECK(tree.Size() == 1000);
+		CHECK(tree.Height() <= 30);
+		CheckQueries(tree, scene, 20);
+
+		for (std::uint32_t i = 0; i < scene.Boxes.size(); i += 3)
+		{
+			tree.Remove(proxies[i]);
+			scene.Live[i] = false;
+		}
+
+		// Small moves stay in the enlarged box; large ones reinsert.
+		std::uint32_t reinserted = 0;
+		for (std::uint32_t i = 1; i < scene.Boxes.size(); i += 3)
+		{
+			BoundingBox& box = scene.Boxes[i];
+			box.Center.x += i % 2 == 0 ? 0.05f : 30.0f;
+			reinserted += tree.Move(proxies[i], box) ? 1 : 0;
+		}
+		CHECK(reinserted == 167);
+		CHECK(tree.Size() == 666);
+		CheckQueries(tree, scene, 30);
+	}
+
+	void TestSetBoundsAndRefit()
+	{
+		Scene scene(500);
+		BoundingVolumeTree tree;
+		std::vector<std::uint32_t> proxies;
+		tree.Build(scene.Boxes.data(), nullptr, (std::uint32_t)scene.Boxes.size(), &proxies);
+
+		for (std::uint32_t i = 0; i < scene.Boxes.size(); ++i)
+		{
+			scene.Boxes[i].Center.y = -scene.Boxes[i].Center.y;
+			tree.SetBounds(proxies[i], scene.Boxes[i]);
+		}
+		tree.Refit();
+		CheckQueries(tree, scene, 40);
+	}
+
+	void TestMarginDoesNotHit()
+	{
+		// One unit box and the default margin of 0.1.
+		BoundingVolumeTree tree;
+		BoundingBox box(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+		std::uint32_t proxy = tree.Insert(box, 7);
+		CHECK(tree.EnlargedBounds(proxy).Extents.x > 1.0f);
+		CHECK(tree.Bounds(proxy).Extents.x == 1.0f);
+
+		// Through the margin but past the box.
+		XMVECTOR direction = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+		CHECK(tree.RayCast(XMVectorSet(1.05f, 0.0f, -10.0f, 1.0f), direction, 100.0f) == BoundingVolumeTree::InvalidNode);
+
+		// A hit reports the distance to the box, not to the margin.
+		float distance = 0.0f;
+		CHECK(tree.RayCast(XMVectorSet(0.5f, 0.0f, -10.0f, 1.0f), direction, 100.0f, &distance) == proxy);
+		CHECK_NEAR(distance, 9.0f, 1e-5f);
+		CHECK(tree.RayCast(XMVectorSet(0.5f, 0.0f, -10.0f, 1.0f), direction, 8.95f) == BoundingVolumeTree::InvalidNode);
+
+		// Nor do the queries count the margin.
+		std::vector<std::uint32_t> hits;
+		tree.QueryBox(BoundingBox(XMFLOAT3(2.05f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f)), hits);
+		CHECK(hits.empty());
+		const float planes[6][4] =
+		{
+			{ 1, 0, 0, -1.05f }, { -1, 0, 0, 10 }, { 0, 1, 0, 10 },
+			{ 0, -1, 0, 10 }, { 0, 0, 1, 10 }, { 0, 0, -1, 10 }
+		};
+		tree.QueryFrustum(planes, hits);
+		CHECK(hits.empty());
+
+		// A small move keeps the leaf, but the object's box follows.
+		box.Center.x = 0.05f;
+		CHECK(!tree.Move(proxy, box));
+		CHECK(tree.Bounds(proxy).Center.x == 0.05f);
+		CHECK(tree.RayCast(XMVectorSet(1.04f, 0.0f, -10.0f, 1.0f), direction, 100.0f) == proxy);
+	}
+}
+
+int main()
+{
+	TestBuild();
+	TestInsertRemoveMove();
+	TestSetBoundsAndRefit();
+	TestMarginDoesNotHit();
+	return Check::Finish("BoundingVolumeTreeTests");
+}
@@ -0,0 +1,137 @@
+#include "BuddyAllocator.h"
+#include "Check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	void TestSplitAndMerge()
+	{
+		BuddyAllocator allocator(1024, 64);
+		CHECK(allocator.Capacity() == 1024);
+
+		std::uint64_t a = allocator.Allocate(64);
+		std::uint64_t b = allocator.Allocate(64);
+		std::uint64_t c = allocator.Allocate(128);
+		CHECK(a == 0);
+		CHECK(b == 64);
+		CHECK(c == 128);
+		CHECK(allocator.BlockSize(c) == 128);
+
+		BuddyAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.AllocationCount == 3);
+		CHECK(stats.AllocatedBytes == 256);
+		CHECK(stats.FreeBytes == 768);
+		CHECK(stats.LargestFreeBlock == 512);
+
+		// a and b are buddies: freeing both gives back the 128-byte block, which merges
+		// with c's once c is freed too.
+		allocator.Free(a);
+		allocator.Free(b);
+		CHECK(allocator.GetStats().FreeBlockCount == 3);
+		allocator.Free(c);
+		CHECK(allocator.IsEmpty());
+		stats = allocator.GetStats();
+		CHECK(stats.FreeBlockCount == 1);
+		CHECK(stats.LargestFreeBlock == 1024);
+		CHECK(stats.ExternalFragmentation() == 0.0f);
+	}
+
+	void TestRoundingAndAlignment()
+	{
+		BuddyAllocator allocator(1000, 100);
+		// Both sizes round up to powers of two.
+		CHECK(allocator.Capacity() == 1024);
+		CHECK(allocator.BlockSize(allocator.Allocate(1)) == 128);
+
+		std::uint64_t aligned = allocator.Allocate(16, 512);
+		CHECK(aligned == 512);
+		CHECK(allocator.BlockSize(aligned) == 512);
+
+		// Requested 1 + 16 bytes of 640 allocated.
+		BuddyAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.RequestedBytes == 17);
+		CHECK(stats.AllocatedBytes == 640);
+		CHECK_NEAR(stats.Occupancy(), 640.0 / 1024.0, 1e-6);
+		CHECK_NEAR(stats.InternalFragmentation(), 1.0 - 17.0 / 640.0, 1e-6);
+	}
+
+	void TestExhaustion()
+	{
+		BuddyAllocator allocator(1024, 256);
+		CHECK(allocator.Allocate(0) == BuddyAllocator::InvalidOffset);
+		CHECK(allocator.Allocate(2048) == BuddyAllocator::InvalidOffset);
+		CHECK(allocator.Allocate(1, 2048) == BuddyAllocator::InvalidOffset);
+
+		for (int i = 0; i < 4; ++i)
+			CHECK(allocator.Allocate(256) == (std::uint64_t)i * 256);
+		CHECK(allocator.Allocate(1) == BuddyAllocator::InvalidOffset);
+		CHECK(allocator.GetStats().LargestFreeBlock == 0);
+
+		// Two free blocks that are not buddies do not make room for 512 bytes.
+		allocator.Free(256);
+		allocator.Free(512);
+		CHECK(allocator.Allocate(512) == BuddyAllocator::InvalidOffset);
+		CHECK_NEAR(allocator.GetStats().ExternalFragmentation(), 0.5, 1e-6);
+		allocator.Free(768);
+		CHECK(allocator.Allocate(512) == 512);
+	}
+
+	void TestRandomTraffic()
+	{
+		const std::uint64_t capacity = 1 << 20;
+		BuddyAllocator allocator(capacity, 256);
+		std::mt19937 random(7);
+		std::vector<std::uint64_t> live;
+
+		for (int i = 0; i < 20000; ++i)
+		{
+			if (live.empty() || random() % 3 != 0)
+			{
+				std::uint64_t size = 1 + random() % 8192;
+				std::uint64_t alignment = 1ull << (random() % 13);
+				std::uint64_t offset = allocator.Allocate(size, alignment);
+				if (offset == BuddyAllocator::InvalidOffset)
+					continue;
+				CHECK(offset % alignment == 0);
+				CHECK(offset + size <= capacity);
+				CHECK(allocator.BlockSize(offset) >= size);
+				live.push_back(offset);
+			}
+			else
+			{
+				std::size_t index = random() % live.size();
+				allocator.Free(live[index]);
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+
+		// Live blocks never overlap.
+		std::vector<std::pair<std::uint64_t, std::uint64_t>> blocks;
+		for (std::uint64_t offset : live)
+			blocks.emplace_back(offset, offset + allocator.BlockSize(offset));
+		std::sort(blocks.begin(), blocks.end());
+		for (std::size_t i = 1; i < blocks.size(); ++i)
+			CHECK(blocks[i - 1].second <= blocks[i].first);
+
+		BuddyAllocator::Stats stats = allocator.GetStats();
+		CHECK(stats.AllocationCount == live.size());
+		CHECK(stats.AllocatedBytes + stats.FreeBytes == capacity);
+
+		for (std::uint64_t offset : live)
+			allocator.Free(offset);
+		CHECK(allocator.IsEmpty());
+		CHECK(allocator.GetStats().LargestFreeBlock == capacity);
+	}
+}
+
+int main()
+{
+	TestSplitAndMerge();
+	TestRoundingAndAlignment();
+	TestExhaustion();
+	TestRandomTraffic();
+	return Check::Finish("BuddyAllocatorTests");
+}
@@ -0,0 +1,41 @@
+//***************************************************************************************
+// Check.h
+//
+// The few assertions the tests need.  A failed CHECK prints the expression and keeps
+// going so one run reports every failure; TestMain returns non-zero if any failed.
+//***************************************************************************************
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+namespace Check
+{
+	inline int& Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	inline void Fail(const char* file, int line, const char* expression)
+	{
+		std::printf("%s(%d): CHECK failed: %s\n", file, line, expression);
+		++Failures();
+	}
+
+	inline int Finish(const char* name)
+	{
+		if (Failures() == 0)
+			std::printf("%s: passed\n", name);
+		else
+			std::printf("%s: %d checks failed\n", name, Failures());
+		return Failures() == 0 ? 0 : 1;
+	}
+}
+
+#define CHECK(expression) \
+	do { if (!(expression)) Check::Fail(__FILE__, __LINE__, #expression); } while (false)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do { if (!(std::fabs((double)(a) - (double)(b)) <= (double)(tolerance))) Check::Fail(__FILE__, __LINE__, #a " ~ " #b); } while (false)
@@ -0,0 +1,176 @@
+#include "DrawPackets.h"
+#include "WorkerPool.h"
+#include "Check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// The packets in key order, ties in the order they were added.
+	bool IsStablySorted(const DrawPacketList& packets)
+	{
+		for (std::size_t i = 1; i < packets.Size(); ++i)
+		{
+			if (packets[i - 1].Key > packets[i].Key)
+				return false;
+			if (packets[i - 1].Key == packets[i].Key && packets[i - 1].Item > packets[i].Item)
+				return false;
+		}
+		return true;
+	}
+
+	void TestFields()
+	{
+		std::uint64_t key = DrawKey::Make(3, 5, 1234, 567890, 0.0f);
+		CHECK(DrawKey::Pass(key) == 3);
+		CHECK(DrawKey::RootSignature(key) == 5);
+		CHECK(DrawKey::Pipeline(key) == 1234);
+		CHECK(DrawKey::Material(key) == 567890);
+		CHECK(DrawKey::Depth(key) == 0);
+
+		// The fields tile the key from the top down, in the order they are given.
+		CHECK(DrawKey::PassShift + DrawKey::PassBits == 64);
+		CHECK(DrawKey::RootSignatureShift + DrawKey::RootSignatureBits == DrawKey::PassShift);
+		CHECK(DrawKey::PipelineShift + DrawKey::PipelineBits == DrawKey::RootSignatureShift);
+		CHECK(DrawKey::MaterialShift + DrawKey::MaterialBits == DrawKey::PipelineShift);
+		CHECK(DrawKey::DepthShift + DrawKey::DepthBits == DrawKey::MaterialShift);
+
+		// Wide fields are truncated rather than spilling into their neighbours.
+		key = DrawKey::Make(0x11, 0x12, 0x1003, 0, 0.0f);
+		CHECK(DrawKey::Pass(key) == 1);
+		CHECK(DrawKey::RootSignature(key) == 2);
+		CHECK(DrawKey::Pipeline(key) == 3);
+		CHECK(DrawKey::Material(key) == 0);
+
+		// Negative depth counts as zero.
+		CHECK(DrawKey::Make(0, 0, 0, 0, -5.0f) == DrawKey::Make(0, 0, 0, 0, 0.0f));
+	}
+
+	void TestKeyOrder()
+	{
+		// Each field outranks every field below it.
+		CHECK(DrawKey::Make(1, 0, 0, 0, 0.0f) > DrawKey::Make(0, 15, 4095, 1048575, 1e30f));
+		CHECK(DrawKey::Make(0, 1, 0, 0, 0.0f) > DrawKey::Make(0, 0, 4095, 1048575, 1e30f));
+		CHECK(DrawKey::Make(0, 0, 1, 0, 0.0f) > DrawKey::Make(0, 0, 0, 1048575, 1e30f));
+		CHECK(DrawKey::Make(0, 0, 0, 1, 0.0f) > DrawKey::Make(0, 0, 0, 0, 1e30f));
+
+		// Depth orders like the distances do, down to fractions.
+		const float depths[] = { 0.0f, 1e-6f, 0.25f, 0.5f, 1.0f, 1.001f, 10.0f, 1000.0f, 1e6f };
+		for (std::size_t i = 1; i < sizeof(depths) / sizeof(depths[0]); ++i)
+			CHECK(DrawKey::Make(0, 0, 0, 0, depths[i - 1]) < DrawKey::Make(0, 0, 0, 0, depths[i]));
+	}
+
+	void TestSortSmall()
+	{
+		DrawPacketList packets;
+		packets.Sort();
+		CHECK(packets.Size() == 0);
+
+		packets.Add(DrawKey::Make(1, 0, 2, 0, 5.0f), 0);
+		packets.Add(DrawKey::Make(0, 1, 0, 0, 5.0f), 1);
+		packets.Add(DrawKey::Make(1, 0, 2, 0, 1.0f), 2);
+		packets.Add(DrawKey::Make(0, 0, 3, 0, 9.0f), 3);
+		packets.Add(DrawKey::Make(1, 0, 2, 0, 5.0f), 4);
+		packets.Sort();
+
+		// Pass, then root signature, then pipeline, then front to back; the two equal keys
+		// stay in the order they were added.
+		const std::uint32_t expected[] = { 3, 1, 2, 0, 4 };
+		CHECK(packets.Size() == 5);
+		for (std::uint32_t i = 0; i < 5; ++i)
+			CHECK(packets[i].Item == expected[i]);
+		CHECK(packets.SortedPasses() + packets.SkippedPasses() == 8);
+
+		// A second Sort starts from a clean list.
+		packets.Clear();
+		packets.Add(7, 0);
+		packets.Sort();
+		CHECK(packets.Size() == 1 && packets[0].Item == 0);
+	}
+
+	void TestSkippedPasses()
+	{
+		// Keys that only differ in the material's low byte, which is one radix digit, need
+		// a single pass.
+		DrawPacketList packets;
+		for (std::uint32_t i = 0; i < 1000; ++i)
+			packets.Add(DrawKey::Make(2, 1, 9, (i * 37) % 256, 3.0f), i);
+		packets.Sort();
+		CHECK(IsStablySorted(packets));
+		CHECK(packets.SortedPasses() == 1);
+		CHECK(packets.SkippedPasses() == 7);
+
+		// Identical keys move nothing at all.
+		packets.Clear();
+		for (std::uint32_t i = 0; i < 1000; ++i)
+			packets.Add(42, i);
+		packets.Sort();
+		CHECK(packets.SortedPasses() == 0);
+		CHECK(packets[0].Item == 0 && packets[999].Item == 999);
+	}
+
+	void TestRandomKeys()
+	{
+		std::mt19937_64 random(3);
+		DrawPacketList packets;
+		std::vector<std::uint64_t> keys;
+		for (std::uint32_t i = 0; i < 50000; ++i)
+		{
+			// Few distinct values in the high fields, so many keys tie.
+			std::uint64_t key = DrawKey::Make((std::uint32_t)(random() % 3), (std::uint32_t)(random() % 2),
+				(std::uint32_t)(random() % 20), (std::uint32_t)(random() % 50), (float)(random() % 8));
+			packets.Add(key, i);
+			keys.push_back(key);
+		}
+		packets.Sort();
+		CHECK(IsStablySorted(packets));
+
+		std::sort(keys.begin(), keys.end());
+		bool same = packets.Size() == keys.size();
+		for (std::size_t i = 0; same && i < keys.size(); ++i)
+			same = packets[i].Key == keys[i];
+		CHECK(same);
+	}
+
+	void TestWorkerPoolMatchesSerial()
+	{
+		// Large enough to be split over every thread of the pool.
+		WorkerPool workers(4);
+		const std::uint32_t count = 4 * DrawPacketList::MinPacketsPerThread + 123;
+
+		std::mt19937_64 random(5);
+		DrawPacketList serial, pooled;
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			std::uint64_t key = random() & 0xF0FF00000FFFFFFFull;
+			serial.Add(key, i);
+			pooled.Add(key, i);
+		}
+
+		for (int run = 0; run < 2; ++run)
+		{
+			serial.Sort();
+			pooled.Sort(&workers);
+		}
+
+		CHECK(IsStablySorted(pooled));
+		CHECK(serial.SortedPasses() == pooled.SortedPasses());
+		CHECK(serial.SkippedPasses() == pooled.SkippedPasses());
+		bool same = true;
+		for (std::uint32_t i = 0; same && i < count; ++i)
+			same = serial[i].Key == pooled[i].Key && serial[i].Item == pooled[i].Item;
+		CHECK(same);
+	}
+}
+
+int main()
+{
+	TestFields();
+	TestKeyOrder();
+	TestSortSmall();
+	TestSkippedPasses();
+	TestRandomKeys();
+	TestWorkerPoolMatchesSerial();
+	return Check::Finish("DrawPacketsTests");
+}
@@ -0,0 +1,126 @@
+#include "FenceTimeline.h"
+#include "FakeFenceBackend.h"
+#include "Check.h"
+#include <vector>
+
+namespace
+{
+	void TestSignalAndComplete()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+
+		CHECK(timeline.Signal() == 1);
+		CHECK(timeline.Signal() == 2);
+		CHECK(timeline.LastSignaled() == 2);
+		CHECK(backend.LastSignaled() == 2);
+
+		CHECK(timeline.IsComplete(0));
+		CHECK(!timeline.IsComplete(1));
+
+		backend.Complete(1);
+		CHECK(timeline.IsComplete(1));
+		CHECK(!timeline.IsComplete(2));
+
+		// The fake GPU never gets ahead of what was signaled.
+		backend.Complete(10);
+		CHECK(timeline.CompletedValue() == 2);
+	}
+
+	void TestWaits()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+
+		std::uint64_t value = timeline.Signal();
+
+		// A finite wait does not move the fake GPU.
+		CHECK(!timeline.WaitFor(value, 0));
+		CHECK(backend.WaitCount() == 1);
+
+		CHECK(timeline.WaitFor(value));
+		CHECK(timeline.IsComplete(value));
+
+		// Complete values do not reach the backend.
+		CHECK(timeline.WaitFor(value));
+		CHECK(backend.WaitCount() == 2);
+
+		timeline.Flush();
+		CHECK(timeline.IsComplete(timeline.LastSignaled()));
+	}
+
+	void TestWaiterPool()
+	{
+		FakeFenceBackend backend;
+		{
+			FenceTimeline timeline(&backend);
+			for (int i = 0; i < 8; ++i)
+				timeline.Flush();
+
+			// Waits one after the other share one waiter.
+			CHECK(timeline.Waiters().CreatedCount() == 1);
+			CHECK(timeline.Waiters().FreeCount() == 1);
+			CHECK(backend.LiveWaiters() == 1);
+		}
+		CHECK(backend.LiveWaiters() == 0);
+	}
+
+	void TestRetirementOrder()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		std::vector<int> order;
+
+		std::uint64_t first = timeline.Signal();
+		std::uint64_t second = timeline.Signal();
+		std::uint64_t third = timeline.Signal();
+
+		timeline.OnRetired(second, [&]() { order.push_back(2); });
+		timeline.OnRetired(third, [&]() { order.push_back(3); });
+		// Out of order registration, and two callbacks on one value.
+		timeline.OnRetired(first, [&]() { order.push_back(1); });
+		timeline.OnRetired(second, [&]() { order.push_back(22); });
+		CHECK(timeline.PendingCallbackCount() == 4);
+
+		CHECK(timeline.RetireCompleted() == 0);
+
+		backend.Complete(second);
+		CHECK(timeline.RetireCompleted() == 3);
+		CHECK(order.size() == 3);
+		CHECK(order.size() == 3 && order[0] == 1 && order[1] == 2 && order[2] == 22);
+
+		backend.CompleteAll();
+		CHECK(timeline.RetireCompleted() == 1);
+		CHECK(order.size() == 4 && order[3] == 3);
+		CHECK(timeline.PendingCallbackCount() == 0);
+	}
+
+	void TestCallbackRegistersCallback()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		int ran = 0;
+
+		std::uint64_t value = timeline.Signal();
+		timeline.OnRetired(value, [&]()
+		{
+			++ran;
+			// Already retired, so it runs in the same RetireCompleted.
+			timeline.OnRetired(value, [&]() { ++ran; });
+		});
+
+		backend.CompleteAll();
+		CHECK(timeline.RetireCompleted() == 2);
+		CHECK(ran == 2);
+	}
+}
+
+int main()
+{
+	TestSignalAndComplete();
+	TestWaits();
+	TestWaiterPool();
+	TestRetirementOrder();
+	TestCallbackRegistersCallback();
+	return Check::Finish("FenceTimelineTests");
+}
@@ -0,0 +1,128 @@
+#include "FrameFenceRing.h"
+#include "FenceTimeline.h"
+#include "FakeFenceBackend.h"
+#include "Check.h"
+#include <vector>
+
+namespace
+{
+	void TestFirstLap()
+	{
+		FrameFenceRing ring(3);
+		CHECK(ring.FrameCount() == 3);
+		CHECK(ring.CurrentIndex() == -1);
+		CHECK(ring.LastSubmitted() == 0);
+
+		// Slots that were never submitted have nothing to wait for.
+		for (int i = 0; i < 3; ++i)
+		{
+			CHECK(ring.Advance() == 0);
+			CHECK(ring.CurrentIndex() == i);
+			CHECK(ring.PendingFence() == 0);
+			CHECK(!ring.NeedsWait(0));
+			ring.MarkSubmitted(10 + i);
+			CHECK(ring.PendingFence() == (std::uint64_t)(10 + i));
+			CHECK(ring.LastSubmitted() == (std::uint64_t)(10 + i));
+		}
+	}
+
+	void TestWrapAround()
+	{
+		FrameFenceRing ring(3);
+		for (std::uint64_t fence = 1; fence <= 3; ++fence)
+		{
+			ring.Advance();
+			ring.MarkSubmitted(fence);
+		}
+
+		// Back at slot 0, which has to wait for the fence of three frames ago.
+		CHECK(ring.Advance() == 1);
+		CHECK(ring.CurrentIndex() == 0);
+		CHECK(ring.NeedsWait(0));
+		CHECK(!ring.NeedsWait(1));
+		CHECK(!ring.NeedsWait(2));
+		ring.MarkSubmitted(4);
+
+		CHECK(ring.Advance() == 2);
+		CHECK(ring.CurrentIndex() == 1);
+		ring.MarkSubmitted(5);
+		CHECK(ring.Advance() == 3);
+		CHECK(ring.CurrentIndex() == 2);
+		ring.MarkSubmitted(6);
+		CHECK(ring.Advance() == 4);
+		CHECK(ring.CurrentIndex() == 0);
+		CHECK(ring.LastSubmitted() == 6);
+	}
+
+	void TestSingleFrame()
+	{
+		// Zero frames is clamped to one: every frame waits for the one before it.
+		FrameFenceRing ring(0);
+		CHECK(ring.FrameCount() == 1);
+		CHECK(ring.Advance() == 0);
+		ring.MarkSubmitted(1);
+		CHECK(ring.Advance() == 1);
+		CHECK(ring.CurrentIndex() == 0);
+		CHECK(ring.NeedsWait(0));
+	}
+
+	// Runs frames the way Draw does against a fake queue whose GPU finishes a frame only
+	// every gpuPeriod CPU frames, and checks the CPU never gets more than frameCount
+	// frames ahead and only blocks when it would.
+	void TestFramesInFlight(int frameCount, int gpuPeriod)
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		FrameFenceRing ring(frameCount);
+		std::vector<std::uint64_t> submitted;
+		int waits = 0;
+
+		for (int frame = 0; frame < 100; ++frame)
+		{
+			ring.Advance();
+			if (!timeline.IsComplete(ring.PendingFence()))
+			{
+				CHECK(ring.NeedsWait(timeline.CompletedValue()));
+				++waits;
+				timeline.WaitFor(ring.PendingFence());
+			}
+			CHECK(timeline.IsComplete(ring.PendingFence()));
+			CHECK(timeline.LastSignaled() - timeline.CompletedValue() <= (std::uint64_t)frameCount);
+
+			std::uint64_t fence = timeline.Signal();
+			ring.MarkSubmitted(fence);
+			submitted.push_back(fence);
+
+			if (frame % gpuPeriod == 0)
+				backend.Complete(timeline.CompletedValue() + 1);
+		}
+
+		// A GPU as fast as the CPU never makes it wait.
+		if (gpuPeriod == 1)
+			CHECK(waits == 0);
+		else
+			CHECK(waits > 0);
+
+		// Each slot waits on the fence submitted frameCount frames earlier.
+		for (int lap = 0; lap < frameCount; ++lap)
+		{
+			std::uint64_t expected = submitted[submitted.size() - frameCount + lap];
+			ring.Advance();
+			CHECK(ring.PendingFence() == expected);
+			ring.MarkSubmitted(timeline.Signal());
+		}
+	}
+}
+
+int main()
+{
+	TestFirstLap();
+	TestWrapAround();
+	TestSingleFrame();
+	for (int frameCount = 1; frameCount <= 4; ++frameCount)
+	{
+		TestFramesInFlight(frameCount, 1);
+		TestFramesInFlight(frameCount, 3);
+	}
+	return Check::Finish("FrameFenceRingTests");
+}
@@ -0,0 +1,177 @@
+#include "FreeListAllocator.h"
+#include "FakeFenceBackend.h"
+#include "Check.h"
+
+namespace
+{
+	void TestFirstFit()
+	{
+		FreeListAllocator allocator(100);
+
+		CHECK(allocator.Allocate(10) == 0);
+		CHECK(allocator.Allocate(20) == 10);
+		CHECK(allocator.Allocate(30) == 30);
+		CHECK(allocator.Allocate(10) == 60);
+		CHECK(allocator.UsedCount() == 70);
+
+		// Holes of 10 at 0 and 30 at 30; the tail has 30 at 70.
+		allocator.Free(0, 10);
+		allocator.Free(30, 30);
+		CHECK(allocator.FreeRangeCount() == 3);
+		CHECK(allocator.FreeCount() == 70);
+
+		// The first hole large enough wins, even if a later one fits as well.
+		CHECK(allocator.Allocate(5) == 0);
+		CHECK(allocator.Allocate(25) == 30);
+		CHECK(allocator.Allocate(8) == 70);
+		CHECK(allocator.Allocate(5) == 5);
+		CHECK(allocator.FreeRangeCount() == 2);
+		CHECK(allocator.LargestFreeRange() == 22);
+	}
+
+	void TestLimits()
+	{
+		FreeListAllocator allocator(16);
+
+		CHECK(allocator.Allocate(0) == FreeListAllocator::InvalidOffset);
+		CHECK(allocator.Allocate(17) == FreeListAllocator::InvalidOffset);
+		CHECK(allocator.Allocate(16) == 0);
+		CHECK(allocator.FreeCount() == 0);
+		CHECK(allocator.FreeRangeCount() == 0);
+		CHECK(allocator.Allocate(1) == FreeListAllocator::InvalidOffset);
+
+		// Enough free slots, but not contiguous.
+		allocator.Free(0, 4);
+		allocator.Free(8, 4);
+		CHECK(allocator.FreeCount() == 8);
+		CHECK(allocator.Allocate(5) == FreeListAllocator::InvalidOffset);
+
+		FreeListAllocator empty(0);
+		CHECK(empty.FreeRangeCount() == 0);
+		CHECK(empty.Allocate(1) == FreeListAllocator::InvalidOffset);
+	}
+
+	void TestCoalescing()
+	{
+		FreeListAllocator allocator(40);
+		for (int i = 0; i < 4; ++i)
+			CHECK(allocator.Allocate(10) == (std::uint32_t)(i * 10));
+
+		// Neither neighbour is free.
+		allocator.Free(10, 10);
+		CHECK(allocator.FreeRangeCount() == 1);
+		CHECK(allocator.LargestFreeRange() == 10);
+
+		// Merges with the range before it.
+		allocator.Free(20, 10);
+		CHECK(allocator.FreeRangeCount() == 1);
+		CHECK(allocator.LargestFreeRange() == 20);
+
+		// Merges with the range after it.
+		allocator.Free(0, 10);
+		CHECK(allocator.FreeRangeCount() == 1);
+		CHECK(allocator.LargestFreeRange() == 30);
+
+		// The last range joins everything back into one.
+		allocator.Free(30, 10);
+		CHECK(allocator.FreeRangeCount() == 1);
+		CHECK(allocator.LargestFreeRange() == 40);
+		CHECK(allocator.FreeCount() == 40);
+		CHECK(allocator.Allocate(40) == 0);
+	}
+
+	void TestCoalescingBothSides()
+	{
+		FreeListAllocator allocator(30);
+		CHECK(allocator.Allocate(10) == 0);
+		CHECK(allocator.Allocate(10) == 10);
+		CHECK(allocator.Allocate(10) == 20);
+
+		allocator.Free(0, 10);
+		allocator.Free(20, 10);
+		CHECK(allocator.FreeRangeCount() == 2);
+
+		allocator.Free(10, 10);
+		CHECK(allocator.FreeRangeCount() == 1);
+		CHECK(allocator.LargestFreeRange() == 30);
+	}
+
+	void TestDeferredFreeWaitsForFence()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		DeferredFreeListAllocator allocator(8, &timeline);
+
+		CHECK(allocator.Allocate(8) == 0);
+
+		// Freed while frame 1 is recorded: nothing comes back before its fence retires.
+		allocator.Free(2, 2);
+		CHECK(allocator.PendingFreeCount() == 1);
+		CHECK(allocator.Allocator().FreeCount() == 0);
+		CHECK(allocator.Allocate(2) == FreeListAllocator::InvalidOffset);
+
+		// An upload batch signals before the frame is submitted; its fence completing
+		// must not release the range.
+		std::uint64_t uploadFence = timeline.Signal();
+		std::uint64_t frameFence = timeline.Signal();
+		allocator.Submit(frameFence);
+		CHECK(allocator.PendingFreeCount() == 0);
+
+		backend.Complete(uploadFence);
+		timeline.RetireCompleted();
+		CHECK(allocator.Allocate(2) == FreeListAllocator::InvalidOffset);
+
+		backend.Complete(frameFence);
+		timeline.RetireCompleted();
+		CHECK(allocator.Allocator().FreeCount() == 2);
+		CHECK(allocator.Allocate(2) == 2);
+	}
+
+	void TestDeferredFreesBatchPerSubmit()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		DeferredFreeListAllocator allocator(30, &timeline);
+		CHECK(allocator.Allocate(10) == 0);
+		CHECK(allocator.Allocate(10) == 10);
+		CHECK(allocator.Allocate(10) == 20);
+
+		allocator.Free(0, 10);
+		allocator.Free(10, 10);
+		std::uint64_t first = timeline.Signal();
+		allocator.Submit(first);
+
+		allocator.Free(20, 10);
+		// An empty range is not queued.
+		allocator.Free(0, 0);
+		CHECK(allocator.PendingFreeCount() == 1);
+		std::uint64_t second = timeline.Signal();
+		allocator.Submit(second);
+		CHECK(timeline.PendingCallbackCount() == 2);
+
+		backend.Complete(first);
+		timeline.RetireCompleted();
+		CHECK(allocator.Allocator().FreeCount() == 20);
+		CHECK(allocator.Allocator().FreeRangeCount() == 1);
+
+		backend.Complete(second);
+		timeline.RetireCompleted();
+		CHECK(allocator.Allocator().FreeCount() == 30);
+		CHECK(allocator.Allocator().FreeRangeCount() == 1);
+
+		// A Submit with nothing freed registers no callback.
+		allocator.Submit(timeline.Signal());
+		CHECK(timeline.PendingCallbackCount() == 0);
+	}
+}
+
+int main()
+{
+	TestFirstFit();
+	TestLimits();
+	TestCoalescing();
+	TestCoalescingBothSides();
+	TestDeferredFreeWaitsForFence();
+	TestDeferredFreesBatchPerSubmit();
+	return Check::Finish("FreeListAllocatorTests");
+}
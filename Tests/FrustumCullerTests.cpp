@@ -0,0 +1,136 @@
+#include "FrustumCuller.h"
+#include "Check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// The axis-aligned box -10 <= x, y, z <= 10 as six planes.
+	void BoxPlanes(float planes[6][4])
+	{
+		const float box[6][4] =
+		{
+			{ 1, 0, 0, 10 }, { -1, 0, 0, 10 }, { 0, 1, 0, 10 },
+			{ 0, -1, 0, 10 }, { 0, 0, 1, 10 }, { 0, 0, -1, 10 }
+		};
+		std::copy(&box[0][0], &box[0][0] + 24, &planes[0][0]);
+	}
+
+	BoundingBox Box(float x, float y, float z, float extent)
+	{
+		return BoundingBox(XMFLOAT3(x, y, z), XMFLOAT3(extent, extent, extent));
+	}
+
+	// What Cull should return: the boxes not entirely behind one plane.
+	std::vector<std::uint32_t> Reference(const std::vector<BoundingBox>& boxes, const float planes[6][4])
+	{
+		std::vector<std::uint32_t> visible;
+		for (std::uint32_t i = 0; i < boxes.size(); ++i)
+		{
+			bool outside = false;
+			for (int p = 0; p < 6; ++p)
+			{
+				const XMFLOAT3& c = boxes[i].Center;
+				const XMFLOAT3& e = boxes[i].Extents;
+				float d = planes[p][0] * c.x + planes[p][1] * c.y + planes[p][2] * c.z + planes[p][3];
+				float r = std::fabs(planes[p][0]) * e.x + std::fabs(planes[p][1]) * e.y + std::fabs(planes[p][2]) * e.z;
+				outside = outside || d + r < 0.0f;
+			}
+			if (!outside)
+				visible.push_back(i);
+		}
+		return visible;
+	}
+
+	void TestInsideOutsideStraddling()
+	{
+		FrustumCuller culler;
+		culler.Add(Box(0, 0, 0, 1));      // inside
+		culler.Add(Box(20, 0, 0, 1));     // outside on +x
+		culler.Add(Box(10.5f, 0, 0, 1));  // straddles +x
+		culler.Add(Box(0, -30, 0, 5));    // outside on -y
+		culler.Add(Box(0, 0, -11, 1));    // touches -z
+		CHECK(culler.Size() == 5);
+
+		float planes[6][4];
+		BoxPlanes(planes);
+		std::vector<std::uint32_t> visible;
+		culler.Cull(planes, visible);
+		CHECK(visible == std::vector<std::uint32_t>({ 0, 2, 4 }));
+	}
+
+	void TestRemoveAndSetBounds()
+	{
+		FrustumCuller culler;
+		for (int i = 0; i < 6; ++i)
+			culler.Add(Box(i % 2 == 0 ? 0.0f : 50.0f, 0, 0, 1));
+
+		// The last box (outside) moves into index 0; index 1 comes inside.
+		culler.Remove(0);
+		culler.SetBounds(1, Box(0, 0, 0, 1));
+		CHECK(culler.Size() == 5);
+
+		float planes[6][4];
+		BoxPlanes(planes);
+		std::vector<std::uint32_t> visible;
+		culler.Cull(planes, visible);
+		CHECK(visible == std::vector<std::uint32_t>({ 1, 2, 4 }));
+
+		// Local bounds moved to world space.
+		culler.SetBounds(0, Box(0, 0, 0, 1), XMMatrixTranslation(0.0f, 0.0f, 5.0f));
+		culler.Cull(planes, visible);
+		CHECK(visible == std::vector<std::uint32_t>({ 0, 1, 2, 4 }));
+
+		// Removing down to a multiple of four keeps the padding empty.
+		culler.Remove(4);
+		culler.Cull(planes, visible);
+		CHECK(visible == std::vector<std::uint32_t>({ 0, 1, 2 }));
+	}
+
+	void TestMatchesReference()
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+		std::uniform_real_distribution<float> extent(0.1f, 3.0f);
+
+		// Enough boxes for several ranges, and a count that is not a multiple of four.
+		std::vector<BoundingBox> boxes;
+		FrustumCuller culler;
+		for (std::uint32_t i = 0; i < 4 * FrustumCuller::MinObjectsPerThread + 3; ++i)
+		{
+			boxes.push_back(Box(position(random), position(random), position(random), extent(random)));
+			culler.Add(boxes.back());
+		}
+
+		// A tilted plane in place of +x.
+		float planes[6][4];
+		BoxPlanes(planes);
+		planes[0][0] = 0.6f;
+		planes[0][1] = 0.8f;
+		const std::vector<std::uint32_t> expected = Reference(boxes, planes);
+
+		std::vector<std::uint32_t> visible;
+		culler.Cull(planes, visible);
+		CHECK(visible == expected);
+
+		WorkerPool workers(4);
+		culler.Cull(planes, visible, &workers);
+		CHECK(visible == expected);
+
+		// More threads than ranges worth a task.
+		WorkerPool moreWorkers(16);
+		culler.Cull(planes, visible, &moreWorkers);
+		CHECK(visible == expected);
+	}
+}
+
+int main()
+{
+	TestInsideOutsideStraddling();
+	TestRemoveAndSetBounds();
+	TestMatchesReference();
+	return Check::Finish("FrustumCullerTests");
+}
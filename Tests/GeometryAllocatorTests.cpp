@@ -0,0 +1,166 @@
+#include "GeometryAllocator.h"
+#include "FakeFenceBackend.h"
+#include "Check.h"
+
+namespace
+{
+	void TestAdd()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		GeometryAllocator allocator(2, 100, 50, &timeline);
+		CHECK(!allocator.HasVertexPool(0) && !allocator.HasVertexPool(1));
+
+		std::uint32_t a = allocator.Add(0, 10, 6, false);
+		std::uint32_t b = allocator.Add(0, 20, 3, false);
+		std::uint32_t c = allocator.Add(1, 5, 7, true);
+		CHECK(a == 0 && b == 1 && c == 2);
+		CHECK(allocator.RangeCount() == 3);
+		CHECK(allocator.HasVertexPool(0) && allocator.HasVertexPool(1));
+
+		// Vertex pools are independent.
+		CHECK(allocator.Get(a).VertexOffset == 0);
+		CHECK(allocator.Get(b).VertexOffset == 10);
+		CHECK(allocator.Get(c).VertexOffset == 0);
+		CHECK(allocator.Get(c).VertexPool == 1);
+		CHECK(allocator.VertexAllocator(0).UsedCount() == 30);
+
+		// 16-bit ranges take half a unit per index, rounded up; 32-bit ones a whole unit.
+		CHECK(allocator.Get(a).IndexUnitCount == 3);
+		CHECK(allocator.Get(b).IndexUnitOffset == 3 && allocator.Get(b).IndexUnitCount == 2);
+		CHECK(allocator.Get(c).IndexUnitOffset == 5 && allocator.Get(c).IndexUnitCount == 7);
+		CHECK(allocator.Get(b).IndexCount == 3 && !allocator.Get(b).Index32);
+		CHECK(allocator.IndexAllocator().UsedCount() == 12);
+
+		// In units of each range's own index format.
+		CHECK(allocator.StartIndexLocation(a) == 0);
+		CHECK(allocator.StartIndexLocation(b) == 6);
+		CHECK(allocator.StartIndexLocation(c) == 5);
+	}
+
+	void TestOutOfRoom()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		GeometryAllocator allocator(1, 100, 10, &timeline);
+
+		CHECK(allocator.Add(0, 101, 3, false) == GeometryAllocator::InvalidHandle);
+		CHECK(allocator.Add(0, 60, 16, false) == 0);
+
+		// No index space left: the vertices it took are given back.
+		CHECK(allocator.Add(0, 10, 6, true) == GeometryAllocator::InvalidHandle);
+		CHECK(allocator.VertexAllocator(0).UsedCount() == 60);
+		CHECK(allocator.IndexAllocator().UsedCount() == 8);
+		CHECK(allocator.RangeCount() == 1);
+
+		CHECK(allocator.Add(0, 40, 2, true) == 1);
+		CHECK(allocator.Add(0, 1, 1, false) == GeometryAllocator::InvalidHandle);
+	}
+
+	void TestRemoveWaitsForFence()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		GeometryAllocator allocator(1, 30, 30, &timeline);
+
+		std::uint32_t a = allocator.Add(0, 10, 20, true);
+		std::uint32_t b = allocator.Add(0, 20, 10, true);
+		allocator.Remove(a);
+		CHECK(!allocator.IsValid(a) && allocator.IsValid(b));
+		CHECK(allocator.RangeCount() == 1);
+		// Removing twice does nothing.
+		allocator.Remove(a);
+		allocator.Remove(17);
+		CHECK(allocator.PendingReleaseCount() == 2);
+
+		bool released = false;
+		allocator.DeferRelease([&released]() { released = true; });
+
+		// The space only comes back once the frame's fence retires.
+		CHECK(allocator.Add(0, 10, 5, true) == GeometryAllocator::InvalidHandle);
+		std::uint64_t uploadFence = timeline.Signal();
+		std::uint64_t frameFence = timeline.Signal();
+		allocator.Submit(frameFence);
+		CHECK(allocator.PendingReleaseCount() == 0);
+
+		backend.Complete(uploadFence);
+		timeline.RetireCompleted();
+		CHECK(!released);
+		CHECK(allocator.VertexAllocator(0).FreeCount() == 0);
+
+		backend.Complete(frameFence);
+		timeline.RetireCompleted();
+		CHECK(released);
+		CHECK(allocator.VertexAllocator(0).FreeCount() == 10);
+		CHECK(allocator.IndexAllocator().FreeCount() == 20);
+
+		std::uint32_t c = allocator.Add(0, 10, 5, true);
+		CHECK(c == a);
+		CHECK(allocator.Get(c).VertexOffset == 0 && allocator.Get(c).IndexUnitOffset == 0);
+
+		// Nothing to release registers no callback.
+		allocator.Submit(timeline.Signal());
+		CHECK(timeline.PendingCallbackCount() == 0);
+	}
+
+	void TestDefragment()
+	{
+		FakeFenceBackend backend;
+		FenceTimeline timeline(&backend);
+		GeometryAllocator allocator(2, 100, 100, &timeline);
+
+		std::uint32_t a = allocator.Add(0, 10, 4, false);
+		std::uint32_t b = allocator.Add(0, 20, 8, false);
+		std::uint32_t c = allocator.Add(0, 30, 6, true);
+		std::uint32_t d = allocator.Add(1, 5, 3, false);
+		std::uint32_t e = allocator.Add(0, 15, 2, false);
+
+		allocator.Remove(b);
+		std::uint64_t first = timeline.Signal();
+		allocator.Submit(first);
+		backend.Complete(first);
+		timeline.RetireCompleted();
+
+		// e is freed but its fence has not retired when Defragment runs.
+		allocator.Remove(e);
+		std::uint64_t second = timeline.Signal();
+		allocator.Submit(second);
+
+		std::vector<GeometryAllocator::Move> moves;
+		allocator.DefragmentVertices(0, moves);
+		CHECK(moves.size() == 2);
+		CHECK(moves[0].From == 0 && moves[0].To == 0 && moves[0].Count == 10);
+		CHECK(moves[1].From == 30 && moves[1].To == 10 && moves[1].Count == 30);
+		CHECK(allocator.Get(a).VertexOffset == 0);
+		CHECK(allocator.Get(c).VertexOffset == 10);
+		CHECK(allocator.VertexAllocator(0).UsedCount() == 40);
+		CHECK(allocator.VertexAllocator(0).FreeRangeCount() == 1);
+		// The other pool is untouched.
+		CHECK(allocator.Get(d).VertexOffset == 0);
+
+		// Index units: a 2 at 0, b 4 at 2 (removed), c 6 at 6, d 2 at 12, e 1 at 14 (removed).
+		allocator.DefragmentIndices(moves);
+		CHECK(moves.size() == 3);
+		CHECK(moves[1].From == 6 && moves[1].To == 2 && moves[1].Count == 6);
+		CHECK(moves[2].From == 12 && moves[2].To == 8 && moves[2].Count == 2);
+		CHECK(allocator.StartIndexLocation(c) == 2);
+		CHECK(allocator.StartIndexLocation(d) == 16);
+		CHECK(allocator.IndexAllocator().UsedCount() == 10);
+
+		// The free of e would now hit live ranges; it is dropped.
+		backend.Complete(second);
+		timeline.RetireCompleted();
+		CHECK(allocator.VertexAllocator(0).UsedCount() == 40);
+		CHECK(allocator.IndexAllocator().UsedCount() == 10);
+		CHECK(allocator.Add(0, 60, 90, false) != GeometryAllocator::InvalidHandle);
+	}
+}
+
+int main()
+{
+	TestAdd();
+	TestOutOfRoom();
+	TestRemoveWaitsForFence();
+	TestDefragment();
+	return Check::Finish("GeometryAllocatorTests");
+}
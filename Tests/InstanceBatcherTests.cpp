@@ -0,0 +1,175 @@
+#include "InstanceBatcher.h"
+#include "Check.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Item i has pipeline pipelines[i] and geometry geometries[i]; the world matrix and
+	// material identify the item.
+	struct Scene
+	{
+		std::vector<std::uint32_t> Pipelines;
+		std::vector<std::uint32_t> Geometries;
+		std::vector<XMFLOAT4X4> Worlds;
+		std::vector<std::uint32_t> Materials;
+
+		void Add(std::uint32_t pipeline, std::uint32_t geometry)
+		{
+			const float id = (float)Pipelines.size();
+			Pipelines.push_back(pipeline);
+			Geometries.push_back(geometry);
+			Worlds.push_back(XMFLOAT4X4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, id, 2 * id, 3 * id, 1));
+			Materials.push_back(1000 + (std::uint32_t)Pipelines.size() - 1);
+		}
+	};
+
+	// Every instance's data belongs to the item the batcher says it is.
+	bool InstancesMatchItems(const InstanceBatcher& batcher, const Scene& scene)
+	{
+		std::vector<InstanceData> instances(batcher.InstanceCount());
+		batcher.WriteInstances(instances.data(), scene.Worlds.data(), scene.Materials.data());
+		for (std::uint32_t i = 0; i < batcher.InstanceCount(); ++i)
+		{
+			const std::uint32_t item = batcher.ItemOf(i);
+			if (instances[i].Material != scene.Materials[item] ||
+				std::memcmp(&instances[i].World, &scene.Worlds[item], sizeof(XMFLOAT4X4)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	void TestGrouping()
+	{
+		Scene scene;
+		scene.Add(0, 0);	// 0
+		scene.Add(1, 0);	// 1
+		scene.Add(0, 0);	// 2
+		scene.Add(0, 1);	// 3
+		scene.Add(1, 0);	// 4
+		scene.Add(0, 0);	// 5
+
+		// Item 5 draws another LOD than items 0 and 2, item 4 is not visible.
+		const std::uint32_t visible[] = { 2, 1, 3, 0, 5 };
+		const std::uint32_t submeshes[] = { 7, 7, 7, 7, 8 };
+
+		InstanceBatcher batcher;
+		batcher.Build(visible, submeshes, 5, scene.Pipelines.data(), scene.Geometries.data());
+
+		// In order of first appearance: (0, 0, 7) from item 2, (1, 0, 7), (0, 1, 7), (0, 0, 8).
+		const std::vector<InstanceBatch>& batches = batcher.Batches();
+		CHECK(batches.size() == 4);
+		CHECK(batches[0].Pipeline == 0 && batches[0].Geometry == 0 && batches[0].Submesh == 7);
+		CHECK(batches[1].Pipeline == 1 && batches[1].Geometry == 0 && batches[1].Submesh == 7);
+		CHECK(batches[2].Pipeline == 0 && batches[2].Geometry == 1 && batches[2].Submesh == 7);
+		CHECK(batches[3].Pipeline == 0 && batches[3].Geometry == 0 && batches[3].Submesh == 8);
+
+		CHECK(batches[0].FirstInstance == 0 && batches[0].InstanceCount == 2);
+		CHECK(batches[1].FirstInstance == 2 && batches[1].InstanceCount == 1);
+		CHECK(batches[2].FirstInstance == 3 && batches[2].InstanceCount == 1);
+		CHECK(batches[3].FirstInstance == 4 && batches[3].InstanceCount == 1);
+
+		// Items keep their visible order inside a batch.
+		CHECK(batcher.InstanceCount() == 5);
+		const std::uint32_t order[] = { 2, 0, 1, 3, 5 };
+		for (std::uint32_t i = 0; i < 5; ++i)
+			CHECK(batcher.ItemOf(i) == order[i]);
+
+		CHECK(InstancesMatchItems(batcher, scene));
+		CHECK(batcher.Stats().Items == 5);
+		CHECK(batcher.Stats().Draws == 4);
+		CHECK(batcher.Stats().SavedDraws() == 1);
+	}
+
+	void TestRebuild()
+	{
+		Scene scene;
+		for (std::uint32_t i = 0; i < 4; ++i)
+			scene.Add(0, 0);
+
+		InstanceBatcher batcher;
+		const std::uint32_t visible[] = { 0, 1, 2, 3 };
+		const std::uint32_t submeshes[] = { 0, 0, 0, 0 };
+		batcher.Build(visible, submeshes, 4, scene.Pipelines.data(), scene.Geometries.data());
+		CHECK(batcher.Batches().size() == 1 && batcher.Batches()[0].InstanceCount == 4);
+		CHECK(batcher.Stats().SavedDraws() == 3);
+
+		// A new frame starts from nothing.
+		batcher.Build(visible, submeshes, 0, scene.Pipelines.data(), scene.Geometries.data());
+		CHECK(batcher.Batches().empty());
+		CHECK(batcher.InstanceCount() == 0);
+		CHECK(batcher.Stats().Items == 0 && batcher.Stats().Draws == 0);
+
+		batcher.Build(visible + 2, submeshes, 2, scene.Pipelines.data(), scene.Geometries.data());
+		CHECK(batcher.Batches().size() == 1 && batcher.Batches()[0].FirstInstance == 0);
+		CHECK(batcher.ItemOf(0) == 2 && batcher.ItemOf(1) == 3);
+	}
+
+	void TestRandomScene()
+	{
+		std::mt19937 random(9);
+		Scene scene;
+		for (std::uint32_t i = 0; i < 5000; ++i)
+			scene.Add(random() % 4, random() % 3);
+
+		std::vector<std::uint32_t> visible, submeshes;
+		for (std::uint32_t i = 0; i < 5000; ++i)
+		{
+			if (random() % 3 != 0)
+			{
+				visible.push_back(i);
+				submeshes.push_back(random() % 5);
+			}
+		}
+
+		InstanceBatcher batcher;
+		batcher.Build(visible.data(), submeshes.data(), (std::uint32_t)visible.size(), scene.Pipelines.data(),
+			scene.Geometries.data());
+
+		// The batches tile the instances, every instance matches its batch's key, and
+		// instances of a batch are in visible order.
+		std::vector<std::uint32_t> positionOf(scene.Pipelines.size());
+		std::vector<std::uint32_t> submeshOf(scene.Pipelines.size());
+		for (std::uint32_t i = 0; i < visible.size(); ++i)
+		{
+			positionOf[visible[i]] = i;
+			submeshOf[visible[i]] = submeshes[i];
+		}
+
+		bool tiled = true, matching = true, ordered = true;
+		std::uint32_t next = 0;
+		for (const InstanceBatch& batch : batcher.Batches())
+		{
+			tiled = tiled && batch.FirstInstance == next && batch.InstanceCount > 0;
+			next += batch.InstanceCount;
+			for (std::uint32_t i = batch.FirstInstance; i < batch.FirstInstance + batch.InstanceCount; ++i)
+			{
+				const std::uint32_t item = batcher.ItemOf(i);
+				matching = matching && scene.Pipelines[item] == batch.Pipeline && scene.Geometries[item] == batch.Geometry &&
+					submeshOf[item] == batch.Submesh;
+				if (i > batch.FirstInstance)
+					ordered = ordered && positionOf[batcher.ItemOf(i - 1)] < positionOf[item];
+			}
+		}
+		CHECK(tiled && next == visible.size());
+		CHECK(matching);
+		CHECK(ordered);
+
+		// 4 pipelines x 3 geometries x 5 submeshes, all of them present.
+		CHECK(batcher.Batches().size() == 60);
+		CHECK(batcher.Stats().Items == visible.size());
+		CHECK(batcher.Stats().SavedDraws() == visible.size() - 60);
+		CHECK(InstancesMatchItems(batcher, scene));
+	}
+}
+
+int main()
+{
+	TestGrouping();
+	TestRebuild();
+	TestRandomScene();
+	return Check::Finish("InstanceBatcherTests");
+}
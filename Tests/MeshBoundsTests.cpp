@@ -0,0 +1,213 @@
+#include "MeshBounds.h"
+#include "SubmeshTable.h"
+#include "TestMeshes.h"
+#include "Check.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Absolute slack for points on the surface of a volume.
+	const float Epsilon = 1e-3f;
+
+	bool InBox(const BoundingBox& box, FXMVECTOR p)
+	{
+		XMVECTOR d = XMVectorAbs(XMVectorSubtract(p, XMLoadFloat3(&box.Center)));
+		return XMVector3LessOrEqual(d, XMVectorAdd(XMLoadFloat3(&box.Extents), XMVectorReplicate(Epsilon)));
+	}
+
+	bool InSphere(const BoundingSphere& sphere, FXMVECTOR p)
+	{
+		float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(p, XMLoadFloat3(&sphere.Center))));
+		return distance <= sphere.Radius + Epsilon;
+	}
+
+	bool InOrientedBox(const BoundingOrientedBox& box, FXMVECTOR p)
+	{
+		XMVECTOR local = XMVector3InverseRotate(XMVectorSubtract(p, XMLoadFloat3(&box.Center)),
+			XMLoadFloat4(&box.Orientation));
+		return XMVector3LessOrEqual(XMVectorAbs(local), XMVectorAdd(XMLoadFloat3(&box.Extents), XMVectorReplicate(Epsilon)));
+	}
+
+	// Every point lies in all three volumes.
+	bool ContainsAll(const MeshBounds& bounds, const std::vector<XMFLOAT3>& points)
+	{
+		for (const XMFLOAT3& point : points)
+		{
+			XMVECTOR p = XMLoadFloat3(&point);
+			if (!InBox(bounds.Box, p) || !InSphere(bounds.Sphere, p) || !InOrientedBox(bounds.OrientedBox, p))
+				return false;
+		}
+		return true;
+	}
+
+	MeshBounds Compute(const std::vector<XMFLOAT3>& points)
+	{
+		return ComputeMeshBounds(points.empty() ? nullptr : &points[0].x, sizeof(XMFLOAT3), points.size());
+	}
+
+	float Volume(const XMFLOAT3& extents)
+	{
+		return 8.0f * extents.x * extents.y * extents.z;
+	}
+
+	// Points in a 20 x 2 x 1 box, rotated and moved far from the origin.
+	std::vector<XMFLOAT3> MakeRotatedSlab(std::uint32_t count, std::uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		XMMATRIX toWorld = XMMatrixRotationRollPitchYaw(0.3f, 0.7f, -0.4f) * XMMatrixTranslation(1000.0f, -250.0f, 40.0f);
+
+		std::vector<XMFLOAT3> points(count);
+		for (XMFLOAT3& point : points)
+		{
+			XMVECTOR local = XMVectorSet(10.0f * unit(random), unit(random), 0.5f * unit(random), 1.0f);
+			XMStoreFloat3(&point, XMVector3TransformCoord(local, toWorld));
+		}
+		return points;
+	}
+
+	void TestContainsPoints()
+	{
+		std::vector<XMFLOAT3> slab = MakeRotatedSlab(5000, 1);
+		MeshBounds bounds = Compute(slab);
+		CHECK(ContainsAll(bounds, slab));
+
+		// The oriented box follows the slab instead of its axis-aligned box.
+		CHECK(Volume(bounds.OrientedBox.Extents) < 0.5f * Volume(bounds.Box.Extents));
+		CHECK(Volume(bounds.OrientedBox.Extents) < 1.1f * 40.0f);
+		CHECK(bounds.Sphere.Radius < 10.5f);
+
+		std::vector<TestMeshes::Vertex> vertices;
+		std::vector<std::uint32_t> indices;
+		TestMeshes::MakeSphere(24, 48, vertices, indices);
+		std::vector<XMFLOAT3> sphere;
+		for (const TestMeshes::Vertex& v : vertices)
+			sphere.push_back(XMFLOAT3(3.0f * v.Position[0] - 7.0f, 3.0f * v.Position[1], 3.0f * v.Position[2] + 2.0f));
+		bounds = Compute(sphere);
+		CHECK(ContainsAll(bounds, sphere));
+		CHECK_NEAR(bounds.Sphere.Radius, 3.0f, 0.05f);
+		CHECK_NEAR(bounds.Sphere.Center.x, -7.0f, 0.05f);
+		CHECK_NEAR(bounds.Box.Extents.y, 3.0f, 1e-4f);
+	}
+
+	void TestDegenerateInputs()
+	{
+		std::vector<XMFLOAT3> points;
+		MeshBounds bounds = Compute(points);
+		CHECK(bounds.Box.Center.x == 0.0f && bounds.Box.Extents.x == 0.0f);
+		CHECK(bounds.Sphere.Radius == 0.0f);
+		CHECK(bounds.OrientedBox.Extents.z == 0.0f && bounds.OrientedBox.Orientation.w == 1.0f);
+
+		// One point, repeated.
+		points.assign(7, XMFLOAT3(4.0f, -5.0f, 6.0f));
+		bounds = Compute(points);
+		CHECK(ContainsAll(bounds, points));
+		CHECK(bounds.Box.Center.y == -5.0f && bounds.Box.Extents.y == 0.0f);
+		CHECK(bounds.Sphere.Radius == 0.0f && bounds.Sphere.Center.z == 6.0f);
+		CHECK(Volume(bounds.OrientedBox.Extents) == 0.0f);
+
+		// Flat: a grid in the plane z = 2.
+		points.clear();
+		for (int y = 0; y < 10; ++y)
+		{
+			for (int x = 0; x < 10; ++x)
+				points.push_back(XMFLOAT3((float)x, (float)y * 0.5f, 2.0f));
+		}
+		bounds = Compute(points);
+		CHECK(ContainsAll(bounds, points));
+		CHECK(bounds.Box.Extents.z == 0.0f);
+		CHECK(Volume(bounds.OrientedBox.Extents) <= Volume(bounds.Box.Extents) + 1e-4f);
+
+		// Collinear, along a diagonal.
+		points.clear();
+		for (int i = 0; i <= 10; ++i)
+			points.push_back(XMFLOAT3((float)i, (float)i, (float)-i));
+		bounds = Compute(points);
+		CHECK(ContainsAll(bounds, points));
+		CHECK_NEAR(bounds.Sphere.Radius, 5.0f * std::sqrt(3.0f), 1e-3f);
+	}
+
+	void TestIndexed()
+	{
+		std::vector<XMFLOAT3> points = MakeRotatedSlab(100, 2);
+		// Vertices 10 .. 59, referenced through a base vertex of 10.
+		std::vector<std::uint32_t> indices;
+		for (std::uint32_t i = 0; i < 50; ++i)
+			indices.push_back(49 - i);
+
+		MeshBounds indexed = ComputeMeshBounds(&points[0].x, sizeof(XMFLOAT3), indices.data(), indices.size(), 10);
+		std::vector<XMFLOAT3> subset(points.begin() + 10, points.begin() + 60);
+		MeshBounds direct = Compute(subset);
+
+		CHECK(ContainsAll(indexed, subset));
+		CHECK(indexed.Box.Center.x == direct.Box.Center.x && indexed.Box.Extents.z == direct.Box.Extents.z);
+		// Vertex 0 is far out of this subset's box.
+		CHECK(!InBox(indexed.Box, XMLoadFloat3(&points[0])) || !InBox(indexed.Box, XMLoadFloat3(&points[99])));
+	}
+
+	void TestSubmeshBounds()
+	{
+		// Eight submeshes of 20k indices each into one shared vertex array, each on its own
+		// slab, so the pool gets enough work to use it.
+		const std::uint32_t submeshCount = 8;
+		const std::uint32_t pointsPerSubmesh = 20000;
+		std::vector<XMFLOAT3> points;
+		std::vector<std::uint32_t> indices;
+		SubmeshTable serialTable, pooledTable;
+		for (std::uint32_t s = 0; s < submeshCount; ++s)
+		{
+			std::vector<XMFLOAT3> slab = MakeRotatedSlab(pointsPerSubmesh, 10 + s);
+			std::uint32_t baseVertex = (std::uint32_t)points.size();
+			std::uint32_t start = (std::uint32_t)indices.size();
+			points.insert(points.end(), slab.begin(), slab.end());
+			for (std::uint32_t i = 0; i < pointsPerSubmesh; ++i)
+				indices.push_back((i * 7919) % pointsPerSubmesh);
+
+			std::string name = "slab" + std::to_string(s);
+			serialTable.Add(name, pointsPerSubmesh, start, baseVertex);
+			pooledTable.Add(name, pointsPerSubmesh, start, baseVertex);
+		}
+
+		ComputeSubmeshBounds(serialTable, &points[0].x, sizeof(XMFLOAT3), indices.data());
+		WorkerPool workers(4);
+		ComputeSubmeshBounds(pooledTable, &points[0].x, sizeof(XMFLOAT3), indices.data(), &workers);
+
+		bool same = true;
+		bool contained = true;
+		for (SubmeshHandle h = 0; h < submeshCount; ++h)
+		{
+			same = same && std::memcmp(&serialTable.Bounds(h), &pooledTable.Bounds(h), sizeof(BoundingBox)) == 0 &&
+				std::memcmp(&serialTable.Sphere(h), &pooledTable.Sphere(h), sizeof(BoundingSphere)) == 0 &&
+				std::memcmp(&serialTable.OrientedBox(h), &pooledTable.OrientedBox(h), sizeof(BoundingOrientedBox)) == 0;
+
+			MeshBounds bounds;
+			bounds.Box = pooledTable.Bounds(h);
+			bounds.Sphere = pooledTable.Sphere(h);
+			bounds.OrientedBox = pooledTable.OrientedBox(h);
+			std::vector<XMFLOAT3> slab(points.begin() + h * pointsPerSubmesh, points.begin() + (h + 1) * pointsPerSubmesh);
+			contained = contained && ContainsAll(bounds, slab) && Volume(bounds.OrientedBox.Extents) < 45.0f;
+		}
+		CHECK(same);
+		CHECK(contained);
+
+		// An empty table is left alone.
+		SubmeshTable empty;
+		ComputeSubmeshBounds(empty, &points[0].x, sizeof(XMFLOAT3), indices.data(), &workers);
+		CHECK(empty.Size() == 0);
+	}
+}
+
+int main()
+{
+	TestContainsPoints();
+	TestDegenerateInputs();
+	TestIndexed();
+	TestSubmeshBounds();
+	return Check::Finish("MeshBoundsTests");
+}
@@ -0,0 +1,194 @@
+#include "MeshFile.h"
+#include "MappedFile.h"
+#include "Check.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	const float Positions[4][3] =
+	{
+		{ 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }
+	};
+	const std::uint16_t Indices[9] = { 0, 1, 2, 0, 2, 3, 0, 1, 2 };
+
+	// A quad and a triangle that starts at the second vertex.
+	MeshFileSource MakeSource()
+	{
+		MeshFileSource source;
+		source.VertexFormat = 7;
+		source.VertexStride = sizeof(Positions[0]);
+		source.VertexCount = 4;
+		source.Vertices = Positions;
+		source.IndexSize = 2;
+		source.IndexCount = 9;
+		source.Indices = Indices;
+
+		MeshFileSource::Submesh quad;
+		quad.Name = "quad";
+		quad.IndexCount = 6;
+		quad.Bounds = { { 0.5f, 0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
+		source.Submeshes.push_back(quad);
+
+		MeshFileSource::Submesh triangle;
+		triangle.Name = "triangle";
+		triangle.IndexCount = 3;
+		triangle.StartIndexLocation = 6;
+		triangle.BaseVertexLocation = 1;
+		source.Submeshes.push_back(triangle);
+
+		source.Bounds = quad.Bounds;
+		return source;
+	}
+
+	MeshFileHeader ReadHeader(const std::vector<unsigned char>& file)
+	{
+		MeshFileHeader header;
+		std::memcpy(&header, file.data(), sizeof(header));
+		return header;
+	}
+
+	// Parses a copy of file after edit has changed its header.
+	template <typename Edit>
+	MeshFile::Status ParseEditedHeader(const std::vector<unsigned char>& file, Edit edit)
+	{
+		std::vector<unsigned char> copy = file;
+		MeshFileHeader header = ReadHeader(copy);
+		edit(header);
+		std::memcpy(copy.data(), &header, sizeof(header));
+		MeshFileView view;
+		return view.Parse(copy.data(), copy.size());
+	}
+
+	// Same, for the given submesh.
+	template <typename Edit>
+	MeshFile::Status ParseEditedSubmesh(const std::vector<unsigned char>& file, std::uint32_t i, Edit edit)
+	{
+		std::vector<unsigned char> copy = file;
+		unsigned char* at = copy.data() + ReadHeader(copy).SubmeshOffset + i * sizeof(MeshFileSubmesh);
+		MeshFileSubmesh submesh;
+		std::memcpy(&submesh, at, sizeof(submesh));
+		edit(submesh);
+		std::memcpy(at, &submesh, sizeof(submesh));
+		MeshFileView view;
+		return view.Parse(copy.data(), copy.size());
+	}
+
+	void CheckView(const MeshFileView& view)
+	{
+		const MeshFileHeader& header = view.Header();
+		CHECK(header.VertexFormat == 7);
+		CHECK(header.VertexStride == 12);
+		CHECK(header.VertexCount == 4);
+		CHECK(header.IndexSize == 2);
+		CHECK(header.IndexCount == 9);
+		CHECK(header.Bounds.Center[1] == 0.5f);
+
+		CHECK(view.VertexByteSize() == sizeof(Positions));
+		CHECK(std::memcmp(view.VertexData(), Positions, sizeof(Positions)) == 0);
+		CHECK(view.IndexByteSize() == sizeof(Indices));
+		CHECK(std::memcmp(view.IndexData(), Indices, sizeof(Indices)) == 0);
+
+		CHECK(view.SubmeshCount() == 2);
+		CHECK(view.SubmeshName(0) == "quad");
+		CHECK(view.SubmeshName(1) == "triangle");
+		CHECK(view.Submesh(0).IndexCount == 6);
+		CHECK(view.Submesh(0).Bounds.Extents[0] == 0.5f);
+		CHECK(view.Submesh(1).StartIndexLocation == 6);
+		CHECK(view.Submesh(1).BaseVertexLocation == 1);
+	}
+
+	void TestRoundTrip()
+	{
+		std::vector<unsigned char> file;
+		BuildMeshFile(MakeSource(), file);
+
+		MeshFileHeader header = ReadHeader(file);
+		CHECK(header.Magic == MeshFile::Magic);
+		CHECK(header.Version == MeshFile::Version);
+		CHECK(header.SubmeshOffset % MeshFile::SectionAlignment == 0);
+		CHECK(header.VertexOffset % MeshFile::SectionAlignment == 0);
+		CHECK(header.IndexOffset % MeshFile::SectionAlignment == 0);
+		CHECK(header.NameOffset % MeshFile::SectionAlignment == 0);
+		CHECK(header.NameBytes == 12);
+		CHECK(file.size() == header.NameOffset + header.NameBytes);
+
+		MeshFileView view;
+		CHECK(view.Parse(file.data(), file.size()) == MeshFile::Status::Ok);
+		CheckView(view);
+	}
+
+	// The loader's path up to the upload: written to disk, mapped and used in place.
+	void TestWriteAndMap()
+	{
+		const char* path = "MeshFileTests.mesh";
+		CHECK(WriteMeshFile(path, MakeSource()));
+
+		{
+			MappedFile file;
+			CHECK(file.Open(path));
+			MeshFileView view;
+			CHECK(view.Parse(file.Data(), file.Size()) == MeshFile::Status::Ok);
+			if (file.IsOpen())
+				CheckView(view);
+		}
+		std::remove(path);
+
+		MappedFile missing;
+		CHECK(!missing.Open(path));
+		CHECK(!missing.IsOpen());
+	}
+
+	void TestRejectsBadHeaders()
+	{
+		using MeshFile::Status;
+		std::vector<unsigned char> file;
+		BuildMeshFile(MakeSource(), file);
+
+		MeshFileView view;
+		CHECK(view.Parse(nullptr, 0) == Status::TooSmall);
+		CHECK(view.Parse(file.data(), sizeof(MeshFileHeader) - 1) == Status::TooSmall);
+		// The name section ends the file.
+		CHECK(view.Parse(file.data(), file.size() - 1) == Status::SectionOutOfRange);
+
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.Magic = 0x4a424f57; }) == Status::BadMagic);
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.Version = 2; }) == Status::UnsupportedVersion);
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.IndexSize = 3; }) == Status::BadIndexSize);
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.VertexCount = 0x40000000; }) == Status::SectionOutOfRange);
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.IndexOffset = ~0ull - 4; }) == Status::SectionOutOfRange);
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.SubmeshCount = 1000; }) == Status::SectionOutOfRange);
+		CHECK(ParseEditedHeader(file, [](MeshFileHeader& h) { h.VertexOffset += 4; }) == Status::MisalignedSection);
+	}
+
+	void TestRejectsBadSubmeshes()
+	{
+		using MeshFile::Status;
+		std::vector<unsigned char> file;
+		BuildMeshFile(MakeSource(), file);
+
+		CHECK(ParseEditedSubmesh(file, 1, [](MeshFileSubmesh& s) { s.IndexCount = 4; }) == Status::SubmeshOutOfRange);
+		CHECK(ParseEditedSubmesh(file, 1, [](MeshFileSubmesh& s) { s.StartIndexLocation = 10; }) == Status::SubmeshOutOfRange);
+		CHECK(ParseEditedSubmesh(file, 0, [](MeshFileSubmesh& s) { s.StartIndexLocation = 0xfffffffe; }) == Status::SubmeshOutOfRange);
+
+		// The base vertex must be one of the file's vertices.
+		CHECK(ParseEditedSubmesh(file, 1, [](MeshFileSubmesh& s) { s.BaseVertexLocation = 3; }) == Status::Ok);
+		CHECK(ParseEditedSubmesh(file, 1, [](MeshFileSubmesh& s) { s.BaseVertexLocation = 4; }) == Status::BaseVertexOutOfRange);
+		CHECK(ParseEditedSubmesh(file, 0, [](MeshFileSubmesh& s) { s.BaseVertexLocation = -1; }) == Status::BaseVertexOutOfRange);
+
+		CHECK(ParseEditedSubmesh(file, 1, [](MeshFileSubmesh& s) { s.NameLength = 9; }) == Status::NameOutOfRange);
+		CHECK(ParseEditedSubmesh(file, 0, [](MeshFileSubmesh& s) { s.NameOffset = 8; }) == Status::Ok);
+		CHECK(ParseEditedSubmesh(file, 0, [](MeshFileSubmesh& s) { s.NameOffset = 9; }) == Status::NameOutOfRange);
+
+		for (int status = (int)Status::Ok; status <= (int)Status::NameOutOfRange; ++status)
+			CHECK(std::strcmp(MeshFile::StatusString((Status)status), "unknown") != 0);
+	}
+}
+
+int main()
+{
+	TestRoundTrip();
+	TestWriteAndMap();
+	TestRejectsBadHeaders();
+	TestRejectsBadSubmeshes();
+	return Check::Finish("MeshFileTests");
+}
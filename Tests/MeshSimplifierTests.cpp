@@ -0,0 +1,238 @@
+#include "MeshSimplifier.h"
+#include "TestMeshes.h"
+#include "Check.h"
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	// A flat n x n quad grid on the xz plane from 0 to 1, with a second copy of column
+	// seamColumn (same positions, other texture coordinate) when seamColumn < n.
+	struct Grid
+	{
+		std::vector<TestMeshes::Vertex> Vertices;
+		std::vector<float> TexCoords;
+		std::vector<std::uint32_t> Indices;
+		std::vector<std::uint32_t> SeamVertices;
+
+		Grid(std::uint32_t n, std::uint32_t seamColumn)
+		{
+			for (std::uint32_t z = 0; z <= n; ++z)
+			{
+				for (std::uint32_t x = 0; x <= n; ++x)
+					Add((float)x / n, (float)z / n, (float)x / n);
+			}
+			std::vector<std::uint32_t> seamCopy(n + 1, 0);
+			for (std::uint32_t z = 0; seamColumn < n && z <= n; ++z)
+			{
+				seamCopy[z] = (std::uint32_t)Vertices.size();
+				SeamVertices.push_back(z * (n + 1) + seamColumn);
+				SeamVertices.push_back(seamCopy[z]);
+				Add((float)seamColumn / n, (float)z / n, 2.0f);
+			}
+
+			for (std::uint32_t z = 0; z < n; ++z)
+			{
+				for (std::uint32_t x = 0; x < n; ++x)
+				{
+					std::uint32_t a = z * (n + 1) + x;
+					std::uint32_t b = a + 1;
+					std::uint32_t c = a + n + 1;
+					std::uint32_t d = c + 1;
+					// Quads right of the seam use its copy.
+					if (x == seamColumn)
+					{
+						a = seamCopy[z];
+						c = seamCopy[z + 1];
+					}
+					std::uint32_t quad[6] = { a, c, b, b, c, d };
+					Indices.insert(Indices.end(), quad, quad + 6);
+				}
+			}
+		}
+
+		void Add(float x, float z, float u)
+		{
+			TestMeshes::Vertex v = { { x, 0.0f, z }, { 0.0f, 1.0f, 0.0f } };
+			Vertices.push_back(v);
+			TexCoords.push_back(u);
+		}
+	};
+
+	void Normal(const float* a, const float* b, const float* c, float n[3])
+	{
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	// Twice the area, signed by the y of the normal.
+	double SignedAreaY(const std::vector<TestMeshes::Vertex>& vertices, const std::vector<std::uint32_t>& indices)
+	{
+		double area = 0.0;
+		for (std::size_t t = 0; t < indices.size(); t += 3)
+		{
+			float n[3];
+			Normal(vertices[indices[t]].Position, vertices[indices[t + 1]].Position, vertices[indices[t + 2]].Position, n);
+			area += n[1];
+		}
+		return area;
+	}
+
+	std::vector<std::uint32_t> Simplify(const std::vector<TestMeshes::Vertex>& vertices,
+		const std::vector<std::uint32_t>& indices, std::size_t targetIndexCount, float targetError, float* resultError)
+	{
+		std::vector<std::uint32_t> result(indices.size());
+		result.resize(MeshSimplifier::Simplify(result.data(), indices.data(), indices.size(),
+			vertices[0].Position, sizeof(TestMeshes::Vertex), (std::uint32_t)vertices.size(),
+			targetIndexCount, targetError, resultError));
+		return result;
+	}
+
+	void TestScale()
+	{
+		std::vector<TestMeshes::Vertex> vertices;
+		std::vector<std::uint32_t> indices;
+		TestMeshes::MakeSphere(8, 16, vertices, indices);
+		CHECK_NEAR(MeshSimplifier::GetScale(vertices[0].Position, sizeof(TestMeshes::Vertex), (std::uint32_t)vertices.size()), 2.0, 1e-5);
+	}
+
+	void TestSphere()
+	{
+		std::vector<TestMeshes::Vertex> vertices;
+		std::vector<std::uint32_t> indices;
+		TestMeshes::MakeSphere(32, 64, vertices, indices);
+
+		float previousError = 0.0f;
+		for (std::size_t divisor : { 2, 4, 10 })
+		{
+			const std::size_t target = indices.size() / divisor / 3 * 3;
+			float error = -1.0f;
+			std::vector<std::uint32_t> result = Simplify(vertices, indices, target, 1.0f, &error);
+			CHECK(result.size() % 3 == 0);
+			CHECK(result.size() <= target);
+			CHECK(result.size() >= target * 3 / 4);
+
+			// Coarser levels cost more, but stay close to the sphere.
+			CHECK(error >= previousError);
+			CHECK(error < 0.05f);
+			previousError = error;
+
+			// No flipped or degenerate triangles: every normal still points out of the
+			// convex sphere.
+			bool valid = true;
+			bool outward = true;
+			for (std::size_t t = 0; t < result.size(); t += 3)
+			{
+				valid = valid && result[t] < vertices.size() && result[t + 1] < vertices.size() && result[t + 2] < vertices.size();
+				if (!valid)
+					break;
+				const float* a = vertices[result[t]].Position;
+				float n[3];
+				Normal(a, vertices[result[t + 1]].Position, vertices[result[t + 2]].Position, n);
+				outward = outward && n[0] * a[0] + n[1] * a[1] + n[2] * a[2] > 0.0f;
+			}
+			CHECK(valid);
+			CHECK(outward);
+		}
+	}
+
+	void TestTargetError()
+	{
+		std::vector<TestMeshes::Vertex> vertices;
+		std::vector<std::uint32_t> indices;
+		TestMeshes::MakeSphere(32, 64, vertices, indices);
+
+		// A curved surface cannot lose anything for free, and a small error budget stops
+		// the collapses well above the index target.
+		float error = -1.0f;
+		std::vector<std::uint32_t> none = Simplify(vertices, indices, 0, 0.0f, &error);
+		CHECK(none.size() == indices.size());
+		CHECK(error == 0.0f);
+
+		std::vector<std::uint32_t> some = Simplify(vertices, indices, 0, 1e-3f, &error);
+		CHECK(some.size() < indices.size());
+		CHECK(some.size() > indices.size() / 10);
+		CHECK(error <= 1e-3f);
+	}
+
+	void TestFlatGridKeepsOutline()
+	{
+		Grid grid(16, 16);
+		float error = -1.0f;
+		std::vector<std::uint32_t> result = Simplify(grid.Vertices, grid.Indices, 0, 1e-6f, &error);
+
+		// A plane collapses for free down to a handful of triangles, and keeps its area,
+		// orientation and outline since border vertices only slide along the border.
+		CHECK(result.size() <= 4 * 3);
+		CHECK(error <= 1e-6f);
+		CHECK_NEAR(SignedAreaY(grid.Vertices, result), SignedAreaY(grid.Vertices, grid.Indices), 1e-4);
+		bool corners[4] = {};
+		for (std::uint32_t v : result)
+		{
+			const float* p = grid.Vertices[v].Position;
+			if ((p[0] == 0.0f || p[0] == 1.0f) && (p[2] == 0.0f || p[2] == 1.0f))
+				corners[(p[0] == 1.0f ? 1 : 0) + (p[2] == 1.0f ? 2 : 0)] = true;
+		}
+		CHECK(corners[0] && corners[1] && corners[2] && corners[3]);
+	}
+
+	void TestSeamsStay()
+	{
+		Grid grid(16, 8);
+		std::vector<std::uint32_t> result = Simplify(grid.Vertices, grid.Indices, 0, 1e-6f, nullptr);
+		CHECK(result.size() < grid.Indices.size() / 4);
+		CHECK_NEAR(SignedAreaY(grid.Vertices, result), SignedAreaY(grid.Vertices, grid.Indices), 1e-4);
+
+		// Both sides of the seam keep their own copies: no triangle mixes the columns left
+		// of the seam with its right copy or the other way round.
+		bool seamIntact = true;
+		for (std::size_t t = 0; t < result.size(); t += 3)
+		{
+			bool left = false;
+			bool right = false;
+			for (std::size_t k = 0; k < 3; ++k)
+			{
+				std::uint32_t v = result[t + k];
+				float x = grid.Vertices[v].Position[0];
+				float u = grid.TexCoords[v];
+				left = left || x < 0.5f || (x == 0.5f && u != 2.0f);
+				right = right || x > 0.5f || u == 2.0f;
+			}
+			seamIntact = seamIntact && !(left && right);
+		}
+		CHECK(seamIntact);
+	}
+
+	void TestAttributes()
+	{
+		// The flat grid again, with a texture coordinate that bends sharply down the
+		// middle: weighting it keeps the vertices that carry the bend.
+		Grid grid(16, 16);
+		std::vector<float> attributes;
+		for (const TestMeshes::Vertex& v : grid.Vertices)
+			attributes.push_back(std::fabs(v.Position[0] - 0.5f) < 0.2f ? 1.0f : 0.0f);
+		const float weight = 1.0f;
+
+		std::vector<std::uint32_t> result(grid.Indices.size());
+		result.resize(MeshSimplifier::Simplify(result.data(), grid.Indices.data(), grid.Indices.size(),
+			grid.Vertices[0].Position, sizeof(TestMeshes::Vertex), (std::uint32_t)grid.Vertices.size(),
+			0, 1e-6f, nullptr, attributes.data(), sizeof(float), &weight, 1));
+
+		std::vector<std::uint32_t> plain = Simplify(grid.Vertices, grid.Indices, 0, 1e-6f, nullptr);
+		CHECK(result.size() > plain.size());
+	}
+}
+
+int main()
+{
+	TestScale();
+	TestSphere();
+	TestTargetError();
+	TestFlatGridKeepsOutline();
+	TestSeamsStay();
+	TestAttributes();
+	return Check::Finish("MeshSimplifierTests");
+}
@@ -0,0 +1,248 @@
+#include "Meshlets.h"
+#include "TestMeshes.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	typedef std::vector<std::uint32_t> Triangle;
+
+	struct Sphere
+	{
+		std::vector<TestMeshes::Vertex> Vertices;
+		std::vector<std::uint32_t> Indices;
+		MeshletSet Set;
+		MeshletRange Range;
+
+		Sphere()
+		{
+			TestMeshes::MakeSphere(32, 64, Vertices, Indices);
+			Range = Meshlets::Build(Set, Indices.data(), Indices.size(), Vertices[0].Position,
+				sizeof(TestMeshes::Vertex), (std::uint32_t)Vertices.size());
+		}
+
+		const float* Position(std::uint32_t v)const { return Vertices[v].Position; }
+	};
+
+	// Triangles rotated to start at their smallest index, which keeps the winding.
+	std::vector<Triangle> Canonical(const std::vector<std::uint32_t>& indices)
+	{
+		std::vector<Triangle> triangles;
+		for (std::size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			Triangle tri(indices.begin() + t, indices.begin() + t + 3);
+			std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+			triangles.push_back(tri);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	std::vector<std::uint32_t> MeshletIndices(const MeshletSet& set, std::uint32_t m)
+	{
+		const Meshlet& meshlet = set.Meshlets[m];
+		std::vector<std::uint32_t> indices;
+		for (std::uint32_t i = 0; i < meshlet.TriangleCount * 3; ++i)
+			indices.push_back(set.Vertices[meshlet.VertexOffset + set.Triangles[meshlet.TriangleOffset * 3 + i]]);
+		return indices;
+	}
+
+	// Planes that hold everything within distance of the origin.
+	void SetBoxPlanes(MeshletCullParams& params, float distance)
+	{
+		const float planes[6][4] =
+		{
+			{ 1, 0, 0, distance }, { -1, 0, 0, distance }, { 0, 1, 0, distance },
+			{ 0, -1, 0, distance }, { 0, 0, 1, distance }, { 0, 0, -1, distance }
+		};
+		std::copy(&planes[0][0], &planes[0][0] + 24, &params.FrustumPlanes[0][0]);
+	}
+
+	void TestBuild()
+	{
+		Sphere sphere;
+		CHECK(sphere.Range.FirstMeshlet == 0);
+		CHECK(sphere.Range.MeshletCount == sphere.Set.Meshlets.size());
+		CHECK(sphere.Set.Bounds.size() == sphere.Set.Meshlets.size());
+
+		bool withinLimits = true;
+		bool spheresHoldVertices = true;
+		bool conesHoldNormals = true;
+		for (std::uint32_t m = 0; m < sphere.Range.MeshletCount; ++m)
+		{
+			const Meshlet& meshlet = sphere.Set.Meshlets[m];
+			const MeshletBounds& bounds = sphere.Set.Bounds[m];
+			withinLimits = withinLimits && meshlet.VertexCount <= Meshlets::DefaultMaxVertices &&
+				meshlet.TriangleCount <= Meshlets::DefaultMaxTriangles && meshlet.TriangleCount > 0;
+
+			std::vector<std::uint32_t> indices = MeshletIndices(sphere.Set, m);
+			for (std::size_t t = 0; t < indices.size(); t += 3)
+			{
+				const float* a = sphere.Position(indices[t]);
+				const float* b = sphere.Position(indices[t + 1]);
+				const float* c = sphere.Position(indices[t + 2]);
+				for (const float* p : { a, b, c })
+				{
+					float dx = p[0] - bounds.Center[0], dy = p[1] - bounds.Center[1], dz = p[2] - bounds.Center[2];
+					spheresHoldVertices = spheresHoldVertices && std::sqrt(dx * dx + dy * dy + dz * dz) <= bounds.Radius * 1.0001f;
+				}
+
+				if (bounds.ConeCutoff > 0.0f)
+				{
+					float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+					float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+					float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+					float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+					float cosine = (n[0] * bounds.ConeAxis[0] + n[1] * bounds.ConeAxis[1] + n[2] * bounds.ConeAxis[2]) / length;
+					conesHoldNormals = conesHoldNormals && cosine >= bounds.ConeCutoff - 1e-4f;
+				}
+			}
+		}
+		CHECK(withinLimits);
+		CHECK(spheresHoldVertices);
+		CHECK(conesHoldNormals);
+
+		// The meshlets hold every triangle exactly once, winding included.
+		std::vector<std::uint32_t> all;
+		for (std::uint32_t m = 0; m < sphere.Range.MeshletCount; ++m)
+		{
+			std::vector<std::uint32_t> indices = MeshletIndices(sphere.Set, m);
+			all.insert(all.end(), indices.begin(), indices.end());
+		}
+		CHECK(Canonical(all) == Canonical(sphere.Indices));
+	}
+
+	void TestCullNothing()
+	{
+		Sphere sphere;
+		MeshletCullParams params;
+		SetBoxPlanes(params, 10.0f);
+		params.BackfaceCulling = false;
+
+		std::vector<std::uint32_t> indices;
+		MeshletCullStats stats = Meshlets::Cull(sphere.Set, sphere.Range, params, indices);
+		CHECK(stats.Visible == sphere.Range.MeshletCount);
+		CHECK(stats.IndexCount == sphere.Indices.size());
+		CHECK(Canonical(indices) == Canonical(sphere.Indices));
+	}
+
+	void TestFrustumCulling()
+	{
+		Sphere sphere;
+		MeshletCullParams params;
+		SetBoxPlanes(params, 10.0f);
+		params.BackfaceCulling = false;
+		// Only x >= 0.5 is inside.
+		params.FrustumPlanes[0][3] = -0.5f;
+
+		std::vector<std::uint32_t> indices;
+		MeshletCullStats stats = Meshlets::Cull(sphere.Set, sphere.Range, params, indices);
+		CHECK(stats.FrustumCulled > 0);
+		CHECK(stats.Visible + stats.FrustumCulled == sphere.Range.MeshletCount);
+
+		// Conservative: nothing with a vertex inside went away.
+		std::vector<Triangle> kept = Canonical(indices);
+		std::vector<Triangle> all = Canonical(sphere.Indices);
+		bool keptEveryInsideTriangle = true;
+		for (const Triangle& tri : all)
+		{
+			bool inside = false;
+			for (std::uint32_t v : tri)
+				inside = inside || sphere.Position(v)[0] >= 0.5f;
+			if (inside)
+				keptEveryInsideTriangle = keptEveryInsideTriangle && std::binary_search(kept.begin(), kept.end(), tri);
+		}
+		CHECK(keptEveryInsideTriangle);
+	}
+
+	void TestBackfaceCulling()
+	{
+		Sphere sphere;
+		MeshletCullParams params;
+		SetBoxPlanes(params, 10.0f);
+		params.CameraPosition[2] = -5.0f;
+
+		std::vector<std::uint32_t> indices;
+		MeshletCullStats stats = Meshlets::Cull(sphere.Set, sphere.Range, params, indices);
+		CHECK(stats.BackfaceCulled > 0);
+		CHECK(stats.Visible + stats.BackfaceCulled == sphere.Range.MeshletCount);
+
+		// Every triangle facing the camera survives.
+		std::vector<Triangle> kept = Canonical(indices);
+		bool keptEveryFrontFace = true;
+		for (const Triangle& tri : Canonical(sphere.Indices))
+		{
+			const float* a = sphere.Position(tri[0]);
+			const float* b = sphere.Position(tri[1]);
+			const float* c = sphere.Position(tri[2]);
+			float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float toA[3] = { a[0] - params.CameraPosition[0], a[1] - params.CameraPosition[1], a[2] - params.CameraPosition[2] };
+			bool frontFacing = n[0] * toA[0] + n[1] * toA[1] + n[2] * toA[2] < 0.0f;
+			if (frontFacing)
+				keptEveryFrontFace = keptEveryFrontFace && std::binary_search(kept.begin(), kept.end(), tri);
+		}
+		CHECK(keptEveryFrontFace);
+	}
+
+	void TestSmallCulling()
+	{
+		Sphere sphere;
+		MeshletCullParams params;
+		SetBoxPlanes(params, 10000.0f);
+		params.BackfaceCulling = false;
+		params.CameraPosition[2] = -5000.0f;
+
+		// A 1080p view 5000 units away: the whole unit sphere is under a pixel across.
+		float viewProj[16];
+		TestMeshes::MakeViewProj(5000.0f, 0.25f * 3.14159265f, 16.0f / 9.0f, 1.0f, 10000.0f, viewProj);
+		params.ProjectionScale = 0.5f * 1080.0f * viewProj[5];
+		params.MinPixelRadius = 0.5f;
+
+		std::vector<std::uint32_t> indices;
+		MeshletCullStats stats = Meshlets::Cull(sphere.Set, sphere.Range, params, indices);
+		CHECK(stats.SmallCulled == sphere.Range.MeshletCount);
+		CHECK(indices.empty());
+
+		params.ProjectionScale = 0.0f;
+		CHECK(Meshlets::Cull(sphere.Set, sphere.Range, params, indices).Visible == sphere.Range.MeshletCount);
+	}
+
+	void TestExtractFrustumPlanes()
+	{
+		float viewProj[16];
+		TestMeshes::MakeViewProj(5.0f, 0.5f * 3.14159265f, 1.0f, 1.0f, 100.0f, viewProj);
+		float planes[6][4];
+		Meshlets::ExtractFrustumPlanes(viewProj, planes);
+
+		auto signedDistance = [&](int p, float x, float y, float z)
+		{
+			return planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3];
+		};
+
+		// The camera is at z = -5 with a 90 degree field of view: the origin is inside, 1
+		// unit from the near plane at z = -4 and sqrt(12.5) from the sides.
+		for (int p = 0; p < 6; ++p)
+			CHECK(signedDistance(p, 0.0f, 0.0f, 0.0f) > 0.0f);
+		CHECK_NEAR(signedDistance(4, 0.0f, 0.0f, 0.0f), 4.0, 1e-4);
+		CHECK_NEAR(signedDistance(5, 0.0f, 0.0f, 0.0f), 95.0, 1e-3);
+		CHECK_NEAR(signedDistance(0, 0.0f, 0.0f, 0.0f), std::sqrt(12.5), 1e-4);
+		CHECK(signedDistance(0, -6.0f, 0.0f, 0.0f) < 0.0f);
+		CHECK(signedDistance(3, 0.0f, 6.0f, 0.0f) < 0.0f);
+		CHECK(signedDistance(4, 0.0f, 0.0f, -4.5f) < 0.0f);
+	}
+}
+
+int main()
+{
+	TestBuild();
+	TestCullNothing();
+	TestFrustumCulling();
+	TestBackfaceCulling();
+	TestSmallCulling();
+	TestExtractFrustumPlanes();
+	return Check::Finish("MeshletsTests");
+}
@@ -0,0 +1,223 @@
+#include "ObjImporter.h"
+#include "Check.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace
+{
+	bool Import(const std::string& text, ObjMesh& mesh, WorkerPool* workers = nullptr)
+	{
+		ObjImporter importer;
+		return importer.Import(text.data(), text.size(), mesh, workers);
+	}
+
+	std::string ImportError(const std::string& text, WorkerPool* workers = nullptr)
+	{
+		ObjImporter importer;
+		ObjMesh mesh;
+		CHECK(!importer.Import(text.data(), text.size(), mesh, workers));
+		return importer.Error();
+	}
+
+	bool SameMesh(const ObjMesh& a, const ObjMesh& b)
+	{
+		if (a.Vertices.size() != b.Vertices.size() || a.Indices != b.Indices ||
+			a.Submeshes.size() != b.Submeshes.size() || a.HasNormals != b.HasNormals || a.HasTexCoords != b.HasTexCoords)
+			return false;
+		if (!a.Vertices.empty() && std::memcmp(a.Vertices.data(), b.Vertices.data(), a.Vertices.size() * sizeof(ObjVertex)) != 0)
+			return false;
+		for (std::size_t i = 0; i < a.Submeshes.size(); ++i)
+		{
+			const ObjSubmesh& x = a.Submeshes[i];
+			const ObjSubmesh& y = b.Submeshes[i];
+			if (x.Name != y.Name || x.IndexCount != y.IndexCount || x.StartIndexLocation != y.StartIndexLocation ||
+				std::memcmp(x.BoundsMin, y.BoundsMin, sizeof(x.BoundsMin)) != 0 ||
+				std::memcmp(x.BoundsMax, y.BoundsMax, sizeof(x.BoundsMax)) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	// A strip of vertexCount vertices at x = 0, 1, 2, ..., each followed (from the third
+	// on) by a triangle of it and the two before it in negative indices, split into
+	// groups of groupSize triangles named after their parity.  Large enough to be split
+	// into several chunks, so the negative indices right after a split point into the
+	// chunk before.
+	std::string MakeStrip(std::uint32_t vertexCount, std::uint32_t groupSize)
+	{
+		std::string text;
+		for (std::uint32_t i = 0; i < vertexCount; ++i)
+		{
+			text += "v " + std::to_string(i) + " 0 0\n";
+			if (i >= 2)
+			{
+				std::uint32_t triangle = i - 2;
+				if (triangle % groupSize == 0)
+					text += (triangle / groupSize) % 2 == 0 ? "g even\n" : "g odd\n";
+				text += "f -1 -2 -3\n";
+			}
+		}
+		return text;
+	}
+
+	void TestCorners()
+	{
+		const char* text =
+			"# comment\n"
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 0 1.5 0\n"
+			"v -1e1 0 2.5E-1\n"
+			"vt 0 0\n"
+			"vt 1 0\n"
+			"vt 0.25\n"
+			"vn 0 0 -1\n"
+			"f 1//1 2//1 3//1\n"
+			"f 1/1 2/2 3/3\n"
+			"f 1/1/1 2/2/1 3/3/1 4/1/1\n"
+			"s off\n"
+			"l 1 2\n";
+
+		ObjMesh mesh;
+		CHECK(Import(text, mesh));
+		CHECK(mesh.HasNormals && mesh.HasTexCoords);
+		CHECK(mesh.Submeshes.size() == 1);
+		CHECK(mesh.Submeshes[0].Name == "default");
+		CHECK(mesh.Indices.size() == 12);
+
+		// v//n and v/t corners of the same position are different vertices.
+		CHECK(mesh.Vertices.size() == 10);
+		const ObjVertex& normalOnly = mesh.Vertices[mesh.Indices[2]];
+		CHECK(normalOnly.Position[1] == 1.5f);
+		CHECK(normalOnly.Normal[2] == -1.0f);
+		CHECK(normalOnly.TexC[0] == 0.0f && normalOnly.TexC[1] == 0.0f);
+		const ObjVertex& texCoordOnly = mesh.Vertices[mesh.Indices[5]];
+		CHECK(texCoordOnly.Position[1] == 1.5f);
+		CHECK(texCoordOnly.Normal[0] == 0.0f && texCoordOnly.Normal[1] == 0.0f && texCoordOnly.Normal[2] == 0.0f);
+		// The missing v of a texture coordinate is 0.
+		CHECK(texCoordOnly.TexC[0] == 0.25f && texCoordOnly.TexC[1] == 0.0f);
+
+		// The quad is a fan around its first corner.
+		CHECK(mesh.Indices[6] == mesh.Indices[9]);
+		CHECK(mesh.Indices[8] == mesh.Indices[10]);
+		const ObjVertex& last = mesh.Vertices[mesh.Indices[11]];
+		CHECK(last.Position[0] == -10.0f && last.Position[2] == 0.25f);
+
+		CHECK(mesh.Submeshes[0].BoundsMin[0] == -10.0f);
+		CHECK(mesh.Submeshes[0].BoundsMax[1] == 1.5f);
+		CHECK(mesh.Fits16BitIndices());
+	}
+
+	void TestGroupMerging()
+	{
+		const char* text =
+			"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 0 5\n"
+			"f 1 2 3\n"
+			"g a\n"
+			"f 1 3 4\n"
+			"o b\n"
+			"usemtl b\n"
+			"f 2 3 4\n"
+			"usemtl a\n"
+			"f 1 2 5\n"
+			"g empty\n"
+			"o b\n"
+			"f 3 4 5\n";
+
+		ObjMesh mesh;
+		CHECK(Import(text, mesh));
+		CHECK(mesh.Submeshes.size() == 3);
+		CHECK(mesh.Indices.size() == 15);
+
+		// In order of first appearance; faces before the first group are "default" and
+		// groups without faces are dropped.
+		const ObjSubmesh& first = mesh.Submeshes[0];
+		CHECK(first.Name == "default" && first.StartIndexLocation == 0 && first.IndexCount == 3);
+		const ObjSubmesh& a = mesh.Submeshes[1];
+		CHECK(a.Name == "a" && a.StartIndexLocation == 3 && a.IndexCount == 6);
+		CHECK(a.BoundsMax[2] == 5.0f);
+		const ObjSubmesh& b = mesh.Submeshes[2];
+		CHECK(b.Name == "b" && b.StartIndexLocation == 9 && b.IndexCount == 6);
+		CHECK(b.BoundsMin[0] == 0.0f && b.BoundsMax[0] == 1.0f);
+
+		// Corners are shared across groups.
+		CHECK(mesh.Vertices.size() == 5);
+		CHECK(mesh.Indices[3] == mesh.Indices[0]);
+	}
+
+	void TestErrors()
+	{
+		CHECK(ImportError("v 0 0 0\nv 1 x 0\n") == "line 2: bad vertex position");
+		CHECK(ImportError("v 0 0 0\n\nvt x\n") == "line 3: bad texture coordinate");
+		CHECK(ImportError("v 0 0 0\nvn 0 1\n") == "line 2: bad vertex normal");
+		CHECK(ImportError("v 0 0 0\nv 1 0 0\nf 1 2\n") == "line 3: face with fewer than three corners");
+		CHECK(ImportError("v 0 0 0\nf 1 0 1\n") == "line 2: bad face index");
+		CHECK(ImportError("v 0 0 0\nf 1/x 1 1\n") == "line 2: bad face texture coordinate index");
+		CHECK(ImportError("v 0 0 0\nf 1//0 1 1\n") == "line 2: bad face normal index");
+		CHECK(ImportError("v 0 0 0\r\nf 1 1 1a\r\n") == "line 2: bad face");
+		CHECK(ImportError("v 0 0 0\ng top\nf 1 1 2\n") == "face index out of range in group top");
+		CHECK(ImportError("v 0 0 0\nf -2 1 1\n") == "face index out of range in group default");
+		CHECK(ImportError("v 0 0 0\nvt 0 0\nf 1/2 1/1 1/1\n") == "face index out of range in group default");
+
+		ObjMesh mesh;
+		CHECK(Import("", mesh));
+		CHECK(mesh.Indices.empty() && mesh.Submeshes.empty());
+	}
+
+	void TestChunks()
+	{
+		const std::uint32_t vertexCount = 200000;
+		std::string text = MakeStrip(vertexCount, 1000);
+		CHECK(text.size() > 4 * ObjImporter::MinChunkSize);
+
+		ObjImporter importer;
+		ObjMesh serial;
+		CHECK(importer.Import(text.data(), text.size(), serial));
+		CHECK(importer.Stats().ChunkCount == 1);
+		CHECK(importer.Stats().TriangleCount == vertexCount - 2);
+		CHECK(importer.Stats().VertexCount == vertexCount);
+		CHECK(importer.Stats().ByteSize == text.size());
+
+		WorkerPool workers(4);
+		ObjMesh pooled;
+		CHECK(importer.Import(text.data(), text.size(), pooled, &workers));
+		CHECK(importer.Stats().ChunkCount == 4);
+		CHECK(SameMesh(serial, pooled));
+
+		// Every triangle is its vertex and the two before it, wherever the chunks split.
+		CHECK(pooled.Submeshes.size() == 2);
+		CHECK(pooled.Submeshes[0].Name == "even" && pooled.Submeshes[1].Name == "odd");
+		bool strip = pooled.Indices.size() == (vertexCount - 2) * 3;
+		for (std::size_t s = 0; s < pooled.Submeshes.size() && strip; ++s)
+		{
+			const ObjSubmesh& submesh = pooled.Submeshes[s];
+			for (std::uint32_t i = 0; i < submesh.IndexCount; i += 3)
+			{
+				// Group g holds triangles 1000 g .. 1000 g + 999, even groups first.
+				std::uint32_t inSubmesh = i / 3;
+				std::uint32_t triangle = (inSubmesh / 1000 * 2 + (std::uint32_t)s) * 1000 + inSubmesh % 1000;
+				const std::uint32_t* corners = &pooled.Indices[submesh.StartIndexLocation + i];
+				strip = strip && pooled.Vertices[corners[0]].Position[0] == (float)(triangle + 2) &&
+					pooled.Vertices[corners[1]].Position[0] == (float)(triangle + 1) &&
+					pooled.Vertices[corners[2]].Position[0] == (float)triangle;
+			}
+		}
+		CHECK(strip);
+		CHECK(!pooled.Fits16BitIndices());
+
+		// Errors in later chunks report the line in the whole text.
+		std::size_t lineCount = std::count(text.begin(), text.end(), '\n');
+		text += "f 1 2\n";
+		CHECK(ImportError(text, &workers) == "line " + std::to_string(lineCount + 1) + ": face with fewer than three corners");
+	}
+}
+
+int main()
+{
+	TestCorners();
+	TestGroupMerging();
+	TestErrors();
+	TestChunks();
+	return Check::Finish("ObjImporterTests");
+}
@@ -0,0 +1,309 @@
+#include "OcclusionCuller.h"
+#include "WorkerPool.h"
+#include "Check.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Takes (x, y, z) in pixels and depth straight to clip space, so occluders and boxes
+	// can be placed on exact pixels.
+	XMMATRIX PixelSpace(std::uint32_t width, std::uint32_t height)
+	{
+		return XMMatrixSet(
+			2.0f / width, 0.0f, 0.0f, 0.0f,
+			0.0f, -2.0f / height, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			-1.0f, 1.0f, 0.0f, 1.0f);
+	}
+
+	struct Occluder
+	{
+		std::vector<XMFLOAT3> Positions;
+		std::vector<std::uint32_t> Indices;
+
+		void AddTriangle(float x0, float y0, float x1, float y1, float x2, float y2, float z)
+		{
+			std::uint32_t first = (std::uint32_t)Positions.size();
+			Positions.push_back(XMFLOAT3(x0, y0, z));
+			Positions.push_back(XMFLOAT3(x1, y1, z));
+			Positions.push_back(XMFLOAT3(x2, y2, z));
+			Indices.push_back(first);
+			Indices.push_back(first + 1);
+			Indices.push_back(first + 2);
+		}
+
+		void AddRect(float x0, float y0, float x1, float y1, float z)
+		{
+			AddTriangle(x0, y0, x1, y0, x0, y1, z);
+			AddTriangle(x1, y0, x1, y1, x0, y1, z);
+		}
+
+		void AddTo(OcclusionCuller& culler)const
+		{
+			culler.AddOccluder(&Positions[0].x, sizeof(XMFLOAT3), Indices.data(), Indices.size(),
+				PixelSpace(culler.Width(), culler.Height()));
+		}
+	};
+
+	// One character per pixel: '.' is cleared, a digit d is depth d / 8.
+	bool MatchesImage(const OcclusionCuller& culler, const char* const* rows)
+	{
+		const float* depth = culler.Level(0);
+		for (std::uint32_t y = 0; y < culler.Height(); ++y)
+		{
+			std::string row;
+			for (std::uint32_t x = 0; x < culler.Width(); ++x)
+			{
+				float z = depth[y * culler.Width() + x];
+				row += z == 1.0f ? '.' : (char)('0' + (int)(z * 8.0f + 0.5f));
+			}
+			if (row != rows[y])
+				return false;
+		}
+		return true;
+	}
+
+	BoundingBox PixelBox(float x0, float y0, float z0, float x1, float y1, float z1)
+	{
+		BoundingBox box;
+		box.Center = XMFLOAT3((x0 + x1) * 0.5f, (y0 + y1) * 0.5f, (z0 + z1) * 0.5f);
+		box.Extents = XMFLOAT3((x1 - x0) * 0.5f, (y1 - y0) * 0.5f, (z1 - z0) * 0.5f);
+		return box;
+	}
+
+	void TestReferenceImage()
+	{
+		OcclusionCuller culler(OcclusionCuller::TileWidth, OcclusionCuller::TileHeight);
+		culler.Clear();
+
+		// Pixels whose centers are covered, nearest depth wins whatever the order.
+		Occluder occluder;
+		occluder.AddTriangle(2, 2, 29, 2, 2, 13, 0.5f);
+		// Counterclockwise on screen, and reaching past the right edge.
+		occluder.AddTriangle(12, 0, 32, 11, 32, 0, 0.75f);
+		occluder.AddRect(18, 8, 28, 15, 0.25f);
+		occluder.AddTo(culler);
+		culler.Render();
+
+		const char* expected[] =
+		{
+			".............6666666666666666666",
+			"...............66666666666666666",
+			"..444444444444444444444444446666",
+			"..444444444444444444444446666666",
+			"..444444444444444444444666666666",
+			"..444444444444444444..6666666666",
+			"..4444444444444444......66666666",
+			"..44444444444444..........666666",
+			"..44444444444.....22222222226666",
+			"..444444444.......2222222222.666",
+			"..444444..........2222222222...6",
+			"..4444............2222222222....",
+			"..4...............2222222222....",
+			"..................2222222222....",
+			"..................2222222222....",
+			"................................",
+		};
+		CHECK(MatchesImage(culler, expected));
+		CHECK(culler.Stats().OccluderTriangles == 4);
+		CHECK(culler.Stats().RasterizedTriangles == 4);
+
+		// Clear starts over.
+		culler.Clear();
+		culler.Render();
+		CHECK(culler.Level(0)[0] == 1.0f && culler.Level(culler.LevelCount() - 1)[0] == 1.0f);
+	}
+
+	void TestDepthInterpolation()
+	{
+		const std::uint32_t width = 2 * OcclusionCuller::TileWidth;
+		const std::uint32_t height = 2 * OcclusionCuller::TileHeight;
+		OcclusionCuller culler(width, height);
+		culler.Clear();
+
+		// Depth grows from 0 at the left edge to 1 at the right one, across tiles.
+		Occluder occluder;
+		occluder.AddRect(0, 0, (float)width, (float)height, 0.0f);
+		occluder.Positions[1].z = occluder.Positions[3].z = occluder.Positions[4].z = 1.0f;
+		occluder.AddTo(culler);
+		culler.Render();
+
+		bool near = true;
+		for (std::uint32_t y = 0; y < height; ++y)
+		{
+			for (std::uint32_t x = 0; x < width; ++x)
+				near = near && std::fabs(culler.Level(0)[y * width + x] - (x + 0.5f) / width) < 1e-5f;
+		}
+		CHECK(near);
+	}
+
+	void TestDroppedTriangles()
+	{
+		OcclusionCuller culler(OcclusionCuller::TileWidth, OcclusionCuller::TileHeight);
+		culler.Clear();
+
+		Occluder occluder;
+		// Behind the near plane.
+		occluder.AddTriangle(0, 0, 32, 0, 0, 16, -0.5f);
+		// Degenerate.
+		occluder.AddTriangle(0, 0, 16, 8, 32, 16, 0.5f);
+		// Entirely off screen.
+		occluder.AddTriangle(40, 0, 60, 0, 40, 16, 0.5f);
+		// Too thin to cover a pixel center.
+		occluder.AddTriangle(4.1f, 4.1f, 4.4f, 4.1f, 4.1f, 4.4f, 0.5f);
+		occluder.AddTo(culler);
+		culler.Render();
+
+		CHECK(culler.Stats().OccluderTriangles == 4);
+		CHECK(culler.Stats().RasterizedTriangles == 0);
+		bool cleared = true;
+		for (std::uint32_t i = 0; i < culler.Width() * culler.Height(); ++i)
+			cleared = cleared && culler.Level(0)[i] == 1.0f;
+		CHECK(cleared);
+	}
+
+	void TestPyramid()
+	{
+		// 96 x 48 halves to odd sizes, which fold into the last texel.
+		OcclusionCuller culler(3 * OcclusionCuller::TileWidth, 3 * OcclusionCuller::TileHeight);
+		culler.Clear();
+
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> x(0.0f, (float)culler.Width());
+		std::uniform_real_distribution<float> y(0.0f, (float)culler.Height());
+		std::uniform_real_distribution<float> z(0.0f, 1.0f);
+		Occluder occluder;
+		for (int i = 0; i < 200; ++i)
+			occluder.AddTriangle(x(random), y(random), x(random), y(random), x(random), y(random), z(random));
+		occluder.AddTo(culler);
+		culler.Render();
+
+		CHECK(culler.LevelWidth(culler.LevelCount() - 1) == 1 && culler.LevelHeight(culler.LevelCount() - 1) == 1);
+
+		bool conservative = true;
+		for (std::uint32_t level = 1; level < culler.LevelCount(); ++level)
+		{
+			const std::uint32_t width = culler.LevelWidth(level);
+			const std::uint32_t height = culler.LevelHeight(level);
+			std::vector<float> expected(width * height, 0.0f);
+			for (std::uint32_t sy = 0; sy < culler.LevelHeight(level - 1); ++sy)
+			{
+				for (std::uint32_t sx = 0; sx < culler.LevelWidth(level - 1); ++sx)
+				{
+					float& texel = expected[std::min(sy / 2, height - 1) * width + std::min(sx / 2, width - 1)];
+					texel = std::max(texel, culler.Level(level - 1)[sy * culler.LevelWidth(level - 1) + sx]);
+				}
+			}
+			conservative = conservative && std::memcmp(expected.data(), culler.Level(level), expected.size() * sizeof(float)) == 0;
+		}
+		CHECK(conservative);
+	}
+
+	void TestWorkerPoolMatchesSerial()
+	{
+		const std::uint32_t width = 8 * OcclusionCuller::TileWidth;
+		const std::uint32_t height = 8 * OcclusionCuller::TileHeight;
+		OcclusionCuller serial(width, height);
+		OcclusionCuller pooled(width, height);
+
+		// Enough small triangles to be binned in several batches.
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> x(-8.0f, (float)width + 8.0f);
+		std::uniform_real_distribution<float> y(-8.0f, (float)height + 8.0f);
+		std::uniform_real_distribution<float> offset(-24.0f, 24.0f);
+		std::uniform_real_distribution<float> z(0.0f, 1.0f);
+		Occluder occluder;
+		for (int i = 0; i < 20000; ++i)
+		{
+			float cx = x(random), cy = y(random);
+			occluder.AddTriangle(cx, cy, cx + offset(random), cy + offset(random), cx + offset(random), cy + offset(random), z(random));
+		}
+
+		WorkerPool workers(4);
+		for (int frame = 0; frame < 3; ++frame)
+		{
+			serial.Clear();
+			occluder.AddTo(serial);
+			serial.Render();
+
+			pooled.Clear();
+			occluder.AddTo(pooled);
+			pooled.Render(&workers);
+		}
+
+		CHECK(serial.Stats().RasterizedTriangles == pooled.Stats().RasterizedTriangles);
+		CHECK(serial.Stats().RasterizedTriangles > 10000);
+		bool same = serial.LevelCount() == pooled.LevelCount();
+		for (std::uint32_t level = 0; same && level < serial.LevelCount(); ++level)
+		{
+			same = std::memcmp(serial.Level(level), pooled.Level(level),
+				serial.LevelWidth(level) * serial.LevelHeight(level) * sizeof(float)) == 0;
+		}
+		CHECK(same);
+	}
+
+	void TestIsOccluded()
+	{
+		const std::uint32_t width = 4 * OcclusionCuller::TileWidth;
+		const std::uint32_t height = 4 * OcclusionCuller::TileHeight;
+		const XMMATRIX viewProj = PixelSpace(width, height);
+		OcclusionCuller culler(width, height);
+		culler.Clear();
+
+		// A wall at depth 0.5 over the left half, with a hole at 32..40 x 32..40.
+		Occluder occluder;
+		occluder.AddRect(0, 0, 64, 32, 0.5f);
+		occluder.AddRect(0, 40, 64, 64, 0.5f);
+		occluder.AddRect(0, 32, 32, 40, 0.5f);
+		occluder.AddRect(40, 32, 64, 40, 0.5f);
+		occluder.AddTo(culler);
+		culler.Render();
+
+		// Behind the wall.
+		CHECK(culler.IsOccluded(PixelBox(4, 4, 0.6f, 20, 20, 0.9f), viewProj));
+		CHECK(culler.IsOccluded(PixelBox(2, 2, 0.6f, 62, 30, 0.9f), viewProj));
+		// Reaching in front of it.
+		CHECK(!culler.IsOccluded(PixelBox(4, 4, 0.4f, 20, 20, 0.9f), viewProj));
+		// Partly beside it.
+		CHECK(!culler.IsOccluded(PixelBox(56, 4, 0.6f, 72, 20, 0.9f), viewProj));
+		// Seen through the hole.
+		CHECK(!culler.IsOccluded(PixelBox(34, 34, 0.6f, 38, 38, 0.9f), viewProj));
+		// Partly off screen, and hidden where it is on screen.
+		CHECK(culler.IsOccluded(PixelBox(-20, 4, 0.6f, 20, 20, 0.9f), viewProj));
+		// Entirely off screen, or crossing the near plane.
+		CHECK(!culler.IsOccluded(PixelBox(-40, 4, 0.6f, -20, 20, 0.9f), viewProj));
+		CHECK(!culler.IsOccluded(PixelBox(4, 4, -0.1f, 20, 20, 0.9f), viewProj));
+
+		// Cull keeps the order of what is left and counts.
+		BoundingBox bounds[] =
+		{
+			PixelBox(4, 4, 0.6f, 20, 20, 0.9f),
+			PixelBox(34, 34, 0.6f, 38, 38, 0.9f),
+			PixelBox(4, 44, 0.6f, 20, 60, 0.9f),
+			PixelBox(100, 4, 0.6f, 120, 20, 0.9f),
+			PixelBox(4, 4, 0.1f, 20, 20, 0.2f),
+		};
+		std::vector<std::uint32_t> indices = { 4, 3, 2, 1, 0 };
+		culler.Cull(bounds, indices, viewProj);
+		CHECK(indices.size() == 3 && indices[0] == 4 && indices[1] == 3 && indices[2] == 1);
+		CHECK(culler.Stats().Tested == 5);
+		CHECK(culler.Stats().Occluded == 2);
+	}
+}
+
+int main()
+{
+	TestReferenceImage();
+	TestDepthInterpolation();
+	TestDroppedTriangles();
+	TestPyramid();
+	TestWorkerPoolMatchesSerial();
+	TestIsOccluded();
+	return Check::Finish("OcclusionCullerTests");
+}
@@ -0,0 +1,213 @@
+#include "RenderGraph.h"
+#include "Check.h"
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	// The D3D12_RESOURCE_STATES values the tests use.
+	const RenderGraph::State Present = 0;
+	const RenderGraph::State RenderTarget = 0x4;
+	const RenderGraph::State UnorderedAccess = 0x8;
+	const RenderGraph::State DepthWrite = 0x10;
+	const RenderGraph::State NonPixelShaderResource = 0x40;
+	const RenderGraph::State PixelShaderResource = 0x80;
+	const RenderGraph::State GenericRead = 0xac3;
+
+	RenderGraph MakeGraph()
+	{
+		return RenderGraph(GenericRead | NonPixelShaderResource | PixelShaderResource, UnorderedAccess);
+	}
+
+	// A deferred frame: the debug view writes a transient nobody reads, Albedo's memory is
+	// reused by Bloom, Hdr is read by two passes in a row and Bloom is written twice as a
+	// UAV.
+	void DeclareDeferredFrame(RenderGraph& graph, std::uint64_t bloomBytes)
+	{
+		RenderGraph::TransientDesc target;
+		target.ByteSize = 4 << 20;
+		target.Alignment = 64 * 1024;
+		RenderGraph::TransientDesc bloomDesc;
+		bloomDesc.ByteSize = bloomBytes;
+		bloomDesc.Alignment = 64 * 1024;
+
+		auto backBuffer = graph.Import("BackBuffer", Present, Present);
+		auto depth = graph.Import("Depth", DepthWrite);
+		auto albedo = graph.CreateTransient("Albedo", target);
+		auto normals = graph.CreateTransient("Normals", target);
+		auto hdr = graph.CreateTransient("Hdr", target);
+		auto bloom = graph.CreateTransient("Bloom", bloomDesc);
+		auto debug = graph.CreateTransient("Debug", bloomDesc);
+
+		auto gbuffer = graph.AddPass("GBuffer");
+		graph.Write(gbuffer, albedo, RenderTarget);
+		graph.Write(gbuffer, normals, RenderTarget);
+		graph.Write(gbuffer, depth, DepthWrite);
+
+		auto lighting = graph.AddPass("Lighting");
+		graph.Read(lighting, albedo, PixelShaderResource);
+		graph.Read(lighting, normals, PixelShaderResource);
+		graph.Write(lighting, hdr, RenderTarget);
+
+		auto debugView = graph.AddPass("DebugView");
+		graph.Read(debugView, normals, PixelShaderResource);
+		graph.Write(debugView, debug, RenderTarget);
+
+		auto bloomDown = graph.AddPass("BloomDown");
+		graph.Read(bloomDown, hdr, NonPixelShaderResource);
+		graph.Write(bloomDown, bloom, UnorderedAccess);
+
+		auto bloomBlur = graph.AddPass("BloomBlur");
+		graph.Write(bloomBlur, bloom, UnorderedAccess);
+
+		auto tonemap = graph.AddPass("Tonemap");
+		graph.Read(tonemap, hdr, PixelShaderResource);
+		graph.Read(tonemap, bloom, PixelShaderResource);
+		graph.Write(tonemap, backBuffer, RenderTarget);
+	}
+
+	const char* DeferredFrameGolden =
+		"culled DebugView\n"
+		"pass GBuffer\n"
+		"  aliasing * -> Albedo\n"
+		"  transition Albedo undefined -> 0x4\n"
+		"  transition Normals undefined -> 0x4\n"
+		"pass Lighting\n"
+		"  transition Albedo 0x4 -> 0x80\n"
+		"  transition Normals 0x4 -> 0x80\n"
+		"  transition Hdr undefined -> 0x4\n"
+		"pass BloomDown\n"
+		"  transition Hdr 0x4 -> 0xc0\n"
+		"  aliasing Albedo -> Bloom\n"
+		"  transition Bloom undefined -> 0x8\n"
+		"pass BloomBlur\n"
+		"  uav Bloom\n"
+		"pass Tonemap\n"
+		"  transition Bloom 0x8 -> 0x80\n"
+		"  transition BackBuffer 0x0 -> 0x4\n"
+		"final\n"
+		"  transition BackBuffer 0x4 -> 0x0\n"
+		"transient Albedo offset 0 size 4194304 passes 0-1\n"
+		"transient Normals offset 4194304 size 4194304 passes 0-1\n"
+		"transient Hdr offset 8388608 size 4194304 passes 1-4\n"
+		"transient Bloom offset 0 size 1048576 passes 2-4\n"
+		"transient bytes 12582912\n";
+
+	void CheckGolden(const std::string& actual, const char* expected)
+	{
+		CHECK(actual == expected);
+		if (actual != expected)
+			std::printf("expected:\n%s\nactual:\n%s\n", expected, actual.c_str());
+	}
+
+	void TestDeferredFrame()
+	{
+		RenderGraph graph = MakeGraph();
+		DeclareDeferredFrame(graph, 1 << 20);
+		CHECK(graph.Compile());
+		CheckGolden(graph.Describe(), DeferredFrameGolden);
+
+		CHECK(graph.IsCulled(2));
+		CHECK(graph.TransientByteSize() == 12 << 20);
+		CHECK(graph.GetPlacement(5).Aliased);
+		CHECK(graph.GetPlacement(5).AliasBefore == 2);
+	}
+
+	void TestRecompileOnlyOnChange()
+	{
+		RenderGraph graph = MakeGraph();
+		DeclareDeferredFrame(graph, 1 << 20);
+		CHECK(graph.Compile());
+
+		// The same frame declared again keeps the compiled result.
+		graph.Reset();
+		DeclareDeferredFrame(graph, 1 << 20);
+		CHECK(!graph.Compile());
+		CHECK(graph.CompileCount() == 1);
+		CheckGolden(graph.Describe(), DeferredFrameGolden);
+
+		// A different size is a different topology.
+		graph.Reset();
+		DeclareDeferredFrame(graph, 2 << 20);
+		CHECK(graph.Compile());
+		CHECK(graph.CompileCount() == 2);
+		CHECK(graph.GetPlacement(5).ByteSize == 2 << 20);
+	}
+
+	void TestCullingChain()
+	{
+		RenderGraph graph = MakeGraph();
+		RenderGraph::TransientDesc desc;
+		desc.ByteSize = 256;
+
+		auto backBuffer = graph.Import("BackBuffer", Present, Present);
+		auto a = graph.CreateTransient("A", desc);
+		auto b = graph.CreateTransient("B", desc);
+
+		// Producer -> Consumer -> nothing: both go.  The side-effect pass stays even though
+		// it writes nothing the graph reads.
+		auto producer = graph.AddPass("Producer");
+		graph.Write(producer, a, RenderTarget);
+		auto consumer = graph.AddPass("Consumer");
+		graph.Read(consumer, a, PixelShaderResource);
+		graph.Write(consumer, b, RenderTarget);
+		auto readback = graph.AddPass("Readback", true);
+		graph.Read(readback, backBuffer, PixelShaderResource);
+
+		graph.Compile();
+		CheckGolden(graph.Describe(),
+			"culled Producer\n"
+			"culled Consumer\n"
+			"pass Readback\n"
+			"  transition BackBuffer 0x0 -> 0x80\n"
+			"final\n"
+			"  transition BackBuffer 0x80 -> 0x0\n"
+			"transient bytes 0\n");
+	}
+
+	void TestCullingKeepsSharedProducer()
+	{
+		RenderGraph graph = MakeGraph();
+		RenderGraph::TransientDesc desc;
+		desc.ByteSize = 256;
+
+		auto backBuffer = graph.Import("BackBuffer", Present, Present);
+		auto t1 = graph.CreateTransient("T1", desc);
+		auto t2 = graph.CreateTransient("T2", desc);
+
+		// B is the last reader of T1 and goes, but A stays for T2, which C still reads.
+		auto a = graph.AddPass("A");
+		graph.Write(a, t1, RenderTarget);
+		graph.Write(a, t2, RenderTarget);
+		auto b = graph.AddPass("B");
+		graph.Read(b, t1, PixelShaderResource);
+		auto c = graph.AddPass("C");
+		graph.Read(c, t2, PixelShaderResource);
+		graph.Write(c, backBuffer, RenderTarget);
+
+		graph.Compile();
+		CheckGolden(graph.Describe(),
+			"culled B\n"
+			"pass A\n"
+			"  transition T1 undefined -> 0x4\n"
+			"  transition T2 undefined -> 0x4\n"
+			"pass C\n"
+			"  transition T2 0x4 -> 0x80\n"
+			"  transition BackBuffer 0x0 -> 0x4\n"
+			"final\n"
+			"  transition BackBuffer 0x4 -> 0x0\n"
+			"transient T1 offset 0 size 256 passes 0-0\n"
+			"transient T2 offset 256 size 256 passes 0-1\n"
+			"transient bytes 512\n");
+		CHECK(!graph.IsCulled(a) && graph.IsCulled(b) && !graph.IsCulled(c));
+	}
+}
+
+int main()
+{
+	TestDeferredFrame();
+	TestRecompileOnlyOnChange();
+	TestCullingChain();
+	TestCullingKeepsSharedProducer();
+	return Check::Finish("RenderGraphTests");
+}
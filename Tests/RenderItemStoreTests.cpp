@@ -0,0 +1,154 @@
+#include "RenderItemStore.h"
+#include "Check.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	XMFLOAT4X4 Translation(float x)
+	{
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, XMMatrixTranslation(x, 0.0f, 0.0f));
+		return world;
+	}
+
+	BoundingBox BoxAt(float x)
+	{
+		return BoundingBox(XMFLOAT3(x, 0.0f, 0.0f), XMFLOAT3(0.5f, 0.5f, 0.5f));
+	}
+
+	// Keeps x >= 0.
+	void PositiveX(float planes[6][4])
+	{
+		const float halfSpace[6][4] =
+		{
+			{ 1, 0, 0, 0 }, { -1, 0, 0, 1e6f }, { 0, 1, 0, 1e6f },
+			{ 0, -1, 0, 1e6f }, { 0, 0, 1, 1e6f }, { 0, 0, -1, 1e6f }
+		};
+		std::copy(&halfSpace[0][0], &halfSpace[0][0] + 24, &planes[0][0]);
+	}
+
+	void TestCreateDestroy()
+	{
+		RenderItemStore store;
+		RenderItemHandle a = store.Create(1, 10, 100, 1000, Translation(1.0f), BoxAt(1.0f));
+		RenderItemHandle b = store.Create(2, 20, 200, 2000, Translation(2.0f), BoxAt(2.0f));
+		RenderItemHandle c = store.Create(3, 30, 300, 3000, Translation(3.0f), BoxAt(3.0f));
+		CHECK(store.Size() == 3);
+		CHECK(store.IndexOf(a) == 0 && store.IndexOf(b) == 1 && store.IndexOf(c) == 2);
+		CHECK(store.HandleAt(1) == b);
+
+		// c moves into a's position with every component.
+		store.Destroy(a);
+		CHECK(!store.IsValid(a));
+		CHECK(store.IsValid(b) && store.IsValid(c));
+		CHECK(store.Size() == 2);
+		CHECK(store.IndexOf(c) == 0);
+		CHECK(store.HandleAt(0) == c);
+		CHECK(store.Geometries()[0] == 3 && store.Submeshes()[0] == 30);
+		CHECK(store.Pipelines()[0] == 300 && store.Materials()[0] == 3000);
+		CHECK(store.Worlds()[0](3, 0) == 3.0f && store.Bounds()[0].Center.x == 3.0f);
+
+		// The freed slot is reused with a new generation, so the old handle stays dead.
+		RenderItemHandle d = store.Create(4, 40, 400, 4000, Translation(4.0f), BoxAt(4.0f));
+		CHECK(d.Slot == a.Slot);
+		CHECK(d != a);
+		CHECK(!store.IsValid(a));
+		CHECK(store.IsValid(d) && store.IndexOf(d) == 2);
+
+		store.SetMaterial(d, 4001);
+		store.SetWorld(b, Translation(-2.0f), BoxAt(-2.0f));
+		CHECK(store.Materials()[2] == 4001);
+		CHECK(store.Worlds()[store.IndexOf(b)](3, 0) == -2.0f);
+		CHECK(store.Bounds()[store.IndexOf(b)].Center.x == -2.0f);
+
+		// The last item destroys without moving anything.
+		store.Destroy(d);
+		CHECK(store.Size() == 2 && store.IndexOf(c) == 0 && store.IndexOf(b) == 1);
+	}
+
+	void TestClear()
+	{
+		RenderItemStore store;
+		std::vector<RenderItemHandle> handles;
+		for (int i = 0; i < 5; ++i)
+			handles.push_back(store.Create(i, 0, 0, 0, Translation((float)i), BoxAt((float)i)));
+		store.Clear();
+		CHECK(store.Size() == 0);
+		CHECK(store.Culler().Size() == 0);
+
+		bool allInvalid = true;
+		for (RenderItemHandle handle : handles)
+			allInvalid = allInvalid && !store.IsValid(handle);
+		CHECK(allInvalid);
+
+		RenderItemHandle again = store.Create(9, 0, 0, 0, Translation(9.0f), BoxAt(9.0f));
+		CHECK(store.IsValid(again) && store.IndexOf(again) == 0);
+		CHECK(store.Culler().Size() == 1);
+	}
+
+	void TestCullerFollowsItems()
+	{
+		// Random creates, destroys and moves; after each the culler must return exactly
+		// the positions of the items on the positive side, with no syncing by the caller.
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+
+		RenderItemStore store;
+		std::vector<RenderItemHandle> live;
+		float planes[6][4];
+		PositiveX(planes);
+
+		bool matches = true;
+		for (int step = 0; step < 2000; ++step)
+		{
+			std::uint32_t action = random() % 4;
+			if (action <= 1 || live.empty())
+			{
+				float x = position(random);
+				live.push_back(store.Create(0, 0, 0, 0, Translation(x), BoxAt(x)));
+			}
+			else if (action == 2)
+			{
+				std::size_t i = random() % live.size();
+				store.Destroy(live[i]);
+				live[i] = live.back();
+				live.pop_back();
+			}
+			else
+			{
+				float x = position(random);
+				store.SetWorld(live[random() % live.size()], Translation(x), BoxAt(x));
+			}
+
+			std::vector<std::uint32_t> expected;
+			for (std::uint32_t i = 0; i < store.Size(); ++i)
+			{
+				if (store.Bounds()[i].Center.x + store.Bounds()[i].Extents.x >= 0.0f)
+					expected.push_back(i);
+			}
+
+			std::vector<std::uint32_t> visible;
+			store.Culler().Cull(planes, visible);
+			matches = matches && store.Culler().Size() == store.Size() && visible == expected;
+		}
+		CHECK(matches);
+
+		bool handlesValid = true;
+		for (RenderItemHandle handle : live)
+			handlesValid = handlesValid && store.IsValid(handle) && store.HandleAt(store.IndexOf(handle)) == handle;
+		CHECK(handlesValid);
+		CHECK(store.Size() == live.size());
+	}
+}
+
+int main()
+{
+	TestCreateDestroy();
+	TestClear();
+	TestCullerFollowsItems();
+	return Check::Finish("RenderItemStoreTests");
+}
@@ -0,0 +1,190 @@
+#include "ResourceStateTracker.h"
+#include "Check.h"
+#include <vector>
+
+namespace
+{
+	// The D3D12_RESOURCE_STATES values the tests use.
+	const ResourceStateTracker::State Common = 0;
+	const ResourceStateTracker::State VertexBuffer = 0x1;
+	const ResourceStateTracker::State IndexBuffer = 0x2;
+	const ResourceStateTracker::State RenderTarget = 0x4;
+	const ResourceStateTracker::State UnorderedAccess = 0x8;
+	const ResourceStateTracker::State PixelShaderResource = 0x80;
+	const ResourceStateTracker::State CopyDest = 0x400;
+	const ResourceStateTracker::State CopySource = 0x800;
+	const ResourceStateTracker::State GenericRead = 0xac3;
+	const ResourceStateTracker::State ReadOnly = VertexBuffer | IndexBuffer | PixelShaderResource | CopySource | GenericRead;
+
+	typedef ResourceStateTracker::Barrier Barrier;
+	typedef ResourceStateTracker::BarrierType BarrierType;
+
+	// Records what Flush hands over, one vector per call.
+	struct RecordingSink
+	{
+		std::vector<std::vector<Barrier>> Batches;
+
+		void operator()(const Barrier* barriers, std::size_t count)
+		{
+			Batches.emplace_back(barriers, barriers + count);
+		}
+	};
+
+	bool IsTransition(const Barrier& barrier, const void* resource, std::uint32_t subresource,
+		ResourceStateTracker::State before, ResourceStateTracker::State after)
+	{
+		return barrier.Type == BarrierType::Transition && barrier.Resource == resource &&
+			barrier.Subresource == subresource && barrier.Before == before && barrier.After == after;
+	}
+
+	void TestRedundantAndFolded()
+	{
+		ResourceStateTracker tracker(ReadOnly, UnorderedAccess);
+		int texture = 0;
+		tracker.Register(&texture, Common);
+
+		tracker.Transition(&texture, Common);
+		CHECK(!tracker.HasPendingBarriers());
+
+		// Common -> CopyDest -> PixelShaderResource folds into one transition.
+		tracker.Transition(&texture, CopyDest);
+		tracker.Transition(&texture, PixelShaderResource);
+		RecordingSink sink;
+		tracker.Flush(sink);
+		CHECK(sink.Batches.size() == 1);
+		CHECK(sink.Batches[0].size() == 1);
+		CHECK(IsTransition(sink.Batches[0][0], &texture, ResourceStateTracker::AllSubresources, Common, PixelShaderResource));
+		CHECK(tracker.GetState(&texture) == PixelShaderResource);
+
+		// A transition undone before the flush disappears, and an empty flush calls nothing.
+		tracker.Transition(&texture, RenderTarget);
+		tracker.Transition(&texture, PixelShaderResource);
+		CHECK(!tracker.HasPendingBarriers());
+		tracker.Flush(sink);
+		CHECK(sink.Batches.size() == 1);
+	}
+
+	void TestCombinedReadState()
+	{
+		ResourceStateTracker tracker(ReadOnly, UnorderedAccess);
+		int buffer = 0;
+		tracker.Register(&buffer, GenericRead);
+
+		// Every read state GenericRead contains is already satisfied.
+		tracker.Transition(&buffer, VertexBuffer);
+		tracker.Transition(&buffer, IndexBuffer);
+		CHECK(!tracker.HasPendingBarriers());
+		CHECK(tracker.GetState(&buffer) == GenericRead);
+
+		tracker.Transition(&buffer, CopyDest);
+		CHECK(tracker.PendingBarriers().size() == 1);
+		CHECK(IsTransition(tracker.PendingBarriers()[0], &buffer, ResourceStateTracker::AllSubresources, GenericRead, CopyDest));
+	}
+
+	void TestSubresources()
+	{
+		ResourceStateTracker tracker(ReadOnly, UnorderedAccess);
+		int texture = 0;
+		tracker.Register(&texture, Common, 3);
+
+		tracker.Transition(&texture, CopyDest, 1);
+		CHECK(tracker.GetState(&texture, 0) == Common);
+		CHECK(tracker.GetState(&texture, 1) == CopyDest);
+
+		// Bringing the whole resource over only moves the subresources that differ.
+		RecordingSink sink;
+		tracker.Flush(sink);
+		tracker.Transition(&texture, PixelShaderResource);
+		tracker.Flush(sink);
+		CHECK(sink.Batches.size() == 2);
+		const std::vector<Barrier>& batch = sink.Batches[1];
+		CHECK(batch.size() == 3);
+		CHECK(batch.size() == 3 && IsTransition(batch[0], &texture, 0, Common, PixelShaderResource));
+		CHECK(batch.size() == 3 && IsTransition(batch[1], &texture, 1, CopyDest, PixelShaderResource));
+		CHECK(batch.size() == 3 && IsTransition(batch[2], &texture, 2, Common, PixelShaderResource));
+
+		// Subresources that agree again are tracked as a whole.
+		tracker.Transition(&texture, RenderTarget, 0);
+		tracker.Transition(&texture, RenderTarget, 1);
+		tracker.Transition(&texture, RenderTarget, 2);
+		tracker.Flush(sink);
+		tracker.Transition(&texture, RenderTarget);
+		CHECK(!tracker.HasPendingBarriers());
+		CHECK(tracker.GetState(&texture, 2) == RenderTarget);
+	}
+
+	void TestUavAndAliasing()
+	{
+		ResourceStateTracker tracker(ReadOnly, UnorderedAccess);
+		int first = 0;
+		int second = 0;
+		tracker.Register(&first, Common);
+		tracker.Register(&second, Common);
+
+		// The transition into the UAV state orders the accesses already.
+		tracker.Transition(&first, UnorderedAccess);
+		tracker.UavBarrier(&first);
+		CHECK(tracker.PendingBarriers().size() == 1);
+
+		RecordingSink sink;
+		tracker.Flush(sink);
+		tracker.UavBarrier(&first);
+		tracker.UavBarrier(&first);
+		tracker.AliasingBarrier(&first, &second);
+		tracker.Flush(sink);
+		CHECK(sink.Batches.size() == 2);
+		const std::vector<Barrier>& batch = sink.Batches[1];
+		CHECK(batch.size() == 2);
+		CHECK(batch.size() == 2 && batch[0].Type == BarrierType::Uav && batch[0].Resource == &first);
+		CHECK(batch.size() == 2 && batch[1].Type == BarrierType::Aliasing && batch[1].Resource == &second &&
+			batch[1].AliasBefore == &first);
+	}
+
+	void TestUnregister()
+	{
+		ResourceStateTracker tracker(ReadOnly, UnorderedAccess);
+		int kept = 0;
+		int dropped = 0;
+		tracker.Register(&kept, Common);
+		tracker.Register(&dropped, Common);
+
+		tracker.Transition(&dropped, CopyDest);
+		tracker.Transition(&kept, CopyDest);
+		tracker.Unregister(&dropped);
+		CHECK(!tracker.IsRegistered(&dropped));
+		CHECK(tracker.PendingBarriers().size() == 1);
+		CHECK(tracker.PendingBarriers()[0].Resource == &kept);
+	}
+
+	void TestSetState()
+	{
+		ResourceStateTracker tracker(ReadOnly, UnorderedAccess);
+		int texture = 0;
+		tracker.Register(&texture, Common, 2);
+		tracker.Transition(&texture, CopyDest, 1);
+		RecordingSink sink;
+		tracker.Flush(sink);
+
+		// An upload list moved it on; the tracker follows without a barrier of its own.
+		tracker.SetState(&texture, PixelShaderResource);
+		CHECK(!tracker.HasPendingBarriers());
+		CHECK(tracker.GetState(&texture, 0) == PixelShaderResource);
+		CHECK(tracker.GetState(&texture, 1) == PixelShaderResource);
+
+		tracker.Transition(&texture, RenderTarget);
+		CHECK(tracker.PendingBarriers().size() == 1);
+		CHECK(IsTransition(tracker.PendingBarriers()[0], &texture, ResourceStateTracker::AllSubresources,
+			PixelShaderResource, RenderTarget));
+	}
+}
+
+int main()
+{
+	TestRedundantAndFolded();
+	TestCombinedReadState();
+	TestSubresources();
+	TestUavAndAliasing();
+	TestUnregister();
+	TestSetState();
+	return Check::Finish("ResourceStateTrackerTests");
+}
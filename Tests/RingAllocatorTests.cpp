@@ -0,0 +1,164 @@
+#include "RingAllocator.h"
+#include "Check.h"
+
+namespace
+{
+	void TestAlignment()
+	{
+		RingAllocator ring(1024);
+
+		CHECK(ring.Allocate(3) == 0);
+		CHECK(ring.Allocate(16, 16) == 16);
+		CHECK(ring.Allocate(1, 256) == 256);
+		CHECK(ring.Head() == 257);
+		// Alignment padding counts as used.
+		CHECK(ring.UsedSize() == 257);
+
+		CHECK(RingAllocator::AlignUp(0, 256) == 0);
+		CHECK(RingAllocator::AlignUp(1, 256) == 256);
+		CHECK(RingAllocator::AlignUp(256, 256) == 256);
+
+		CHECK(ring.Allocate(0) == RingAllocator::InvalidOffset);
+		CHECK(ring.Allocate(1025) == RingAllocator::InvalidOffset);
+	}
+
+	void TestFullRing()
+	{
+		RingAllocator ring(256);
+
+		CHECK(ring.Allocate(128) == 0);
+		CHECK(ring.Allocate(128) == 128);
+		CHECK(ring.IsFull());
+		CHECK(ring.FreeSize() == 0);
+		CHECK(ring.Allocate(1) == RingAllocator::InvalidOffset);
+
+		ring.FinishSubmission(1);
+		CHECK(ring.OldestPendingFence() == 1);
+		ring.ReleaseCompleted(0);
+		CHECK(ring.IsFull());
+
+		ring.ReleaseCompleted(1);
+		CHECK(ring.IsEmpty());
+		CHECK(ring.OldestPendingFence() == 0);
+
+		// An empty ring starts over at 0, so the whole capacity is available again.
+		CHECK(ring.Allocate(256) == 0);
+	}
+
+	void TestWrapWithPadding()
+	{
+		RingAllocator ring(1000);
+
+		CHECK(ring.Allocate(400) == 0);
+		ring.FinishSubmission(1);
+		CHECK(ring.Allocate(400) == 400);
+		ring.FinishSubmission(2);
+		ring.ReleaseCompleted(1);
+		CHECK(ring.Tail() == 400);
+		CHECK(ring.UsedSize() == 400);
+
+		// 300 bytes do not fit in [800, 1000), so the block wraps to 0 and the skipped
+		// 200 bytes stay used until the block is released.
+		CHECK(ring.Allocate(300) == 0);
+		CHECK(ring.Head() == 300);
+		CHECK(ring.UsedSize() == 400 + 200 + 300);
+		ring.FinishSubmission(3);
+
+		// Only [300, 400) is free now.
+		CHECK(ring.Allocate(101) == RingAllocator::InvalidOffset);
+		CHECK(ring.Allocate(64, 64) == 320);
+		ring.FinishSubmission(4);
+
+		// The skipped tail belongs to the block that wrapped, not to the one before it.
+		ring.ReleaseCompleted(2);
+		CHECK(ring.Tail() == 800);
+		CHECK(ring.UsedSize() == 200 + 300 + 84);
+
+		ring.ReleaseCompleted(3);
+		CHECK(ring.Tail() == 300);
+		CHECK(ring.UsedSize() == 84);
+
+		ring.ReleaseCompleted(4);
+		CHECK(ring.IsEmpty());
+	}
+
+	void TestWrapTooLarge()
+	{
+		RingAllocator ring(1000);
+
+		CHECK(ring.Allocate(600) == 0);
+		ring.FinishSubmission(1);
+		CHECK(ring.Allocate(200) == 600);
+		ring.FinishSubmission(2);
+		ring.ReleaseCompleted(1);
+
+		// Neither [800, 1000) nor [0, 600) holds 700 bytes; nothing may change.
+		CHECK(ring.Allocate(700) == RingAllocator::InvalidOffset);
+		CHECK(ring.Head() == 800);
+		CHECK(ring.UsedSize() == 200);
+	}
+
+	void TestRetireInOrder()
+	{
+		RingAllocator ring(300);
+
+		CHECK(ring.Allocate(100) == 0);
+		ring.FinishSubmission(5);
+		CHECK(ring.Allocate(100) == 100);
+		ring.FinishSubmission(6);
+		CHECK(ring.Allocate(100) == 200);
+		ring.FinishSubmission(8);
+		CHECK(ring.IsFull());
+
+		// Nothing is freed for a fence older than every submission.
+		ring.ReleaseCompleted(4);
+		CHECK(ring.UsedSize() == 300);
+
+		// Submissions retire oldest first: a completed value frees every older
+		// submission and none after it.
+		ring.ReleaseCompleted(7);
+		CHECK(ring.UsedSize() == 100);
+		CHECK(ring.Tail() == 200);
+		CHECK(ring.OldestPendingFence() == 8);
+
+		// A completed value that went backwards frees nothing more.
+		ring.ReleaseCompleted(6);
+		CHECK(ring.UsedSize() == 100);
+
+		// Finishing a submission with nothing allocated adds nothing to retire.
+		ring.FinishSubmission(9);
+		CHECK(ring.OldestPendingFence() == 8);
+		ring.ReleaseCompleted(8);
+		CHECK(ring.IsEmpty());
+		CHECK(ring.OldestPendingFence() == 0);
+	}
+
+	void TestOpenAllocationsAreNotReleased()
+	{
+		RingAllocator ring(256);
+
+		CHECK(ring.Allocate(64) == 0);
+		ring.FinishSubmission(1);
+		CHECK(ring.Allocate(64) == 64);
+
+		// The second block has no fence yet, so only the first one goes.
+		ring.ReleaseCompleted(100);
+		CHECK(ring.UsedSize() == 64);
+		CHECK(ring.Tail() == 64);
+
+		ring.FinishSubmission(2);
+		ring.ReleaseCompleted(2);
+		CHECK(ring.IsEmpty());
+	}
+}
+
+int main()
+{
+	TestAlignment();
+	TestFullRing();
+	TestWrapWithPadding();
+	TestWrapTooLarge();
+	TestRetireInOrder();
+	TestOpenAllocationsAreNotReleased();
+	return Check::Finish("RingAllocatorTests");
+}
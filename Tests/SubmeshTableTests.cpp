@@ -0,0 +1,142 @@
+#include "SubmeshTable.h"
+#include "Check.h"
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	BoundingBox Box(float x, float extent)
+	{
+		return BoundingBox(XMFLOAT3(x, 0.0f, 0.0f), XMFLOAT3(extent, extent, extent));
+	}
+
+	void TestAddAndFind()
+	{
+		SubmeshTable table;
+		table.Reserve(4);
+		SubmeshHandle box = table.Add("box", 36, 0, 0, Box(1.0f, 0.5f));
+		SubmeshHandle grid = table.Add("grid", 600, 36, 24);
+		SubmeshHandle sphere = table.Add("sphere", 1200, 636, 145, Box(-2.0f, 1.0f));
+
+		CHECK(table.Size() == 3);
+		CHECK(box == 0 && grid == 1 && sphere == 2);
+		CHECK(table.Find("box") == box);
+		CHECK(table.Find("grid") == grid);
+		CHECK(table.Find("sphere") == sphere);
+		CHECK(table.Find("cylinder") == SubmeshTable::InvalidHandle);
+		CHECK(table.Find("") == SubmeshTable::InvalidHandle);
+		CHECK(table.IsValid(sphere));
+		CHECK(!table.IsValid(3));
+
+		CHECK(table.IndexCount(grid) == 600);
+		CHECK(table.StartIndexLocation(grid) == 36);
+		CHECK(table.BaseVertexLocation(grid) == 24);
+		CHECK(table.Name(sphere) == "sphere");
+		CHECK(table.LodCount(sphere) == 0);
+		CHECK(table.SelectLod(sphere, 1000.0f) == sphere);
+
+		// The columns hold the same values as the accessors.
+		CHECK(table.IndexCounts()[sphere] == 1200);
+		CHECK(table.StartIndexLocations()[sphere] == 636);
+		CHECK(table.BaseVertexLocations()[sphere] == 145);
+		CHECK(table.AllBounds()[sphere].Center.x == -2.0f);
+
+		// The sphere and oriented box are derived from the box.
+		CHECK_NEAR(table.Sphere(box).Center.x, 1.0f, 0.0f);
+		CHECK_NEAR(table.Sphere(box).Radius, std::sqrt(0.75f), 1e-6f);
+		CHECK(table.OrientedBox(box).Extents.y == 0.5f);
+		CHECK(table.OrientedBox(box).Orientation.w == 1.0f);
+
+		table.Clear();
+		CHECK(table.Size() == 0);
+		CHECK(table.Find("box") == SubmeshTable::InvalidHandle);
+		CHECK(table.Add("box", 6, 0, 0) == 0);
+	}
+
+	void TestLodChains()
+	{
+		SubmeshTable table;
+		SubmeshHandle rock = table.Add("rock", 3000, 0, 10, Box(5.0f, 2.0f));
+		SubmeshHandle tree = table.Add("tree", 900, 3000, 500);
+
+		// Each chain is added in one go, finest first; the chains follow each other.
+		SubmeshHandle rock1 = table.AddLod(rock, 1500, 3900, 0.01f);
+		SubmeshHandle rock2 = table.AddLod(rock, 700, 5400, 0.05f);
+		SubmeshHandle rock3 = table.AddLod(rock, 300, 6100, 0.2f);
+		SubmeshHandle tree1 = table.AddLod(tree, 400, 6400, 0.1f);
+
+		CHECK(rock1 == 2 && rock2 == 3 && rock3 == 4 && tree1 == 5);
+		CHECK(table.LodCount(rock) == 3);
+		CHECK(table.LodCount(tree) == 1);
+		CHECK(table.LodCount(rock2) == 0);
+		CHECK(table.LodError(rock) == 0.0f);
+		CHECK(table.LodError(rock2) == 0.05f);
+
+		// LODs are named after their base, draw from its vertices and share its bounds.
+		CHECK(table.Name(rock2) == "rock#lod2");
+		CHECK(table.Find("rock#lod3") == rock3);
+		CHECK(table.Find("tree#lod1") == tree1);
+		CHECK(table.BaseVertexLocation(rock3) == 10);
+		CHECK(table.BaseVertexLocation(tree1) == 500);
+		CHECK(table.IndexCount(rock3) == 300);
+		CHECK(table.StartIndexLocation(rock3) == 6100);
+		CHECK(table.Bounds(rock3).Center.x == 5.0f);
+		CHECK(table.Sphere(rock3).Radius == table.Sphere(rock).Radius);
+		CHECK(table.OrientedBox(rock3).Extents.z == 2.0f);
+	}
+
+	void TestSelectLod()
+	{
+		SubmeshTable table;
+		SubmeshHandle rock = table.Add("rock", 3000, 0, 0);
+		SubmeshHandle rock1 = table.AddLod(rock, 1500, 3000, 0.01f);
+		SubmeshHandle rock2 = table.AddLod(rock, 700, 4500, 0.05f);
+		SubmeshHandle rock3 = table.AddLod(rock, 300, 5200, 0.2f);
+
+		// Below the finest LOD's error only the full mesh will do.
+		CHECK(table.SelectLod(rock, 0.0f) == rock);
+		CHECK(table.SelectLod(rock, 0.009f) == rock);
+
+		// The coarsest LOD whose error fits; an error equal to the limit fits.
+		CHECK(table.SelectLod(rock, 0.01f) == rock1);
+		CHECK(table.SelectLod(rock, 0.049f) == rock1);
+		CHECK(table.SelectLod(rock, 0.05f) == rock2);
+		CHECK(table.SelectLod(rock, 0.1f) == rock2);
+		CHECK(table.SelectLod(rock, 0.2f) == rock3);
+		CHECK(table.SelectLod(rock, 1e9f) == rock3);
+
+		// A negative tolerance never picks a LOD.
+		CHECK(table.SelectLod(rock, -1.0f) == rock);
+	}
+
+	void TestSetBounds()
+	{
+		SubmeshTable table;
+		SubmeshHandle box = table.Add("box", 36, 0, 0);
+
+		table.SetBounds(box, Box(3.0f, 2.0f));
+		CHECK(table.Bounds(box).Center.x == 3.0f);
+		CHECK(table.Sphere(box).Center.x == 3.0f);
+		CHECK_NEAR(table.Sphere(box).Radius, std::sqrt(12.0f), 1e-5f);
+		CHECK(table.OrientedBox(box).Center.x == 3.0f);
+
+		// Fitted volumes are taken as they are.
+		MeshBounds bounds = MeshBounds::FromBox(Box(0.0f, 1.0f));
+		bounds.Sphere.Radius = 1.0f;
+		bounds.OrientedBox.Orientation = XMFLOAT4(0.0f, 0.38268343f, 0.0f, 0.92387953f);
+		table.SetBounds(box, bounds);
+		CHECK(table.Bounds(box).Center.x == 0.0f);
+		CHECK(table.Sphere(box).Radius == 1.0f);
+		CHECK(table.OrientedBox(box).Orientation.y == 0.38268343f);
+	}
+}
+
+int main()
+{
+	TestAddAndFind();
+	TestLodChains();
+	TestSelectLod();
+	TestSetBounds();
+	return Check::Finish("SubmeshTableTests");
+}
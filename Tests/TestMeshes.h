@@ -0,0 +1,115 @@
+//***************************************************************************************
+// TestMeshes.h
+//
+// Procedural meshes for the tests and benchmarks of the D3D-free mesh code.
+//***************************************************************************************
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace TestMeshes
+{
+	struct Vertex
+	{
+		float Position[3];
+		float Normal[3];
+	};
+
+	// Unit sphere around the origin with rings x segments quads (the caps are fans), wound
+	// clockwise seen from outside like the rest of the sample.
+	inline void MakeSphere(std::uint32_t rings, std::uint32_t segments, std::vector<Vertex>& vertices,
+		std::vector<std::uint32_t>& indices)
+	{
+		const float pi = 3.14159265f;
+		vertices.clear();
+		indices.clear();
+
+		for (std::uint32_t r = 0; r <= rings; ++r)
+		{
+			float phi = pi * r / rings;
+			for (std::uint32_t s = 0; s <= segments; ++s)
+			{
+				float theta = 2.0f * pi * s / segments;
+				Vertex v;
+				v.Position[0] = std::sin(phi) * std::cos(theta);
+				v.Position[1] = std::cos(phi);
+				v.Position[2] = std::sin(phi) * std::sin(theta);
+				v.Normal[0] = v.Position[0];
+				v.Normal[1] = v.Position[1];
+				v.Normal[2] = v.Position[2];
+				vertices.push_back(v);
+			}
+		}
+
+		for (std::uint32_t r = 0; r < rings; ++r)
+		{
+			for (std::uint32_t s = 0; s < segments; ++s)
+			{
+				std::uint32_t a = r * (segments + 1) + s;
+				std::uint32_t b = a + segments + 1;
+				if (r != 0)
+				{
+					indices.push_back(a);
+					indices.push_back(a + 1);
+					indices.push_back(b);
+				}
+				if (r != rings - 1)
+				{
+					indices.push_back(a + 1);
+					indices.push_back(b + 1);
+					indices.push_back(b);
+				}
+			}
+		}
+	}
+
+	// Row-major view * projection of a left-handed camera at (0, 0, -distance) looking
+	// down +z, for Meshlets::ExtractFrustumPlanes.
+	inline void MakeViewProj(float distance, float fovY, float aspect, float zNear, float zFar, float viewProj[16])
+	{
+		float h = 1.0f / std::tan(fovY * 0.5f);
+		float w = h / aspect;
+		float q = zFar / (zFar - zNear);
+		const float m[16] =
+		{
+			w, 0.0f, 0.0f, 0.0f,
+			0.0f, h, 0.0f, 0.0f,
+			0.0f, 0.0f, q, 1.0f,
+			0.0f, 0.0f, distance * q - zNear * q, distance
+		};
+		for (int i = 0; i < 16; ++i)
+			viewProj[i] = m[i];
+	}
+
+	// The same mesh as OBJ text: a "v" and a "vn" line per vertex and an "f v//vn" line per
+	// triangle, all in group.
+	inline std::string MakeObjText(const std::vector<Vertex>& vertices, const std::vector<std::uint32_t>& indices,
+		const char* group)
+	{
+		std::string text;
+		text.reserve(vertices.size() * 64 + indices.size() * 12);
+		char line[128];
+		for (const Vertex& v : vertices)
+		{
+			std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvn %.6f %.6f %.6f\n",
+				v.Position[0], v.Position[1], v.Position[2], v.Normal[0], v.Normal[1], v.Normal[2]);
+			text += line;
+		}
+
+		text += "g ";
+		text += group;
+		text += "\n";
+		for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			std::uint32_t a = indices[i] + 1, b = indices[i + 1] + 1, c = indices[i + 2] + 1;
+			std::snprintf(line, sizeof(line), "f %u//%u %u//%u %u//%u\n", a, a, b, b, c, c);
+			text += line;
+		}
+		return text;
+	}
+}
@@ -0,0 +1,176 @@
+#include "TransformHierarchy.h"
+#include "Check.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	bool NearlyEqual(const XMFLOAT4X4& a, const XMFLOAT4X4& b, float tolerance = 1e-4f)
+	{
+		for (int r = 0; r < 4; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				if (std::fabs(a(r, c) - b(r, c)) > tolerance)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// scale * rotation * translation * parent, spelled out with separate matrices.
+	XMFLOAT4X4 Reference(const TransformHierarchy& hierarchy, std::uint32_t node)
+	{
+		XMMATRIX world = XMMatrixScaling(hierarchy.Scale(node).x, hierarchy.Scale(node).y, hierarchy.Scale(node).z) *
+			XMMatrixRotationQuaternion(XMLoadFloat4(&hierarchy.Rotation(node))) *
+			XMMatrixTranslation(hierarchy.Translation(node).x, hierarchy.Translation(node).y, hierarchy.Translation(node).z);
+		std::uint32_t parent = hierarchy.Parent(node);
+		if (parent != TransformHierarchy::InvalidNode)
+		{
+			XMFLOAT4X4 parentWorld = Reference(hierarchy, parent);
+			world = world * XMLoadFloat4x4(&parentWorld);
+		}
+
+		XMFLOAT4X4 result;
+		XMStoreFloat4x4(&result, world);
+		return result;
+	}
+
+	XMFLOAT4 RandomRotation(std::mt19937& random)
+	{
+		std::uniform_real_distribution<float> angle(-3.14159f, 3.14159f);
+		XMFLOAT4 rotation;
+		XMStoreFloat4(&rotation, XMQuaternionRotationRollPitchYaw(angle(random), angle(random), angle(random)));
+		return rotation;
+	}
+
+	void TestChain()
+	{
+		TransformHierarchy hierarchy;
+		std::uint32_t root = hierarchy.Add();
+		std::uint32_t child = hierarchy.Add(root);
+		std::uint32_t grandchild = hierarchy.Add(child);
+
+		XMFLOAT4 quarterTurn;
+		XMStoreFloat4(&quarterTurn, XMQuaternionRotationAxis(XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f), 0.5f * 3.14159265f));
+		hierarchy.SetLocal(root, XMFLOAT3(1.0f, 1.0f, 1.0f), quarterTurn, XMFLOAT3(10.0f, 0.0f, 0.0f));
+		hierarchy.SetTranslation(child, XMFLOAT3(1.0f, 0.0f, 0.0f));
+		hierarchy.SetScale(grandchild, XMFLOAT3(2.0f, 2.0f, 2.0f));
+		CHECK(hierarchy.Update() == 3);
+
+		// The child's offset along x turns to -z under the root's quarter turn about y.
+		const XMFLOAT4X4& world = hierarchy.World(child);
+		CHECK_NEAR(world(3, 0), 10.0f, 1e-5f);
+		CHECK_NEAR(world(3, 1), 0.0f, 1e-5f);
+		CHECK_NEAR(world(3, 2), -1.0f, 1e-5f);
+
+		// The grandchild's scale is applied before its ancestors' transforms.
+		XMFLOAT3 point;
+		XMStoreFloat3(&point, XMVector3TransformCoord(XMVectorSet(1.0f, 0.0f, 0.0f, 1.0f),
+			XMLoadFloat4x4(&hierarchy.World(grandchild))));
+		CHECK_NEAR(point.x, 10.0f, 1e-5f);
+		CHECK_NEAR(point.z, -3.0f, 1e-5f);
+
+		for (std::uint32_t node = 0; node < hierarchy.Size(); ++node)
+			CHECK(NearlyEqual(hierarchy.World(node), Reference(hierarchy, node)));
+	}
+
+	void TestDirtySubtrees()
+	{
+		// 0 has the children 1 and 2, 1 has 3 and 4, and 2 has 5.
+		TransformHierarchy hierarchy;
+		hierarchy.Add();
+		hierarchy.Add(0);
+		hierarchy.Add(0);
+		hierarchy.Add(1);
+		hierarchy.Add(1);
+		hierarchy.Add(2);
+		CHECK(hierarchy.Update() == 6);
+		CHECK(hierarchy.Update() == 0);
+		for (std::uint32_t node = 0; node < 6; ++node)
+			CHECK(!hierarchy.Changed(node));
+
+		hierarchy.SetTranslation(1, XMFLOAT3(0.0f, 5.0f, 0.0f));
+		CHECK(hierarchy.Update() == 3);
+		const bool expected[6] = { false, true, false, true, true, false };
+		for (std::uint32_t node = 0; node < 6; ++node)
+			CHECK(hierarchy.Changed(node) == expected[node]);
+		CHECK_NEAR(hierarchy.World(4)(3, 1), 5.0f, 1e-6f);
+		CHECK_NEAR(hierarchy.World(5)(3, 1), 0.0f, 1e-6f);
+
+		// Two dirty leaves in different subtrees.
+		hierarchy.SetScale(3, XMFLOAT3(3.0f, 3.0f, 3.0f));
+		hierarchy.SetRotation(5, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+		CHECK(hierarchy.Update() == 2);
+		CHECK(!hierarchy.Changed(1) && hierarchy.Changed(3) && !hierarchy.Changed(4) && hierarchy.Changed(5));
+
+		// A node added under an existing one only computes itself.
+		std::uint32_t added = hierarchy.Add(4);
+		CHECK(hierarchy.Update() == 1);
+		CHECK(hierarchy.Changed(added) && !hierarchy.Changed(4));
+		CHECK_NEAR(hierarchy.World(added)(3, 1), 5.0f, 1e-6f);
+
+		CHECK(hierarchy.UpdateAll() == hierarchy.Size());
+	}
+
+	void TestRandomTree()
+	{
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+		std::uniform_real_distribution<float> scale(0.5f, 1.5f);
+
+		TransformHierarchy hierarchy;
+		hierarchy.Reserve(500);
+		for (std::uint32_t node = 0; node < 500; ++node)
+		{
+			std::uint32_t parent = node == 0 || node % 50 == 0 ? TransformHierarchy::InvalidNode : random() % node;
+			hierarchy.Add(parent);
+			hierarchy.SetLocal(node, XMFLOAT3(scale(random), scale(random), scale(random)), RandomRotation(random),
+				XMFLOAT3(offset(random), offset(random), offset(random)));
+		}
+		hierarchy.Update();
+
+		// A few frames of sparse edits: the incremental pass gives the same matrices as
+		// recomputing everything.
+		bool matches = true;
+		for (int frame = 0; frame < 10; ++frame)
+		{
+			for (int edit = 0; edit < 5; ++edit)
+				hierarchy.SetRotation(random() % hierarchy.Size(), RandomRotation(random));
+			std::uint32_t updated = hierarchy.Update();
+			matches = matches && updated > 0 && updated < hierarchy.Size();
+
+			for (std::uint32_t node = 0; node < hierarchy.Size(); ++node)
+				matches = matches && NearlyEqual(hierarchy.World(node), Reference(hierarchy, node), 1e-3f);
+		}
+		CHECK(matches);
+	}
+
+	void TestClear()
+	{
+		TransformHierarchy hierarchy;
+		hierarchy.Add();
+		hierarchy.Add(0);
+		hierarchy.Update();
+		hierarchy.Clear();
+		CHECK(hierarchy.Size() == 0);
+		CHECK(hierarchy.Update() == 0);
+		CHECK(hierarchy.UpdateAll() == 0);
+
+		std::uint32_t node = hierarchy.Add();
+		CHECK(node == 0);
+		CHECK(hierarchy.Update() == 1);
+	}
+}
+
+int main()
+{
+	TestChain();
+	TestDirtySubtrees();
+	TestRandomTree();
+	TestClear();
+	return Check::Finish("TransformHierarchyTests");
+}
@@ -0,0 +1,234 @@
+#include "VertexPacking.h"
+#include "Check.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+	// Half-precision floats keep 11 significant bits: rounding is off by at most 2^-11 of
+	// the value.
+	const float HalfRelativeError = 1.0f / 2048.0f;
+
+	float Distance(const XMFLOAT3& a, FXMVECTOR b)
+	{
+		return XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&a), b)));
+	}
+
+	std::vector<XMFLOAT3> RandomPoints(const BoundingBox& bounds, std::size_t count, unsigned seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::vector<XMFLOAT3> points(count);
+		for (XMFLOAT3& p : points)
+		{
+			p.x = bounds.Center.x + unit(random) * bounds.Extents.x;
+			p.y = bounds.Center.y + unit(random) * bounds.Extents.y;
+			p.z = bounds.Center.z + unit(random) * bounds.Extents.z;
+		}
+		// The corners are the extreme values of every axis.
+		XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+		bounds.GetCorners(corners);
+		points.insert(points.end(), corners, corners + BoundingBox::CORNER_COUNT);
+		return points;
+	}
+
+	std::vector<XMFLOAT3> RandomUnitVectors(std::size_t count, unsigned seed)
+	{
+		std::mt19937 random(seed);
+		std::normal_distribution<float> normal;
+		const XMFLOAT3 axes[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+		std::vector<XMFLOAT3> vectors(axes, axes + 6);
+		while (vectors.size() < count)
+		{
+			XMFLOAT3 v(normal(random), normal(random), normal(random));
+			XMVECTOR n = XMLoadFloat3(&v);
+			if (XMVectorGetX(XMVector3LengthSq(n)) < 1e-6f)
+				continue;
+			XMStoreFloat3(&v, XMVector3Normalize(n));
+			vectors.push_back(v);
+		}
+		return vectors;
+	}
+
+	void TestSnormPositions()
+	{
+		BoundingBox bounds(XMFLOAT3(10.0f, -3.0f, 250.0f), XMFLOAT3(40.0f, 2.5f, 0.75f));
+		PositionQuantization quantization = PositionQuantization::FromBounds(bounds);
+		std::vector<XMFLOAT3> points = RandomPoints(bounds, 10000, 1);
+
+		std::vector<XMSHORTN4> quantized(points.size());
+		VertexPacking::QuantizePositionStream(quantized.data(), sizeof(XMSHORTN4), points.data(), sizeof(XMFLOAT3),
+			points.size(), quantization);
+
+		// Rounding to snorm16 moves each axis by at most half a step of extent / 32767.
+		XMMATRIX dequantization = quantization.Dequantization();
+		float worstAxis[3] = { 0.0f, 0.0f, 0.0f };
+		bool wIsOne = true;
+		for (std::size_t i = 0; i < points.size(); ++i)
+		{
+			XMVECTOR q = XMLoadShortN4(&quantized[i]);
+			wIsOne = wIsOne && quantized[i].w == 32767;
+			XMFLOAT3 p;
+			XMStoreFloat3(&p, XMVector3Transform(XMVectorSetW(q, 1.0f), dequantization));
+			worstAxis[0] = std::max(worstAxis[0], std::fabs(p.x - points[i].x));
+			worstAxis[1] = std::max(worstAxis[1], std::fabs(p.y - points[i].y));
+			worstAxis[2] = std::max(worstAxis[2], std::fabs(p.z - points[i].z));
+		}
+		std::printf("snorm16 position error: %g %g %g\n", worstAxis[0], worstAxis[1], worstAxis[2]);
+
+		// The float math adds a little on top of the rounding, mostly around the bias.
+		const float extents[3] = { bounds.Extents.x, bounds.Extents.y, bounds.Extents.z };
+		const float centers[3] = { bounds.Center.x, bounds.Center.y, bounds.Center.z };
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			float bound = extents[axis] * 0.5f / 32767.0f + 4.0f * FLT_EPSILON * (std::fabs(centers[axis]) + extents[axis]);
+			CHECK(worstAxis[axis] <= bound);
+		}
+		CHECK(wIsOne);
+	}
+
+	void TestHalfPositions()
+	{
+		BoundingBox bounds(XMFLOAT3(-5.0f, 0.0f, 1.0f), XMFLOAT3(8.0f, 8.0f, 1.0f));
+		PositionQuantization quantization = PositionQuantization::FromBounds(bounds);
+		std::vector<XMFLOAT3> points = RandomPoints(bounds, 10000, 2);
+
+		std::vector<XMHALF4> packed(points.size());
+		VertexPacking::HalfPositionStream(packed.data(), sizeof(XMHALF4), points.data(), sizeof(XMFLOAT3),
+			points.size(), quantization);
+
+		// Normalized coordinates are within [-1, 1], so the error is at most 2^-11 of the
+		// extent.
+		XMMATRIX dequantization = quantization.Dequantization();
+		float worst = 0.0f;
+		for (std::size_t i = 0; i < points.size(); ++i)
+		{
+			XMVECTOR p = XMVector3Transform(XMVectorSetW(XMLoadHalf4(&packed[i]), 1.0f), dequantization);
+			worst = std::max(worst, Distance(points[i], p) / 8.0f);
+		}
+		std::printf("half position error: %g of the extent\n", worst);
+		CHECK(worst <= HalfRelativeError * std::sqrt(3.0f) + 1e-6f);
+	}
+
+	void TestDegenerateAxis()
+	{
+		// A flat mesh: z has no extent and must not divide by zero.
+		BoundingBox bounds(XMFLOAT3(0.0f, 0.0f, 2.0f), XMFLOAT3(1.0f, 1.0f, 0.0f));
+		PositionQuantization quantization = PositionQuantization::FromBounds(bounds);
+		CHECK(quantization.Scale.z == 1.0f);
+
+		XMFLOAT3 point(0.5f, -0.25f, 2.0f);
+		XMSHORTN4 quantized;
+		VertexPacking::QuantizePositionStream(&quantized, sizeof(quantized), &point, sizeof(point), 1, quantization);
+		CHECK(quantized.z == 0);
+		CHECK(quantized.x == 16384 || quantized.x == 16383);
+	}
+
+	void TestOctahedralNormals()
+	{
+		std::vector<XMFLOAT3> normals = RandomUnitVectors(20000, 3);
+
+		// The encoding alone is exact up to float rounding.
+		float worstExact = 0.0f;
+		for (const XMFLOAT3& n : normals)
+		{
+			XMVECTOR e = VertexPacking::EncodeOctahedral(XMLoadFloat3(&n));
+			CHECK(std::fabs(XMVectorGetX(e)) <= 1.0f && std::fabs(XMVectorGetY(e)) <= 1.0f);
+			worstExact = std::max(worstExact, Distance(n, VertexPacking::DecodeOctahedral(e)));
+		}
+		CHECK(worstExact < 1e-5f);
+
+		// Stored as snorm16, each of the two coordinates is off by at most 1/65534; the
+		// decoded direction stays within a few thousandths of a degree.  For such small
+		// angles the chord length is the angle in radians (acos of the dot product would
+		// lose it to float rounding).
+		std::vector<XMSHORTN2> packed(normals.size());
+		VertexPacking::OctahedralNormalStream(packed.data(), sizeof(XMSHORTN2), normals.data(), sizeof(XMFLOAT3),
+			normals.size());
+		float worstDegrees = 0.0f;
+		for (std::size_t i = 0; i < normals.size(); ++i)
+		{
+			XMVECTOR decoded = VertexPacking::DecodeOctahedral(XMLoadShortN2(&packed[i]));
+			worstDegrees = std::max(worstDegrees, Distance(normals[i], decoded) * 180.0f / XM_PI);
+		}
+		std::printf("octahedral snorm16 normal error: %g degrees\n", worstDegrees);
+		CHECK(worstDegrees < 0.01f);
+
+		// The lower hemisphere folds out to the corners.
+		XMFLOAT3 down(0.0f, 0.0f, -1.0f);
+		XMVECTOR e = VertexPacking::EncodeOctahedral(XMLoadFloat3(&down));
+		CHECK(std::fabs(XMVectorGetX(e)) == 1.0f && std::fabs(XMVectorGetY(e)) == 1.0f);
+	}
+
+	void TestTexCoordsAndColors()
+	{
+		// Interleaved input: the kernels only see strides.
+		struct Vertex
+		{
+			XMFLOAT2 TexC;
+			XMFLOAT4 Color;
+		};
+
+		std::mt19937 random(4);
+		std::uniform_real_distribution<float> texCoord(-4.0f, 4.0f);
+		std::uniform_real_distribution<float> channel(-0.25f, 1.25f);
+		std::vector<Vertex> vertices(5000);
+		for (Vertex& v : vertices)
+		{
+			v.TexC = XMFLOAT2(texCoord(random), texCoord(random));
+			v.Color = XMFLOAT4(channel(random), channel(random), channel(random), channel(random));
+		}
+
+		struct Packed
+		{
+			XMHALF2 TexC;
+			XMUBYTEN4 Color;
+		};
+		std::vector<Packed> packed(vertices.size());
+		VertexPacking::HalfTexCoordStream(&packed[0].TexC, sizeof(Packed), &vertices[0].TexC, sizeof(Vertex), vertices.size());
+		VertexPacking::PackColorStream(&packed[0].Color, sizeof(Packed), &vertices[0].Color, sizeof(Vertex), vertices.size());
+
+		bool texCoordsWithinBound = true;
+		bool colorsWithinBound = true;
+		for (std::size_t i = 0; i < vertices.size(); ++i)
+		{
+			XMFLOAT2 t;
+			XMStoreFloat2(&t, XMLoadHalf2(&packed[i].TexC));
+			// Below 2^-14 halfs are denormal and their step is 2^-24.
+			float boundU = std::max(std::fabs(vertices[i].TexC.x) * HalfRelativeError, 1.0f / (1 << 24));
+			float boundV = std::max(std::fabs(vertices[i].TexC.y) * HalfRelativeError, 1.0f / (1 << 24));
+			texCoordsWithinBound = texCoordsWithinBound && std::fabs(t.x - vertices[i].TexC.x) <= boundU &&
+				std::fabs(t.y - vertices[i].TexC.y) <= boundV;
+
+			// Channels saturate to [0, 1], then round to the nearest 1/255.
+			XMFLOAT4 c;
+			XMStoreFloat4(&c, XMLoadUByteN4(&packed[i].Color));
+			const float in[4] = { vertices[i].Color.x, vertices[i].Color.y, vertices[i].Color.z, vertices[i].Color.w };
+			const float out[4] = { c.x, c.y, c.z, c.w };
+			for (int k = 0; k < 4; ++k)
+			{
+				float expected = std::min(std::max(in[k], 0.0f), 1.0f);
+				colorsWithinBound = colorsWithinBound && std::fabs(out[k] - expected) <= 0.5f / 255.0f + 1e-6f;
+			}
+		}
+		CHECK(texCoordsWithinBound);
+		CHECK(colorsWithinBound);
+	}
+}
+
+int main()
+{
+	TestSnormPositions();
+	TestHalfPositions();
+	TestDegenerateAxis();
+	TestOctahedralNormals();
+	TestTexCoordsAndColors();
+	return Check::Finish("VertexPackingTests");
+}
@@ -0,0 +1,85 @@
+#include "WorkerPool.h"
+#include "Check.h"
+#include <atomic>
+#include <set>
+#include <vector>
+
+namespace
+{
+	void TestEveryTaskOnce()
+	{
+		WorkerPool pool(4);
+		CHECK(pool.ThreadCount() == 4);
+
+		std::vector<std::atomic<int>> runs(1000);
+		for (std::atomic<int>& count : runs)
+			count.store(0);
+		pool.Run((std::uint32_t)runs.size(), [&](std::uint32_t task) { ++runs[task]; });
+
+		bool once = true;
+		for (std::atomic<int>& count : runs)
+			once = once && count.load() == 1;
+		CHECK(once);
+	}
+
+	void TestManyJobs()
+	{
+		// Back to back jobs of every size reuse the same threads; a worker that is late
+		// for one job must not run tasks of the next with the old work.
+		WorkerPool pool(8);
+		bool correct = true;
+		for (std::uint32_t job = 0; job < 2000; ++job)
+		{
+			const std::uint32_t taskCount = job % 17;
+			std::atomic<std::uint64_t> sum(0);
+			pool.Run(taskCount, [&sum, job](std::uint32_t task) { sum += job * 100 + task + 1; });
+
+			std::uint64_t expected = 0;
+			for (std::uint32_t task = 0; task < taskCount; ++task)
+				expected += job * 100 + task + 1;
+			correct = correct && sum.load() == expected;
+		}
+		CHECK(correct);
+	}
+
+	void TestSpreadsOverThreads()
+	{
+		WorkerPool pool(4);
+		std::mutex mutex;
+		std::set<std::thread::id> threads;
+		std::atomic<int> waiting(0);
+
+		// Four tasks that each wait for the others can only finish on four threads.
+		pool.Run(4, [&](std::uint32_t)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				threads.insert(std::this_thread::get_id());
+			}
+			++waiting;
+			while (waiting.load() < 4)
+				std::this_thread::yield();
+		});
+		CHECK(threads.size() == 4);
+		CHECK(threads.count(std::this_thread::get_id()) == 1);
+	}
+
+	void TestSingleThread()
+	{
+		WorkerPool pool(1);
+		CHECK(pool.ThreadCount() == 1);
+
+		std::vector<std::uint32_t> order;
+		pool.Run(5, [&](std::uint32_t task) { order.push_back(task); });
+		CHECK(order == std::vector<std::uint32_t>({ 0, 1, 2, 3, 4 }));
+	}
+}
+
+int main()
+{
+	TestEveryTaskOnce();
+	TestManyJobs();
+	TestSpreadsOverThreads();
+	TestSingleThread();
+	return Check::Finish("WorkerPoolTests");
+}
@@ -0,0 +1,117 @@
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace DirectX;
+
+void TransformHierarchy::Reserve(std::uint32_t count)
+{
+	mScales.reserve(count);
+	mRotations.reserve(count);
+	mTranslations.reserve(count);
+	mParents.reserve(count);
+	mWorlds.reserve(count);
+	mDirty.reserve(count);
+	mChanged.reserve(count);
+}
+
+void TransformHierarchy::Clear()
+{
+	mFirstDirty = 0;
+	mScales.clear();
+	mRotations.clear();
+	mTranslations.clear();
+	mParents.clear();
+	mWorlds.clear();
+	mDirty.clear();
+	mChanged.clear();
+}
+
+std::uint32_t TransformHierarchy::Add(std::uint32_t parent)
+{
+	std::uint32_t node = Size();
+	assert(parent == InvalidNode || parent < node);
+
+	mScales.push_back(XMFLOAT3(1.0f, 1.0f, 1.0f));
+	mRotations.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+	mTranslations.push_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+	mParents.push_back(parent);
+	mWorlds.emplace_back();
+	mDirty.push_back(0);
+	mChanged.push_back(0);
+
+	MarkDirty(node);
+	return node;
+}
+
+void TransformHierarchy::SetLocal(std::uint32_t node, const XMFLOAT3& scale, const XMFLOAT4& rotation,
+	const XMFLOAT3& translation)
+{
+	mScales[node] = scale;
+	mRotations[node] = rotation;
+	mTranslations[node] = translation;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetTranslation(std::uint32_t node, const XMFLOAT3& translation)
+{
+	mTranslations[node] = translation;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetRotation(std::uint32_t node, const XMFLOAT4& rotation)
+{
+	mRotations[node] = rotation;
+	MarkDirty(node);
+}
+
+void TransformHierarchy::SetScale(std::uint32_t node, const XMFLOAT3& scale)
+{
+	mScales[node] = scale;
+	MarkDirty(node);
+}
+
+std::uint32_t TransformHierarchy::Update()
+{
+	const std::uint32_t count = Size();
+	std::fill(mChanged.begin(), mChanged.begin() + std::min(mFirstDirty, count), (std::uint8_t)0);
+
+	std::uint32_t updated = 0;
+	for (std::uint32_t i = mFirstDirty; i < count; ++i)
+	{
+		const std::uint32_t parent = mParents[i];
+		const bool changed = mDirty[i] != 0 || (parent != InvalidNode && mChanged[parent] != 0);
+		mChanged[i] = changed ? 1 : 0;
+		if (!changed)
+			continue;
+
+		XMMATRIX local = XMMatrixAffineTransformation(XMLoadFloat3(&mScales[i]), g_XMZero,
+			XMLoadFloat4(&mRotations[i]), XMLoadFloat3(&mTranslations[i]));
+		if (parent != InvalidNode)
+			local = XMMatrixMultiply(local, XMLoadFloat4x4(&mWorlds[parent]));
+		XMStoreFloat4x4(&mWorlds[i], local);
+
+		mDirty[i] = 0;
+		++updated;
+	}
+
+	mFirstDirty = count;
+	return updated;
+}
+
+std::uint32_t TransformHierarchy::UpdateAll()
+{
+	if (Size() > 0)
+	{
+		std::memset(mDirty.data(), 1, mDirty.size());
+		mFirstDirty = 0;
+	}
+	return Update();
+}
+
+void TransformHierarchy::MarkDirty(std::uint32_t node)
+{
+	mDirty[node] = 1;
+	mFirstDirty = std::min(mFirstDirty, node);
+}
@@ -0,0 +1,74 @@
+//***************************************************************************************
+// TransformHierarchy.h
+//
+// Scene graph transforms stored as parallel arrays: local scale, rotation and
+// translation, parent index and world matrix, one entry per node.
+//
+// Nodes are kept in topological order (a parent always comes before its children), so
+// Update is a single forward pass: a node's world matrix is recomputed when its local
+// transform was set or its parent's world matrix changed in the same pass.  Nothing
+// before the first dirty node is looked at, and only the changed subtrees are
+// recomputed.  Changed() tells which world matrices the last Update touched, so bounds
+// and constants only need refreshing for those.
+//
+// Nodes are addressed by index and cannot be removed individually.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+
+class TransformHierarchy
+{
+public:
+	static const std::uint32_t InvalidNode = 0xffffffff;
+
+	void Reserve(std::uint32_t count);
+	void Clear();
+
+	// parent must be InvalidNode or an existing node.  The new node starts at identity.
+	std::uint32_t Add(std::uint32_t parent = InvalidNode);
+
+	std::uint32_t Size()const { return (std::uint32_t)mParents.size(); }
+	std::uint32_t Parent(std::uint32_t node)const { return mParents[node]; }
+
+	void SetLocal(std::uint32_t node, const DirectX::XMFLOAT3& scale, const DirectX::XMFLOAT4& rotation,
+		const DirectX::XMFLOAT3& translation);
+	void SetTranslation(std::uint32_t node, const DirectX::XMFLOAT3& translation);
+	void SetRotation(std::uint32_t node, const DirectX::XMFLOAT4& rotation);
+	void SetScale(std::uint32_t node, const DirectX::XMFLOAT3& scale);
+
+	const DirectX::XMFLOAT3& Scale(std::uint32_t node)const { return mScales[node]; }
+	const DirectX::XMFLOAT4& Rotation(std::uint32_t node)const { return mRotations[node]; }
+	const DirectX::XMFLOAT3& Translation(std::uint32_t node)const { return mTranslations[node]; }
+
+	// Valid after Update.
+	const DirectX::XMFLOAT4X4& World(std::uint32_t node)const { return mWorlds[node]; }
+	const DirectX::XMFLOAT4X4* Worlds()const { return mWorlds.data(); }
+
+	// Whether the last Update recomputed the node's world matrix.
+	bool Changed(std::uint32_t node)const { return mChanged[node] != 0; }
+
+	// Recomputes the world matrices of dirty nodes and their descendants; returns how
+	// many were recomputed.
+	std::uint32_t Update();
+
+	// Recomputes every world matrix, dirty or not.
+	std::uint32_t UpdateAll();
+
+private:
+	void MarkDirty(std::uint32_t node);
+
+	// The first node that may need recomputing; Size() when none does.
+	std::uint32_t mFirstDirty = 0;
+
+	std::vector<DirectX::XMFLOAT3> mScales;
+	std::vector<DirectX::XMFLOAT4> mRotations;
+	std::vector<DirectX::XMFLOAT3> mTranslations;
+	std::vector<std::uint32_t> mParents;
+	std::vector<DirectX::XMFLOAT4X4> mWorlds;
+	std::vector<std::uint8_t> mDirty;
+	std::vector<std::uint8_t> mChanged;
+};
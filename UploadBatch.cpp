@@ -0,0 +1,207 @@
+#include "UploadBatch.h"
+#include <algorithm>
+#include <unordered_set>
+
+UploadBatch::UploadBatch(ID3D12Device* device, ID3D12CommandQueue* queue, FenceTimeline* timeline, UploadRing* uploadRing,
+	GpuHeapAllocator* bufferHeap) :
+	mDevice(device),
+	mQueue(queue),
+	mTimeline(timeline),
+	mUploadRing(uploadRing),
+	mBufferHeap(bufferHeap)
+{
+	ThrowIfFailed(mDevice->CreateCommandAllocator(
+		D3D12_COMMAND_LIST_TYPE_DIRECT,
+		IID_PPV_ARGS(mCmdListAlloc.GetAddressOf())));
+
+	ThrowIfFailed(mDevice->CreateCommandList(
+		0,
+		D3D12_COMMAND_LIST_TYPE_DIRECT,
+		mCmdListAlloc.Get(),
+		nullptr,
+		IID_PPV_ARGS(mCommandList.GetAddressOf())));
+
+	// Start off in a closed state; Submit() resets it.
+	mCommandList->Close();
+}
+
+void UploadBatch::Enqueue(ID3D12Resource* dest, const void* data, UINT64 byteSize, UINT64 destOffset,
+	D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+	if (byteSize == 0)
+		return;
+
+	Request request;
+	request.Dest = dest;
+	request.Data = data;
+	request.ByteSize = byteSize;
+	request.DestOffset = destOffset;
+	request.StateBefore = stateBefore;
+	request.StateAfter = stateAfter;
+	mRequests.push_back(request);
+
+	mPendingBytes = RingAllocator::AlignUp(mPendingBytes, PackAlignment) + byteSize;
+}
+
+void UploadBatch::EnqueueOwned(ID3D12Resource* dest, std::vector<std::uint8_t> data, UINT64 destOffset,
+	D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+	if (data.empty())
+		return;
+
+	// Moving the vector keeps its storage, so the request can point into it.
+	mOwned.push_back(std::move(data));
+	Enqueue(dest, mOwned.back().data(), mOwned.back().size(), destOffset, stateBefore, stateAfter);
+}
+
+GpuHeapAllocator::Allocation UploadBatch::CreateDefaultBuffer(const void* data, UINT64 byteSize,
+	D3D12_RESOURCE_STATES stateAfter)
+{
+	GpuHeapAllocator::Allocation allocation = mBufferHeap->CreateBuffer(byteSize, D3D12_RESOURCE_STATE_COMMON);
+
+	Enqueue(allocation.Resource.Get(), data, byteSize, 0, D3D12_RESOURCE_STATE_COMMON, stateAfter);
+	mCreated.push_back(allocation.Resource);
+
+	return allocation;
+}
+
+UINT64 UploadBatch::MaxChunkBytes()const
+{
+	UINT64 half = (mUploadRing->Allocator().Capacity() / 2) & ~(PackAlignment - 1);
+	return std::max(half, PackAlignment);
+}
+
+UINT64 UploadBatch::Submit()
+{
+	if (mRequests.empty())
+		return mTimeline->LastSignaled();
+
+	// Cut the requests into chunks that fit the ring, splitting requests at chunk ends.
+	const UINT64 maxChunkBytes = MaxChunkBytes();
+	std::vector<size_t> chunkEnds;
+	std::vector<UINT64> chunkBytes;
+	mPieces.clear();
+	UINT64 offset = 0;
+	for (size_t i = 0; i < mRequests.size(); ++i)
+	{
+		for (UINT64 done = 0; done < mRequests[i].ByteSize; )
+		{
+			offset = RingAllocator::AlignUp(offset, PackAlignment);
+			if (offset >= maxChunkBytes)
+			{
+				chunkEnds.push_back(mPieces.size());
+				chunkBytes.push_back(offset);
+				offset = 0;
+			}
+
+			Piece piece;
+			piece.Request = i;
+			piece.SourceOffset = done;
+			piece.ByteSize = std::min(mRequests[i].ByteSize - done, maxChunkBytes - offset);
+			piece.StagingOffset = offset;
+			mPieces.push_back(piece);
+
+			offset += piece.ByteSize;
+			done += piece.ByteSize;
+		}
+	}
+	chunkEnds.push_back(mPieces.size());
+	chunkBytes.push_back(offset);
+
+	// A destination queued more than once takes its transitions from the first request.
+	mDestStates.clear();
+	for (const Request& request : mRequests)
+	{
+		DestState state;
+		state.Current = request.StateBefore;
+		state.After = request.StateAfter;
+		mDestStates.emplace(request.Dest, state);
+	}
+
+	size_t first = 0;
+	for (size_t c = 0; c < chunkEnds.size(); ++c)
+	{
+		SubmitChunk(first, chunkEnds[c], chunkBytes[c]);
+		first = chunkEnds[c];
+	}
+
+	// Keep the buffers created here alive until their copies have executed, even if
+	// the caller drops them early.
+	if (!mCreated.empty())
+	{
+		auto created = std::make_shared<std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>>>(std::move(mCreated));
+		mTimeline->OnRetired(mLastFence, [created]() { created->clear(); });
+		mCreated.clear();
+	}
+
+	mRequests.clear();
+	mOwned.clear();
+	mPieces.clear();
+	mPendingBytes = 0;
+
+	return mLastFence;
+}
+
+void UploadBatch::SubmitChunk(size_t first, size_t end, UINT64 stagingBytes)
+{
+	// Pack the chunk into one staging region.  This may wait for earlier chunks to
+	// release ring memory, and overlaps with the copies of the previous chunk otherwise.
+	UploadRing::Allocation staging = mUploadRing->Allocate(stagingBytes, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+	for (size_t i = first; i < end; ++i)
+	{
+		const Piece& piece = mPieces[i];
+		const BYTE* source = static_cast<const BYTE*>(mRequests[piece.Request].Data) + piece.SourceOffset;
+		memcpy(staging.CpuAddress + piece.StagingOffset, source, static_cast<size_t>(piece.ByteSize));
+	}
+
+	// Only reset the allocator once the GPU is done with the previous submission.
+	mTimeline->WaitFor(mLastFence);
+	ThrowIfFailed(mCmdListAlloc->Reset());
+	ThrowIfFailed(mCommandList->Reset(mCmdListAlloc.Get(), nullptr));
+
+	// One transition per destination resource, all in a single ResourceBarrier call.
+	std::unordered_set<ID3D12Resource*> seen;
+	mBarriers.clear();
+	for (size_t i = first; i < end; ++i)
+	{
+		ID3D12Resource* dest = mRequests[mPieces[i].Request].Dest;
+		D3D12_RESOURCE_STATES state = mDestStates[dest].Current;
+		if (state != D3D12_RESOURCE_STATE_COPY_DEST && seen.insert(dest).second)
+			mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(dest, state, D3D12_RESOURCE_STATE_COPY_DEST));
+	}
+	if (!mBarriers.empty())
+		mCommandList->ResourceBarrier(static_cast<UINT>(mBarriers.size()), mBarriers.data());
+
+	for (size_t i = first; i < end; ++i)
+	{
+		const Piece& piece = mPieces[i];
+		const Request& request = mRequests[piece.Request];
+		mCommandList->CopyBufferRegion(request.Dest, request.DestOffset + piece.SourceOffset,
+			staging.Resource, staging.Offset + piece.StagingOffset, piece.ByteSize);
+	}
+
+	// Every chunk leaves its destinations in their final state, so the next chunk (or
+	// anyone reading them after this one) starts from a known state.
+	seen.clear();
+	mBarriers.clear();
+	for (size_t i = first; i < end; ++i)
+	{
+		ID3D12Resource* dest = mRequests[mPieces[i].Request].Dest;
+		if (!seen.insert(dest).second)
+			continue;
+
+		DestState& state = mDestStates[dest];
+		if (state.After != D3D12_RESOURCE_STATE_COPY_DEST)
+			mBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(dest, D3D12_RESOURCE_STATE_COPY_DEST, state.After));
+		state.Current = state.After;
+	}
+	if (!mBarriers.empty())
+		mCommandList->ResourceBarrier(static_cast<UINT>(mBarriers.size()), mBarriers.data());
+
+	ThrowIfFailed(mCommandList->Close());
+	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
+	mQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+
+	mLastFence = mTimeline->Signal();
+	mUploadRing->Submit(mLastFence);
+}
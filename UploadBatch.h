@@ -0,0 +1,122 @@
+//***************************************************************************************
+// UploadBatch.h
+//
+// Collects buffer uploads (destination, data, size) and submits them together: all the
+// source data is packed into one staging region of the UploadRing, the state transitions
+// are merged into one ResourceBarrier call before and one after the copies, and
+// everything goes out in a single command list.  Submit returns the fence value that
+// marks the end of the copies.
+//
+// A batch larger than MaxChunkBytes() goes out as several such submissions, each with
+// its own staging region; requests are split across them where needed.  Before reusing
+// the command allocator for the next chunk, Submit waits for the previous one.
+//
+// The batch owns its command allocator/list but shares the UploadRing, so do not leave
+// unsubmitted ring allocations from another command list pending across Submit().
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FenceTimeline.h"
+#include "GpuHeapAllocator.h"
+#include "UploadRing.h"
+
+class UploadBatch
+{
+public:
+	// bufferHeap places the buffers made by CreateDefaultBuffer.
+	UploadBatch(ID3D12Device* device, ID3D12CommandQueue* queue, FenceTimeline* timeline, UploadRing* uploadRing,
+		GpuHeapAllocator* bufferHeap);
+	UploadBatch(const UploadBatch& rhs) = delete;
+	UploadBatch& operator=(const UploadBatch& rhs) = delete;
+
+	// Queues a copy of byteSize bytes from data into dest at destOffset.  data is read
+	// during Submit(), so it must stay valid until then.  dest is expected in stateBefore
+	// and left in stateAfter; if dest is queued more than once, its first request decides
+	// the transitions.
+	void Enqueue(ID3D12Resource* dest, const void* data, UINT64 byteSize, UINT64 destOffset = 0,
+		D3D12_RESOURCE_STATES stateBefore = D3D12_RESOURCE_STATE_COMMON,
+		D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_GENERIC_READ);
+
+	// Same, for data the batch keeps until Submit(); for data built just for the upload.
+	void EnqueueOwned(ID3D12Resource* dest, std::vector<std::uint8_t> data, UINT64 destOffset = 0,
+		D3D12_RESOURCE_STATES stateBefore = D3D12_RESOURCE_STATE_COMMON,
+		D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_GENERIC_READ);
+
+	// Places a default-heap buffer in the buffer heap and queues its initial data.  Free
+	// the allocation through the heap once the GPU is done with it.
+	GpuHeapAllocator::Allocation CreateDefaultBuffer(const void* data, UINT64 byteSize,
+		D3D12_RESOURCE_STATES stateAfter = D3D12_RESOURCE_STATE_GENERIC_READ);
+
+	// Records and executes every queued upload.  Returns the fence value to wait on, or
+	// the last signaled value if nothing was queued.
+	UINT64 Submit();
+
+	size_t PendingCount()const { return mRequests.size(); }
+	UINT64 PendingBytes()const { return mPendingBytes; }
+
+	// Largest staging region one submission uses: half the ring, so the next chunk can be
+	// packed while the GPU copies the previous one.
+	UINT64 MaxChunkBytes()const;
+
+	// Alignment of each request inside the staging region.
+	static const UINT64 PackAlignment = 16;
+
+private:
+	struct Request
+	{
+		ID3D12Resource* Dest = nullptr;
+		const void* Data = nullptr;
+		UINT64 ByteSize = 0;
+		UINT64 DestOffset = 0;
+		D3D12_RESOURCE_STATES StateBefore = D3D12_RESOURCE_STATE_COMMON;
+		D3D12_RESOURCE_STATES StateAfter = D3D12_RESOURCE_STATE_COMMON;
+	};
+
+	// Part of a request that goes out in one chunk.
+	struct Piece
+	{
+		size_t Request = 0;
+		UINT64 SourceOffset = 0;
+		UINT64 ByteSize = 0;
+		UINT64 StagingOffset = 0;
+	};
+
+	// Records, executes and signals the copies of pieces [first, end), packed in
+	// stagingBytes of staging memory.
+	void SubmitChunk(size_t first, size_t end, UINT64 stagingBytes);
+
+	ID3D12Device* mDevice = nullptr;
+	ID3D12CommandQueue* mQueue = nullptr;
+	FenceTimeline* mTimeline = nullptr;
+	UploadRing* mUploadRing = nullptr;
+	GpuHeapAllocator* mBufferHeap = nullptr;
+
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mCmdListAlloc;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> mCommandList;
+
+	// Fence of the last submission; the allocator cannot be reset before it completes.
+	UINT64 mLastFence = 0;
+
+	std::vector<Request> mRequests;
+	UINT64 mPendingBytes = 0;
+
+	// Buffers created through CreateDefaultBuffer are held until their copies are submitted.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mCreated;
+
+	// Data handed over by EnqueueOwned, freed once Submit has copied it.
+	std::vector<std::vector<std::uint8_t>> mOwned;
+
+	// Transitions of each destination, from its first request.  Current is the state it
+	// is in between chunks.
+	struct DestState
+	{
+		D3D12_RESOURCE_STATES Current = D3D12_RESOURCE_STATE_COMMON;
+		D3D12_RESOURCE_STATES After = D3D12_RESOURCE_STATE_COMMON;
+	};
+
+	std::vector<Piece> mPieces;
+	std::unordered_map<ID3D12Resource*, DestState> mDestStates;
+	std::vector<D3D12_RESOURCE_BARRIER> mBarriers;
+};
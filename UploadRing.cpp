@@ -0,0 +1,88 @@
+#include "UploadRing.h"
+
+UploadRing::UploadRing(ID3D12Device* device, FenceTimeline* timeline, UINT64 capacity) :
+	mTimeline(timeline),
+	mAllocator(capacity)
+{
+	auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	auto buffer = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+	ThrowIfFailed(device->CreateCommittedResource(
+		&heapProperties,
+		D3D12_HEAP_FLAG_NONE,
+		&buffer,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(mUploadBuffer.GetAddressOf())));
+
+	// Upload heaps may stay mapped for the lifetime of the resource.  We do not intend
+	// to read from this resource on the CPU.
+	CD3DX12_RANGE readRange(0, 0);
+	ThrowIfFailed(mUploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mMappedData)));
+	mGpuBase = mUploadBuffer->GetGPUVirtualAddress();
+}
+
+UploadRing::~UploadRing()
+{
+	if (mUploadBuffer != nullptr)
+		mUploadBuffer->Unmap(0, nullptr);
+	mMappedData = nullptr;
+}
+
+UploadRing::Allocation UploadRing::Allocate(UINT64 byteSize, UINT64 alignment)
+{
+	if (byteSize > mAllocator.Capacity())
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	Reclaim();
+
+	UINT64 offset = mAllocator.Allocate(byteSize, alignment);
+	while (offset == RingAllocator::InvalidOffset)
+	{
+		// Everything left belongs to commands that have not been submitted yet; waiting
+		// for the GPU would never free it.
+		UINT64 oldest = mAllocator.OldestPendingFence();
+		if (oldest == 0)
+			ThrowIfFailed(E_OUTOFMEMORY);
+
+		mTimeline->WaitFor(oldest);
+		Reclaim();
+		offset = mAllocator.Allocate(byteSize, alignment);
+	}
+
+	Allocation allocation;
+	allocation.Resource = mUploadBuffer.Get();
+	allocation.Offset = offset;
+	allocation.CpuAddress = mMappedData + offset;
+	allocation.GpuAddress = mGpuBase + offset;
+	return allocation;
+}
+
+void UploadRing::Submit(UINT64 fenceValue)
+{
+	mAllocator.FinishSubmission(fenceValue);
+}
+
+void UploadRing::Reclaim()
+{
+	mAllocator.ReleaseCompleted(mTimeline->CompletedValue());
+}
+
+void UploadRing::CopyBuffer(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* dest, UINT64 destOffset,
+	const void* data, UINT64 byteSize)
+{
+	Allocation allocation = Allocate(byteSize, 4);
+	memcpy(allocation.CpuAddress, data, static_cast<size_t>(byteSize));
+	cmdList->CopyBufferRegion(dest, destOffset, allocation.Resource, allocation.Offset, byteSize);
+}
+
+void UploadRing::CopySubresources(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* dest,
+	UINT firstSubresource, UINT numSubresources, D3D12_SUBRESOURCE_DATA* srcData)
+{
+	// GetRequiredIntermediateSize accounts for the row pitch and placement alignment of
+	// texture footprints; for buffers it is just the byte size.
+	UINT64 requiredSize = GetRequiredIntermediateSize(dest, firstSubresource, numSubresources);
+	Allocation allocation = Allocate(requiredSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+	UpdateSubresources(cmdList, dest, allocation.Resource, allocation.Offset,
+		firstSubresource, numSubresources, srcData);
+}
@@ -0,0 +1,63 @@
+//***************************************************************************************
+// UploadRing.h
+//
+// One persistently mapped UPLOAD buffer that every buffer/texture upload is staged in.
+// Space is sub-allocated with a RingAllocator and reclaimed once the fence value of the
+// submission that used it has completed.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FenceTimeline.h"
+#include "RingAllocator.h"
+
+class UploadRing
+{
+public:
+	struct Allocation
+	{
+		ID3D12Resource* Resource = nullptr;
+		UINT64 Offset = 0;
+		BYTE* CpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+	};
+
+	UploadRing(ID3D12Device* device, FenceTimeline* timeline, UINT64 capacity);
+	UploadRing(const UploadRing& rhs) = delete;
+	UploadRing& operator=(const UploadRing& rhs) = delete;
+	~UploadRing();
+
+	// Reserves byteSize bytes of staging memory.  If the ring is full, waits for the
+	// oldest submission still holding memory.  Throws if the request can never fit, or
+	// if the ring is full of memory that has not been submitted yet.
+	Allocation Allocate(UINT64 byteSize, UINT64 alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	// Tags everything allocated since the last call with the fence value that will be
+	// signaled after the command lists using it.  Call right after ExecuteCommandLists.
+	void Submit(UINT64 fenceValue);
+
+	// Returns the memory of every submission the GPU has finished with.
+	void Reclaim();
+
+	// Stages data and records a copy into dest at destOffset.  dest must be in the
+	// COPY_DEST state.
+	void CopyBuffer(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* dest, UINT64 destOffset,
+		const void* data, UINT64 byteSize);
+
+	// Stages the subresources and records the copies into dest (buffer or texture).
+	// dest must be in the COPY_DEST state.
+	void CopySubresources(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* dest,
+		UINT firstSubresource, UINT numSubresources, D3D12_SUBRESOURCE_DATA* srcData);
+
+	ID3D12Resource* Resource()const { return mUploadBuffer.Get(); }
+	const RingAllocator& Allocator()const { return mAllocator; }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
+	BYTE* mMappedData = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS mGpuBase = 0;
+
+	FenceTimeline* mTimeline = nullptr;
+	RingAllocator mAllocator;
+};
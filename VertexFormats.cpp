@@ -0,0 +1,173 @@
+#include "VertexFormats.h"
+#include <cstring>
+#include <type_traits>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+	const D3D12_INPUT_ELEMENT_DESC PositionColorElements[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	const D3D12_INPUT_ELEMENT_DESC PositionColorPackedElements[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	const D3D12_INPUT_ELEMENT_DESC HalfPositionColorElements[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	const D3D12_INPUT_ELEMENT_DESC QuantizedPositionColorElements[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	const D3D12_INPUT_ELEMENT_DESC PositionNormalTexCElements[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	const D3D12_INPUT_ELEMENT_DESC QuantizedPositionNormalTexCElements[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_SNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+	};
+
+	// InstanceData, in input slot 1: the world matrix as four rows, then the material.
+	const D3D12_INPUT_ELEMENT_DESC InstanceElements[] =
+	{
+		{ "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+		{ "MATERIAL", 0, DXGI_FORMAT_R32_UINT, 1, 64, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
+	};
+
+	struct FormatInfo
+	{
+		UINT Stride;
+		const D3D12_INPUT_ELEMENT_DESC* Elements;
+		UINT ElementCount;
+		bool QuantizedPositions;
+	};
+
+	const FormatInfo Formats[] =
+	{
+		{ 28, PositionColorElements, _countof(PositionColorElements), false },
+		{ 16, PositionColorPackedElements, _countof(PositionColorPackedElements), false },
+		{ 12, HalfPositionColorElements, _countof(HalfPositionColorElements), true },
+		{ 12, QuantizedPositionColorElements, _countof(QuantizedPositionColorElements), true },
+		{ 32, PositionNormalTexCElements, _countof(PositionNormalTexCElements), false },
+		{ 16, QuantizedPositionNormalTexCElements, _countof(QuantizedPositionNormalTexCElements), true }
+	};
+
+	static_assert(_countof(Formats) == (size_t)VertexFormat::Count, "Every VertexFormat needs a FormatInfo.");
+
+	template<typename T>
+	T* Advance(T* p, size_t stride, size_t i)
+	{
+		typedef typename std::conditional<std::is_const<T>::value, const unsigned char, unsigned char>::type Byte;
+		return reinterpret_cast<T*>(reinterpret_cast<Byte*>(p) + stride * i);
+	}
+}
+
+UINT GetVertexStride(VertexFormat format)
+{
+	return Formats[(size_t)format].Stride;
+}
+
+D3D12_INPUT_LAYOUT_DESC GetInputLayout(VertexFormat format)
+{
+	const FormatInfo& info = Formats[(size_t)format];
+	return { info.Elements, info.ElementCount };
+}
+
+D3D12_INPUT_LAYOUT_DESC GetInstanceInputLayout()
+{
+	return { InstanceElements, _countof(InstanceElements) };
+}
+
+bool HasQuantizedPositions(VertexFormat format)
+{
+	return Formats[(size_t)format].QuantizedPositions;
+}
+
+void PackPositionColorVertices(VertexFormat format, const XMFLOAT3* positions, size_t positionStride,
+	const XMFLOAT4* colors, size_t colorStride, size_t count, const PositionQuantization& quantization, void* dst)
+{
+	const size_t stride = GetVertexStride(format);
+	unsigned char* base = static_cast<unsigned char*>(dst);
+
+	switch (format)
+	{
+	case VertexFormat::PositionColor:
+		for (size_t i = 0; i < count; ++i)
+		{
+			memcpy(base + stride * i, Advance(positions, positionStride, i), sizeof(XMFLOAT3));
+			memcpy(base + stride * i + 12, Advance(colors, colorStride, i), sizeof(XMFLOAT4));
+		}
+		break;
+
+	case VertexFormat::PositionColorPacked:
+		for (size_t i = 0; i < count; ++i)
+			memcpy(base + stride * i, Advance(positions, positionStride, i), sizeof(XMFLOAT3));
+		VertexPacking::PackColorStream(reinterpret_cast<XMUBYTEN4*>(base + 12), stride, colors, colorStride, count);
+		break;
+
+	case VertexFormat::HalfPositionColor:
+		VertexPacking::HalfPositionStream(reinterpret_cast<XMHALF4*>(base), stride, positions, positionStride, count, quantization);
+		VertexPacking::PackColorStream(reinterpret_cast<XMUBYTEN4*>(base + 8), stride, colors, colorStride, count);
+		break;
+
+	case VertexFormat::QuantizedPositionColor:
+		VertexPacking::QuantizePositionStream(reinterpret_cast<XMSHORTN4*>(base), stride, positions, positionStride, count, quantization);
+		VertexPacking::PackColorStream(reinterpret_cast<XMUBYTEN4*>(base + 8), stride, colors, colorStride, count);
+		break;
+
+	default:
+		assert(false && "Not a position/color vertex format.");
+		break;
+	}
+}
+
+void PackPositionNormalTexCVertices(VertexFormat format, const XMFLOAT3* positions, size_t positionStride,
+	const XMFLOAT3* normals, size_t normalStride, const XMFLOAT2* texCoords, size_t texCoordStride,
+	size_t count, const PositionQuantization& quantization, void* dst)
+{
+	const size_t stride = GetVertexStride(format);
+	unsigned char* base = static_cast<unsigned char*>(dst);
+
+	switch (format)
+	{
+	case VertexFormat::PositionNormalTexC:
+		for (size_t i = 0; i < count; ++i)
+		{
+			memcpy(base + stride * i, Advance(positions, positionStride, i), sizeof(XMFLOAT3));
+			memcpy(base + stride * i + 12, Advance(normals, normalStride, i), sizeof(XMFLOAT3));
+			memcpy(base + stride * i + 24, Advance(texCoords, texCoordStride, i), sizeof(XMFLOAT2));
+		}
+		break;
+
+	case VertexFormat::QuantizedPositionNormalTexC:
+		VertexPacking::QuantizePositionStream(reinterpret_cast<XMSHORTN4*>(base), stride, positions, positionStride, count, quantization);
+		VertexPacking::OctahedralNormalStream(reinterpret_cast<XMSHORTN2*>(base + 8), stride, normals, normalStride, count);
+		VertexPacking::HalfTexCoordStream(reinterpret_cast<XMHALF2*>(base + 12), stride, texCoords, texCoordStride, count);
+		break;
+
+	default:
+		assert(false && "Not a position/normal/texcoord vertex format.");
+		break;
+	}
+}
@@ -0,0 +1,58 @@
+//***************************************************************************************
+// VertexFormats.h
+//
+// Vertex layouts, from full float to packed, with their input layouts and the functions
+// that write float data into them (with the kernels of VertexPacking.h).
+//
+//   Color     - R8G8B8A8_UNORM (XMUBYTEN4) instead of four floats.
+//   Position  - quantized formats store (p - Bias) / Scale in [-1, 1] as snorm16 or half;
+//               PositionQuantization::Dequantization() undoes it and is folded into the
+//               world matrix, so shaders read the position unchanged.
+//   Normal    - octahedral encoding in two snorm16 values.  Decode in the shader with
+//                 float3 n = float3(e.xy, 1 - abs(e.x) - abs(e.y));
+//                 float t = saturate(-n.z);
+//                 n.xy += n.xy >= 0 ? -t : t;
+//                 n = normalize(n);
+//   TexCoord  - half2.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "VertexPacking.h"
+
+enum class VertexFormat : std::uint32_t
+{
+	// float3 position, float4 color (28 bytes).
+	PositionColor,
+	// float3 position, rgba8 color (16 bytes).
+	PositionColorPacked,
+	// half4 quantized position, rgba8 color (12 bytes).
+	HalfPositionColor,
+	// snorm16x4 quantized position, rgba8 color (12 bytes).
+	QuantizedPositionColor,
+	// float3 position, float3 normal, float2 texcoord (32 bytes; ObjVertex).
+	PositionNormalTexC,
+	// snorm16x4 quantized position, octahedral snorm16x2 normal, half2 texcoord (16 bytes).
+	QuantizedPositionNormalTexC,
+
+	Count
+};
+
+UINT GetVertexStride(VertexFormat format);
+D3D12_INPUT_LAYOUT_DESC GetInputLayout(VertexFormat format);
+// The per-instance elements of InstanceData (InstanceBatcher.h), read from input slot 1.
+// Append them to a vertex format's elements to draw it instanced.
+D3D12_INPUT_LAYOUT_DESC GetInstanceInputLayout();
+bool HasQuantizedPositions(VertexFormat format);
+
+// Writes count interleaved vertices of a position/color format (PositionColor through
+// QuantizedPositionColor) to dst, which must hold count * GetVertexStride(format) bytes.
+void PackPositionColorVertices(VertexFormat format, const DirectX::XMFLOAT3* positions, size_t positionStride,
+	const DirectX::XMFLOAT4* colors, size_t colorStride, size_t count,
+	const PositionQuantization& quantization, void* dst);
+
+// Same for PositionNormalTexC and QuantizedPositionNormalTexC.
+void PackPositionNormalTexCVertices(VertexFormat format, const DirectX::XMFLOAT3* positions, size_t positionStride,
+	const DirectX::XMFLOAT3* normals, size_t normalStride, const DirectX::XMFLOAT2* texCoords, size_t texCoordStride,
+	size_t count, const PositionQuantization& quantization, void* dst);
@@ -0,0 +1,106 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+	template<typename T>
+	T* Advance(T* p, size_t stride, size_t i)
+	{
+		typedef typename std::conditional<std::is_const<T>::value, const unsigned char, unsigned char>::type Byte;
+		return reinterpret_cast<T*>(reinterpret_cast<Byte*>(p) + stride * i);
+	}
+}
+
+PositionQuantization PositionQuantization::FromBounds(const BoundingBox& bounds)
+{
+	PositionQuantization quantization;
+	quantization.Bias = bounds.Center;
+
+	// Keep a degenerate axis from dividing by zero.
+	quantization.Scale.x = bounds.Extents.x > 0.0f ? bounds.Extents.x : 1.0f;
+	quantization.Scale.y = bounds.Extents.y > 0.0f ? bounds.Extents.y : 1.0f;
+	quantization.Scale.z = bounds.Extents.z > 0.0f ? bounds.Extents.z : 1.0f;
+	return quantization;
+}
+
+XMMATRIX PositionQuantization::Dequantization()const
+{
+	return XMMatrixScaling(Scale.x, Scale.y, Scale.z) * XMMatrixTranslation(Bias.x, Bias.y, Bias.z);
+}
+
+void VertexPacking::PackColorStream(XMUBYTEN4* out, size_t outStride, const XMFLOAT4* in, size_t inStride, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		XMStoreUByteN4(Advance(out, outStride, i), XMLoadFloat4(Advance(in, inStride, i)));
+}
+
+void VertexPacking::QuantizePositionStream(XMSHORTN4* out, size_t outStride, const XMFLOAT3* in, size_t inStride,
+	size_t count, const PositionQuantization& quantization)
+{
+	XMVECTOR bias = XMLoadFloat3(&quantization.Bias);
+	XMVECTOR inverseScale = XMVectorReciprocal(XMLoadFloat3(&quantization.Scale));
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		XMVECTOR p = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(Advance(in, inStride, i)), bias), inverseScale);
+		XMStoreShortN4(Advance(out, outStride, i), XMVectorSetW(p, 1.0f));
+	}
+}
+
+void VertexPacking::HalfPositionStream(XMHALF4* out, size_t outStride, const XMFLOAT3* in, size_t inStride,
+	size_t count, const PositionQuantization& quantization)
+{
+	XMVECTOR bias = XMLoadFloat3(&quantization.Bias);
+	XMVECTOR inverseScale = XMVectorReciprocal(XMLoadFloat3(&quantization.Scale));
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		XMVECTOR p = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(Advance(in, inStride, i)), bias), inverseScale);
+		XMStoreHalf4(Advance(out, outStride, i), XMVectorSetW(p, 1.0f));
+	}
+}
+
+void VertexPacking::OctahedralNormalStream(XMSHORTN2* out, size_t outStride, const XMFLOAT3* in, size_t inStride,
+	size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		XMStoreShortN2(Advance(out, outStride, i), EncodeOctahedral(XMLoadFloat3(Advance(in, inStride, i))));
+}
+
+void VertexPacking::HalfTexCoordStream(XMHALF2* out, size_t outStride, const XMFLOAT2* in, size_t inStride,
+	size_t count)
+{
+	XMConvertFloatToHalfStream(&out->x, outStride, &in->x, inStride, count);
+	XMConvertFloatToHalfStream(&out->y, outStride, &in->y, inStride, count);
+}
+
+XMVECTOR XM_CALLCONV VertexPacking::EncodeOctahedral(FXMVECTOR n)
+{
+	// Project onto the octahedron |x| + |y| + |z| = 1 ...
+	XMVECTOR l1 = XMVectorSum(XMVectorAbs(XMVectorSetW(n, 0.0f)));
+	XMVECTOR p = XMVectorDivide(n, l1);
+
+	// ... and fold the lower hemisphere over the diagonals.
+	XMVECTOR signs = XMVectorSelect(XMVectorReplicate(-1.0f), g_XMOne, XMVectorGreaterOrEqual(p, XMVectorZero()));
+	XMVECTOR folded = XMVectorMultiply(XMVectorSubtract(g_XMOne, XMVectorAbs(XMVectorSwizzle<1, 0, 2, 3>(p))), signs);
+
+	return XMVectorGetZ(p) < 0.0f ? folded : p;
+}
+
+XMVECTOR XM_CALLCONV VertexPacking::DecodeOctahedral(FXMVECTOR e)
+{
+	XMVECTOR xy = XMVectorSetZ(XMVectorSetW(e, 0.0f), 0.0f);
+	float z = 1.0f - std::fabs(XMVectorGetX(e)) - std::fabs(XMVectorGetY(e));
+
+	// Unfold the lower hemisphere.
+	XMVECTOR t = XMVectorReplicate(std::max(-z, 0.0f));
+	XMVECTOR adjust = XMVectorSelect(t, XMVectorNegate(t), XMVectorGreaterOrEqual(xy, XMVectorZero()));
+	XMVECTOR n = XMVectorSetZ(XMVectorAdd(xy, adjust), z);
+
+	return XMVector3Normalize(n);
+}
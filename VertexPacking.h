@@ -0,0 +1,52 @@
+//***************************************************************************************
+// VertexPacking.h
+//
+// The kernels behind the packed vertex formats of VertexFormats.h: position quantization
+// to snorm16 or half, octahedral normals and half texture coordinates.  They only use
+// DirectXMath, so they can be tested without D3D.
+//
+// The stream kernels take strides like the DirectXMath stream functions, so they can
+// read from and write into interleaved vertices.
+//***************************************************************************************
+
+#pragma once
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <DirectXCollision.h>
+#include <cstddef>
+
+struct PositionQuantization
+{
+	DirectX::XMFLOAT3 Scale = { 1.0f, 1.0f, 1.0f };
+	DirectX::XMFLOAT3 Bias = { 0.0f, 0.0f, 0.0f };
+
+	// Maps bounds onto [-1, 1] on every axis.
+	static PositionQuantization FromBounds(const DirectX::BoundingBox& bounds);
+
+	// Quantized position to local space; multiply it in front of the world matrix.
+	DirectX::XMMATRIX Dequantization()const;
+};
+
+namespace VertexPacking
+{
+	void PackColorStream(DirectX::PackedVector::XMUBYTEN4* out, size_t outStride,
+		const DirectX::XMFLOAT4* in, size_t inStride, size_t count);
+
+	void QuantizePositionStream(DirectX::PackedVector::XMSHORTN4* out, size_t outStride,
+		const DirectX::XMFLOAT3* in, size_t inStride, size_t count, const PositionQuantization& quantization);
+
+	void HalfPositionStream(DirectX::PackedVector::XMHALF4* out, size_t outStride,
+		const DirectX::XMFLOAT3* in, size_t inStride, size_t count, const PositionQuantization& quantization);
+
+	// in must hold unit vectors.
+	void OctahedralNormalStream(DirectX::PackedVector::XMSHORTN2* out, size_t outStride,
+		const DirectX::XMFLOAT3* in, size_t inStride, size_t count);
+
+	void HalfTexCoordStream(DirectX::PackedVector::XMHALF2* out, size_t outStride,
+		const DirectX::XMFLOAT2* in, size_t inStride, size_t count);
+
+	// Octahedral encoding of a unit vector into [-1, 1]^2 and back.
+	DirectX::XMVECTOR XM_CALLCONV EncodeOctahedral(DirectX::FXMVECTOR n);
+	DirectX::XMVECTOR XM_CALLCONV DecodeOctahedral(DirectX::FXMVECTOR e);
+}
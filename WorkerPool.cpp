@@ -0,0 +1,100 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(std::uint32_t threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (std::uint32_t t = 1; t < threadCount; ++t)
+		mThreads.emplace_back([this]() { WorkerMain(); });
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread& thread : mThreads)
+		thread.join();
+}
+
+void WorkerPool::Run(std::uint32_t taskCount, const std::function<void(std::uint32_t)>& work)
+{
+	if (mThreads.empty() || taskCount <= 1)
+	{
+		for (std::uint32_t task = 0; task < taskCount; ++task)
+			work(task);
+		return;
+	}
+
+	{
+		// A worker that woke up late for the previous job may still be claiming from it.
+		std::unique_lock<std::mutex> lock(mMutex);
+		mDone.wait(lock, [this]() { return mBusyWorkers == 0; });
+
+		mWork = &work;
+		mTaskCount = taskCount;
+		mFinishedTasks = 0;
+		mNextTask.store(0);
+		++mGeneration;
+	}
+	mWake.notify_all();
+
+	RunTasks(&work, taskCount);
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this]() { return mFinishedTasks == mTaskCount; });
+	mWork = nullptr;
+}
+
+void WorkerPool::WorkerMain()
+{
+	std::uint64_t generation = 0;
+	for (;;)
+	{
+		const std::function<void(std::uint32_t)>* work;
+		std::uint32_t taskCount;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [&]() { return mStopping || mGeneration != generation; });
+			if (mStopping)
+				return;
+
+			generation = mGeneration;
+			work = mWork;
+			taskCount = mTaskCount;
+			++mBusyWorkers;
+		}
+
+		RunTasks(work, taskCount);
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			--mBusyWorkers;
+		}
+		mDone.notify_all();
+	}
+}
+
+void WorkerPool::RunTasks(const std::function<void(std::uint32_t)>* work, std::uint32_t taskCount)
+{
+	std::uint32_t finished = 0;
+	for (std::uint32_t task = mNextTask.fetch_add(1); task < taskCount; task = mNextTask.fetch_add(1))
+	{
+		(*work)(task);
+		++finished;
+	}
+
+	if (finished == 0)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mFinishedTasks += finished;
+	}
+	mDone.notify_all();
+}
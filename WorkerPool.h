@@ -0,0 +1,60 @@
+//***************************************************************************************
+// WorkerPool.h
+//
+// A fixed set of worker threads that per-frame jobs (culling, sorting) are spread over,
+// so no thread is created or joined while the sample runs.  Run hands out task indices
+// to the workers and the calling thread, which all take the next unclaimed index until
+// none are left, and returns once every task has finished.
+//
+// One Run at a time: the pool belongs to the thread that owns the frame.  Nothing here
+// touches D3D.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+public:
+	// threadCount counts the calling thread; 0 uses every hardware thread.
+	explicit WorkerPool(std::uint32_t threadCount = 0);
+	~WorkerPool();
+	WorkerPool(const WorkerPool& rhs) = delete;
+	WorkerPool& operator=(const WorkerPool& rhs) = delete;
+
+	// Threads Run spreads tasks over, the calling thread included.
+	std::uint32_t ThreadCount()const { return (std::uint32_t)mThreads.size() + 1; }
+
+	// Runs work(0) .. work(taskCount - 1) and waits for all of them.
+	void Run(std::uint32_t taskCount, const std::function<void(std::uint32_t)>& work);
+
+private:
+	void WorkerMain();
+	// Runs tasks of the current job until none are left.
+	void RunTasks(const std::function<void(std::uint32_t)>* work, std::uint32_t taskCount);
+
+	std::vector<std::thread> mThreads;
+
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::condition_variable mDone;
+
+	// The current job, guarded by mMutex.  mGeneration counts jobs so sleeping workers
+	// can tell a new one from the one they already worked on.
+	const std::function<void(std::uint32_t)>* mWork = nullptr;
+	std::uint32_t mTaskCount = 0;
+	std::uint64_t mGeneration = 0;
+	std::uint32_t mFinishedTasks = 0;
+	// Workers inside RunTasks; a new job waits for them to leave the previous one.
+	std::uint32_t mBusyWorkers = 0;
+	bool mStopping = false;
+
+	std::atomic<std::uint32_t> mNextTask{ 0 };
+};
@@ -27,6 +27,8 @@
 #include <cassert>
 #include "d3dx12.h"
 #include "MathHelper.h"
+#include "SubmeshTable.h"
+#include "Meshlets.h"
 
 extern const int gNumFrameResources;
 
@@ -171,9 +173,13 @@ struct MeshGeometry
 	UINT IndexBufferByteSize = 0;
 
 	// A MeshGeometry may store multiple geometries in one vertex/index buffer.
-	// Use this container to define the Submesh geometries so we can draw
-	// the Submeshes individually.
-	std::unordered_map<std::string, SubmeshGeometry> DrawArgs;
+	// Use this table to define the Submesh geometries so we can draw
+	// the Submeshes individually.  Resolve names to handles once at load time.
+	SubmeshTable Submeshes;
+
+	// Clusters for CPU culling, indexed by submesh handle; empty unless the loader built
+	// them.  Their vertex indices are relative to the submesh's base vertex.
+	MeshletSet Meshlets;
 
 	D3D12_VERTEX_BUFFER_VIEW VertexBufferView()const
 	{
@@ -2,14 +2,36 @@
 
 #include <windowsx.h>
 #include "d3dUtil.h"
+#include "FrameResource.h"
+#include "FrameFenceRing.h"
+#include "FenceTimeline.h"
+#include "D3D12FenceBackend.h"
+#include "UploadRing.h"
+#include "UploadBatch.h"
+#include "GpuHeapAllocator.h"
+#include "DescriptorAllocator.h"
+#include "D3D12StateTracker.h"
+#include "D3D12RenderGraph.h"
+#include "VertexFormats.h"
+#include "GeometryBuffer.h"
+#include "BoundingVolumeTree.h"
+#include "TransformHierarchy.h"
+#include "RenderItemStore.h"
+#include "OcclusionCuller.h"
+#include "InstanceBatcher.h"
+#include "DrawPackets.h"
+#include "D3D12DrawStateCache.h"
+#include "WorkerPool.h"
 #include <d3dcompiler.h>
 
 using namespace DirectX;
 
-struct ObjectConstants
-{
-	DirectX::XMFLOAT4X4 WorldViewProj = MathHelper::Identity4x4();
-};
+const int gNumFrameResources = 3;
+// Largest geometric error of an LOD on screen, in pixels.
+const float gLodPixelError = 1.0f;
+// Size of the software depth buffer used for occlusion culling.
+const std::uint32_t gOcclusionWidth = 256;
+const std::uint32_t gOcclusionHeight = 128;
 
 struct Vertex
 {
@@ -17,16 +39,25 @@ struct Vertex
 	XMFLOAT4 Color;
 };
 
+// A pipeline state with the pass it draws in and the index of its root signature in
+// mRootSignatures, for the draw sort keys.
+struct MyPipeline
+{
+	ID3D12PipelineState* State = nullptr;
+	std::uint32_t RootSignature = 0;
+	std::uint32_t Pass = 0;
+};
+
 struct MyMeshGeometry
 {
-	Microsoft::WRL::ComPtr<ID3D12Resource> VertexBuffer = nullptr;
-	Microsoft::WRL::ComPtr<ID3D12Resource> IndexBuffer = nullptr;
-	D3D12_VERTEX_BUFFER_VIEW VertexBufferView;
-	D3D12_INDEX_BUFFER_VIEW IndexBufferView;
-	UINT VertexBufferStride = 0;
-	UINT VertexBufferOffset = 0;
-	UINT IndexBufferFormat = DXGI_FORMAT_R16_UINT;
-	UINT IndexBufferOffset = 0;
+	// Vertices and indices live in mGeometryBuffer; submesh locations are relative to it.
+	GeometryHandle Geometry = GeometryBuffer::InvalidHandle;
+	SubmeshTable Submeshes;
+	// Identity unless the vertex format quantizes positions.
+	PositionQuantization Quantization;
+	// A coarse CPU copy for the occlusion culler, in unquantized local space.
+	std::vector<XMFLOAT3> OccluderPositions;
+	std::vector<std::uint32_t> OccluderIndices;
 };
 
 HINSTANCE								g_hInstance;
@@ -40,8 +71,18 @@ IDXGIFactory4							*mdxgiFactory;
 IDXGISwapChain							*mSwapChain;
 ID3D12Device							*md3dDevice;
 
-ID3D12Fence								*mFence;
-UINT64									mCurrentFence = 0;
+std::unique_ptr<D3D12FenceBackend>		mFenceBackend;
+std::unique_ptr<FenceTimeline>			mFenceTimeline;
+std::unique_ptr<UploadRing>				mUploadRing;
+std::unique_ptr<UploadBatch>			mUploadBatch;
+
+// Default-heap memory is placed inside a few large heaps instead of one committed
+// resource per object.  Resource heap tier 1 needs buffers and RT/DS textures apart.
+std::unique_ptr<GpuHeapAllocator>		mBufferHeap;
+std::unique_ptr<GpuHeapAllocator>		mRtDsHeap;
+
+// Every mesh is sub-allocated from one vertex buffer per format and one index buffer.
+std::unique_ptr<GeometryBuffer>			mGeometryBuffer;
 
 ID3D12CommandQueue						*mCommandQueue;
 ID3D12CommandAllocator					*mDirectCmdListAlloc;
@@ -51,9 +92,16 @@ static const int						SwapChainBufferCount = 2;
 int										mCurrBackBuffer = 0;
 ID3D12Resource							*mSwapChainBuffer[SwapChainBufferCount];
 ID3D12Resource							*mDepthStencilBuffer;
+GpuHeapAllocator::Allocation			mDepthStencilAllocation;
+
+// Current state of the swap chain and depth buffers; transitions are inferred from it.
+D3D12StateTracker						mStateTracker;
+std::unique_ptr<D3D12RenderGraph>		mRenderGraph;
 
-ID3D12DescriptorHeap					*mRtvHeap;
-ID3D12DescriptorHeap					*mDsvHeap;
+std::unique_ptr<StagingDescriptorHeap>	mRtvHeap;
+std::unique_ptr<StagingDescriptorHeap>	mDsvHeap;
+DescriptorRange							mBackBufferRtvs;
+DescriptorRange							mDepthStencilDsv;
 
 D3D12_VIEWPORT							mScreenViewport;
 D3D12_RECT								mScissorRect;
@@ -70,15 +118,24 @@ int										g_ClientWidth = 800;
 int										g_ClientHeight = 600;
 
 ID3D12RootSignature						*mRootSignature = nullptr;
-ID3D12DescriptorHeap					*mCbvHeap = nullptr;
+std::vector<ID3D12RootSignature*>		mRootSignatures;
+std::unique_ptr<GpuDescriptorHeap>		mGpuDescriptorHeap;
 
 ID3DBlob								*mvsByteCode = nullptr;
 ID3DBlob								*mpsByteCode = nullptr;
 
-std::vector<D3D12_INPUT_ELEMENT_DESC>	mInputLayout;
+// Layout the box vertices are packed into; the input layout is its elements followed by
+// the per-instance ones.
+VertexFormat							mVertexFormat = VertexFormat::QuantizedPositionColor;
+std::vector<D3D12_INPUT_ELEMENT_DESC>	mInputElements;
+D3D12_INPUT_LAYOUT_DESC					mInputLayout;
 ID3D12PipelineState						*mPSO = nullptr;
+// Render items refer to pipeline states by their index in here.
+std::vector<MyPipeline>					mPipelines;
 
-XMFLOAT4X4								 mWorld = MathHelper::Identity4x4();
+// Object transforms; Update recomputes the world matrices of the nodes that moved.
+TransformHierarchy						mTransforms;
+std::uint32_t							mBoxTransform = TransformHierarchy::InvalidNode;
 XMFLOAT4X4								 mView = MathHelper::Identity4x4();
 XMFLOAT4X4								 mProj = MathHelper::Identity4x4();
 
@@ -86,36 +143,69 @@ float									mTheta = 1.5f * XM_PI;
 float									mPhi = XM_PIDIV4;
 float									mRadius = 5.0f;
 
-ID3D12Resource*							constantBuffer;
+std::vector<std::unique_ptr<FrameResource>>	mFrameResources;
+FrameResource							*mCurrFrameResource = nullptr;
+FrameFenceRing							mFrameRing(gNumFrameResources);
+
+// Everything that can be drawn.
+RenderItemStore							mRenderItems;
+RenderItemHandle						mBoxItem;
+
+// Update culls the render items into mVisibleObjects (item positions), picks the LOD of
+// each in mVisibleSubmeshes, and Draw only records those.  The culling jobs run on
+// mWorkerPool.
+WorkerPool								mWorkerPool;
+std::vector<std::uint32_t>				mVisibleObjects;
+std::vector<SubmeshHandle>				mVisibleSubmeshes;
+
+// Frustum survivors hidden behind occluders are dropped from mVisibleObjects too.
+OcclusionCuller							mOcclusionCuller(gOcclusionWidth, gOcclusionHeight);
+
+// The same items in a hierarchy, for picking with the mouse.  Leaves hold render item
+// slots; mPickedObject is the last one clicked.
+BoundingVolumeTree						mSceneTree;
+std::uint32_t							mBoxTreeProxy = BoundingVolumeTree::InvalidNode;
+std::uint32_t							mPickedObject = BoundingVolumeTree::InvalidNode;
+
+// Visible items that share a pipeline state, geometry and submesh are drawn as one
+// instanced batch.  The instance data and pass constants live in the frame's arena.
+InstanceBatcher							mInstanceBatcher;
+D3D12_VERTEX_BUFFER_VIEW				mInstanceBufferView = {};
+D3D12_GPU_VIRTUAL_ADDRESS				mPassCBAddress = 0;
+InstancingStats							mReportedInstancing;
+
+// The visible items are drawn in the order of their sort keys, which group them by
+// state and then front to back.  mDrawState drops repeated state changes.
+DrawPacketList							mDrawPackets;
+std::vector<std::uint32_t>				mSortedObjects;
+std::vector<SubmeshHandle>				mSortedSubmeshes;
+D3D12DrawStateCache						mDrawState;
 
 bool									Init();
 bool									Build();
 int										Run();
 
 MyMeshGeometry mBoxGeo; // Define mBoxGeo
+SubmeshHandle mBoxSubmesh = SubmeshTable::InvalidHandle;
 
 void FlushCommandQueue()
 {
-	// Advance the fence value to mark commands up to this fence point.
-	mCurrentFence++;
-
-	// Add an instruction to the command queue to set a new fence point.  Because we 
-	// are on the GPU timeline, the new fence point won't be set until the GPU finishes
-	// processing all the commands prior to this Signal().
-	mCommandQueue->Signal(mFence, mCurrentFence);
-
-	// Wait until the GPU has completed commands up to this fence point.
-	if (mFence->GetCompletedValue() < mCurrentFence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, nullptr, TRUE, EVENT_ALL_ACCESS);
+	// Signal a new fence point and wait until the GPU has completed commands up to it.
+	mFenceTimeline->Flush();
+}
 
-		// Fire event when GPU hits current fence.  
-		mFence->SetEventOnCompletion(mCurrentFence, eventHandle);
+// Shows the draw calls instancing saved this frame in the window title.  The title is
+// only set when the numbers change, which keeps the window messages out of most frames.
+void ReportInstancing()
+{
+	const InstancingStats& instancing = mInstanceBatcher.Stats();
+	if (instancing.Items == mReportedInstancing.Items && instancing.Draws == mReportedInstancing.Draws)
+		return;
 
-		// Wait until the GPU hits current fence event is fired.
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
+	std::wstring title = L"App - " + std::to_wstring(instancing.Items) + L" items in " +
+		std::to_wstring(instancing.Draws) + L" draws (" + std::to_wstring(instancing.SavedDraws()) + L" saved)";
+	SetWindowText(g_mainWindow, title.c_str());
+	mReportedInstancing = instancing;
 }
 
 void OnResize()
@@ -127,8 +217,15 @@ void OnResize()
 
 	// Release the previous resources we will be recreating.
 	for (int i = 0; i < SwapChainBufferCount; ++i)
+	{
+		if (mSwapChainBuffer[i] != nullptr)
+			mStateTracker.Unregister(mSwapChainBuffer[i]);
 		mSwapChainBuffer[i] = nullptr;
+	}
+	if (mDepthStencilBuffer != nullptr)
+		mStateTracker.Unregister(mDepthStencilBuffer);
 	mDepthStencilBuffer = nullptr;
+	mRtDsHeap->Free(mDepthStencilAllocation);
 
 	// Resize the swap chain.
 	mSwapChain->ResizeBuffers(
@@ -139,12 +236,11 @@ void OnResize()
 
 	mCurrBackBuffer = 0;
 
-	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(mRtvHeap->GetCPUDescriptorHandleForHeapStart());
 	for (UINT i = 0; i < SwapChainBufferCount; i++)
 	{
 		mSwapChain->GetBuffer(i, IID_PPV_ARGS(&mSwapChainBuffer[i]));
-		md3dDevice->CreateRenderTargetView(mSwapChainBuffer[i], nullptr, rtvHeapHandle);
-		rtvHeapHandle.Offset(1, mRtvDescriptorSize);
+		mStateTracker.Register(mSwapChainBuffer[i], D3D12_RESOURCE_STATE_PRESENT);
+		md3dDevice->CreateRenderTargetView(mSwapChainBuffer[i], nullptr, mBackBufferRtvs.Cpu(i));
 	}
 
 	// Create the depth/stencil buffer and view.
@@ -165,14 +261,9 @@ void OnResize()
 	optClear.Format = mDepthStencilFormat;
 	optClear.DepthStencil.Depth = 1.0f;
 	optClear.DepthStencil.Stencil = 0;
-	auto heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-	md3dDevice->CreateCommittedResource(
-		&heapProperties,
-		D3D12_HEAP_FLAG_NONE,
-		&depthStencilDesc,
-		D3D12_RESOURCE_STATE_COMMON,
-		&optClear,
-		IID_PPV_ARGS(&mDepthStencilBuffer));
+	mDepthStencilAllocation = mRtDsHeap->CreateResource(depthStencilDesc, D3D12_RESOURCE_STATE_COMMON, &optClear);
+	mDepthStencilBuffer = mDepthStencilAllocation.Resource.Get();
+	mStateTracker.Register(mDepthStencilBuffer, D3D12_RESOURCE_STATE_COMMON);
 
 	// Create descriptor to mip level 0 of entire resource using the format of the resource.
 	D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc;
@@ -180,12 +271,11 @@ void OnResize()
 	dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
 	dsvDesc.Format = mDepthStencilFormat;
 	dsvDesc.Texture2D.MipSlice = 0;
-	md3dDevice->CreateDepthStencilView(mDepthStencilBuffer, &dsvDesc, mDsvHeap->GetCPUDescriptorHandleForHeapStart());
+	md3dDevice->CreateDepthStencilView(mDepthStencilBuffer, &dsvDesc, mDepthStencilDsv.CpuStart);
 
 	// Transition the resource from its initial state to be used as a depth buffer.
-	auto resourceBarrier = CD3DX12_RESOURCE_BARRIER::Transition(mDepthStencilBuffer,
-		D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE);
-	mCommandList->ResourceBarrier(1, &resourceBarrier);
+	mStateTracker.Transition(mDepthStencilBuffer, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+	mStateTracker.FlushBarriers(mCommandList);
 
 	// Execute the resize commands.
 	mCommandList->Close();
@@ -206,6 +296,24 @@ void OnResize()
 	mScissorRect = { 0, 0, g_ClientWidth, g_ClientHeight };
 }
 
+// The render item slot of the object under the pixel, or BoundingVolumeTree::InvalidNode.
+std::uint32_t Pick(int sx, int sy)
+{
+	// The ray through the pixel, in view space and then in world space.
+	float vx = (2.0f * sx / g_ClientWidth - 1.0f) / mProj(0, 0);
+	float vy = (-2.0f * sy / g_ClientHeight + 1.0f) / mProj(1, 1);
+
+	XMMATRIX view = XMLoadFloat4x4(&mView);
+	XMVECTOR determinant = XMMatrixDeterminant(view);
+	XMMATRIX invView = XMMatrixInverse(&determinant, view);
+
+	XMVECTOR rayOrigin = XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), invView);
+	XMVECTOR rayDir = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(vx, vy, 1.0f, 0.0f), invView));
+
+	std::uint32_t proxy = mSceneTree.RayCast(rayOrigin, rayDir, MathHelper::Infinity);
+	return proxy != BoundingVolumeTree::InvalidNode ? mSceneTree.UserData(proxy) : BoundingVolumeTree::InvalidNode;
+}
+
 LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
 	switch (msg)
@@ -225,6 +333,10 @@ LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 		PostQuitMessage(0);
 		return 0;
 
+	case WM_LBUTTONDOWN:
+		mPickedObject = Pick(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+		return 0;
+
 	case WM_KEYUP:
 		if (wParam == VK_ESCAPE)
 		{
@@ -345,22 +457,12 @@ void CreateSwapChain()
 
 void CreateRtvAndDsvDescriptorHeaps()
 {
-	D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc;
-	rtvHeapDesc.NumDescriptors = SwapChainBufferCount;
-	rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-	rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-	rtvHeapDesc.NodeMask = 0;
-	md3dDevice->CreateDescriptorHeap(
-		&rtvHeapDesc, IID_PPV_ARGS(&mRtvHeap));
-
-
-	D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc;
-	dsvHeapDesc.NumDescriptors = 1;
-	dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-	dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-	dsvHeapDesc.NodeMask = 0;
-	md3dDevice->CreateDescriptorHeap(
-		&dsvHeapDesc, IID_PPV_ARGS(&mDsvHeap));
+	// Sized for more than the swap chain so off-screen targets can be added later.
+	mRtvHeap = std::make_unique<StagingDescriptorHeap>(md3dDevice, D3D12_DESCRIPTOR_HEAP_TYPE_RTV, 64);
+	mDsvHeap = std::make_unique<StagingDescriptorHeap>(md3dDevice, D3D12_DESCRIPTOR_HEAP_TYPE_DSV, 16);
+
+	mBackBufferRtvs = mRtvHeap->Allocate(SwapChainBufferCount);
+	mDepthStencilDsv = mDsvHeap->Allocate(1);
 }
 
 bool InitDirect3D()
@@ -385,9 +487,6 @@ bool InitDirect3D()
 			IID_PPV_ARGS(&md3dDevice));
 	}
 
-	md3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE,
-		IID_PPV_ARGS(&mFence));
-
 	mRtvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	mDsvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
 	mCbvSrvUavDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
@@ -405,6 +504,26 @@ bool InitDirect3D()
 	m4xMsaaQuality = msQualityLevels.NumQualityLevels;
 
 	CreateCommandObjects();
+
+	mFenceBackend = std::make_unique<D3D12FenceBackend>(md3dDevice, mCommandQueue);
+	mFenceTimeline = std::make_unique<FenceTimeline>(mFenceBackend.get());
+
+	// Staging memory shared by every buffer and texture upload.
+	mUploadRing = std::make_unique<UploadRing>(md3dDevice, mFenceTimeline.get(), 16 * 1024 * 1024);
+
+	mBufferHeap = std::make_unique<GpuHeapAllocator>(md3dDevice, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
+	mRtDsHeap = std::make_unique<GpuHeapAllocator>(md3dDevice, D3D12_HEAP_TYPE_DEFAULT,
+		D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES, 64 * 1024 * 1024, D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	mUploadBatch = std::make_unique<UploadBatch>(md3dDevice, mCommandQueue, mFenceTimeline.get(), mUploadRing.get(),
+		mBufferHeap.get());
+
+	mGeometryBuffer = std::make_unique<GeometryBuffer>(mBufferHeap.get(), mUploadBatch.get(), mFenceTimeline.get(),
+		&mStateTracker, 1024 * 1024, 16 * 1024 * 1024);
+
+	mRenderGraph = std::make_unique<D3D12RenderGraph>(md3dDevice, &mStateTracker, mFenceTimeline.get());
+
 	CreateSwapChain();
 	CreateRtvAndDsvDescriptorHeaps();
 
@@ -420,49 +539,18 @@ bool Init()
 		return 0;
 }
 
-void BuildDescriptorHeaps()
+void BuildFrameResources()
 {
-	D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-	cbvHeapDesc.NumDescriptors = 1;
-	cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	cbvHeapDesc.NodeMask = 0;
-	md3dDevice->CreateDescriptorHeap(&cbvHeapDesc,
-		IID_PPV_ARGS(&mCbvHeap));
+	for (int i = 0; i < gNumFrameResources; ++i)
+		mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice, 1));
 }
 
-void BuildConstantBuffers()
+void BuildDescriptorHeaps()
 {
-	// Calculate constant buffer size
-	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
-
-	// Create a committed resource
-	
-	auto heapProperties3 = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	auto buffer3 = CD3DX12_RESOURCE_DESC::Buffer(objCBByteSize);
-	md3dDevice->CreateCommittedResource(
-		&heapProperties3,
-		D3D12_HEAP_FLAG_NONE,
-		&buffer3,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&constantBuffer));
-
-	// Map the resource
-	UINT8* cbvDataBegin;
-	CD3DX12_RANGE readRange(0, 0); // We do not intend to read from this resource on the CPU.
-	constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&cbvDataBegin));
-
-	// Build the constant buffer view descriptor
-	D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc = {};
-	cbvDesc.BufferLocation = constantBuffer->GetGPUVirtualAddress();
-	cbvDesc.SizeInBytes = objCBByteSize;
-
-	// Create the constant buffer view
-	md3dDevice->CreateConstantBufferView(&cbvDesc, mCbvHeap->GetCPUDescriptorHandleForHeapStart());
-
-	// Unmap the resource (not strictly necessary since it's an UPLOAD heap, but good practice)
-	constantBuffer->Unmap(0, nullptr);
+	// The one shader-visible CBV/SRV/UAV heap: a static region for persistent views and
+	// a dynamic ring for per-frame tables.  Pass constants are bound as a root CBV
+	// straight from the frame's constant buffer arena and do not use it.
+	mGpuDescriptorHeap = std::make_unique<GpuDescriptorHeap>(md3dDevice, mFenceTimeline.get(), 4096, 16384);
 }
 
 void BuildRootSignature()
@@ -471,16 +559,15 @@ void BuildRootSignature()
 	// Root parameter can be a table, root descriptor or root constants.
 	CD3DX12_ROOT_PARAMETER slotRootParameter[1];
 
-	// Create a single descriptor table of CBVs.
-	CD3DX12_DESCRIPTOR_RANGE cbvTable;
-	cbvTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
-	slotRootParameter[0].InitAsDescriptorTable(1, &cbvTable);
+	// Pass constants are a root CBV addressed by GPU virtual address; per-object data
+	// comes in through the per-instance vertex stream.
+	slotRootParameter[0].InitAsConstantBufferView(0);
 
 	// A root signature is an array of root parameters.
 	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(1, slotRootParameter, 0, nullptr,
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
-	// create a root signature with a single slot which points to a descriptor range consisting of a single constant buffer
+	// create a root signature with a single slot which holds a root constant buffer view
 	ID3DBlob *serializedRootSig = nullptr;
 	ID3DBlob *errorBlob = nullptr;
 	HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
@@ -497,6 +584,7 @@ void BuildRootSignature()
 		serializedRootSig->GetBufferPointer(),
 		serializedRootSig->GetBufferSize(),
 		IID_PPV_ARGS(&mRootSignature)));
+	mRootSignatures.push_back(mRootSignature);
 }
 
 ID3DBlob *CompileShader(
@@ -529,11 +617,12 @@ void BuildShadersAndInputLayout()
 	mvsByteCode = CompileShader(L"Shaders\\color.hlsl", nullptr, "VS", "vs_5_0");
 	mpsByteCode = CompileShader(L"Shaders\\color.hlsl", nullptr, "PS", "ps_5_0");
 
-	mInputLayout =
-	{
-		{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
-	};
+	D3D12_INPUT_LAYOUT_DESC vertexLayout = GetInputLayout(mVertexFormat);
+	D3D12_INPUT_LAYOUT_DESC instanceLayout = GetInstanceInputLayout();
+	mInputElements.assign(vertexLayout.pInputElementDescs, vertexLayout.pInputElementDescs + vertexLayout.NumElements);
+	mInputElements.insert(mInputElements.end(), instanceLayout.pInputElementDescs,
+		instanceLayout.pInputElementDescs + instanceLayout.NumElements);
+	mInputLayout = { mInputElements.data(), (UINT)mInputElements.size() };
 }
 
 void BuildBoxGeometry()
@@ -573,26 +662,36 @@ void BuildBoxGeometry()
 		4, 3, 7
 	};
 
-	const UINT vbByteSize = static_cast<UINT>(vertices.size()) * sizeof(Vertex);
-	const UINT ibByteSize = static_cast<UINT>(indices.size()) * sizeof(std::uint16_t);
+	MeshBounds bounds = ComputeMeshBounds(&vertices[0].Pos.x, sizeof(Vertex), vertices.size());
 
-	// Create vertex buffer
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertexUploadBuffer;
-	mBoxGeo.VertexBuffer = d3dUtil::CreateDefaultBuffer(md3dDevice, mCommandList, vertices.data(), vbByteSize, vertexUploadBuffer);
+	// Pack the float vertices into the selected layout.
+	if (HasQuantizedPositions(mVertexFormat))
+		mBoxGeo.Quantization = PositionQuantization::FromBounds(bounds.Box);
 
-	// Initialize vertex buffer view
-	mBoxGeo.VertexBufferView.BufferLocation = mBoxGeo.VertexBuffer->GetGPUVirtualAddress();
-	mBoxGeo.VertexBufferView.StrideInBytes = sizeof(Vertex);
-	mBoxGeo.VertexBufferView.SizeInBytes = vbByteSize;
+	const UINT vbStride = GetVertexStride(mVertexFormat);
+	std::vector<std::uint8_t> packedVertices(vertices.size() * vbStride);
+	PackPositionColorVertices(mVertexFormat, &vertices[0].Pos, sizeof(Vertex), &vertices[0].Color, sizeof(Vertex),
+		vertices.size(), mBoxGeo.Quantization, packedVertices.data());
 
-	// Create index buffer
-	Microsoft::WRL::ComPtr<ID3D12Resource> indexUploadBuffer;
-	mBoxGeo.IndexBuffer = d3dUtil::CreateDefaultBuffer(md3dDevice, mCommandList, indices.data(), ibByteSize, indexUploadBuffer);
+	mBoxGeo.Geometry = mGeometryBuffer->Add(mVertexFormat, packedVertices.data(), (UINT)vertices.size(),
+		indices.data(), (UINT)indices.size());
+	if (mBoxGeo.Geometry == GeometryBuffer::InvalidHandle)
+		ThrowIfFailed(E_OUTOFMEMORY);
 
-	// Initialize index buffer view
-	mBoxGeo.IndexBufferView.BufferLocation = mBoxGeo.IndexBuffer->GetGPUVirtualAddress();
-	mBoxGeo.IndexBufferView.Format = DXGI_FORMAT_R16_UINT;
-	mBoxGeo.IndexBufferView.SizeInBytes = ibByteSize;
+	mBoxSubmesh = mBoxGeo.Submeshes.Add("box", (UINT)indices.size(), 0, 0);
+
+	// The box is its own coarsest LOD, so it occludes with its full mesh.
+	for (const Vertex& vertex : vertices)
+		mBoxGeo.OccluderPositions.push_back(vertex.Pos);
+	mBoxGeo.OccluderIndices.assign(indices.begin(), indices.end());
+	mBoxGeo.Submeshes.SetBounds(mBoxSubmesh, bounds);
+	mBoxTransform = mTransforms.Add();
+	mBoxItem = mRenderItems.Create(mBoxGeo.Geometry, mBoxSubmesh, 0, 0, MathHelper::Identity4x4(), bounds.Box);
+	mBoxTreeProxy = mSceneTree.Insert(bounds.Box, mBoxItem.Slot);
+
+	// Vertex and index uploads go out in one submission; the source arrays only have to
+	// live until here.
+	mUploadBatch->Submit();
 }
 
 
@@ -600,7 +699,7 @@ void BuildPSO()
 {
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc;
 	ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
-	psoDesc.InputLayout = { mInputLayout.data(), (UINT)mInputLayout.size() };
+	psoDesc.InputLayout = mInputLayout;
 	psoDesc.pRootSignature = mRootSignature;
 	psoDesc.VS =
 	{
@@ -623,14 +722,20 @@ void BuildPSO()
 	psoDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
 	psoDesc.DSVFormat = mDepthStencilFormat;
 	md3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&mPSO));
+
+	MyPipeline pipeline;
+	pipeline.State = mPSO;
+	pipeline.RootSignature = 0;
+	pipeline.Pass = 0;
+	mPipelines.push_back(pipeline);
 }
 
 bool Build()
 {
 	mCommandList->Reset(mDirectCmdListAlloc, nullptr);
 
+	BuildFrameResources();
 	BuildDescriptorHeaps();
-	BuildConstantBuffers();
 	BuildRootSignature();
 	BuildShadersAndInputLayout();
 	BuildBoxGeometry();
@@ -645,8 +750,18 @@ bool Build()
 	return 1;
 }
 
-void Update(ID3D12Resource* constantBuffer)
+void Update()
 {
+	// Cycle through the circular frame resource array.  If the GPU has not finished
+	// processing the commands of the slot we are about to reuse, wait until it has.
+	mFrameRing.Advance();
+	mCurrFrameResource = mFrameResources[mFrameRing.CurrentIndex()].get();
+	if (!mFenceTimeline->IsComplete(mFrameRing.PendingFence()))
+		mFenceTimeline->WaitFor(mFrameRing.PendingFence());
+
+	// Release anything that was waiting on frames the GPU has finished.
+	mFenceTimeline->RetireCompleted();
+
 	// Convert Spherical to Cartesian coordinates.
 	float x = mRadius * sinf(mPhi) * cosf(mTheta);
 	float z = mRadius * sinf(mPhi) * sinf(mTheta);
@@ -660,79 +775,161 @@ void Update(ID3D12Resource* constantBuffer)
 	XMMATRIX view = XMMatrixLookAtLH(pos, target, up);
 	XMStoreFloat4x4(&mView, view);
 
-	XMMATRIX world = XMLoadFloat4x4(&mWorld);
+	// World matrices and bounds only change with the transform.  Quantized positions are
+	// expanded back to local space as part of the world matrix.
+	mTransforms.Update();
+	if (mTransforms.Changed(mBoxTransform))
+	{
+		const XMMATRIX boxWorld = XMLoadFloat4x4(&mTransforms.World(mBoxTransform));
+		XMFLOAT4X4 world;
+		XMStoreFloat4x4(&world, mBoxGeo.Quantization.Dequantization() * boxWorld);
+		BoundingBox boxWorldBounds;
+		mBoxGeo.Submeshes.Bounds(mBoxSubmesh).Transform(boxWorldBounds, boxWorld);
+
+		mRenderItems.SetWorld(mBoxItem, world, boxWorldBounds);
+		mSceneTree.Move(mBoxTreeProxy, boxWorldBounds);
+	}
+
+	// Cull in world space against the planes of view * proj.
 	XMMATRIX proj = XMLoadFloat4x4(&mProj);
-	XMMATRIX worldViewProj = world * view * proj;
+	XMMATRIX viewProj = view * proj;
+	XMFLOAT4X4 viewProjF;
+	XMStoreFloat4x4(&viewProjF, viewProj);
+	float frustumPlanes[6][4];
+	Meshlets::ExtractFrustumPlanes(&viewProjF.m[0][0], frustumPlanes);
+	mRenderItems.Culler().Cull(frustumPlanes, mVisibleObjects, &mWorkerPool);
+
+	// Rasterize the occluders and drop what they hide.  An occluder never hides itself:
+	// its bounds start in front of its surface.
+	mOcclusionCuller.Clear();
+	mOcclusionCuller.AddOccluder(&mBoxGeo.OccluderPositions[0].x, sizeof(XMFLOAT3), mBoxGeo.OccluderIndices.data(),
+		mBoxGeo.OccluderIndices.size(), XMLoadFloat4x4(&mTransforms.World(mBoxTransform)) * viewProj);
+	mOcclusionCuller.Render(&mWorkerPool);
+	mOcclusionCuller.Cull(mRenderItems.Bounds(), mVisibleObjects, viewProj);
+
+	// The coarsest LOD of each visible item that stays within gLodPixelError at the
+	// distance of its bounds, and the item's sort key at that distance.
+	float projectionScale = 0.5f * g_ClientHeight * mProj._22;
+	const BoundingBox* itemBounds = mRenderItems.Bounds();
+	const SubmeshHandle* itemSubmeshes = mRenderItems.Submeshes();
+	const std::uint32_t* itemPipelines = mRenderItems.Pipelines();
+	const std::uint32_t* itemMaterials = mRenderItems.Materials();
+	mVisibleSubmeshes.resize(mVisibleObjects.size());
+	mDrawPackets.Clear();
+	for (size_t i = 0; i < mVisibleObjects.size(); ++i)
+	{
+		std::uint32_t index = mVisibleObjects[i];
+		float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&itemBounds[index].Center) - pos));
+		mVisibleSubmeshes[i] = mBoxGeo.Submeshes.SelectLod(itemSubmeshes[index], gLodPixelError * distance / projectionScale);
 
-	// Update the constant buffer with the latest worldViewProj matrix.
-	ObjectConstants objConstants;
-	XMStoreFloat4x4(&objConstants.WorldViewProj, XMMatrixTranspose(worldViewProj));
+		const MyPipeline& pipeline = mPipelines[itemPipelines[index]];
+		mDrawPackets.Add(DrawKey::Make(pipeline.Pass, pipeline.RootSignature, itemPipelines[index], itemMaterials[index],
+			distance), (std::uint32_t)i);
+	}
 
-	// Map the constant buffer resource.
-	UINT8* cbvDataBegin;
-	CD3DX12_RANGE readRange(0, 0); // We do not intend to read from this resource on the CPU.
-	HRESULT hr = constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&cbvDataBegin));
-	if (FAILED(hr))
+	// Put the visible list in key order.  The batches below come out in the order of
+	// their first item, so they follow it too.
+	mDrawPackets.Sort(&mWorkerPool);
+	mSortedObjects.resize(mVisibleObjects.size());
+	mSortedSubmeshes.resize(mVisibleSubmeshes.size());
+	for (size_t i = 0; i < mDrawPackets.Size(); ++i)
 	{
-		// Handle mapping failure
-		// This could be due to incorrect resource setup or other issues
-		// Print error message or throw an exception
-		return;
+		mSortedObjects[i] = mVisibleObjects[mDrawPackets[i].Item];
+		mSortedSubmeshes[i] = mVisibleSubmeshes[mDrawPackets[i].Item];
+	}
+	mVisibleObjects.swap(mSortedObjects);
+	mVisibleSubmeshes.swap(mSortedSubmeshes);
+
+	// The arena stays mapped; the GPU is done with this frame resource, so its slots
+	// from the last time around can be handed out again.
+	ConstantBufferArena* objectCB = mCurrFrameResource->ObjectCB.get();
+	objectCB->Reset();
+
+	PassConstants passConstants;
+	XMStoreFloat4x4(&passConstants.ViewProj, XMMatrixTranspose(viewProj));
+	mPassCBAddress = objectCB->Push(passConstants).GpuAddress;
+
+	// Group the visible items into instanced batches and write their instance data
+	// straight into the arena.
+	mInstanceBatcher.Build(mVisibleObjects.data(), mVisibleSubmeshes.data(), (std::uint32_t)mVisibleObjects.size(),
+		mRenderItems.Pipelines(), mRenderItems.Geometries());
+	const UINT instanceBytes = mInstanceBatcher.InstanceCount() * sizeof(InstanceData);
+	mInstanceBufferView = {};
+	if (instanceBytes > 0)
+	{
+		ConstantBufferArena::Slot instanceSlot = objectCB->Allocate(instanceBytes);
+		mInstanceBatcher.WriteInstances(reinterpret_cast<InstanceData*>(instanceSlot.CpuAddress),
+			mRenderItems.Worlds(), mRenderItems.Materials());
+		mInstanceBufferView.BufferLocation = instanceSlot.GpuAddress;
+		mInstanceBufferView.SizeInBytes = instanceBytes;
+		mInstanceBufferView.StrideInBytes = sizeof(InstanceData);
 	}
 
-	// Copy the constant buffer data.
-	memcpy(cbvDataBegin, &objConstants, sizeof(ObjectConstants));
-
-	// Unmap the constant buffer resource.
-	constantBuffer->Unmap(0, nullptr);
+	ReportInstancing();
 }
 
 
 void Draw()
 {
-	mDirectCmdListAlloc->Reset();
-
-	mCommandList->Reset(mDirectCmdListAlloc, mPSO);
-
-	mCommandList->RSSetViewports(1, &mScreenViewport);
-	mCommandList->RSSetScissorRects(1, &mScissorRect);
+	auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
 
-	auto resourceBarrier5 = CD3DX12_RESOURCE_BARRIER::Transition(mSwapChainBuffer[mCurrBackBuffer],
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	// Reuse the memory associated with command recording.
+	// We can only reset when the associated command lists have finished execution on the GPU.
+	cmdListAlloc->Reset();
 
-	mCommandList->ResourceBarrier(1, &resourceBarrier5);
+	mCommandList->Reset(cmdListAlloc.Get(), mPSO);
 
-	mCommandList->ClearRenderTargetView(CD3DX12_CPU_DESCRIPTOR_HANDLE(
-										mRtvHeap->GetCPUDescriptorHandleForHeapStart(),
-										mCurrBackBuffer,
-										mRtvDescriptorSize)
-										, Colors::LightSteelBlue, 0, nullptr);
-	mCommandList->ClearDepthStencilView(mDsvHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+	// The frame is declared every time but only recompiled when its shape changes.
+	mRenderGraph->Begin();
 
-	auto descriptorHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-		mRtvHeap->GetCPUDescriptorHandleForHeapStart(),
-		mCurrBackBuffer,
-		mRtvDescriptorSize);
-	auto handleforheap = mDsvHeap->GetCPUDescriptorHandleForHeapStart();
-	mCommandList->OMSetRenderTargets(1, &descriptorHandle, true, &handleforheap);
+	auto backBuffer = mRenderGraph->Import("BackBuffer", mSwapChainBuffer[mCurrBackBuffer], D3D12_RESOURCE_STATE_PRESENT);
+	auto depthStencil = mRenderGraph->Import("DepthStencil", mDepthStencilBuffer);
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { mCbvHeap };
-	mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-
-	mCommandList->SetGraphicsRootSignature(mRootSignature);
-
-	mCommandList->IASetVertexBuffers(0, 1, &mBoxGeo.VertexBufferView);
-	mCommandList->IASetIndexBuffer(&mBoxGeo.IndexBufferView);
-	mCommandList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	auto forwardPass = mRenderGraph->AddPass("Forward", [](ID3D12GraphicsCommandList* cmdList)
+	{
+		cmdList->RSSetViewports(1, &mScreenViewport);
+		cmdList->RSSetScissorRects(1, &mScissorRect);
 
-	mCommandList->SetGraphicsRootDescriptorTable(0, mCbvHeap->GetGPUDescriptorHandleForHeapStart());
+		cmdList->ClearRenderTargetView(mBackBufferRtvs.Cpu(mCurrBackBuffer), Colors::LightSteelBlue, 0, nullptr);
+		cmdList->ClearDepthStencilView(mDepthStencilDsv.CpuStart, D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
 
-	mCommandList->DrawIndexedInstanced(36, 1, 0, 0, 0);
+		auto descriptorHandle = mBackBufferRtvs.Cpu(mCurrBackBuffer);
+		auto handleforheap = mDepthStencilDsv.CpuStart;
+		cmdList->OMSetRenderTargets(1, &descriptorHandle, true, &handleforheap);
 
-	auto resourcebarrier6 = CD3DX12_RESOURCE_BARRIER::Transition(mSwapChainBuffer[mCurrBackBuffer],
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
+		D3D12_VERTEX_BUFFER_VIEW vertexBufferViews[] =
+		{
+			mGeometryBuffer->VertexBufferView(mVertexFormat),
+			mInstanceBufferView
+		};
+		D3D12_INDEX_BUFFER_VIEW indexBufferView = mGeometryBuffer->IndexBufferView(mGeometryBuffer->IndexFormat(mBoxGeo.Geometry));
+		cmdList->IASetVertexBuffers(0, _countof(vertexBufferViews), vertexBufferViews);
+		cmdList->IASetIndexBuffer(&indexBufferView);
+		cmdList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		// One draw per batch, in key order; StartInstanceLocation offsets the per-instance
+		// stream to the batch's instances.  Every item draws from mBoxGeo for now.
+		ID3D12DescriptorHeap* descriptorHeaps[] = { mGpuDescriptorHeap->Heap() };
+		const SubmeshTable& submeshes = mBoxGeo.Submeshes;
+		mDrawState.Begin(cmdList, mPSO);
+		for (const InstanceBatch& batch : mInstanceBatcher.Batches())
+		{
+			const MyPipeline& pipeline = mPipelines[batch.Pipeline];
+			mDrawState.SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+			if (mDrawState.SetGraphicsRootSignature(mRootSignatures[pipeline.RootSignature]))
+				cmdList->SetGraphicsRootConstantBufferView(0, mPassCBAddress);
+			mDrawState.SetPipelineState(pipeline.State);
+
+			cmdList->DrawIndexedInstanced(submeshes.IndexCount(batch.Submesh), batch.InstanceCount,
+				mGeometryBuffer->StartIndexLocation(batch.Geometry) + submeshes.StartIndexLocation(batch.Submesh),
+				mGeometryBuffer->BaseVertexLocation(batch.Geometry) + submeshes.BaseVertexLocation(batch.Submesh),
+				batch.FirstInstance);
+		}
+	});
+	mRenderGraph->Write(forwardPass, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	mRenderGraph->Write(forwardPass, depthStencil, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 
-	mCommandList->ResourceBarrier(1, &resourcebarrier6);
+	mRenderGraph->Execute(mCommandList);
 
 	mCommandList->Close();
 
@@ -742,7 +939,13 @@ void Draw()
 	mSwapChain->Present(0, 0);
 	mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
-	FlushCommandQueue();
+	// Advance the fence value to mark commands up to this fence point and remember it
+	// for the current frame slot.  The GPU may still be working on this frame; we only
+	// wait when the slot comes around again.
+	UINT64 frameFence = mFenceTimeline->Signal();
+	mFrameRing.MarkSubmitted(frameFence);
+	mGpuDescriptorHeap->Submit(frameFence);
+	mGeometryBuffer->Submit(frameFence);
 }
 
 
@@ -761,7 +964,7 @@ int Run()
 		// Otherwise, do animation/game stuff.
 		else
 		{
-			Update(constantBuffer);
+			Update();
 			Draw();
 		}
 	}